@@ -63,6 +63,13 @@
 #include "services/iot/cloud/wifi_service.h"
 #include "services/iot/cloud/bsd_adapter/bsdWINC.h"
 #include "credentials_storage/credentials_storage.h"
+#include "credentials_storage/dps_cache.h"
+#include "services/iot/cloud/backoff.h"
+#include "services/iot/cloud/power_manager.h"
+#include "idle.h"
+#include "console_dma.h"
+#include "scheduler.h"
+#include "perf.h"
 #include "debug_print.h"
 #include "led.h"
 #include "azutil.h"
@@ -96,6 +103,12 @@ static char *LED_Property[3] = {
 
 #ifdef CFG_MQTT_PROVISIONING_HOST
 void iot_provisioning_completed(void);
+#if CFG_DPS_CACHE_ENABLE
+static bool          appDpsCacheActive     = false;
+static volatile bool appDpsFallbackPending = false;   // Set from callbacks, handled in APP_Tasks()
+static void APP_ConnackRefusedCb(uint8_t returnCode);
+static void APP_FallbackToDps(void);
+#endif
 #endif
 // *****************************************************************************
 // *****************************************************************************
@@ -143,12 +156,13 @@ shared_networking_params_t shared_networking_params;
 static DRV_HANDLE wdrvHandle;
 static uint8_t    wifi_mode = WIFI_DEFAULT;
 
-static SYS_TIME_HANDLE App_DataTaskHandle      = SYS_TIME_HANDLE_INVALID;
-volatile bool          App_DataTaskTmrExpired  = false;
-static SYS_TIME_HANDLE App_CloudTaskHandle     = SYS_TIME_HANDLE_INVALID;
-volatile bool          App_CloudTaskTmrExpired = false;
+static SYS_TIME_HANDLE App_DataTaskHandle  = SYS_TIME_HANDLE_INVALID;
+static SYS_TIME_HANDLE App_CloudTaskHandle = SYS_TIME_HANDLE_INVALID;
 
 static time_t     previousTransmissionTime;
+#if CFG_DIAG_TELEMETRY_INTERVAL_SEC > 0
+static time_t     previousDiagnosticsTime;
+#endif
 volatile uint32_t telemetryInterval = CFG_DEFAULT_TELEMETRY_INTERVAL_SEC;
 
 volatile bool iothubConnected = false;
@@ -197,12 +211,12 @@ const az_span device_model_id_span = AZ_SPAN_LITERAL_FROM_STR(IOT_PLUG_AND_PLAY_
 // *****************************************************************************
 void APP_CloudTaskcb(uintptr_t context)
 {
-    App_CloudTaskTmrExpired = true;
+    SCHED_post(SCHED_EVENT_APP_CLOUD_TASK);
 }
 
 void APP_DataTaskcb(uintptr_t context)
 {
-    App_DataTaskTmrExpired = true;
+    SCHED_post(SCHED_EVENT_APP_DATA_TASK);
 }
 // *****************************************************************************
 // *****************************************************************************
@@ -255,6 +269,7 @@ void APP_SW1_Handler(void)
  */
 void APP_Initialize(void)
 {
+    CONSOLE_DMA_start();
     debug_printInfo("  APP: %s()", __FUNCTION__);
     /* Place the App state machine in its initial state. */
     appData.state = APP_STATE_CRYPTO_INIT;
@@ -265,6 +280,11 @@ void APP_Initialize(void)
 
     previousTransmissionTime = 0;
 
+    PERF_init();
+    SCHED_init();
+    SCHED_register(SCHED_EVENT_APP_CLOUD_TASK, CLOUD_task);
+    SCHED_register(SCHED_EVENT_APP_DATA_TASK, APP_DataTask);
+
     debug_init(attDeviceID);
     LED_init();
     LED_test();
@@ -333,6 +353,15 @@ static void APP_GetTimeNotifyCb(DRV_HANDLE handle, uint32_t timeUTC)
         theTime.tm_mday  = pSysTime.u8Day;
         theTime.tm_isdst = 0;
         RTC_RTCCTimeSet(&theTime);
+
+#if defined(CFG_MQTT_PROVISIONING_HOST) && CFG_DPS_CACHE_ENABLE
+        // First chance to check the age of the cached assignment
+        if (appDpsCacheActive && DPS_CACHE_isExpired((uint32_t)mktime(&theTime)))
+        {
+            debug_printInfo("  APP: Cached DPS assignment expired");
+            appDpsFallbackPending = true;
+        }
+#endif
     }
 }
 
@@ -371,6 +400,8 @@ static void APP_ProvisionRespCb(DRV_HANDLE handle, WDRV_WINC_SSID* targetSSID,
 
 void APP_Tasks(void)
 {
+    PERF_BEGIN(APP_TASKS);
+
     switch (appData.state)
     {
         case APP_STATE_CRYPTO_INIT: {
@@ -385,6 +416,16 @@ void APP_Tasks(void)
             {
                 debug_printError("  APP: CryptoAuthInit failed");
             }
+            else
+            {
+                uint32_t seed;
+
+                // Randomize reconnect backoff so a fleet does not retry in lockstep
+                if (CRYPTO_CLIENT_getRandom32(&seed) == NO_ERROR)
+                {
+                    BACKOFF_seed(seed);
+                }
+            }
 
 #ifdef HUB_DEVICE_ID
             attDeviceID = HUB_DEVICE_ID;
@@ -436,6 +477,7 @@ void APP_Tasks(void)
 
             if (DRV_HANDLE_INVALID != wdrvHandle)
             {
+                POWER_init(wdrvHandle);
                 appData.state = APP_STATE_WDRV_OPEN;
             }
 
@@ -452,8 +494,23 @@ void APP_Tasks(void)
             wifi_init(APP_WiFiConnectionStateChanged, wifi_mode);
 
 #ifdef CFG_MQTT_PROVISIONING_HOST
-            pf_mqtt_iotprovisioning_client.MQTT_CLIENT_task_completed = iot_provisioning_completed;
-            CLOUD_init_host(CFG_MQTT_PROVISIONING_HOST, attDeviceID, &pf_mqtt_iotprovisioning_client);
+#if CFG_DPS_CACHE_ENABLE
+            MQTT_Set_ConnackRefused_callback(APP_ConnackRefusedCb);
+
+            if (DPS_CACHE_load(attDeviceID) == true)
+            {
+                // Skip DPS and go straight to the hub we were assigned last time
+                appDpsCacheActive                                = true;
+                hub_hostname                                     = DPS_CACHE_getHubHostname();
+                pf_mqtt_iothub_client.MQTT_CLIENT_task_completed = iot_connection_completed;
+                CLOUD_init_host(hub_hostname, DPS_CACHE_getDeviceId(), &pf_mqtt_iothub_client);
+            }
+            else
+#endif
+            {
+                pf_mqtt_iotprovisioning_client.MQTT_CLIENT_task_completed = iot_provisioning_completed;
+                CLOUD_init_host(CFG_MQTT_PROVISIONING_HOST, attDeviceID, &pf_mqtt_iotprovisioning_client);
+            }
 #else
             CLOUD_init_host(hub_hostname, attDeviceID, &pf_mqtt_iothub_client);
 #endif   //CFG_MQTT_PROVISIONING_HOST
@@ -470,25 +527,20 @@ void APP_Tasks(void)
             }
 
             appData.state = APP_STATE_WDRV_ACTIV;
+            IDLE_start();
             break;
         }
 
         case APP_STATE_WDRV_ACTIV: {
-            if (App_CloudTaskTmrExpired == true)
-            {
-                App_CloudTaskTmrExpired = false;
-                CLOUD_task();
-            }
-
-            if (App_DataTaskTmrExpired == true)
+#if defined(CFG_MQTT_PROVISIONING_HOST) && CFG_DPS_CACHE_ENABLE
+            // Outside CLOUD_task(), which may be the one that asked for it
+            if (appDpsFallbackPending)
             {
-                App_DataTaskTmrExpired = false;
-                APP_DataTask();
+                appDpsFallbackPending = false;
+                APP_FallbackToDps();
             }
-
-            CLOUD_sched();
-            wifi_sched();
-            MQTT_sched();
+#endif
+            SCHED_run();
             break;
         }
         default: {
@@ -496,6 +548,8 @@ void APP_Tasks(void)
             break;
         }
     }
+
+    PERF_END(APP_TASKS);
 }
 
 // This gets called by the scheduler approximately every 100ms
@@ -519,7 +573,22 @@ static void APP_DataTask(void)
 
             // send telemetry
             APP_SendToCloud();
+            POWER_setDeadline(POWER_DEADLINE_TELEMETRY, telemetryInterval * 1000);
+        }
+
+#if CFG_DIAG_TELEMETRY_INTERVAL_SEC > 0
+        if (difftime(timeNow, previousDiagnosticsTime) >= CFG_DIAG_TELEMETRY_INTERVAL_SEC)
+        {
+            az_result rc;
+
+            previousDiagnosticsTime = timeNow;
+            rc                      = send_diagnostics_message();
+            if (az_result_failed(rc))
+            {
+                debug_printError("  APP: Diagnostics telemetry not sent, return code 0x%08x", rc);
+            }
         }
+#endif
 
         check_button_status();
     }
@@ -627,7 +696,11 @@ void APP_ReceivedFromCloud_patch(uint8_t* topic, uint8_t* payload)
 
     debug_printInfo("  APP: %s() Payload %s", __FUNCTION__, payload);
 
-    if (az_result_failed(rc = process_device_twin_property(topic, payload, &twin_properties)))
+    PERF_BEGIN(TWIN_PARSE);
+    rc = process_device_twin_property(topic, payload, &twin_properties);
+    PERF_END(TWIN_PARSE);
+
+    if (az_result_failed(rc))
     {
         // If the item can't be found, the desired temp might not be set so take no action
         debug_printError("  APP: Could not parse desired property, return code 0x%08x\n", rc);
@@ -646,7 +719,9 @@ void APP_ReceivedFromCloud_patch(uint8_t* topic, uint8_t* payload)
             debug_printInfo("  APP: Found telemetryInterval value '%d'", telemetryInterval);
         }
         update_leds(&twin_properties);
+        PERF_BEGIN(REPORTED_PROPERTY);
         send_reported_property(&twin_properties);
+        PERF_END(REPORTED_PROPERTY);
     }
 }
 
@@ -666,7 +741,11 @@ void APP_ReceivedFromCloud_twin(uint8_t* topic, uint8_t* payload)
 
     debug_printTrace("  APP: %s() Payload %s", __FUNCTION__, payload);
 
-    if (az_result_failed(rc = process_device_twin_property(topic, payload, &twin_properties)))
+    PERF_BEGIN(TWIN_PARSE);
+    rc = process_device_twin_property(topic, payload, &twin_properties);
+    PERF_END(TWIN_PARSE);
+
+    if (az_result_failed(rc))
     {
         // If the item can't be found, the desired temp might not be set so take no action
         debug_printError("  APP: Could not parse desired property, return code 0x%08x\n", rc);
@@ -691,7 +770,9 @@ void APP_ReceivedFromCloud_twin(uint8_t* topic, uint8_t* payload)
         }
 
         update_leds(&twin_properties);
+        PERF_BEGIN(REPORTED_PROPERTY);
         send_reported_property(&twin_properties);
+        PERF_END(REPORTED_PROPERTY);
     }
 
     //debug_printInfo("  APP: << %s() rc = 0x%08x", __FUNCTION__, rc);
@@ -803,6 +884,33 @@ void iot_provisioning_completed(void)
     CLOUD_reset();
     LED_SetCloud(LED_INDICATOR_PENDING);
 }
+
+#if CFG_DPS_CACHE_ENABLE
+//
+// Drop the cached assignment and provision through DPS again.
+//
+static void APP_FallbackToDps(void)
+{
+    appDpsCacheActive = false;
+    DPS_CACHE_invalidate();
+    pf_mqtt_iotprovisioning_client.MQTT_CLIENT_task_completed = iot_provisioning_completed;
+    CLOUD_init_host(CFG_MQTT_PROVISIONING_HOST, attDeviceID, &pf_mqtt_iotprovisioning_client);
+    CLOUD_reset();
+    LED_SetCloud(LED_INDICATOR_PENDING);
+}
+
+static void APP_ConnackRefusedCb(uint8_t returnCode)
+{
+    if (appDpsCacheActive)
+    {
+        // The device may have been re-assigned or deleted from the cached hub
+        debug_printWarn("  APP: Hub refused cached assignment (%d)", returnCode);
+        // Called from MQTT_ReceptionHandler(), which closes the connection
+        // next; the cloud service is reset once it has returned
+        appDpsFallbackPending = true;
+    }
+}
+#endif
 #endif   //CFG_MQTT_PROVISIONING_HOST
 
 /*******************************************************************************
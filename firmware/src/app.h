@@ -60,6 +60,7 @@
 #include "azure/core/az_span.h"
 #include "azure/core/az_json.h"
 #include "azure/iot/az_iot_pnp_client.h"
+#include "services/iot/cloud/wifi_service.h"
 
 // DOM-IGNORE-BEGIN
 #ifdef __cplusplus   // Provide C++ Compatibility
@@ -202,25 +203,6 @@ void APP_Tasks(void);
 
 void set_deviceId(char* id);
 
-typedef union
-{
-    uint16_t allBits;
-    struct
-    {
-        uint16_t haveAPConnection : 1;
-        uint16_t haveIpAddress : 1;
-        uint16_t haveHostIp : 1;
-        uint16_t haveSocketConnection : 1;
-        uint16_t haveMqttConnection : 1;
-        uint16_t amDisconnecting : 1;
-        uint16_t haveERROR : 1;
-        uint16_t cloudInitPending : 1;
-        uint16_t : 8;
-    };
-} shared_networking_params_t;
-
-extern shared_networking_params_t shared_networking_params;
-
 void    iot_connection_completed(void);
 void    APP_ReceivedFromCloud_methods(uint8_t* topic, uint8_t* payload);
 void    APP_ReceivedFromCloud_patch(uint8_t* topic, uint8_t* payload);
@@ -1,7 +1,13 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // SPDX-License-Identifier: MIT
 
+#define DEBUG_MODULE AZUTIL
+
 #include "azutil.h"
+#include "dtdl_model.h"
+#include "perf.h"
+#include "metrics.h"
+#include "mqtt/mqtt_comm_bsd/mqtt_comm_layer.h"
 
 #ifdef IOT_PLUG_AND_PLAY_MODEL_ID
 extern az_iot_pnp_client pnp_client;
@@ -17,6 +23,13 @@ extern uint16_t packet_identifier;
 
 static char pnp_telemetry_topic_buffer[128];
 static char pnp_telemetry_payload_buffer[128];
+#if CFG_DIAG_TELEMETRY_INTERVAL_SEC > 0
+// The diagnostics PUBLISH goes out whole from the MQTT transmit buffer: one
+// byte of fixed header, two of remaining length, two of topic length, the
+// topic, then the payload (QoS 0, no packet identifier)
+#define DIAGNOSTICS_PUBLISH_HEADER_SIZE (1 + 2 + 2)
+static char diagnostics_payload_buffer[MQTT_TX_BUFF_SIZE - DIAGNOSTICS_PUBLISH_HEADER_SIZE];
+#endif
 
 static char pnp_property_topic_buffer[128];
 static char pnp_property_payload_buffer[256];
@@ -34,30 +47,19 @@ static const az_span iot_hub_property_desired         = AZ_SPAN_LITERAL_FROM_STR
 static const az_span iot_hub_property_desired_version = AZ_SPAN_LITERAL_FROM_STR("$version");
 #endif
 
-static const az_span telemetry_name_temperature_span = AZ_SPAN_LITERAL_FROM_STR("temperature");
-static const az_span telemetry_name_light_span       = AZ_SPAN_LITERAL_FROM_STR("light");
-
-// Telemetry Interval writable property
-static const az_span property_telemetry_interval_span = AZ_SPAN_LITERAL_FROM_STR("telemetryInterval");
-
 // Button Press
 button_press_data_t button_press_data = {0};
 static char         button_event_buffer[128];
 
-static const az_span event_name_button_event_span = AZ_SPAN_LITERAL_FROM_STR("button_event");
-static const az_span event_name_button_name_span  = AZ_SPAN_LITERAL_FROM_STR("button_name");
-static const az_span event_name_button_sw0_span   = AZ_SPAN_LITERAL_FROM_STR("SW0");
-static const az_span event_name_button_sw1_span   = AZ_SPAN_LITERAL_FROM_STR("SW1");
-static const az_span event_name_press_count_span  = AZ_SPAN_LITERAL_FROM_STR("press_count");
+static const az_span event_name_button_name_span = AZ_SPAN_LITERAL_FROM_STR("button_name");
+static const az_span event_name_button_sw0_span  = AZ_SPAN_LITERAL_FROM_STR("SW0");
+static const az_span event_name_button_sw1_span  = AZ_SPAN_LITERAL_FROM_STR("SW1");
+static const az_span event_name_press_count_span = AZ_SPAN_LITERAL_FROM_STR("press_count");
 
-// LED Properties
-static const az_span led_blue_property_name_span   = AZ_SPAN_LITERAL_FROM_STR("led_b");
-static const az_span led_green_property_name_span  = AZ_SPAN_LITERAL_FROM_STR("led_g");
-static const az_span led_yellow_property_name_span = AZ_SPAN_LITERAL_FROM_STR("led_y");
-static const az_span led_red_property_name_span    = AZ_SPAN_LITERAL_FROM_STR("led_r");
+// Property, telemetry and command names come from the tables in dtdl_model.c,
+// generated from the DTDL model by tools/dtdl_codegen.py
 
 // Command
-static const az_span command_name_reboot_span           = AZ_SPAN_LITERAL_FROM_STR("reboot");
 static const az_span command_reboot_delay_payload_span  = AZ_SPAN_LITERAL_FROM_STR("delay");
 static const az_span command_status_span                = AZ_SPAN_LITERAL_FROM_STR("status");
 static const az_span command_resp_success_span          = AZ_SPAN_LITERAL_FROM_STR("Success");
@@ -160,18 +162,43 @@ static az_result append_reported_property_response_int32(
 #endif
 /**********************************************
 * Build sensor telemetry JSON
+* One value for each telemetry in the model with a read handler
 **********************************************/
 az_result build_sensor_telemetry_message(
-    az_span* out_payload_span,
-    int32_t  temperature,
-    int32_t  light)
+    az_span* out_payload_span)
 {
     az_json_writer jw;
+    az_result      rc = AZ_OK;
+    int32_t        values[DTDL_TELEMETRY_COUNT];
+    uint8_t        i;
+
+    // Read the sensors first so the probe only times the JSON
+    for (i = 0; i < DTDL_TELEMETRY_COUNT; i++)
+    {
+        if (dtdlTelemetry[i].read != NULL)
+        {
+            values[i] = dtdlTelemetry[i].read();
+            debug_printGood("AZURE: %s: %ld", az_span_ptr(dtdlTelemetry[i].name), values[i]);
+        }
+    }
+
+    PERF_BEGIN(TELEMETRY_JSON);
     memset(&pnp_telemetry_payload_buffer, 0, sizeof(pnp_telemetry_payload_buffer));
-    RETURN_ERR_IF_FAILED(start_json_object(&jw, AZ_SPAN_FROM_BUFFER(pnp_telemetry_payload_buffer)));
-    RETURN_ERR_IF_FAILED(append_json_property_int32(&jw, telemetry_name_temperature_span, temperature));
-    RETURN_ERR_IF_FAILED(append_json_property_int32(&jw, telemetry_name_light_span, light));
-    RETURN_ERR_IF_FAILED(end_json_object(&jw));
+    rc = start_json_object(&jw, AZ_SPAN_FROM_BUFFER(pnp_telemetry_payload_buffer));
+    for (i = 0; i < DTDL_TELEMETRY_COUNT && az_result_succeeded(rc); i++)
+    {
+        if (dtdlTelemetry[i].read != NULL)
+        {
+            rc = append_json_property_int32(&jw, dtdlTelemetry[i].name, values[i]);
+        }
+    }
+    if (az_result_succeeded(rc))
+    {
+        rc = end_json_object(&jw);
+    }
+    PERF_END(TELEMETRY_JSON);
+
+    RETURN_ERR_IF_FAILED(rc);
     *out_payload_span = az_json_writer_get_bytes_used_in_destination(&jw);
     return AZ_OK;
 }
@@ -244,7 +271,7 @@ static az_result append_button_press_telemetry(
     az_span         button_name_span,
     int32_t         press_count)
 {
-    RETURN_ERR_IF_FAILED(az_json_writer_append_property_name(jw, event_name_button_event_span));
+    RETURN_ERR_IF_FAILED(az_json_writer_append_property_name(jw, dtdlTelemetry[DTDL_TELEMETRY_BUTTON_EVENT].name));
     RETURN_ERR_IF_FAILED(az_json_writer_append_begin_object(jw));
     RETURN_ERR_IF_FAILED(append_json_property_string(jw, event_name_button_name_span, button_name_span));
     RETURN_ERR_IF_FAILED(append_json_property_int32(jw, event_name_press_count_span, press_count));
@@ -323,14 +350,9 @@ az_result send_telemetry_message(void)
     az_result rc = AZ_OK;
     az_span   telemetry_payload_span;
 
-    int16_t temp  = APP_GetTempSensorValue();
-    int32_t light = APP_GetLightSensorValue();
-
-    debug_printGood("AZURE: Light: %d Temperature: %d", light, temp);
+    rc = build_sensor_telemetry_message(&telemetry_payload_span);
 
-    RETURN_ERR_WITH_MESSAGE_IF_FAILED(
-        build_sensor_telemetry_message(&telemetry_payload_span, temp, light),
-        "Failed to build sensor telemetry JSON payload");
+    RETURN_ERR_WITH_MESSAGE_IF_FAILED(rc, "Failed to build sensor telemetry JSON payload");
 
 #ifdef IOT_PLUG_AND_PLAY_MODEL_ID
     rc = az_iot_pnp_client_telemetry_get_publish_topic(&pnp_client,
@@ -353,6 +375,123 @@ az_result send_telemetry_message(void)
     return rc;
 }
 
+#if CFG_DIAG_TELEMETRY_INTERVAL_SEC > 0
+static az_result append_metric_name(
+    az_json_writer* jw,
+    const char*     name,
+    const char*     suffix)
+{
+    char property_name[32];
+    int  length;
+
+    length = snprintf(property_name, sizeof(property_name), "%s%s", name, suffix);
+    if (length < 0 || length >= (int)sizeof(property_name))
+    {
+        return AZ_ERROR_NOT_ENOUGH_SPACE;
+    }
+    return az_json_writer_append_property_name(jw, az_span_create((uint8_t*)property_name, length));
+}
+
+// Counters and histograms are unsigned and may pass INT32_MAX
+static az_result append_metric_uint32(
+    az_json_writer* jw,
+    const char*     name,
+    const char*     suffix,
+    uint32_t        value)
+{
+    uint8_t value_buffer[10];   // UINT32_MAX
+    az_span value_span = AZ_SPAN_FROM_BUFFER(value_buffer);
+    az_span remainder;
+
+    RETURN_ERR_IF_FAILED(append_metric_name(jw, name, suffix));
+    RETURN_ERR_IF_FAILED(az_span_u32toa(value_span, value, &remainder));
+    return az_json_writer_append_json_text(jw, az_span_slice(value_span, 0, az_span_size(value_span) - az_span_size(remainder)));
+}
+
+static az_result append_metric_int32(
+    az_json_writer* jw,
+    const char*     name,
+    const char*     suffix,
+    int32_t         value)
+{
+    RETURN_ERR_IF_FAILED(append_metric_name(jw, name, suffix));
+    return az_json_writer_append_int32(jw, value);
+}
+
+/**********************************************
+* Send the metrics registry as diagnostics telemetry
+* e.g.
+* {
+*   "diagnostics":{
+*     "mqttTxPackets":12,
+*     ...
+*     "pubackLatencyMsMax":420
+*   }
+* }
+**********************************************/
+az_result send_diagnostics_message(void)
+{
+    az_result      rc = AZ_OK;
+    az_json_writer jw;
+    az_span        diagnostics_payload_span;
+    uint8_t        i;
+
+#ifdef IOT_PLUG_AND_PLAY_MODEL_ID
+    rc = az_iot_pnp_client_telemetry_get_publish_topic(&pnp_client,
+                                                       AZ_SPAN_EMPTY,
+#else
+    rc = az_iot_hub_client_telemetry_get_publish_topic(&iothub_client,
+#endif
+                                                       NULL,
+                                                       pnp_telemetry_topic_buffer,
+                                                       sizeof(pnp_telemetry_topic_buffer),
+                                                       NULL);
+    RETURN_ERR_IF_FAILED(rc);
+
+    // Whatever the topic leaves of the transmit buffer; the JSON writer fails
+    // rather than hand MQTT a payload it would cut short
+    diagnostics_payload_span = az_span_slice(AZ_SPAN_FROM_BUFFER(diagnostics_payload_buffer),
+                                             0,
+                                             (int32_t)(sizeof(diagnostics_payload_buffer) - strlen(pnp_telemetry_topic_buffer)));
+
+    RETURN_ERR_IF_FAILED(start_json_object(&jw, diagnostics_payload_span));
+    RETURN_ERR_IF_FAILED(az_json_writer_append_property_name(&jw, dtdlTelemetry[DTDL_TELEMETRY_DIAGNOSTICS].name));
+    RETURN_ERR_IF_FAILED(az_json_writer_append_begin_object(&jw));
+
+    for (i = 0; i < METRIC_COUNTER_COUNT; i++)
+    {
+        RETURN_ERR_IF_FAILED(append_metric_uint32(&jw, METRICS_counterName((metric_counter_t)i), "", metricCounters[i]));
+    }
+
+    for (i = 0; i < METRIC_GAUGE_COUNT; i++)
+    {
+        RETURN_ERR_IF_FAILED(append_metric_int32(&jw, METRICS_gaugeName((metric_gauge_t)i), "", metricGauges[i].value));
+        RETURN_ERR_IF_FAILED(append_metric_int32(&jw, METRICS_gaugeName((metric_gauge_t)i), "Max", metricGauges[i].max));
+    }
+
+    for (i = 0; i < METRIC_HISTOGRAM_COUNT; i++)
+    {
+        metric_histogram_value_t* hist = &metricHistograms[i];
+
+        RETURN_ERR_IF_FAILED(append_metric_uint32(&jw, METRICS_histogramName((metric_histogram_t)i), "Count", hist->count));
+        RETURN_ERR_IF_FAILED(append_metric_uint32(&jw, METRICS_histogramName((metric_histogram_t)i), "Avg", hist->count ? (uint32_t)(hist->sum / hist->count) : 0));
+        RETURN_ERR_IF_FAILED(append_metric_uint32(&jw, METRICS_histogramName((metric_histogram_t)i), "Max", hist->max));
+    }
+
+    RETURN_ERR_IF_FAILED(az_json_writer_append_end_object(&jw));
+    RETURN_ERR_IF_FAILED(end_json_object(&jw));
+
+    diagnostics_payload_span = az_json_writer_get_bytes_used_in_destination(&jw);
+
+    // QoS 0, a lost sample is fine and it does not hold up telemetry waiting for PUBACK
+    CLOUD_publishData((uint8_t*)pnp_telemetry_topic_buffer,
+                      az_span_ptr(diagnostics_payload_span),
+                      az_span_size(diagnostics_payload_span),
+                      0);
+    return rc;
+}
+#endif
+
 /**********************************************
 * Check if LED status has changed or not.
 * If any LED status has changed, update Device Twin
@@ -527,7 +666,7 @@ void reboot_task_callback(uintptr_t context)
 /**********************************************
 *	Handle reboot command
 **********************************************/
-static az_result process_reboot_command(
+az_result dtdl_command_reboot(
     az_span   payload_span,
     az_span   response_span,
     az_span*  out_response_span,
@@ -633,28 +772,31 @@ az_result process_direct_method_command(
     az_iot_hub_client_method_request* method_request)
 #endif
 {
-    az_result rc                = AZ_OK;
-    uint16_t  response_status   = AZ_IOT_STATUS_BAD_REQUEST;   // assume error
-    az_span   command_resp_span = AZ_SPAN_FROM_BUFFER(command_resp_buffer);
-    az_span   payload_span      = az_span_create_from_str((char*)payload);
+    az_result             rc                = AZ_OK;
+    uint16_t              response_status   = AZ_IOT_STATUS_BAD_REQUEST;   // assume error
+    az_span               command_resp_span = AZ_SPAN_FROM_BUFFER(command_resp_buffer);
+    az_span               payload_span      = az_span_create_from_str((char*)payload);
+    const dtdl_command_t* command;
 
 #ifdef IOT_PLUG_AND_PLAY_MODEL_ID
-    debug_printInfo("AZURE: Processing Command '%s'", command_request->command_name);
+    debug_printInfo("AZURE: Processing Command '%.*s'", az_span_size(command_request->command_name), az_span_ptr(command_request->command_name));
 #else
-    debug_printInfo("AZURE: Processing Command '%s'", method_request->name);
+    debug_printInfo("AZURE: Processing Command '%.*s'", az_span_size(method_request->name), az_span_ptr(method_request->name));
 #endif
 
 #ifdef IOT_PLUG_AND_PLAY_MODEL_ID
-    if (az_span_is_content_equal(command_name_reboot_span, command_request->command_name))
+    command = DTDL_findCommand(command_request->command_name);
 #else
-    if (az_span_is_content_equal(command_name_reboot_span, method_request->name))
+    command = DTDL_findCommand(method_request->name);
 #endif
+
+    if (command != NULL)
     {
-        rc = process_reboot_command(payload_span, command_resp_span, &command_resp_span, &response_status);
+        rc = command->handler(payload_span, command_resp_span, &command_resp_span, &response_status);
 
         if (az_result_failed(rc))
         {
-            debug_printError("AZURE: Failed process_reboot_command, status 0x%08x", rc);
+            debug_printError("AZURE: Failed command '%s', status 0x%08x", az_span_ptr(command->name), rc);
             if (az_span_size(command_resp_span) == 0)
             {
                 // if response is empty, payload was not in the right format.
@@ -792,9 +934,10 @@ az_result process_device_twin_property(
     uint8_t*           payload,
     twin_properties_t* twin_properties)
 {
-    az_result rc;
-    az_span   property_topic_span;
-    az_span   payload_span;
+    az_result              rc;
+    az_span                property_topic_span;
+    az_span                payload_span;
+    const dtdl_property_t* property;
 
 #ifdef IOT_PLUG_AND_PLAY_MODEL_ID
     az_span component_name_span;
@@ -851,8 +994,9 @@ az_result process_device_twin_property(
     else if (property_response.response_type == AZ_IOT_HUB_CLIENT_TWIN_RESPONSE_TYPE_DESIRED_PROPERTIES)
 #endif
     {
-        debug_printInfo("AZURE: Property DESIRED Status %d Version %s",
+        debug_printInfo("AZURE: Property DESIRED Status %d Version %.*s",
                         property_response.status,
+                        az_span_size(property_response.version),
                         az_span_ptr(property_response.version));
     }
 #ifdef IOT_PLUG_AND_PLAY_MODEL_ID
@@ -863,8 +1007,9 @@ az_result process_device_twin_property(
     {
         if (!az_iot_status_succeeded(property_response.status))
         {
-            debug_printInfo("AZURE: Property REPORTED Status %d Version %s",
+            debug_printInfo("AZURE: Property REPORTED Status %d Version %.*s",
                             property_response.status,
+                            az_span_size(property_response.version),
                             az_span_ptr(property_response.version));
         }
 
@@ -873,10 +1018,12 @@ az_result process_device_twin_property(
     }
     else
     {
-        debug_printInfo("AZURE: Type %d Status %d ID %s Version %s",
+        debug_printInfo("AZURE: Type %d Status %d ID %.*s Version %.*s",
                         property_response.response_type,
                         property_response.status,
+                        az_span_size(property_response.request_id),
                         az_span_ptr(property_response.request_id),
+                        az_span_size(property_response.version),
                         az_span_ptr(property_response.version));
     }
 
@@ -917,22 +1064,13 @@ az_result process_device_twin_property(
         property_response.response_type,
         &component_name_span)))
     {
-        if (az_json_token_is_text_equal(&jr.token, property_telemetry_interval_span))
-        {
-            uint32_t data;
-            // found writable property to adjust telemetry interval
-            RETURN_ERR_IF_FAILED(az_json_reader_next_token(&jr));
-            RETURN_ERR_IF_FAILED(az_json_token_get_uint32(&jr.token, &data));
-            twin_properties->flag.telemetry_interval_found = 1;
-            telemetryInterval                              = data;
-        }
-        else if (az_json_token_is_text_equal(&jr.token, led_yellow_property_name_span))
+        property = DTDL_findProperty(jr.token.slice);
+
+        if (property != NULL && property->desired != NULL)
         {
-            // found writable property to control Yellow LED
+            // found writable property, its handler parses the value
             RETURN_ERR_IF_FAILED(az_json_reader_next_token(&jr));
-            RETURN_ERR_IF_FAILED(az_json_token_get_int32(&jr.token,
-                                                         &twin_properties->desired_led_yellow));
-            twin_properties->flag.yellow_led_found = 1;
+            RETURN_ERR_IF_FAILED(property->desired(&jr.token, twin_properties));
         }
         else
         {
@@ -972,22 +1110,13 @@ az_result process_device_twin_property(
         {
             if (jr.token.kind == AZ_JSON_TOKEN_PROPERTY_NAME)
             {
-                if (az_json_token_is_text_equal(&jr.token, property_telemetry_interval_span))
-                {
-                    uint32_t data;
-                    // found writable property to adjust telemetry interval
-                    RETURN_ERR_IF_FAILED(az_json_reader_next_token(&jr));
-                    RETURN_ERR_IF_FAILED(az_json_token_get_uint32(&jr.token, &data));
-                    twin_properties->flag.telemetry_interval_found = 1;
-                    telemetryInterval                              = data;
-                }
-                else if (az_json_token_is_text_equal(&jr.token, led_yellow_property_name_span))
+                property = DTDL_findProperty(jr.token.slice);
+
+                if (property != NULL && property->desired != NULL)
                 {
-                    // found writable property to control Yellow LED
+                    // found writable property, its handler parses the value
                     RETURN_ERR_IF_FAILED(az_json_reader_next_token(&jr));
-                    RETURN_ERR_IF_FAILED(az_json_token_get_int32(&jr.token,
-                                                                 &twin_properties->desired_led_yellow));
-                    twin_properties->flag.yellow_led_found = 1;
+                    RETURN_ERR_IF_FAILED(property->desired(&jr.token, twin_properties));
                 }
                 else if (az_json_token_is_text_equal(&jr.token, iot_hub_property_desired_version))
                 {
@@ -1032,6 +1161,80 @@ int32_t get_led_value(uint16_t led_flag)
     return led_property_value;
 }
 
+/**********************************************
+* DTDL model handlers, bound by the tables in dtdl_model.c
+**********************************************/
+az_result dtdl_desired_telemetryInterval(
+    az_json_token*     token,
+    twin_properties_t* twin_properties)
+{
+    uint32_t data;
+
+    RETURN_ERR_IF_FAILED(az_json_token_get_uint32(token, &data));
+    twin_properties->flag.telemetry_interval_found = 1;
+    telemetryInterval                              = data;
+    return AZ_OK;
+}
+
+bool dtdl_reported_telemetryInterval(
+    const twin_properties_t* twin_properties,
+    int32_t*                 value)
+{
+    *value = (int32_t)telemetryInterval;
+    return twin_properties->flag.telemetry_interval_found;
+}
+
+az_result dtdl_desired_led_y(
+    az_json_token*     token,
+    twin_properties_t* twin_properties)
+{
+    RETURN_ERR_IF_FAILED(az_json_token_get_int32(token, &twin_properties->desired_led_yellow));
+    twin_properties->flag.yellow_led_found = 1;
+    return AZ_OK;
+}
+
+bool dtdl_reported_led_y(
+    const twin_properties_t* twin_properties,
+    int32_t*                 value)
+{
+    *value = get_led_value(led_status.state_flag.yellow);
+    return twin_properties->desired_led_yellow != LED_TWIN_NO_CHANGE;
+}
+
+bool dtdl_reported_led_r(
+    const twin_properties_t* twin_properties,
+    int32_t*                 value)
+{
+    *value = twin_properties->reported_led_red;
+    return twin_properties->reported_led_red != LED_TWIN_NO_CHANGE;
+}
+
+bool dtdl_reported_led_g(
+    const twin_properties_t* twin_properties,
+    int32_t*                 value)
+{
+    *value = twin_properties->reported_led_green;
+    return twin_properties->reported_led_green != LED_TWIN_NO_CHANGE;
+}
+
+bool dtdl_reported_led_b(
+    const twin_properties_t* twin_properties,
+    int32_t*                 value)
+{
+    *value = twin_properties->reported_led_blue;
+    return twin_properties->reported_led_blue != LED_TWIN_NO_CHANGE;
+}
+
+int32_t dtdl_telemetry_temperature(void)
+{
+    return (int16_t)APP_GetTempSensorValue();
+}
+
+int32_t dtdl_telemetry_light(void)
+{
+    return APP_GetLightSensorValue();
+}
+
 /**********************************************
 * Create AZ Span for Reported Property Request ID 
 **********************************************/
@@ -1059,7 +1262,8 @@ az_result send_reported_property(
     az_result      rc;
     az_json_writer jw;
     az_span        identifier_span;
-    int32_t        led_property_value;
+    int32_t        property_value;
+    uint8_t        i;
 
     if (twin_properties->flag.as_uint16 == 0)
     {
@@ -1077,142 +1281,41 @@ az_result send_reported_property(
     rc = start_json_object(&jw, payload_span);
     RETURN_ERR_WITH_MESSAGE_IF_FAILED(rc, "AZURE:Unable to initialize json writer for property PATCH");
 
-    if (twin_properties->flag.telemetry_interval_found)
+    // Writable properties acknowledge the desired version they applied, or
+    // version 1 when reporting the current value after the initial GET
+    for (i = 0; i < DTDL_PROPERTY_COUNT; i++)
     {
-        if (az_result_failed(
-#ifdef IOT_PLUG_AND_PLAY_MODEL_ID
-                rc = append_reported_property_response_int32(
-                    &jw,
-                    property_telemetry_interval_span,
-                    telemetryInterval,
-                    AZ_IOT_STATUS_OK,
-                    twin_properties->version_num,
-                    AZ_SPAN_FROM_STR("Success"))))
-#else
-                rc = append_json_property_int32(
-                    &jw,
-                    property_telemetry_interval_span,
-                    telemetryInterval)))
-#endif
-        {
-            debug_printError("AZURE: Unable to add property for telemetry interval, return code 0x%08x", rc);
-            return rc;
-        }
-    }
-    else if (twin_properties->flag.is_initial_get)
-    {
-        if (az_result_failed(
+        const dtdl_property_t* property = &dtdlProperties[i];
+        bool                   changed  = property->reported(twin_properties, &property_value);
 
-#ifdef IOT_PLUG_AND_PLAY_MODEL_ID
-                rc = append_reported_property_response_int32(
-                    &jw,
-                    property_telemetry_interval_span,
-                    telemetryInterval,
-                    AZ_IOT_STATUS_OK,
-                    1,
-                    AZ_SPAN_FROM_STR("Success"))))
-#else
-                rc = append_json_property_int32(
-                    &jw,
-                    property_telemetry_interval_span,
-                    telemetryInterval)))
-#endif
+        if (!changed && !twin_properties->flag.is_initial_get)
         {
-            debug_printError("AZURE: Unable to add property for telemetry interval, return code 0x%08x", rc);
-            return rc;
+            continue;
         }
-    }
-    // Add Yellow LED to the reported property
-    // Example with integer Enum
-    if (twin_properties->desired_led_yellow != LED_TWIN_NO_CHANGE)
-    {
-        led_property_value = get_led_value(led_status.state_flag.yellow);
 
-        if (az_result_failed(
 #ifdef IOT_PLUG_AND_PLAY_MODEL_ID
-                rc = append_reported_property_response_int32(
-                    &jw,
-                    led_yellow_property_name_span,
-                    led_property_value,
-                    AZ_IOT_STATUS_OK,
-                    twin_properties->version_num,
-                    AZ_SPAN_FROM_STR("Success"))))
-#else
-                rc = append_json_property_int32(
-                    &jw,
-                    led_yellow_property_name_span,
-                    led_property_value)))
-#endif
+        if (property->desired != NULL)
         {
-            debug_printError("AZURE: Unable to add property for Yellow LED, return code 0x%08x", rc);
-            return rc;
+            rc = append_reported_property_response_int32(
+                &jw,
+                property->name,
+                property_value,
+                AZ_IOT_STATUS_OK,
+                changed ? twin_properties->version_num : 1,
+                AZ_SPAN_FROM_STR("Success"));
         }
-    }
-    else if (twin_properties->flag.is_initial_get)
-    {
-        led_property_value = get_led_value(led_status.state_flag.yellow);
-
-        if (az_result_failed(
-
-#ifdef IOT_PLUG_AND_PLAY_MODEL_ID
-                rc = append_reported_property_response_int32(
-                    &jw,
-                    led_yellow_property_name_span,
-                    led_property_value,
-                    AZ_IOT_STATUS_OK,
-                    1,
-                    AZ_SPAN_FROM_STR("Success"))))
-#else
-                rc = append_json_property_int32(
-                    &jw,
-                    led_yellow_property_name_span,
-                    led_property_value)))
+        else
 #endif
         {
-            debug_printError("AZURE: Unable to add property for Yellow LED, return code 0x%08x", rc);
-            return rc;
-        }
-    }
-
-    // Add Red LED
-    // Example with String Enum
-    if (twin_properties->flag.is_initial_get || twin_properties->reported_led_red != LED_TWIN_NO_CHANGE)
-    {
-        if (az_result_failed(
-                rc = append_json_property_int32(
-                    &jw,
-                    led_red_property_name_span,
-                    twin_properties->reported_led_red)))
-        {
-            debug_printError("AZURE: Unable to add property for Red LED, return code  0x%08x", rc);
-            return rc;
-        }
-    }
-
-    // Add Blue LED
-    if (twin_properties->flag.is_initial_get || twin_properties->reported_led_blue != LED_TWIN_NO_CHANGE)
-    {
-        if (az_result_failed(
-                rc = append_json_property_int32(
-                    &jw,
-                    led_blue_property_name_span,
-                    twin_properties->reported_led_blue)))
-        {
-            debug_printError("AZURE: Unable to add property for Blue LED, return code  0x%08x", rc);
-            return rc;
+            rc = append_json_property_int32(
+                &jw,
+                property->name,
+                property_value);
         }
-    }
 
-    // Add Green LED
-    if (twin_properties->flag.is_initial_get || twin_properties->reported_led_green != LED_TWIN_NO_CHANGE)
-    {
-        if (az_result_failed(
-                rc = append_json_property_int32(
-                    &jw,
-                    led_green_property_name_span,
-                    twin_properties->reported_led_green)))
+        if (az_result_failed(rc))
         {
-            debug_printError("AZURE: Unable to add property for Green LED, return code  0x%08x", rc);
+            debug_printError("AZURE: Unable to add property '%s', return code 0x%08x", az_span_ptr(property->name), rc);
             return rc;
         }
     }
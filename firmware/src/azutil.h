@@ -140,6 +140,8 @@ void check_button_status(void);
 
 az_result send_telemetry_message(void);
 
+az_result send_diagnostics_message(void);
+
 az_result send_reported_property(
     twin_properties_t* twin_properties);
 
@@ -39,6 +39,8 @@
 #include "definitions.h"
 #include "osal/osal.h"
 #include "wdrv_winc_common.h"
+#include "wdrv_winc_spi.h"
+#include "perf.h"
 
 #if defined(USE_CACHE_MAINTENANCE)
 /* Cache Management to be enabled in core & system components of MHC Project Graph*/
@@ -54,8 +56,9 @@
 
 #ifdef DRV_SPI_DMA_MODE
 #define SPI_DMA_DCACHE_CLEAN(addr, size) WDRV_DCACHE_CLEAN(addr, size)
-#define SPI_DMA_MAX_TX_SIZE 1024
-#define SPI_DMA_MAX_RX_SIZE 1024
+/* DMAC BTCNT is 16 bits, so a whole HIF transfer fits in one descriptor */
+#define SPI_DMA_MAX_TX_SIZE 65535
+#define SPI_DMA_MAX_RX_SIZE 65535
 #else /* (DRV_SPI_DMA_MODE != 0) */
 #define SPI_DMA_DCACHE_CLEAN(addr, size) do { } while (0)
 #endif /* (DRV_SPI_DMA != 0) */
@@ -86,8 +89,13 @@ static void _DataCacheClean(unsigned char *address, uint32_t size)
 static DRV_SPI_TRANSFER_HANDLE transferTxHandle;
 static DRV_SPI_TRANSFER_HANDLE transferRxHandle;
 
+static WDRV_WINC_SPI_STATS spiStats;
+
 static bool _SPI_Tx(unsigned char *buf, uint32_t size)
 {
+    uint32_t startCount = SYS_TIME_CounterGet();
+    PERF_BEGIN(WINC_SPI_TX);
+
     SPI_DMA_DCACHE_CLEAN(buf, size);
     DRV_SPI_WriteTransferAdd(spiHandle, buf, size, &transferTxHandle);
 
@@ -102,12 +110,19 @@ static bool _SPI_Tx(unsigned char *buf, uint32_t size)
 
     }
 
+    spiStats.txBytes += size;
+    spiStats.txTransfers++;
+    spiStats.txBusyUs += SYS_TIME_CountToUS(SYS_TIME_CounterGet() - startCount);
+    PERF_END(WINC_SPI_TX);
+
     return true;
 }
 
 static bool _SPI_Rx(unsigned char *const buf, uint32_t size)
 {
     static uint8_t dummy = 0;
+    uint32_t startCount = SYS_TIME_CounterGet();
+    PERF_BEGIN(WINC_SPI_RX);
 
     SPI_DMA_DCACHE_CLEAN(buf, size);
 
@@ -122,6 +137,11 @@ static bool _SPI_Rx(unsigned char *const buf, uint32_t size)
     {
     }
 
+    spiStats.rxBytes += size;
+    spiStats.rxTransfers++;
+    spiStats.rxBusyUs += SYS_TIME_CountToUS(SYS_TIME_CounterGet() - startCount);
+    PERF_END(WINC_SPI_RX);
+
     return true;
 }
 
@@ -212,6 +232,15 @@ bool WDRV_WINC_SPIReceive(unsigned char *const buf, uint32_t size)
     return ret;
 }
 
+/****************************************************************************
+ * Function:        WDRV_WINC_SPIStatsGet
+ * Summary: Returns the SPI transfer counters.
+ *****************************************************************************/
+const WDRV_WINC_SPI_STATS* WDRV_WINC_SPIStatsGet(void)
+{
+    return &spiStats;
+}
+
 /****************************************************************************
  * Function:        WDRV_WINC_SPIInitialize
  * Summary: Initializes the SPI object for the WiFi driver.
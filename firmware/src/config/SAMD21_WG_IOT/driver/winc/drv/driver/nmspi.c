@@ -90,6 +90,11 @@
 #define DATA_PKT_SZ_8K          (8 * 1024)
 #define DATA_PKT_SZ             DATA_PKT_SZ_8K
 
+/* Read command responses and register values in one transfer, 0 polls byte by byte */
+#ifndef NMSPI_PREFETCH_RSP
+#define NMSPI_PREFETCH_RSP      1
+#endif
+
 static uint8_t gu8Crc_off = 0;
 
 static OSAL_MUTEX_HANDLE_TYPE s_spiLock = 0;
@@ -110,6 +115,56 @@ static inline int8_t spi_write(uint8_t *b, uint16_t sz)
     return N_FAIL;
 }
 
+/********************************************
+
+    Response prefetch
+
+    The WINC output is a plain byte stream, so reading the shortest possible
+    response in one SPI transfer and parsing it a byte at a time behaves the
+    same as polling single bytes. When the WINC inserts filler bytes the parser
+    falls through to single byte reads once the prefetched bytes run out.
+    A prefetch only covers bytes the WINC sends after the step before it
+    succeeded, so a failed command is not followed by reads of data it
+    never sent.
+
+********************************************/
+
+typedef struct
+{
+    uint8_t buf[9];
+    uint8_t len;
+    uint8_t pos;
+} spi_rsp_stream_t;
+
+static int8_t spi_rsp_prefetch(spi_rsp_stream_t *stream, uint8_t sz)
+{
+    stream->len = 0;
+    stream->pos = 0;
+
+#if NMSPI_PREFETCH_RSP
+    if (N_OK != spi_read(stream->buf, sz))
+        return N_FAIL;
+
+    stream->len = sz;
+#endif
+
+    return N_OK;
+}
+
+static int8_t spi_rsp_get(spi_rsp_stream_t *stream, uint8_t *b, uint16_t sz)
+{
+    while ((sz > 0) && (stream->pos < stream->len))
+    {
+        *b++ = stream->buf[stream->pos++];
+        sz--;
+    }
+
+    if (sz > 0)
+        return spi_read(b, sz);
+
+    return N_OK;
+}
+
 /********************************************
 
     Crc7
@@ -280,7 +335,7 @@ static int8_t spi_cmd(uint8_t cmd, uint32_t adr, uint32_t u32data, uint32_t sz,
     return N_OK;
 }
 
-static int8_t spi_cmd_rsp(uint8_t cmd)
+static int8_t spi_cmd_rsp_stream(uint8_t cmd, spi_rsp_stream_t *stream)
 {
     uint8_t rsp;
     int8_t s8RetryCnt;
@@ -297,7 +352,7 @@ static int8_t spi_cmd_rsp(uint8_t cmd)
 #endif
         )
     {
-        if (N_OK != spi_read(&rsp, 1))
+        if (N_OK != spi_rsp_get(stream, &rsp, 1))
             return N_FAIL;
     }
 
@@ -305,7 +360,7 @@ static int8_t spi_cmd_rsp(uint8_t cmd)
     s8RetryCnt = SPI_RESP_RETRY_COUNT;
     do
     {
-        if (N_OK != spi_read(&rsp, 1))
+        if (N_OK != spi_rsp_get(stream, &rsp, 1))
         {
             M2M_ERR("  M2M: [spi_cmd_rsp]: Failed cmd response read, bus error...");
             return N_FAIL;
@@ -325,7 +380,7 @@ static int8_t spi_cmd_rsp(uint8_t cmd)
     s8RetryCnt = SPI_RESP_RETRY_COUNT;
     do
     {
-        if (N_OK != spi_read(&rsp, 1))
+        if (N_OK != spi_rsp_get(stream, &rsp, 1))
         {
             M2M_ERR("  M2M: [spi_cmd_rsp]: Failed cmd response read, bus error...");
             return N_FAIL;
@@ -342,6 +397,20 @@ static int8_t spi_cmd_rsp(uint8_t cmd)
     return N_OK;
 }
 
+static int8_t spi_cmd_rsp(uint8_t cmd)
+{
+    spi_rsp_stream_t stream;
+
+    /* Command echo and state byte */
+    if (N_OK != spi_rsp_prefetch(&stream, 2))
+    {
+        M2M_ERR("  M2M: [spi_cmd_rsp]: Failed cmd response read, bus error...");
+        return N_FAIL;
+    }
+
+    return spi_cmd_rsp_stream(cmd, &stream);
+}
+
 static void spi_reset(void)
 {
     nm_sleep(1);
@@ -604,6 +673,9 @@ static int8_t spi_read_reg(uint32_t u32Addr, uint32_t* pu32RetVal)
     uint8_t cmd = CMD_SINGLE_READ;
     uint8_t tmp[4];
     uint8_t clockless = 0;
+    uint8_t rsp;
+    int16_t retry;
+    spi_rsp_stream_t stream;
 
     if (u32Addr <= 0xff)
     {
@@ -626,13 +698,54 @@ static int8_t spi_read_reg(uint32_t u32Addr, uint32_t* pu32RetVal)
         return N_FAIL;
     }
 
+    /* Command accepted: data start token and the 4 data bytes, plus the data
+     * CRC while CRC is still on */
+    if (spi_rsp_prefetch(&stream, ((!clockless && !gu8Crc_off) ? 7 : 5)) != N_OK)
+    {
+        M2M_ERR("  M2M: [spi_read_reg]: Failed data response read, bus error...");
+        return N_FAIL;
+    }
+
+    /**
+        Data Response header
+    **/
+    retry = SPI_RESP_RETRY_COUNT;
+    do
+    {
+        if (N_OK != spi_rsp_get(&stream, &rsp, 1))
+        {
+            M2M_ERR("  M2M: [spi_read_reg]: Failed data response read, bus error...");
+            return N_FAIL;
+        }
+        if ((rsp & 0xf0) == 0xf0)
+            break;
+    }
+    while (retry--);
+
+    if (retry <= 0)
+    {
+        M2M_ERR("  M2M: [spi_read_reg]: Failed data response read...(%02x)", rsp);
+        return N_FAIL;
+    }
+
     /* to avoid endianess issues */
-    if (spi_data_read(&tmp[0], 4, clockless) != N_OK)
+    if (spi_rsp_get(&stream, &tmp[0], 4) != N_OK)
     {
         M2M_ERR("  M2M: [spi_read_reg]: Failed data read...");
         return N_FAIL;
     }
 
+    if (!clockless && !gu8Crc_off)
+    {
+        uint8_t crc[2];
+
+        if (spi_rsp_get(&stream, crc, 2) != N_OK)
+        {
+            M2M_ERR("  M2M: [spi_read_reg]: Failed data block CRC read, bus error...");
+            return N_FAIL;
+        }
+    }
+
     *pu32RetVal = ((uint32_t)tmp[0])       |
                   ((uint32_t)tmp[1] << 8)  |
                   ((uint32_t)tmp[2] << 16) |
@@ -40,6 +40,30 @@
 #ifndef _WDRV_WINC_SPI_H
 #define _WDRV_WINC_SPI_H
 
+//*******************************************************************************
+/*  SPI Transfer Counters
+
+  Summary:
+    Bytes, transfers and time spent waiting for SPI transfers to complete.
+
+  Description:
+    Busy time runs from queuing a transfer to its completion event, so
+    bytes divided by busy time gives the sustained bus throughput.
+
+  Remarks:
+    None.
+*/
+
+typedef struct
+{
+    uint32_t txBytes;
+    uint32_t rxBytes;
+    uint32_t txTransfers;
+    uint32_t rxTransfers;
+    uint64_t txBusyUs;
+    uint64_t rxBusyUs;
+} WDRV_WINC_SPI_STATS;
+
 //*******************************************************************************
 /*
   Function:
@@ -138,4 +162,27 @@ void WDRV_WINC_SPIInitialize(void);
  */
 void WDRV_WINC_SPIDeinitialize(void);
 
+//*******************************************************************************
+/*
+  Function:
+    const WDRV_WINC_SPI_STATS* WDRV_WINC_SPIStatsGet(void)
+
+  Summary:
+    Returns the SPI transfer counters.
+
+  Description:
+    This function returns the byte, transfer and busy time counters
+    accumulated by WDRV_WINC_SPISend and WDRV_WINC_SPIReceive.
+
+  Precondition:
+    None.
+
+  Returns:
+    Pointer to the counters.
+
+  Remarks:
+    None.
+ */
+const WDRV_WINC_SPI_STATS* WDRV_WINC_SPIStatsGet(void);
+
 #endif /* _WDRV_WINC_SPI_H */
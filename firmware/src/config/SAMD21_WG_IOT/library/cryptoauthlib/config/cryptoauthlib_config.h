@@ -17,6 +17,11 @@
 #define ATCA_PRINTF 1
 #endif
 
+/* Unrolled software SHA-256 tuned for Cortex-M0+, 0 selects the compact rolled loop */
+#ifndef ATCA_SW_SHA256_FAST
+#define ATCA_SW_SHA256_FAST 1
+#endif
+
 #ifndef CONF_CRYPTOAUTHLIB_DEBUG_HELPER
 #define CONF_CRYPTOAUTHLIB_DEBUG_HELPER 0
 #endif
@@ -26,10 +26,123 @@
  */
 
 #include <string.h>
+#include "config/cryptoauthlib_config.h"
 #include "sha2_routines.h"
 
 #define rotate_right(value, places) ((value >> places) | (value << (32 - places)))
 
+static const uint32_t sha256_k[] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+#if ATCA_SW_SHA256_FAST
+
+#define SHA256_ROTR(x, n)   (((x) >> (n)) | ((x) << (32 - (n))))
+#define SHA256_S0(x)        (SHA256_ROTR(x, 2) ^ SHA256_ROTR(x, 13) ^ SHA256_ROTR(x, 22))
+#define SHA256_S1(x)        (SHA256_ROTR(x, 6) ^ SHA256_ROTR(x, 11) ^ SHA256_ROTR(x, 25))
+#define SHA256_s0(x)        (SHA256_ROTR(x, 7) ^ SHA256_ROTR(x, 18) ^ ((x) >> 3))
+#define SHA256_s1(x)        (SHA256_ROTR(x, 17) ^ SHA256_ROTR(x, 19) ^ ((x) >> 10))
+#define SHA256_CH(e, f, g)  ((g) ^ ((e) & ((f) ^ (g))))
+#define SHA256_MAJ(a, b, c) (((a) & (b)) | ((c) & ((a) | (b))))
+
+/* Expand the next schedule word in place, the window only keeps 16 words */
+#define SHA256_SCHEDULE(w, i) \
+    ((w)[(i) & 15] += SHA256_s1((w)[((i) - 2) & 15]) + (w)[((i) - 7) & 15] + SHA256_s0((w)[((i) - 15) & 15]))
+
+/* One round. The caller rotates the variable names instead of moving eight words per round. */
+#define SHA256_ROUND(a, b, c, d, e, f, g, h, i, wi)                                  \
+    do                                                                               \
+    {                                                                                \
+        uint32_t t1 = (h) + SHA256_S1(e) + SHA256_CH(e, f, g) + sha256_k[i] + (wi); \
+        (d) += t1;                                                                   \
+        (h) = t1 + SHA256_S0(a) + SHA256_MAJ(a, b, c);                              \
+    } while (0)
+
+#define SHA256_ROUNDS8_LOAD(i)                                      \
+    SHA256_ROUND(a, b, c, d, e, f, g, h, (i) + 0, w[(i) + 0]);      \
+    SHA256_ROUND(h, a, b, c, d, e, f, g, (i) + 1, w[(i) + 1]);      \
+    SHA256_ROUND(g, h, a, b, c, d, e, f, (i) + 2, w[(i) + 2]);      \
+    SHA256_ROUND(f, g, h, a, b, c, d, e, (i) + 3, w[(i) + 3]);      \
+    SHA256_ROUND(e, f, g, h, a, b, c, d, (i) + 4, w[(i) + 4]);      \
+    SHA256_ROUND(d, e, f, g, h, a, b, c, (i) + 5, w[(i) + 5]);      \
+    SHA256_ROUND(c, d, e, f, g, h, a, b, (i) + 6, w[(i) + 6]);      \
+    SHA256_ROUND(b, c, d, e, f, g, h, a, (i) + 7, w[(i) + 7])
+
+#define SHA256_ROUNDS8_EXPAND(i)                                                    \
+    SHA256_ROUND(a, b, c, d, e, f, g, h, (i) + 0, SHA256_SCHEDULE(w, (i) + 0));     \
+    SHA256_ROUND(h, a, b, c, d, e, f, g, (i) + 1, SHA256_SCHEDULE(w, (i) + 1));     \
+    SHA256_ROUND(g, h, a, b, c, d, e, f, (i) + 2, SHA256_SCHEDULE(w, (i) + 2));     \
+    SHA256_ROUND(f, g, h, a, b, c, d, e, (i) + 3, SHA256_SCHEDULE(w, (i) + 3));     \
+    SHA256_ROUND(e, f, g, h, a, b, c, d, (i) + 4, SHA256_SCHEDULE(w, (i) + 4));     \
+    SHA256_ROUND(d, e, f, g, h, a, b, c, (i) + 5, SHA256_SCHEDULE(w, (i) + 5));     \
+    SHA256_ROUND(c, d, e, f, g, h, a, b, (i) + 6, SHA256_SCHEDULE(w, (i) + 6));     \
+    SHA256_ROUND(b, c, d, e, f, g, h, a, (i) + 7, SHA256_SCHEDULE(w, (i) + 7))
+
+/**
+ * \brief Processes whole blocks (64 bytes) of data.
+ *
+ * Speed optimized variant: 16 word rolling message schedule, rounds unrolled by
+ * eight so the working variables stay in place. The block is copied into the
+ * schedule with memcpy, which compiles to word loads when the input happens to
+ * be aligned and is safe when it is not, then byte reversed in place.
+ *
+ * \param[in] ctx          SHA256 hash context
+ * \param[in] blocks       Raw blocks to be processed
+ * \param[in] block_count  Number of 64-byte blocks to process
+ */
+static void sw_sha256_process(sw_sha256_ctx* ctx, const uint8_t* blocks, uint32_t block_count)
+{
+    uint32_t w[16];
+    uint32_t a, b, c, d, e, f, g, h;
+    uint32_t i;
+
+    while (block_count--)
+    {
+        memcpy(w, blocks, sizeof(w));
+        for (i = 0; i < 16; i++)
+        {
+            w[i] = __builtin_bswap32(w[i]);
+        }
+
+        a = ctx->hash[0];
+        b = ctx->hash[1];
+        c = ctx->hash[2];
+        d = ctx->hash[3];
+        e = ctx->hash[4];
+        f = ctx->hash[5];
+        g = ctx->hash[6];
+        h = ctx->hash[7];
+
+        SHA256_ROUNDS8_LOAD(0);
+        SHA256_ROUNDS8_LOAD(8);
+
+        for (i = 16; i < SHA256_BLOCK_SIZE; i += 8)
+        {
+            SHA256_ROUNDS8_EXPAND(i);
+        }
+
+        ctx->hash[0] += a;
+        ctx->hash[1] += b;
+        ctx->hash[2] += c;
+        ctx->hash[3] += d;
+        ctx->hash[4] += e;
+        ctx->hash[5] += f;
+        ctx->hash[6] += g;
+        ctx->hash[7] += h;
+
+        blocks += SHA256_BLOCK_SIZE;
+    }
+}
+
+#else
+
 /**
  * \brief Processes whole blocks (64 bytes) of data.
  *
@@ -48,17 +161,6 @@ static void sw_sha256_process(sw_sha256_ctx* ctx, const uint8_t* blocks, uint32_
         uint8_t  w_byte[SHA256_BLOCK_SIZE * sizeof(uint32_t)];
     } w_union;
 
-    static const uint32_t k[] = {
-        0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
-        0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
-        0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
-        0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
-        0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
-        0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
-        0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
-        0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
-    };
-
     // Loop through all the blocks to process
     for (block = 0; block < block_count; block++)
     {
@@ -115,7 +217,7 @@ static void sw_sha256_process(sw_sha256_ctx* ctx, const uint8_t* blocks, uint32_
                  ^ rotate_right(rotate_register[4], 25);
             ch = (rotate_register[4] & rotate_register[5])
                  ^ (~rotate_register[4] & rotate_register[6]);
-            t1 = rotate_register[7] + s1 + ch + k[i] + w_union.w_word[i];
+            t1 = rotate_register[7] + s1 + ch + sha256_k[i] + w_union.w_word[i];
 
             rotate_register[7] = rotate_register[6];
             rotate_register[6] = rotate_register[5];
@@ -135,6 +237,8 @@ static void sw_sha256_process(sw_sha256_ctx* ctx, const uint8_t* blocks, uint32_
     }
 }
 
+#endif /* ATCA_SW_SHA256_FAST */
+
 /**
  * \brief Intialize the software SHA256.
  *
@@ -49,6 +49,113 @@
 #include "definitions.h"
 
 
+#define HAL_I2C_ECC_ADDRESS      0x58
+#define HAL_I2C_WAKE_SPEED       100000    // slow enough for the address-0 write to hold SDA low for tWLO
+
+static volatile bool hal_i2c_xfer_done = false;
+
+/* SERCOM3 reports the end of every transfer, successful or not, through this callback */
+static void hal_i2c_xfer_callback(uintptr_t context)
+{
+    hal_i2c_xfer_done = true;
+}
+
+/* Sleep the core until the flag is set by an interrupt handler. PRIMASK is held
+ * around WFI so an interrupt arriving between the check and WFI still wakes us,
+ * and restored afterwards so a caller with interrupts masked keeps them masked. */
+static void hal_i2c_wait_flag(volatile bool* flag)
+{
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    while (*flag == false)
+    {
+        __WFI();
+        __enable_irq();
+        __disable_irq();
+    }
+    __set_PRIMASK(primask);
+}
+
+/* Sleep the same way until SERCOM3 has finished a transfer another driver on
+ * the bus (the MCP9808) started; its completion interrupt wakes the core. */
+static void hal_i2c_wait_idle(void)
+{
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    while (SERCOM3_I2C_IsBusy() == true)
+    {
+        __WFI();
+        __enable_irq();
+        __disable_irq();
+    }
+    __set_PRIMASK(primask);
+}
+
+static void hal_i2c_delay_callback(uintptr_t context)
+{
+    *(volatile bool*)context = true;
+}
+
+static ATCA_STATUS hal_i2c_delay_us(uint32_t us)
+{
+    volatile bool expired = false;
+
+    if (SYS_TIME_CallbackRegisterUS(hal_i2c_delay_callback, (uintptr_t)&expired, us, SYS_TIME_SINGLE) == SYS_TIME_HANDLE_INVALID)
+    {
+        return ATCA_COMM_FAIL;
+    }
+
+    hal_i2c_wait_flag(&expired);
+
+    return ATCA_SUCCESS;
+}
+
+static void hal_i2c_set_speed(uint32_t speed)
+{
+    SERCOM_I2C_TRANSFER_SETUP setup;
+
+    setup.clkSpeed = speed;
+    hal_i2c_wait_idle();
+
+    SERCOM3_I2C_TransferSetup(&setup, 0);
+}
+
+/* Start a read or write to the device and sleep until the interrupt driven
+ * transfer completes */
+static ATCA_STATUS hal_i2c_transfer(uint16_t address, uint8_t* data, uint32_t length, bool read)
+{
+    bool started;
+
+    hal_i2c_xfer_done = false;
+    SERCOM3_I2C_CallbackRegister(hal_i2c_xfer_callback, 0);
+
+    if (read == true)
+    {
+        started = SERCOM3_I2C_Read(address, data, length);
+    }
+    else
+    {
+        started = SERCOM3_I2C_Write(address, data, length);
+    }
+
+    if (started == false)
+    {
+        return ATCA_COMM_FAIL;
+    }
+
+    hal_i2c_wait_flag(&hal_i2c_xfer_done);
+
+    /* Transfer complete. Check if the transfer was successful */
+    if (SERCOM3_I2C_ErrorGet() != SERCOM_I2C_ERROR_NONE)
+    {
+        return ATCA_COMM_FAIL;
+    }
+
+    return ATCA_SUCCESS;
+}
+
 /** \brief initialize an I2C interface using given config
  * \param[in] hal - opaque ptr to HAL data
  * \param[in] cfg - interface configuration
@@ -81,27 +188,7 @@ ATCA_STATUS hal_i2c_send(ATCAIface iface, uint8_t* txdata, int txlength)
     txdata[0] = 0x03;   // insert the Word Address Value, Command token
     txlength++;         // account for word address value byte.
 
-    while (SERCOM3_I2C_IsBusy() == true)
-        ;
-
-    if (SERCOM3_I2C_Write(0x58, txdata, txlength) == true)
-    {
-        /* Wait for the I2C transfer to complete */
-        while (SERCOM3_I2C_IsBusy() == true)
-            ;
-
-        /* Transfer complete. Check if the transfer was successful */
-        if (SERCOM3_I2C_ErrorGet() != SERCOM_I2C_ERROR_NONE)
-        {
-            return ATCA_COMM_FAIL;
-        }
-    }
-    else
-    {
-        return ATCA_COMM_FAIL;
-    }
-
-    return ATCA_SUCCESS;
+    return hal_i2c_transfer(HAL_I2C_ECC_ADDRESS, txdata, txlength, false);
 }
 
 /** \brief HAL implementation of I2C receive function for ASF I2C
@@ -125,24 +212,9 @@ ATCA_STATUS hal_i2c_receive(ATCAIface iface, uint8_t* rxdata, uint16_t* rxlength
         return ATCA_SMALL_BUFFER;
     }
 
-    /* Wait for the I2C bus to be ready */
-    while (SERCOM3_I2C_IsBusy() == true)
-        ;
-
     while (retries-- > 0 && isSuccess == false)
     {
-        if (SERCOM3_I2C_Read(0x58, rxdata, 1) == true)
-        {
-            /* Wait for the I2C transfer to complete */
-            while (SERCOM3_I2C_IsBusy() == true)
-                ;
-
-            /* Transfer complete. Check if the transfer was successful */
-            if (SERCOM3_I2C_ErrorGet() == SERCOM_I2C_ERROR_NONE)
-            {
-                isSuccess = true;
-            }
-        }
+        isSuccess = (hal_i2c_transfer(HAL_I2C_ECC_ADDRESS, rxdata, 1, true) == ATCA_SUCCESS);
     }
     if (isSuccess == false)
     {
@@ -160,19 +232,7 @@ ATCA_STATUS hal_i2c_receive(ATCAIface iface, uint8_t* rxdata, uint16_t* rxlength
 
     count = rxdata[0] - 1;
 
-    if (SERCOM3_I2C_Read(0x58, &rxdata[1], count) == true)
-    {
-        /* Wait for the I2C transfer to complete */
-        while (SERCOM3_I2C_IsBusy() == true)
-            ;
-
-        /* Transfer complete. Check if the transfer was successful */
-        if (SERCOM3_I2C_ErrorGet() != SERCOM_I2C_ERROR_NONE)
-        {
-            return ATCA_COMM_FAIL;
-        }
-    }
-    else
+    if (hal_i2c_transfer(HAL_I2C_ECC_ADDRESS, &rxdata[1], count, true) != ATCA_SUCCESS)
     {
         return ATCA_COMM_FAIL;
     }
@@ -183,81 +243,41 @@ ATCA_STATUS hal_i2c_receive(ATCAIface iface, uint8_t* rxdata, uint16_t* rxlength
 }
 
 /** \brief wake up CryptoAuth device using I2C bus
+ *
+ * The wake pulse is sent at 100 kHz, then the bus is switched to cfg->atcai2c.baud.
  * \param[in] iface  interface to logical device to wakeup
  */
 ATCA_STATUS hal_i2c_wake(ATCAIface iface)
 {
-    SYS_TIME_HANDLE           tmrHandle = SYS_TIME_HANDLE_INVALID;
-    SERCOM_I2C_TRANSFER_SETUP setup;
+    ATCAIfaceCfg* cfg = atgetifacecfg(iface);
 
     uint8_t init_data[4]  = {0, 0, 0, 0};
     uint8_t verif_data[4] = {0x04, 0x11, 0x33, 0x43};
-    uint8_t verification  = true;
     uint8_t dummyData     = 0x0;
-    bool    isSuccess     = false;
-
-    setup.clkSpeed = 100000;
-    while (SERCOM3_I2C_IsBusy() == true)
-        ;
 
-    SERCOM3_I2C_TransferSetup(&setup, 0);
-
-    while (SERCOM3_I2C_IsBusy() == true)
-        ;
+    hal_i2c_set_speed(HAL_I2C_WAKE_SPEED);
 
-    SERCOM3_I2C_Write(0, (void*)&dummyData, 1);
-    while (SERCOM3_I2C_IsBusy() == true)
-        ;
+    /* The address-0 write is NAKed, it only serves to hold SDA low */
+    hal_i2c_transfer(0, (void*)&dummyData, 1, false);
 
-    if (SYS_TIME_SUCCESS != SYS_TIME_DelayMS(5, &tmrHandle))
+    if (hal_i2c_delay_us(cfg->wake_delay) != ATCA_SUCCESS)
     {
         return ATCA_COMM_FAIL;
     }
 
-    while (true != SYS_TIME_DelayIsComplete(tmrHandle))
-    {
-    }
-
-    setup.clkSpeed = 400000;
-    while (SERCOM3_I2C_IsBusy() == true)
-        ;
+    hal_i2c_set_speed(cfg->atcai2c.baud);
 
-    SERCOM3_I2C_TransferSetup(&setup, 0);
-
-    while (SERCOM3_I2C_IsBusy() == true)
-        ;
-
-    if (SERCOM3_I2C_Read(0x58, (void*)init_data, 4) == true)
+    if (hal_i2c_transfer(HAL_I2C_ECC_ADDRESS, init_data, sizeof(init_data), true) != ATCA_SUCCESS)
     {
-        /* Wait for the I2C transfer to complete */
-        while (SERCOM3_I2C_IsBusy() == true)
-            ;
-
-        /* Transfer complete. Check if the transfer was successful */
-        if (SERCOM3_I2C_ErrorGet() == SERCOM_I2C_ERROR_NONE)
-        {
-            isSuccess = true;
-        }
+        return ATCA_COMM_FAIL;
     }
 
-    if (isSuccess == true)
-    {
-        for (uint8_t i = 0; i < 4; i++)
-        {
-            if (init_data[i] != verif_data[i])
-                verification = false;
-        }
-    }
-    else
+    if (memcmp(init_data, verif_data, sizeof(verif_data)) != 0)
     {
         return ATCA_COMM_FAIL;
     }
 
-
-    if (verification)
-        return ATCA_SUCCESS;
-    else
-        return ATCA_COMM_FAIL;
+    return ATCA_SUCCESS;
 }
 
 /** \brief idle CryptoAuth device using I2C bus
@@ -268,28 +288,7 @@ ATCA_STATUS hal_i2c_idle(ATCAIface iface)
 {
     uint8_t data = 0x02;
 
-    /* Wait for the I2C bus to be ready */
-    while (SERCOM3_I2C_IsBusy() == true)
-        ;
-
-    if (SERCOM3_I2C_Write(0x58, (uint8_t*)&data, 1) == true)
-    {
-        /* Wait for the I2C transfer to complete */
-        while (SERCOM3_I2C_IsBusy() == true)
-            ;
-
-        /* Transfer complete. Check if the transfer was successful */
-        if (SERCOM3_I2C_ErrorGet() != SERCOM_I2C_ERROR_NONE)
-        {
-            return ATCA_COMM_FAIL;
-        }
-    }
-    else
-    {
-        return ATCA_COMM_FAIL;
-    }
-
-    return ATCA_SUCCESS;
+    return hal_i2c_transfer(HAL_I2C_ECC_ADDRESS, &data, 1, false);
 }
 
 /** \brief sleep CryptoAuth device using I2C bus
@@ -300,28 +299,7 @@ ATCA_STATUS hal_i2c_sleep(ATCAIface iface)
 {
     uint8_t data = 0x01;
 
-    /* Wait for the I2C bus to be ready */
-    while (SERCOM3_I2C_IsBusy() == true)
-        ;
-
-    if (SERCOM3_I2C_Write(0x58, (uint8_t*)&data, 1) == true)
-    {
-        /* Wait for the I2C transfer to complete */
-        while (SERCOM3_I2C_IsBusy() == true)
-            ;
-
-        /* Transfer complete. Check if the transfer was successful */
-        if (SERCOM3_I2C_ErrorGet() != SERCOM_I2C_ERROR_NONE)
-        {
-            return ATCA_COMM_FAIL;
-        }
-    }
-    else
-    {
-        return ATCA_COMM_FAIL;
-    }
-
-    return ATCA_SUCCESS;
+    return hal_i2c_transfer(HAL_I2C_ECC_ADDRESS, &data, 1, false);
 }
 
 /** \brief manages reference count on given bus and releases resource if no more refences exist
@@ -0,0 +1,203 @@
+/*
+    \file   console_dma.c
+
+    \brief  console_dma.ceader file.
+
+    (c) 2018 Microchip Technology Inc. and its subsidiaries.
+
+    Subject to your compliance with these terms, you may use Microchip software and any
+    derivatives exclusively with Microchip products. It is your responsibility to comply with third party
+    license terms applicable to your use of third party software (including open source software) that
+    may accompany Microchip software.
+
+    THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+    EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY
+    IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS
+    FOR A PARTICULAR PURPOSE.
+
+    IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
+    INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND
+    WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP
+    HAS BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO
+    THE FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL
+    CLAIMS IN ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT
+    OF FEES, IF ANY, THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS
+    SOFTWARE.
+*/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "console_dma.h"
+#include "definitions.h"
+#include "system/console/src/sys_console_uart.h"
+#include "iot_config/IoT_Sensor_Node_config.h"
+
+// The MHC SERCOM USART plib drains its transmit ring one DRE interrupt per
+// byte, about 11,500 interrupts a second while a log burst goes out at
+// 115200 baud, and has no DMA option.  The console writes go to this ring
+// instead, and DMAC channel 2 (triggered by SERCOM5 TX in the MHC project)
+// sends each contiguous run of it as one block.  Receive stays with the plib.
+#define CONSOLE_DMA_CHANNEL DMAC_CHANNEL_2
+
+static uint8_t           console_txBuffer[CFG_CONSOLE_TX_BUFFER_SIZE];
+static volatile uint32_t console_txIn;
+static volatile uint32_t console_txOut;
+static volatile uint32_t console_txDmaCount;   // bytes in the block the DMAC is sending, 0 when idle
+static volatile uint32_t console_txOverflow;
+
+static size_t console_write(uint8_t* pWrBuffer, const size_t size);
+static size_t console_writeFreeBufferCountGet(void);
+
+static const SYS_CONSOLE_UART_PLIB_INTERFACE console_plibAPI = {
+    .read                    = (SYS_CONSOLE_UART_PLIB_READ)SERCOM5_USART_Read,
+    .readCountGet            = (SYS_CONSOLE_UART_PLIB_READ_COUNT_GET)SERCOM5_USART_ReadCountGet,
+    .readFreeBufferCountGet  = (SYS_CONSOLE_UART_PLIB_READ_FREE_BUFFFER_COUNT_GET)SERCOM5_USART_ReadFreeBufferCountGet,
+    .write                   = console_write,
+    .writeCountGet           = CONSOLE_DMA_WriteCountGet,
+    .writeFreeBufferCountGet = console_writeFreeBufferCountGet,
+};
+
+static const SYS_CONSOLE_UART_INIT_DATA console_initData = {
+    .uartPLIB = &console_plibAPI,
+};
+
+// Called with the DMAC interrupt masked or from it
+static void console_dmaStart(void)
+{
+    uint32_t in  = console_txIn;
+    uint32_t out = console_txOut;
+
+    if ((console_txDmaCount == 0) && (out != in))
+    {
+        // One block up to the write index or the end of the ring
+        console_txDmaCount = (in > out) ? in - out : CFG_CONSOLE_TX_BUFFER_SIZE - out;
+        DMAC_ChannelTransfer(CONSOLE_DMA_CHANNEL, &console_txBuffer[out], (const void*)&SERCOM5_REGS->USART_INT.SERCOM_DATA, console_txDmaCount);
+    }
+}
+
+static void console_dmaCallback(DMAC_TRANSFER_EVENT event, uintptr_t context)
+{
+    uint32_t out = console_txOut + console_txDmaCount;
+
+    // A block never wraps, so it ends at the end of the ring at most
+    if (out >= CFG_CONSOLE_TX_BUFFER_SIZE)
+    {
+        out = 0;
+    }
+    console_txOut      = out;
+    console_txDmaCount = 0;
+
+    console_dmaStart();
+}
+
+#if CFG_CONSOLE_TX_DROP_OLDEST
+// Makes room for size bytes by discarding the oldest queued bytes.  The block
+// the DMAC is reading stays, the younger bytes move over the dropped ones.
+static void console_dropOldest(size_t size)
+{
+    uint32_t pending = CONSOLE_DMA_WriteCountGet();
+    uint32_t free    = (CFG_CONSOLE_TX_BUFFER_SIZE - 1) - pending;
+    uint32_t drop;
+    uint32_t dst;
+    uint32_t src;
+
+    if (size <= free)
+    {
+        return;
+    }
+
+    drop = pending - console_txDmaCount;
+    if (drop > size - free)
+    {
+        drop = size - free;
+    }
+
+    dst = (console_txOut + console_txDmaCount) % CFG_CONSOLE_TX_BUFFER_SIZE;
+    src = (dst + drop) % CFG_CONSOLE_TX_BUFFER_SIZE;
+    while (src != console_txIn)
+    {
+        console_txBuffer[dst] = console_txBuffer[src];
+        dst                   = (dst + 1) % CFG_CONSOLE_TX_BUFFER_SIZE;
+        src                   = (src + 1) % CFG_CONSOLE_TX_BUFFER_SIZE;
+    }
+    console_txIn = dst;
+    console_txOverflow += drop;
+}
+#endif
+
+// Whatever does not fit is dropped and counted, the console never blocks
+static size_t console_write(uint8_t* pWrBuffer, const size_t size)
+{
+    size_t   written = 0;
+    uint32_t next;
+
+    // The DMAC callback moves the read index, keep it out while the ring is updated
+    NVIC_DisableIRQ(DMAC_IRQn);
+
+#if CFG_CONSOLE_TX_DROP_OLDEST
+    console_dropOldest(size);
+#endif
+
+    while (written < size)
+    {
+        next = (console_txIn + 1) % CFG_CONSOLE_TX_BUFFER_SIZE;
+        if (next == console_txOut)
+        {
+            break;
+        }
+        console_txBuffer[console_txIn] = pWrBuffer[written++];
+        console_txIn                   = next;
+    }
+    console_txOverflow += size - written;
+
+    // Start the DMAC if it is idle, otherwise its callback picks the data up
+    console_dmaStart();
+
+    NVIC_EnableIRQ(DMAC_IRQn);
+
+    return written;
+}
+
+static size_t console_writeFreeBufferCountGet(void)
+{
+    return (CFG_CONSOLE_TX_BUFFER_SIZE - 1) - CONSOLE_DMA_WriteCountGet();
+}
+
+// Called by the application before it prints anything.  The MHC console
+// setup binds SYS_CONSOLE to the SERCOM5 plib functions; hand it this ring
+// instead, once whatever the plib still has queued is out.  Done at run time
+// so the generated files stay as MHC writes them.
+void CONSOLE_DMA_start(void)
+{
+    while (SERCOM5_USART_WriteCountGet() > 0)
+    {
+        /* Wait for the plib ring to drain */
+    }
+
+    console_txIn       = 0;
+    console_txOut      = 0;
+    console_txDmaCount = 0;
+    console_txOverflow = 0;
+    DMAC_ChannelCallbackRegister(CONSOLE_DMA_CHANNEL, console_dmaCallback, 0);
+
+    Console_UART_Initialize(SYS_CONSOLE_INDEX_0, &console_initData);
+}
+
+size_t CONSOLE_DMA_WriteCountGet(void)
+{
+    uint32_t in  = console_txIn;
+    uint32_t out = console_txOut;
+
+    return (in >= out) ? in - out : (CFG_CONSOLE_TX_BUFFER_SIZE - out) + in;
+}
+
+size_t CONSOLE_DMA_WriteBufferSizeGet(void)
+{
+    return CFG_CONSOLE_TX_BUFFER_SIZE - 1;
+}
+
+size_t CONSOLE_DMA_WriteOverflowCountGet(void)
+{
+    return console_txOverflow;
+}
@@ -0,0 +1,215 @@
+/*
+    \file   dps_cache.c
+
+    \brief  DPS assignment cache source file.
+
+    (c) 2018 Microchip Technology Inc. and its subsidiaries.
+
+    Subject to your compliance with these terms, you may use Microchip software and any
+    derivatives exclusively with Microchip products. It is your responsibility to comply with third party
+    license terms applicable to your use of third party software (including open source software) that
+    may accompany Microchip software.
+
+    THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+    EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY
+    IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS
+    FOR A PARTICULAR PURPOSE.
+
+    IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
+    INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND
+    WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP
+    HAS BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO
+    THE FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL
+    CLAIMS IN ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT
+    OF FEES, IF ANY, THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS
+    SOFTWARE.
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "dps_cache.h"
+#include "definitions.h"
+#include "debug_print.h"
+#include "iot_config/IoT_Sensor_Node_config.h"
+#include "lib/cryptoauthlib.h"
+#include "services/iot/cloud/crypto_client/crypto_client.h"
+
+#define DPS_CACHE_MAGIC 0x31535044UL   // "DPS1"
+
+typedef struct
+{
+    uint32_t magic;
+    uint32_t assignedTime;
+    char     idScope[DPS_CACHE_ID_SCOPE_LENGTH];
+    char     registrationId[DPS_CACHE_REGISTRATION_ID_LENGTH];
+    char     hubHostname[DPS_CACHE_HUB_HOSTNAME_LENGTH];
+    char     deviceId[DPS_CACHE_DEVICE_ID_LENGTH];
+    uint16_t reserved;
+    uint16_t crc;
+} dps_cache_record_t;
+
+typedef union
+{
+    dps_cache_record_t record;
+    uint32_t           words[NVMCTRL_FLASH_ROWSIZE / sizeof(uint32_t)];
+} dps_cache_row_t;
+
+// The record's flash row. Row aligned and row sized, so no other data shares
+// the row DPS_CACHE_store() and DPS_CACHE_invalidate() erase. It is part of
+// the image and programmed back to 0xFF by every firmware update, so a new
+// image always starts by provisioning through DPS.
+static const volatile uint8_t dps_cache_nvm[NVMCTRL_FLASH_ROWSIZE] __attribute__((aligned(NVMCTRL_FLASH_ROWSIZE), used)) = {
+    [0 ... (NVMCTRL_FLASH_ROWSIZE - 1)] = 0xFF};
+
+static dps_cache_row_t dps_cache;
+static bool            dps_cache_valid = false;
+
+static uint16_t dps_cache_crc(const dps_cache_record_t* record)
+{
+    uint16_t crc;
+
+    atCRC(offsetof(dps_cache_record_t, crc), (const uint8_t*)record, (uint8_t*)&crc);
+    return crc;
+}
+
+static void dps_cache_waitReady(void)
+{
+    while (NVMCTRL_IsBusy())
+    {
+        continue;
+    }
+}
+
+bool DPS_CACHE_load(const char* registrationId)
+{
+    char idScope[DPS_CACHE_ID_SCOPE_LENGTH] = {0};
+
+    dps_cache_valid = false;
+
+    NVMCTRL_Read(dps_cache.words, sizeof(dps_cache.words), (uint32_t)dps_cache_nvm);
+
+    if (dps_cache.record.magic != DPS_CACHE_MAGIC)
+    {
+        debug_printInfo("  DPS: No cached assignment");
+        return false;
+    }
+
+    if (dps_cache.record.crc != dps_cache_crc(&dps_cache.record))
+    {
+        debug_printWarn("  DPS: Cached assignment corrupted");
+        return false;
+    }
+
+    // Terminate the strings in case the record was written by a different layout
+    dps_cache.record.idScope[sizeof(dps_cache.record.idScope) - 1]               = '\0';
+    dps_cache.record.registrationId[sizeof(dps_cache.record.registrationId) - 1] = '\0';
+    dps_cache.record.hubHostname[sizeof(dps_cache.record.hubHostname) - 1]       = '\0';
+    dps_cache.record.deviceId[sizeof(dps_cache.record.deviceId) - 1]             = '\0';
+
+    // The record is only good for the ID Scope and certificate it was assigned with
+    if (CRYPTO_CLIENT_readIdScope(idScope) != NO_ERROR)
+    {
+        debug_printError("  DPS: Failed to read ID Scope");
+        return false;
+    }
+
+    if (strcmp(idScope, dps_cache.record.idScope) != 0)
+    {
+        debug_printWarn("  DPS: ID Scope changed, ignoring cached assignment");
+        return false;
+    }
+
+    if (strcmp(registrationId, dps_cache.record.registrationId) != 0)
+    {
+        debug_printWarn("  DPS: Registration ID changed, ignoring cached assignment");
+        return false;
+    }
+
+    debug_printGood("  DPS: Cached assignment %s on %s", dps_cache.record.deviceId, dps_cache.record.hubHostname);
+    dps_cache_valid = true;
+    return true;
+}
+
+bool DPS_CACHE_store(const char* idScope, const char* registrationId, const char* hubHostname, const char* deviceId, uint32_t assignedTime)
+{
+    uint32_t offset;
+
+    if ((strlen(idScope) >= DPS_CACHE_ID_SCOPE_LENGTH) ||
+        (strlen(registrationId) >= DPS_CACHE_REGISTRATION_ID_LENGTH) ||
+        (strlen(hubHostname) >= DPS_CACHE_HUB_HOSTNAME_LENGTH) ||
+        (strlen(deviceId) >= DPS_CACHE_DEVICE_ID_LENGTH))
+    {
+        debug_printWarn("  DPS: Assignment too large to cache");
+        return false;
+    }
+
+    memset(&dps_cache, 0xFF, sizeof(dps_cache));
+    memset(&dps_cache.record, 0, sizeof(dps_cache.record));
+    dps_cache.record.magic        = DPS_CACHE_MAGIC;
+    dps_cache.record.assignedTime = assignedTime;
+    strcpy(dps_cache.record.idScope, idScope);
+    strcpy(dps_cache.record.registrationId, registrationId);
+    strcpy(dps_cache.record.hubHostname, hubHostname);
+    strcpy(dps_cache.record.deviceId, deviceId);
+    dps_cache.record.crc = dps_cache_crc(&dps_cache.record);
+
+    dps_cache_waitReady();
+    NVMCTRL_RowErase((uint32_t)dps_cache_nvm);
+    dps_cache_waitReady();
+
+    for (offset = 0; offset < sizeof(dps_cache_record_t); offset += NVMCTRL_FLASH_PAGESIZE)
+    {
+        NVMCTRL_PageWrite(&dps_cache.words[offset / sizeof(uint32_t)], (uint32_t)dps_cache_nvm + offset);
+        dps_cache_waitReady();
+    }
+
+    if (NVMCTRL_ErrorGet() != NVMCTRL_ERROR_NONE)
+    {
+        debug_printError("  DPS: Failed to write assignment to NVM");
+        dps_cache_valid = false;
+        return false;
+    }
+
+    debug_printInfo("  DPS: Assignment cached");
+    dps_cache_valid = true;
+    return true;
+}
+
+void DPS_CACHE_invalidate(void)
+{
+    dps_cache_valid = false;
+
+    if (dps_cache_nvm[0] == 0xFF)
+    {
+        // Already erased
+        return;
+    }
+
+    debug_printInfo("  DPS: Invalidating cached assignment");
+    dps_cache_waitReady();
+    NVMCTRL_RowErase((uint32_t)dps_cache_nvm);
+    dps_cache_waitReady();
+}
+
+bool DPS_CACHE_isExpired(uint32_t now)
+{
+#if CFG_DPS_CACHE_TTL_SEC > 0
+    if (dps_cache_valid && (now - dps_cache.record.assignedTime) > CFG_DPS_CACHE_TTL_SEC)
+    {
+        return true;
+    }
+#endif
+    return false;
+}
+
+char* DPS_CACHE_getHubHostname(void)
+{
+    return dps_cache_valid ? dps_cache.record.hubHostname : NULL;
+}
+
+char* DPS_CACHE_getDeviceId(void)
+{
+    return dps_cache_valid ? dps_cache.record.deviceId : NULL;
+}
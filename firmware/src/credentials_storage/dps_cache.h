@@ -0,0 +1,55 @@
+/*
+    \file   dps_cache.h
+
+    \brief  DPS assignment cache header file.
+
+    (c) 2018 Microchip Technology Inc. and its subsidiaries.
+
+    Subject to your compliance with these terms, you may use Microchip software and any
+    derivatives exclusively with Microchip products. It is your responsibility to comply with third party
+    license terms applicable to your use of third party software (including open source software) that
+    may accompany Microchip software.
+
+    THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+    EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY
+    IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS
+    FOR A PARTICULAR PURPOSE.
+
+    IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
+    INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND
+    WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP
+    HAS BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO
+    THE FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL
+    CLAIMS IN ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT
+    OF FEES, IF ANY, THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS
+    SOFTWARE.
+*/
+
+
+#ifndef DPS_CACHE_H
+#define DPS_CACHE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define DPS_CACHE_ID_SCOPE_LENGTH        (11 + 1)
+#define DPS_CACHE_REGISTRATION_ID_LENGTH 32
+#define DPS_CACHE_HUB_HOSTNAME_LENGTH    (67 + 1)
+#define DPS_CACHE_DEVICE_ID_LENGTH       64
+
+// Loads the cached assignment from NVM.  Succeeds only if the record is intact and
+// was written for the ID Scope currently in the secure element and this registration ID.
+bool DPS_CACHE_load(const char* registrationId);
+
+// Persists the hub/device assigned by DPS.  assignedTime is the UTC time of the assignment.
+bool DPS_CACHE_store(const char* idScope, const char* registrationId, const char* hubHostname, const char* deviceId, uint32_t assignedTime);
+
+void DPS_CACHE_invalidate(void);
+
+// True if the loaded record is older than CFG_DPS_CACHE_TTL_SEC
+bool DPS_CACHE_isExpired(uint32_t now);
+
+char* DPS_CACHE_getHubHostname(void);
+char* DPS_CACHE_getDeviceId(void);
+
+#endif /* DPS_CACHE_H */
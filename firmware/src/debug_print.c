@@ -37,11 +37,37 @@ static char                   printBuff[APP_PRINT_BUFFER_SIZE] __attribute__((al
 static int                    printBuffPtr;
 static OSAL_MUTEX_HANDLE_TYPE consoleMutex;
 static debug_severity_t       debug_severity_filter    = SEVERITY_NONE;
+static const char* const      debug_moduleNames[DEBUG_MODULE_COUNT] = {"app", "cloud", "mqtt", "bsd", "azutil"};
+
+// Runtime filter per module, checked by the debug_print macros before the
+// arguments are evaluated
+debug_severity_t debug_moduleFilter[DEBUG_MODULE_COUNT];
 static char                   debug_message_prefix[25] = "sn000000000000000000";
 
 char tmpBuf[APP_PRINT_BUFFER_SIZE];
 char tmpFormat[APP_PRINT_BUFFER_SIZE];
 
+#if CFG_DEBUG_BINARY_LOG
+// Binary records, drained to the console from the main loop:
+//   A5 5A <arg bytes> <severity << 4 | level> <format address:4> <SYS_TIME count:4> <args> <xor of all before>
+// Arguments are 4 bytes, 8 for long long and double, and %s is a length byte
+// and up to DEBUG_BIN_STRING_MAX characters.  The format string stays in flash
+// and the host decoder reads it from the ELF at the recorded address.
+#define DEBUG_BIN_SYNC0       0xA5
+#define DEBUG_BIN_SYNC1       0x5A
+#define DEBUG_BIN_HEADER_SIZE 12
+#define DEBUG_BIN_ARGS_MAX    96
+#define DEBUG_BIN_STRING_MAX  48
+#define DEBUG_BIN_MASK        (CFG_DEBUG_BINARY_LOG_SIZE - 1)
+
+// Single producer, single consumer: both ends run in the main loop, so the
+// ring needs no lock.  The indices only grow, the mask picks the slot.
+static uint8_t           debug_binRing[CFG_DEBUG_BINARY_LOG_SIZE];
+static volatile uint32_t debug_binHead;
+static volatile uint32_t debug_binTail;
+static uint32_t          debug_binDropped;
+#endif
+
 void debug_init(const char* prefix)
 {
     if (prefix)
@@ -56,7 +82,13 @@ void debug_init(const char* prefix)
 
 void debug_setSeverity(debug_severity_t debug_level)
 {
+    uint8_t module;
+
     debug_severity_filter = debug_level;
+    for (module = 0; module < DEBUG_MODULE_COUNT; module++)
+    {
+        debug_moduleFilter[module] = debug_level;
+    }
 }
 
 debug_severity_t debug_getSeverity(void)
@@ -64,6 +96,24 @@ debug_severity_t debug_getSeverity(void)
     return debug_severity_filter;
 }
 
+void debug_setModuleSeverity(debug_module_t module, debug_severity_t debug_level)
+{
+    if (module < DEBUG_MODULE_COUNT)
+    {
+        debug_moduleFilter[module] = debug_level;
+    }
+}
+
+debug_severity_t debug_getModuleSeverity(debug_module_t module)
+{
+    return module < DEBUG_MODULE_COUNT ? debug_moduleFilter[module] : SEVERITY_NONE;
+}
+
+const char* debug_moduleName(debug_module_t module)
+{
+    return module < DEBUG_MODULE_COUNT ? debug_moduleNames[module] : NULL;
+}
+
 void debug_setPrefix(const char* prefix)
 {
     strncpy(debug_message_prefix, prefix, sizeof(debug_message_prefix));
@@ -97,44 +147,259 @@ void debug_mutex_lock(OSAL_MUTEX_HANDLE_TYPE* mutexID)
     }
 }
 
+#if CFG_DEBUG_BINARY_LOG
+static void debug_binPut(uint8_t* record, uint8_t* used, const void* data, uint8_t length)
+{
+    if (*used + length <= DEBUG_BIN_HEADER_SIZE + DEBUG_BIN_ARGS_MAX)
+    {
+        memcpy(&record[*used], data, length);
+        *used += length;
+    }
+}
+
+// Walks the conversions the way printf would, so each argument is taken from
+// the va_list with its promoted type
+static uint8_t debug_binEncodeArgs(uint8_t* record, const char* format, va_list args)
+{
+    uint8_t     used = DEBUG_BIN_HEADER_SIZE;
+    const char* p    = format;
+    int         precision;
+    int         longs;
+    uint32_t    word;
+    uint64_t    wide;
+    double      real;
+    const char* str;
+    uint8_t     strLength;
+
+    while ((p = strchr(p, '%')) != NULL)
+    {
+        p++;
+        if (*p == '%')
+        {
+            p++;
+            continue;
+        }
+        precision = -1;
+        longs     = 0;
+        while (strchr("-+ #0", *p) && *p)
+        {
+            p++;
+        }
+        if (*p == '*')
+        {
+            word = (uint32_t)va_arg(args, int);
+            debug_binPut(record, &used, &word, sizeof(word));
+            p++;
+        }
+        while (*p >= '0' && *p <= '9')
+        {
+            p++;
+        }
+        if (*p == '.')
+        {
+            p++;
+            precision = 0;
+            if (*p == '*')
+            {
+                precision = va_arg(args, int);
+                word      = (uint32_t)precision;
+                debug_binPut(record, &used, &word, sizeof(word));
+                p++;
+            }
+            while (*p >= '0' && *p <= '9')
+            {
+                precision = precision * 10 + (*p++ - '0');
+            }
+        }
+        while (*p && strchr("hlLqjzt", *p))
+        {
+            longs += (*p == 'l' || *p == 'q' || *p == 'j') ? 1 : 0;
+            p++;
+        }
+
+        switch (*p)
+        {
+            case 's':
+                str       = va_arg(args, const char*);
+                str       = str ? str : "(null)";
+                strLength = 0;
+                // Bounded by the precision too, spans are not terminated
+                while (strLength < DEBUG_BIN_STRING_MAX && (precision < 0 || strLength < precision) && str[strLength])
+                {
+                    strLength++;
+                }
+                debug_binPut(record, &used, &strLength, sizeof(strLength));
+                debug_binPut(record, &used, str, strLength);
+                break;
+            case 'e':
+            case 'E':
+            case 'f':
+            case 'g':
+            case 'G':
+                real = va_arg(args, double);
+                debug_binPut(record, &used, &real, sizeof(real));
+                break;
+            case '\0':
+                return used;
+            default:
+                if (longs >= 2)
+                {
+                    wide = va_arg(args, uint64_t);
+                    debug_binPut(record, &used, &wide, sizeof(wide));
+                }
+                else
+                {
+                    word = va_arg(args, unsigned int);
+                    debug_binPut(record, &used, &word, sizeof(word));
+                }
+                break;
+        }
+        p++;
+    }
+    return used;
+}
+
+static void debug_binRecord(debug_severity_t debug_severity, debug_errorLevel_t error_level, const char* format, va_list args)
+{
+    uint8_t  record[DEBUG_BIN_HEADER_SIZE + DEBUG_BIN_ARGS_MAX + 1];
+    uint8_t  length;
+    uint8_t  check = 0;
+    uint32_t word;
+    uint32_t head;
+    uint8_t  i;
+
+    if (__get_IPSR() != 0)
+    {
+        // The ring has one producer, the main loop
+        debug_binDropped++;
+        return;
+    }
+
+    length = debug_binEncodeArgs(record, format, args);
+
+    record[0] = DEBUG_BIN_SYNC0;
+    record[1] = DEBUG_BIN_SYNC1;
+    record[2] = length - DEBUG_BIN_HEADER_SIZE;
+    record[3] = (uint8_t)((debug_severity << 4) | error_level);
+    word      = (uint32_t)(uintptr_t)format;
+    memcpy(&record[4], &word, sizeof(word));
+    word = SYS_TIME_CounterGet();
+    memcpy(&record[8], &word, sizeof(word));
+    for (i = 0; i < length; i++)
+    {
+        check ^= record[i];
+    }
+    record[length++] = check;
+
+    head = debug_binHead;
+    if (CFG_DEBUG_BINARY_LOG_SIZE - (head - debug_binTail) < length)
+    {
+        debug_binDropped++;
+        return;
+    }
+    for (i = 0; i < length; i++)
+    {
+        debug_binRing[(head + i) & DEBUG_BIN_MASK] = record[i];
+    }
+    debug_binHead = head + length;
+}
+#endif
+
+// Called from the main loop.  In binary mode it moves queued records into the
+// console's transmit buffer, reporting any that were dropped as a record with
+// a zero format address.
+void debug_drain(void)
+{
+#if CFG_DEBUG_BINARY_LOG
+    uint32_t tail = debug_binTail;
+    uint32_t count;
+    ssize_t  written;
+
+    if (debug_binDropped && (CFG_DEBUG_BINARY_LOG_SIZE - (debug_binHead - tail)) > DEBUG_BIN_HEADER_SIZE + 5)
+    {
+        uint8_t  record[DEBUG_BIN_HEADER_SIZE + 5] = {DEBUG_BIN_SYNC0, DEBUG_BIN_SYNC1, 4, (SEVERITY_WARN << 4) | LEVEL_WARN};
+        uint32_t word                              = SYS_TIME_CounterGet();
+        uint8_t  check                             = 0;
+        uint8_t  i;
+
+        memcpy(&record[8], &word, sizeof(word));
+        memcpy(&record[DEBUG_BIN_HEADER_SIZE], &debug_binDropped, sizeof(debug_binDropped));
+        for (i = 0; i < sizeof(record) - 1; i++)
+        {
+            check ^= record[i];
+        }
+        record[sizeof(record) - 1] = check;
+        for (i = 0; i < sizeof(record); i++)
+        {
+            debug_binRing[(debug_binHead + i) & DEBUG_BIN_MASK] = record[i];
+        }
+        debug_binHead += sizeof(record);
+        debug_binDropped = 0;
+    }
+
+    while (debug_binHead != tail)
+    {
+        // Contiguous run up to the end of the ring
+        count = debug_binHead - tail;
+        if (count > CFG_DEBUG_BINARY_LOG_SIZE - (tail & DEBUG_BIN_MASK))
+        {
+            count = CFG_DEBUG_BINARY_LOG_SIZE - (tail & DEBUG_BIN_MASK);
+        }
+        written = SYS_CONSOLE_Write(0, &debug_binRing[tail & DEBUG_BIN_MASK], count);
+        if (written <= 0)
+        {
+            break;
+        }
+        tail += (uint32_t)written;
+    }
+    debug_binTail = tail;
+#endif
+}
+
 void debug_printer(debug_severity_t debug_severity, debug_errorLevel_t error_level, const char* format, ...)
 {
     size_t  len = 0;
     va_list args;
 
+    // The module filter was checked by the caller's macro
     if (debug_severity >= SEVERITY_NONE && debug_severity <= SEVERITY_TRACE)
     {
-        if (debug_severity <= debug_severity_filter)
-        {
-            if (error_level < LEVEL_INFO)
-                error_level = LEVEL_INFO;
+        if (error_level < LEVEL_INFO)
+            error_level = LEVEL_INFO;
 
-            if (error_level > LEVEL_ERROR)
-                error_level = LEVEL_ERROR;
+        if (error_level > LEVEL_ERROR)
+            error_level = LEVEL_ERROR;
 
-            debug_mutex_lock(&consoleMutex);
+#if CFG_DEBUG_BINARY_LOG
+        va_start(args, format);
+        debug_binRecord(debug_severity, error_level, format, args);
+        va_end(args);
+        return;
+#endif
 
-            sprintf(tmpFormat, "%s %s %s %s\r\n" CSI_RESET, debug_message_prefix, severity_strings[debug_severity], level_strings[error_level], format);
+        debug_mutex_lock(&consoleMutex);
 
-            va_start(args, format);
-            len = vsnprintf(tmpBuf, APP_PRINT_BUFFER_SIZE, tmpFormat, args);
-            va_end(args);
+        sprintf(tmpFormat, "%s %s %s %s\r\n" CSI_RESET, debug_message_prefix, severity_strings[debug_severity], level_strings[error_level], format);
 
-            if ((len > 0) && (len < APP_PRINT_BUFFER_SIZE))
-            {
-                char* pBuf;
-                if ((len + printBuffPtr) > APP_PRINT_BUFFER_SIZE)
-                {
-                    printBuffPtr = 0;
-                }
+        va_start(args, format);
+        len = vsnprintf(tmpBuf, APP_PRINT_BUFFER_SIZE, tmpFormat, args);
+        va_end(args);
 
-                memcpy(&printBuff[printBuffPtr], tmpBuf, len);
-                pBuf                              = &printBuff[printBuffPtr];
-                printBuff[printBuffPtr + len + 1] = '\0';
-                printBuffPtr                      = (printBuffPtr + len + 3) & ~3;
-                SYS_CONSOLE_Write(0, pBuf, len);
+        if ((len > 0) && (len < APP_PRINT_BUFFER_SIZE))
+        {
+            char* pBuf;
+            // Room for the message and its terminator
+            if ((len + printBuffPtr) >= APP_PRINT_BUFFER_SIZE)
+            {
+                printBuffPtr = 0;
             }
-            OSAL_MUTEX_Unlock(&consoleMutex);
+
+            memcpy(&printBuff[printBuffPtr], tmpBuf, len);
+            pBuf                          = &printBuff[printBuffPtr];
+            printBuff[printBuffPtr + len] = '\0';
+            printBuffPtr                      = (printBuffPtr + len + 3) & ~3;
+            SYS_CONSOLE_Write(0, pBuf, len);
         }
+        OSAL_MUTEX_Unlock(&consoleMutex);
     }
 }
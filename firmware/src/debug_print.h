@@ -30,6 +30,13 @@
 
 #include "iot_config/IoT_Sensor_Node_config.h"
 
+// Module tag of the translation unit, define it before the first include,
+// e.g. #define DEBUG_MODULE MQTT.  It picks CFG_DEBUG_LEVEL_<tag> at compile
+// time and the runtime filter of DEBUG_MODULE_<tag>.
+#ifndef DEBUG_MODULE
+#define DEBUG_MODULE APP
+#endif
+
 #define CSI_RESET   "\33[0m"
 #define CSI_BLACK   "\33[30m"
 #define CSI_RED     "\33[31m"
@@ -62,6 +69,16 @@ typedef enum
     LEVEL_ERROR
 } debug_errorLevel_t;
 
+typedef enum
+{
+    DEBUG_MODULE_APP,
+    DEBUG_MODULE_CLOUD,
+    DEBUG_MODULE_MQTT,
+    DEBUG_MODULE_BSD,
+    DEBUG_MODULE_AZUTIL,
+    DEBUG_MODULE_COUNT
+} debug_module_t;
+
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wunused-variable"
 static const char*     severity_strings[] = {
@@ -70,6 +87,7 @@ static const char*     severity_strings[] = {
     CSI_YELLOW "  WARN" CSI_WHITE,
     CSI_CYAN " DEBUG" CSI_WHITE,
     CSI_WHITE "  INFO" CSI_NORMAL CSI_WHITE,
+    CSI_WHITE " TRACE" CSI_NORMAL CSI_WHITE,
 };
 
 static const char* level_strings[] = {
@@ -80,54 +98,71 @@ static const char* level_strings[] = {
 };
 #pragma GCC diagnostic pop
 
+extern debug_severity_t debug_moduleFilter[DEBUG_MODULE_COUNT];
+
 debug_severity_t debug_getSeverity(void);
 
-void debug_setSeverity(debug_severity_t debug_level);
+void             debug_setSeverity(debug_severity_t debug_level);
+debug_severity_t debug_getModuleSeverity(debug_module_t module);
+void             debug_setModuleSeverity(debug_module_t module, debug_severity_t debug_level);
+const char*      debug_moduleName(debug_module_t module);
 void debug_printer(debug_severity_t debug_severity, debug_errorLevel_t error_level, const char* format, ...);
 void debug_setPrefix(const char* prefix);
 void debug_init(const char* prefix);
+void debug_drain(void);
 //void debug_printf(const char* format, ...);
 
+#define DEBUG_PASTE_(a, b) a##b
+#define DEBUG_PASTE(a, b)  DEBUG_PASTE_(a, b)
+
+// Constant false when the module's compile-time level excludes the severity,
+// so the call and its arguments compile to nothing.  Otherwise the runtime
+// filter is checked before any argument is evaluated.
+#define DEBUG_ENABLED(severity)                                      \
+    (IOT_DEBUG_PRINT                                                 \
+     && (severity) <= DEBUG_PASTE(CFG_DEBUG_LEVEL_, DEBUG_MODULE)    \
+     && (severity) <= debug_moduleFilter[DEBUG_PASTE(DEBUG_MODULE_, DEBUG_MODULE)])
+
 
 #define debug_print(fmt, ...)                                                        \
     do                                                                               \
     {                                                                                \
-        if (IOT_DEBUG_PRINT)                                                         \
+        if (DEBUG_ENABLED(SEVERITY_DEBUG))                                           \
             debug_printer(SEVERITY_DEBUG, LEVEL_INFO, fmt CSI_RESET, ##__VA_ARGS__); \
     } while (0)
 
 #define debug_printGood(fmt, ...)                                                    \
     do                                                                               \
     {                                                                                \
-        if (IOT_DEBUG_PRINT)                                                         \
+        if (DEBUG_ENABLED(SEVERITY_DEBUG))                                           \
             debug_printer(SEVERITY_DEBUG, LEVEL_GOOD, fmt CSI_RESET, ##__VA_ARGS__); \
     } while (0)
 
 #define debug_printWarn(fmt, ...)                                                   \
     do                                                                              \
     {                                                                               \
-        if (IOT_DEBUG_PRINT)                                                        \
+        if (DEBUG_ENABLED(SEVERITY_WARN))                                           \
             debug_printer(SEVERITY_WARN, LEVEL_WARN, fmt CSI_RESET, ##__VA_ARGS__); \
     } while (0)
 
 #define debug_printError(fmt, ...)                                                    \
     do                                                                                \
     {                                                                                 \
-        if (IOT_DEBUG_PRINT)                                                          \
+        if (DEBUG_ENABLED(SEVERITY_ERROR))                                            \
             debug_printer(SEVERITY_ERROR, LEVEL_ERROR, fmt CSI_RESET, ##__VA_ARGS__); \
     } while (0)
 
 #define debug_printInfo(fmt, ...)                                                   \
     do                                                                              \
     {                                                                               \
-        if (IOT_DEBUG_PRINT)                                                        \
+        if (DEBUG_ENABLED(SEVERITY_INFO))                                           \
             debug_printer(SEVERITY_INFO, LEVEL_INFO, fmt CSI_RESET, ##__VA_ARGS__); \
     } while (0)
 
 #define debug_printTrace(fmt, ...)                                                   \
     do                                                                               \
     {                                                                                \
-        if (IOT_DEBUG_PRINT)                                                         \
+        if (DEBUG_ENABLED(SEVERITY_TRACE))                                           \
             debug_printer(SEVERITY_TRACE, LEVEL_INFO, fmt CSI_RESET, ##__VA_ARGS__); \
     } while (0)
 #endif   // DEBUG_PRINT_H
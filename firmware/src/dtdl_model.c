@@ -0,0 +1,72 @@
+// Generated by tools/dtdl_codegen.py from device_model/sam_iot_wm-2.json, do not edit.
+
+#include <stddef.h>
+#include <string.h>
+#include "dtdl_model.h"
+
+const dtdl_property_t dtdlProperties[DTDL_PROPERTY_COUNT] = {
+    {AZ_SPAN_LITERAL_FROM_STR("led_b"), DTDL_SCHEMA_ENUM, NULL, dtdl_reported_led_b},
+    {AZ_SPAN_LITERAL_FROM_STR("led_g"), DTDL_SCHEMA_ENUM, NULL, dtdl_reported_led_g},
+    {AZ_SPAN_LITERAL_FROM_STR("led_r"), DTDL_SCHEMA_ENUM, NULL, dtdl_reported_led_r},
+    {AZ_SPAN_LITERAL_FROM_STR("led_y"), DTDL_SCHEMA_ENUM, dtdl_desired_led_y, dtdl_reported_led_y},
+    {AZ_SPAN_LITERAL_FROM_STR("telemetryInterval"), DTDL_SCHEMA_INTEGER, dtdl_desired_telemetryInterval, dtdl_reported_telemetryInterval},
+};
+
+const dtdl_telemetry_t dtdlTelemetry[DTDL_TELEMETRY_COUNT] = {
+    {AZ_SPAN_LITERAL_FROM_STR("button_event"), DTDL_SCHEMA_OBJECT, NULL},
+    {AZ_SPAN_LITERAL_FROM_STR("diagnostics"), DTDL_SCHEMA_OBJECT, NULL},
+    {AZ_SPAN_LITERAL_FROM_STR("light"), DTDL_SCHEMA_INTEGER, dtdl_telemetry_light},
+    {AZ_SPAN_LITERAL_FROM_STR("temperature"), DTDL_SCHEMA_INTEGER, dtdl_telemetry_temperature},
+};
+
+const dtdl_command_t dtdlCommands[DTDL_COMMAND_COUNT] = {
+    {AZ_SPAN_LITERAL_FROM_STR("reboot"), dtdl_command_reboot},
+};
+
+// Every table entry starts with its az_span name, so one search serves all three
+static const void* dtdl_search(az_span name, const void* table, size_t count, size_t stride)
+{
+    size_t low  = 0;
+    size_t high = count;
+
+    while (low < high)
+    {
+        size_t         mid   = low + (high - low) / 2;
+        const az_span* key   = (const az_span*)((const uint8_t*)table + mid * stride);
+        int32_t        size  = az_span_size(name) < az_span_size(*key) ? az_span_size(name) : az_span_size(*key);
+        int            order = memcmp(az_span_ptr(name), az_span_ptr(*key), (size_t)size);
+
+        if (order == 0)
+        {
+            order = az_span_size(name) - az_span_size(*key);
+        }
+        if (order == 0)
+        {
+            return key;
+        }
+        if (order < 0)
+        {
+            high = mid;
+        }
+        else
+        {
+            low = mid + 1;
+        }
+    }
+    return NULL;
+}
+
+const dtdl_property_t* DTDL_findProperty(az_span name)
+{
+    return dtdl_search(name, dtdlProperties, DTDL_PROPERTY_COUNT, sizeof(dtdl_property_t));
+}
+
+const dtdl_telemetry_t* DTDL_findTelemetry(az_span name)
+{
+    return dtdl_search(name, dtdlTelemetry, DTDL_TELEMETRY_COUNT, sizeof(dtdl_telemetry_t));
+}
+
+const dtdl_command_t* DTDL_findCommand(az_span name)
+{
+    return dtdl_search(name, dtdlCommands, DTDL_COMMAND_COUNT, sizeof(dtdl_command_t));
+}
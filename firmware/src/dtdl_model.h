@@ -0,0 +1,106 @@
+// Generated by tools/dtdl_codegen.py from device_model/sam_iot_wm-2.json, do not edit.
+
+#ifndef DTDL_MODEL_H_
+#define DTDL_MODEL_H_
+#include <stdbool.h>
+#include <stdint.h>
+#include "azutil.h"
+
+#define DTDL_MODEL_ID "dtmi:com:Microchip:SAM_IoT_WM;2"
+
+// dtmi:com:Microchip:SAM_IoT_WM:LedState;2
+#define DTDL_LED_STATE_ON    1
+#define DTDL_LED_STATE_OFF   2
+#define DTDL_LED_STATE_BLINK 3
+
+typedef enum
+{
+    DTDL_SCHEMA_BOOLEAN = 0,
+    DTDL_SCHEMA_DATE,
+    DTDL_SCHEMA_DATETIME,
+    DTDL_SCHEMA_DOUBLE,
+    DTDL_SCHEMA_DURATION,
+    DTDL_SCHEMA_FLOAT,
+    DTDL_SCHEMA_INTEGER,
+    DTDL_SCHEMA_LONG,
+    DTDL_SCHEMA_STRING,
+    DTDL_SCHEMA_TIME,
+    DTDL_SCHEMA_ENUM,
+    DTDL_SCHEMA_OBJECT,
+    DTDL_SCHEMA_ARRAY,
+    DTDL_SCHEMA_MAP,
+} dtdl_schema_t;
+
+typedef az_result (*dtdl_desired_handler_t)(az_json_token* token, twin_properties_t* twin_properties);
+typedef bool (*dtdl_reported_handler_t)(const twin_properties_t* twin_properties, int32_t* value);
+typedef int32_t (*dtdl_telemetry_handler_t)(void);
+typedef az_result (*dtdl_command_handler_t)(az_span payload_span, az_span response_span, az_span* out_response_span, uint16_t* out_response_status);
+
+typedef struct
+{
+    az_span                 name;
+    dtdl_schema_t           schema;
+    dtdl_desired_handler_t  desired;    // NULL for read-only properties
+    dtdl_reported_handler_t reported;   // returns true when the value changed
+} dtdl_property_t;
+
+typedef struct
+{
+    az_span                  name;
+    dtdl_schema_t            schema;
+    dtdl_telemetry_handler_t read;   // NULL for objects, their builder writes the fields
+} dtdl_telemetry_t;
+
+typedef struct
+{
+    az_span                name;
+    dtdl_command_handler_t handler;
+} dtdl_command_t;
+
+typedef enum
+{
+    DTDL_PROPERTY_LED_B = 0,
+    DTDL_PROPERTY_LED_G,
+    DTDL_PROPERTY_LED_R,
+    DTDL_PROPERTY_LED_Y,
+    DTDL_PROPERTY_TELEMETRY_INTERVAL,
+    DTDL_PROPERTY_COUNT
+} dtdl_property_index_t;
+
+typedef enum
+{
+    DTDL_TELEMETRY_BUTTON_EVENT = 0,
+    DTDL_TELEMETRY_DIAGNOSTICS,
+    DTDL_TELEMETRY_LIGHT,
+    DTDL_TELEMETRY_TEMPERATURE,
+    DTDL_TELEMETRY_COUNT
+} dtdl_telemetry_index_t;
+
+typedef enum
+{
+    DTDL_COMMAND_REBOOT = 0,
+    DTDL_COMMAND_COUNT
+} dtdl_command_index_t;
+
+// Sorted by name
+extern const dtdl_property_t  dtdlProperties[DTDL_PROPERTY_COUNT];
+extern const dtdl_telemetry_t dtdlTelemetry[DTDL_TELEMETRY_COUNT];
+extern const dtdl_command_t   dtdlCommands[DTDL_COMMAND_COUNT];
+
+const dtdl_property_t*  DTDL_findProperty(az_span name);
+const dtdl_telemetry_t* DTDL_findTelemetry(az_span name);
+const dtdl_command_t*   DTDL_findCommand(az_span name);
+
+// Handlers, implemented by the application
+bool      dtdl_reported_led_b(const twin_properties_t* twin_properties, int32_t* value);
+bool      dtdl_reported_led_g(const twin_properties_t* twin_properties, int32_t* value);
+bool      dtdl_reported_led_r(const twin_properties_t* twin_properties, int32_t* value);
+az_result dtdl_desired_led_y(az_json_token* token, twin_properties_t* twin_properties);
+bool      dtdl_reported_led_y(const twin_properties_t* twin_properties, int32_t* value);
+az_result dtdl_desired_telemetryInterval(az_json_token* token, twin_properties_t* twin_properties);
+bool      dtdl_reported_telemetryInterval(const twin_properties_t* twin_properties, int32_t* value);
+int32_t   dtdl_telemetry_light(void);
+int32_t   dtdl_telemetry_temperature(void);
+az_result dtdl_command_reboot(az_span payload_span, az_span response_span, az_span* out_response_span, uint16_t* out_response_status);
+
+#endif /* DTDL_MODEL_H_ */
@@ -0,0 +1,218 @@
+/*
+    \file   idle.c
+
+    \brief  idle.ceader file.
+
+    (c) 2018 Microchip Technology Inc. and its subsidiaries.
+
+    Subject to your compliance with these terms, you may use Microchip software and any
+    derivatives exclusively with Microchip products. It is your responsibility to comply with third party
+    license terms applicable to your use of third party software (including open source software) that
+    may accompany Microchip software.
+
+    THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+    EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY
+    IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS
+    FOR A PARTICULAR PURPOSE.
+
+    IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
+    INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND
+    WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP
+    HAS BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO
+    THE FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL
+    CLAIMS IN ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT
+    OF FEES, IF ANY, THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS
+    SOFTWARE.
+*/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "idle.h"
+#include "console_dma.h"
+#include "definitions.h"
+#include "iot_config/IoT_Sensor_Node_config.h"
+
+idle_stats_t idleStats;
+
+static bool     idle_enabled = (CFG_IDLE_SLEEP_ENABLE != 0);
+static bool     idle_started = false;
+static uint32_t idle_lastCount;
+
+#if CFG_IDLE_STANDBY_ENABLE
+#define IDLE_STANDBY_GCLK 2    // OSC8M / 8, the SYS_TIME clock for TC3
+#define IDLE_EIC_GCLK_ID  5    // GCLK_EIC peripheral channel
+
+// The MHC clock, EIC and TC3 setup lets everything stop in standby.  Keep
+// SYS_TIME and the pin interrupts alive instead: OSC8M and GCLK2 run in
+// standby, the EIC moves off GCLK0 (DFLL48M, stopped in standby) onto GCLK2
+// so its edge detection still sees the WINC and button lines, those lines
+// may wake the core, and TC3 keeps counting.  Done at run time so the
+// generated plib files stay as MHC writes them.
+static void idle_configureStandby(void)
+{
+    uint32_t genctrl;
+
+    if (TC3_REGS->COUNT16.TC_CTRLA & TC_CTRLA_RUNSTDBY_Msk)
+    {
+        return;
+    }
+
+    SYSCTRL_REGS->SYSCTRL_OSC8M |= SYSCTRL_OSC8M_RUNSTDBY_Msk;
+
+    // GENCTRL reads back the generator selected by the last ID write
+    *(volatile uint8_t*)&GCLK_REGS->GCLK_GENCTRL = GCLK_GENCTRL_ID(IDLE_STANDBY_GCLK);
+    genctrl = GCLK_REGS->GCLK_GENCTRL;
+    GCLK_REGS->GCLK_GENCTRL = genctrl | GCLK_GENCTRL_RUNSTDBY_Msk;
+    while ((GCLK_REGS->GCLK_STATUS & GCLK_STATUS_SYNCBUSY_Msk) == GCLK_STATUS_SYNCBUSY_Msk)
+    {
+        /* Wait for the generator to synchronize */
+    }
+
+    // A peripheral channel only changes generator while it is disabled
+    GCLK_REGS->GCLK_CLKCTRL = GCLK_CLKCTRL_ID(IDLE_EIC_GCLK_ID);
+    while ((GCLK_REGS->GCLK_CLKCTRL & GCLK_CLKCTRL_CLKEN_Msk) == GCLK_CLKCTRL_CLKEN_Msk)
+    {
+        /* Wait for the EIC clock to stop */
+    }
+    GCLK_REGS->GCLK_CLKCTRL = GCLK_CLKCTRL_ID(IDLE_EIC_GCLK_ID) | GCLK_CLKCTRL_GEN(IDLE_STANDBY_GCLK) | GCLK_CLKCTRL_CLKEN_Msk;
+
+    EIC_REGS->EIC_WAKEUP = EIC_REGS->EIC_INTENSET;
+
+    // RUNSTDBY is enable-protected.  Disabling keeps COUNT, so SYS_TIME only
+    // misses the few counts spent synchronizing.
+    TC3_REGS->COUNT16.TC_CTRLA &= ~TC_CTRLA_ENABLE_Msk;
+    while ((TC3_REGS->COUNT16.TC_STATUS & TC_STATUS_SYNCBUSY_Msk) == TC_STATUS_SYNCBUSY_Msk)
+    {
+        /* Wait for the timer to stop */
+    }
+    TC3_REGS->COUNT16.TC_CTRLA |= TC_CTRLA_RUNSTDBY_Msk;
+    TC3_REGS->COUNT16.TC_CTRLA |= TC_CTRLA_ENABLE_Msk;
+    while ((TC3_REGS->COUNT16.TC_STATUS & TC_STATUS_SYNCBUSY_Msk) == TC_STATUS_SYNCBUSY_Msk)
+    {
+        /* Wait for the timer to restart */
+    }
+}
+
+// Standby stops GCLK0, so anything clocked from it has to be finished first
+static bool idle_peripheralsBusy(void)
+{
+    return (CONSOLE_DMA_WriteCountGet() > 0) ||
+           SERCOM4_SPI_IsBusy() ||
+           SERCOM3_I2C_IsBusy() ||
+           DMAC_ChannelIsBusy(DMAC_CHANNEL_0) ||
+           DMAC_ChannelIsBusy(DMAC_CHANNEL_1);
+}
+#endif
+
+// Called by the application once start-up is over.  The start-up states poll
+// driver status with no interrupt behind it, so they must not sleep.
+void IDLE_start(void)
+{
+#if CFG_IDLE_STANDBY_ENABLE
+    idle_configureStandby();
+#endif
+    IDLE_resetStats();
+    idle_started = true;
+}
+
+void IDLE_enable(bool enable)
+{
+    idle_enabled = enable;
+}
+
+bool IDLE_isEnabled(void)
+{
+    return idle_enabled;
+}
+
+void IDLE_resetStats(void)
+{
+    memset(&idleStats, 0, sizeof(idleStats));
+    idle_lastCount = SYS_TIME_CounterGet();
+}
+
+// Called after every SYS_Tasks() pass.  SYS_TIME already programs TC3 for
+// the next software timer (and at least once per 16-bit counter wrap), and
+// the EIC, SERCOM and DMAC interrupts wake the core for everything else, so
+// sleeping here until the next interrupt loses nothing.
+void IDLE_task(void)
+{
+    idle_sleep_t mode = IDLE_SLEEP_IDLE;
+    uint32_t     now;
+
+    if (!idle_started)
+    {
+        return;
+    }
+
+    now = SYS_TIME_CounterGet();
+    idleStats.elapsedUs += SYS_TIME_CountToUS(now - idle_lastCount);
+    idle_lastCount = now;
+
+    if (!idle_enabled)
+    {
+        return;
+    }
+
+#if CFG_IDLE_STANDBY_ENABLE
+    if (idle_peripheralsBusy())
+    {
+        idleStats.busy++;
+    }
+    else
+    {
+        mode = IDLE_SLEEP_STANDBY;
+    }
+#endif
+
+    if (mode == IDLE_SLEEP_STANDBY)
+    {
+        SCB->SCR |= SCB_SCR_SLEEPDEEP_Msk;
+    }
+    else
+    {
+        PM_REGS->PM_SLEEP = PM_SLEEP_IDLE_CPU;
+    }
+
+    // Any interrupt handled since the last WFE leaves the event register set,
+    // so a flag raised by an ISR during SYS_Tasks() returns straight away for
+    // another pass instead of sleeping on it.
+    __DSB();
+    __WFE();
+
+    // The secure element HAL waits with WFI and expects plain idle
+    SCB->SCR &= ~SCB_SCR_SLEEPDEEP_Msk;
+
+    now = SYS_TIME_CounterGet();
+    idleStats.sleepUs[mode] += SYS_TIME_CountToUS(now - idle_lastCount);
+    idleStats.elapsedUs += SYS_TIME_CountToUS(now - idle_lastCount);
+    idle_lastCount = now;
+    idleStats.entries[mode]++;
+    idleStats.wakeups++;
+}
+
+uint32_t IDLE_wakeupsPerSecond(void)
+{
+    uint64_t elapsedUs = idleStats.elapsedUs;
+
+    return (elapsedUs < 1000000ULL) ? idleStats.wakeups : (uint32_t)(((uint64_t)idleStats.wakeups * 1000000ULL) / elapsedUs);
+}
+
+// Average MCU current from the time budget and the CFG_MCU_CURRENT_* figures
+uint32_t IDLE_averageUa(void)
+{
+    uint64_t elapsedUs = idleStats.elapsedUs;
+    uint64_t idleUs    = idleStats.sleepUs[IDLE_SLEEP_IDLE];
+    uint64_t standbyUs = idleStats.sleepUs[IDLE_SLEEP_STANDBY];
+    uint64_t activeUs;
+
+    if (elapsedUs == 0 || idleUs + standbyUs > elapsedUs)
+    {
+        return CFG_MCU_CURRENT_ACTIVE_UA;
+    }
+
+    activeUs = elapsedUs - idleUs - standbyUs;
+
+    return (uint32_t)((activeUs * CFG_MCU_CURRENT_ACTIVE_UA + idleUs * CFG_MCU_CURRENT_IDLE_UA + standbyUs * CFG_MCU_CURRENT_STANDBY_UA) / elapsedUs);
+}
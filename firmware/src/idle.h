@@ -0,0 +1,60 @@
+/*
+    \file   idle.h
+
+    \brief  idle.header file.
+
+    (c) 2018 Microchip Technology Inc. and its subsidiaries.
+
+    Subject to your compliance with these terms, you may use Microchip software and any
+    derivatives exclusively with Microchip products. It is your responsibility to comply with third party
+    license terms applicable to your use of third party software (including open source software) that
+    may accompany Microchip software.
+
+    THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+    EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY
+    IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS
+    FOR A PARTICULAR PURPOSE.
+
+    IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
+    INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND
+    WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP
+    HAS BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO
+    THE FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL
+    CLAIMS IN ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT
+    OF FEES, IF ANY, THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS
+    SOFTWARE.
+*/
+
+
+#ifndef IDLE_H_
+#define IDLE_H_
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef enum
+{
+    IDLE_SLEEP_IDLE = 0,   // CPU clock stopped, peripherals and DMA keep running
+    IDLE_SLEEP_STANDBY,    // all clocks stopped except OSC8M for SYS_TIME
+    IDLE_SLEEP_COUNT
+} idle_sleep_t;
+
+typedef struct
+{
+    uint64_t elapsedUs;                    // time covered by the statistics
+    uint64_t sleepUs[IDLE_SLEEP_COUNT];    // time spent asleep in each mode
+    uint32_t entries[IDLE_SLEEP_COUNT];    // times each mode was entered
+    uint32_t wakeups;                      // super-loop passes that ended in a sleep request
+    uint32_t busy;                         // standby requests turned into idle by a busy peripheral
+} idle_stats_t;
+
+extern idle_stats_t idleStats;
+
+void     IDLE_start(void);
+void     IDLE_task(void);
+void     IDLE_enable(bool enable);
+bool     IDLE_isEnabled(void);
+void     IDLE_resetStats(void);
+uint32_t IDLE_wakeupsPerSecond(void);
+uint32_t IDLE_averageUa(void);
+
+#endif /* IDLE_H_ */
@@ -41,9 +41,18 @@
 #include "services/iot/cloud/crypto_client/crypto_client.h"
 #include "services/iot/cloud/cloud_service.h"
 #include "services/iot/cloud/wifi_service.h"
+#include "services/iot/cloud/backoff.h"
+#include "services/iot/cloud/power_manager.h"
+#include "idle.h"
+#include "console_dma.h"
+#include "scheduler.h"
+#include "perf.h"
+#include "metrics.h"
+#include "memwatch.h"
 #include "credentials_storage/credentials_storage.h"
 #include "debug_print.h"
 #include "m2m_wifi.h"
+#include "wdrv_winc_spi.h"
 #include "services/iot/cloud/mqtt_packetPopulation/mqtt_iotprovisioning_packetPopulate.h"
 
 #define MAX_PUB_KEY_LEN  200
@@ -63,6 +72,20 @@ static void get_cli_version(SYS_CMD_DEVICE_NODE* pCmdIO, int argc, char** argv);
 static void get_firmware_version(SYS_CMD_DEVICE_NODE* pCmdIO, int argc, char** argv);
 static void get_set_debug_level(SYS_CMD_DEVICE_NODE* pCmdIO, int argc, char** argv);
 static void get_set_dps_idscope(SYS_CMD_DEVICE_NODE* pCmdIO, int argc, char** argv);
+static void get_backoff_status(SYS_CMD_DEVICE_NODE* pCmdIO, int argc, char** argv);
+static void get_dns_cache(SYS_CMD_DEVICE_NODE* pCmdIO, int argc, char** argv);
+static void get_tls_stats(SYS_CMD_DEVICE_NODE* pCmdIO, int argc, char** argv);
+static void get_set_i2c_speed(SYS_CMD_DEVICE_NODE* pCmdIO, int argc, char** argv);
+static void get_spi_stats(SYS_CMD_DEVICE_NODE* pCmdIO, int argc, char** argv);
+static void get_set_power(SYS_CMD_DEVICE_NODE* pCmdIO, int argc, char** argv);
+static void get_set_idle(SYS_CMD_DEVICE_NODE* pCmdIO, int argc, char** argv);
+static void get_sched_stats(SYS_CMD_DEVICE_NODE* pCmdIO, int argc, char** argv);
+static void get_console_stats(SYS_CMD_DEVICE_NODE* pCmdIO, int argc, char** argv);
+static void get_metrics(SYS_CMD_DEVICE_NODE* pCmdIO, int argc, char** argv);
+static void get_memory(SYS_CMD_DEVICE_NODE* pCmdIO, int argc, char** argv);
+#if CFG_PERF_ENABLE
+static void get_perf_stats(SYS_CMD_DEVICE_NODE* pCmdIO, int argc, char** argv);
+#endif
 
 #define LINE_TERM "\r\n"
 
@@ -75,7 +98,21 @@ static const SYS_CMD_DESCRIPTOR _iotCmdTbl[] =
         {"device", get_device_id, ": Get ECC Serial No. "},
         {"cli_version", get_cli_version, ": Get CLI version "},
         {"version", get_firmware_version, ": Get Firmware version "},
-        {"debug", get_set_debug_level, ": Get and Set Debug Level "},
+        {"debug", get_set_debug_level, ": Get and Set Debug Level [module] <level> "},
+        {"backoff", get_backoff_status, ": Get reconnect backoff attempts and next retry "},
+        {"dns", get_dns_cache, ": Get cached MQTT host addresses and time to CONNACK "},
+        {"tls", get_tls_stats, ": Get TLS handshake and secure element timing "},
+        {"i2c", get_set_i2c_speed, ": Get/Set secure element I2C bus speed in Hz "},
+        {"spi", get_spi_stats, ": Get WINC SPI transfer counts and throughput "},
+        {"power", get_set_power, ": WINC power save //Usage: power [on|off] or power est <telemetry s> <keep-alive s> [listen interval] "},
+        {"idle", get_set_idle, ": MCU sleep in the main loop //Usage: idle [on|off|reset] "},
+        {"sched", get_sched_stats, ": Get event queue depth and per-event latency "},
+        {"console", get_console_stats, ": Get console transmit backlog and overflow count "},
+        {"stats", get_metrics, ": Get runtime counters, gauges and histograms //Usage: stats [reset] "},
+        {"mem", get_memory, ": Get stack and heap high-water marks "},
+#if CFG_PERF_ENABLE
+        {"perf", get_perf_stats, ": Get hot-path probe timing //Usage: perf [reset] "},
+#endif
 };
 
 void sys_cmd_init()
@@ -127,22 +164,54 @@ static void get_set_debug_level(SYS_CMD_DEVICE_NODE* pCmdIO, int argc, char** ar
 {
     const void* cmdIoParam = pCmdIO->cmdIoParam;
     uint8_t     level      = 0;
+    uint8_t     module;
     (*pCmdIO->pCmdApi->msg)(cmdIoParam, LINE_TERM "Set Debug Level\r\n");
 
     if (argc == 1)
     {
         debug_severity_t level;
         level = debug_getSeverity();
-        (*pCmdIO->pCmdApi->print)(cmdIoParam, LINE_TERM "Current debug level %s\r\n\4", severity_strings[level]);
+        (*pCmdIO->pCmdApi->print)(cmdIoParam, LINE_TERM "Current debug level %s\r\n", severity_strings[level]);
+        for (module = 0; module < DEBUG_MODULE_COUNT; module++)
+        {
+            (*pCmdIO->pCmdApi->print)(cmdIoParam, "  %-7s %s\r\n", debug_moduleName(module), severity_strings[debug_getModuleSeverity(module)]);
+        }
+        (*pCmdIO->pCmdApi->msg)(cmdIoParam, "\4");
         return;
     }
 
+    // debug <module> <level> sets one module, debug <level> sets them all
+    module = DEBUG_MODULE_COUNT;
+    if (argc == 3)
+    {
+        for (module = 0; module < DEBUG_MODULE_COUNT; module++)
+        {
+            if (strcmp(argv[1], debug_moduleName(module)) == 0)
+            {
+                break;
+            }
+        }
+        if (module == DEBUG_MODULE_COUNT)
+        {
+            (*pCmdIO->pCmdApi->print)(cmdIoParam, LINE_TERM "Unknown module %s\r\n", argv[1]);
+            return;
+        }
+        argv++;
+    }
+
     (*pCmdIO->pCmdApi->print)(cmdIoParam, argv[1]);
     level = (*argv[1] - '0');
 
     if (level >= SEVERITY_NONE && level <= SEVERITY_TRACE)
     {
-        debug_setSeverity((debug_severity_t)level);
+        if (module < DEBUG_MODULE_COUNT)
+        {
+            debug_setModuleSeverity((debug_module_t)module, (debug_severity_t)level);
+        }
+        else
+        {
+            debug_setSeverity((debug_severity_t)level);
+        }
         (*pCmdIO->pCmdApi->msg)(cmdIoParam, LINE_TERM "OK\r\n\4");
     }
     else
@@ -151,6 +220,390 @@ static void get_set_debug_level(SYS_CMD_DEVICE_NODE* pCmdIO, int argc, char** ar
     }
 }
 
+static void get_backoff_status(SYS_CMD_DEVICE_NODE* pCmdIO, int argc, char** argv)
+{
+    const void*      cmdIoParam = pCmdIO->cmdIoParam;
+    const backoff_t* backoff;
+    uint8_t          i;
+
+    (*pCmdIO->pCmdApi->msg)(cmdIoParam, LINE_TERM "Reconnect Backoff\r\n");
+
+    for (i = 0; i < BACKOFF_getCount(); i++)
+    {
+        backoff = BACKOFF_get(i);
+        (*pCmdIO->pCmdApi->print)(cmdIoParam,
+                                  "%-6s attempts %lu (total %lu) last delay %lu ms next retry in %ld ms\r\n",
+                                  backoff->name,
+                                  backoff->attempts,
+                                  backoff->totalRetries,
+                                  backoff->lastDelayMs,
+                                  BACKOFF_msUntilRetry(backoff));
+    }
+    (*pCmdIO->pCmdApi->msg)(cmdIoParam, "OK\r\n\4");
+}
+
+static void get_dns_cache(SYS_CMD_DEVICE_NODE* pCmdIO, int argc, char** argv)
+{
+    const void* cmdIoParam = pCmdIO->cmdIoParam;
+    char*       host;
+    uint32_t    ip;
+    int32_t     ttl;
+    uint8_t     i;
+
+    (*pCmdIO->pCmdApi->msg)(cmdIoParam, LINE_TERM "DNS Cache\r\n");
+
+    for (i = 0; i < CLOUD_DNS_CACHE_SIZE; i++)
+    {
+        if (CLOUD_getDnsCache(i, &host, &ip, &ttl))
+        {
+            (*pCmdIO->pCmdApi->print)(cmdIoParam,
+                                      "%s %lu.%lu.%lu.%lu ttl %ld s\r\n",
+                                      host,
+                                      (0x0FF & (ip)),
+                                      (0x0FF & (ip >> 8)),
+                                      (0x0FF & (ip >> 16)),
+                                      (0x0FF & (ip >> 24)),
+                                      ttl);
+        }
+    }
+
+    (*pCmdIO->pCmdApi->print)(cmdIoParam,
+                              "CONNACK after reset: cached DNS %lu ms (%lu), resolved DNS %lu ms (%lu)\r\n",
+                              cloudConnectStats.lastWithDnsCacheMs,
+                              cloudConnectStats.connectsWithDnsCache,
+                              cloudConnectStats.lastWithoutDnsCacheMs,
+                              cloudConnectStats.connectsWithoutDnsCache);
+    (*pCmdIO->pCmdApi->msg)(cmdIoParam, "OK\r\n\4");
+}
+
+static void get_tls_stats(SYS_CMD_DEVICE_NODE* pCmdIO, int argc, char** argv)
+{
+    static const char* const ecc_request_names[CRYPTO_CLIENT_ECC_REQ_COUNT] = {"none", "client ecdh", "server ecdh", "gen key", "sign", "verify"};
+    const void*              cmdIoParam                                    = pCmdIO->cmdIoParam;
+    uint8_t                  i;
+
+    (*pCmdIO->pCmdApi->msg)(cmdIoParam, LINE_TERM "TLS Handshakes\r\n");
+    (*pCmdIO->pCmdApi->print)(cmdIoParam,
+                              "full %lu (last %lu ms, %lu ms in ECC) resumed %lu (last %lu ms) failed %lu\r\n",
+                              cloudTlsStats.fullHandshakes,
+                              cloudTlsStats.lastFullMs,
+                              cloudTlsStats.lastFullEccMs,
+                              cloudTlsStats.resumedHandshakes,
+                              cloudTlsStats.lastResumedMs,
+                              cloudTlsStats.failedHandshakes);
+    (*pCmdIO->pCmdApi->print)(cmdIoParam,
+                              "chain verify cache hits %lu misses %lu\r\n",
+                              verifyCacheStats.hits,
+                              verifyCacheStats.misses);
+    (*pCmdIO->pCmdApi->print)(cmdIoParam,
+                              "device data cache hits %lu misses %lu session reuse %lu commands avoided %lu\r\n",
+                              cryptoCacheStats.hits,
+                              cryptoCacheStats.misses,
+                              cryptoCacheStats.sessionReuse,
+                              cryptoCacheStats.commandsAvoided);
+    (*pCmdIO->pCmdApi->print)(cmdIoParam,
+                              "ecdh precomputed %lu used %lu inline %lu (keygen %lu us, %lu ms moved out of handshakes)\r\n",
+                              ecdhPrecomputeStats.precomputed,
+                              ecdhPrecomputeStats.used,
+                              ecdhPrecomputeStats.inlineGen,
+                              ecdhPrecomputeStats.lastGenUs,
+                              ecdhPrecomputeStats.movedMs);
+
+    for (i = 1; i < CRYPTO_CLIENT_ECC_REQ_COUNT; i++)
+    {
+        (*pCmdIO->pCmdApi->print)(cmdIoParam,
+                                  "%-11s count %lu last %lu us max %lu us total %lu ms\r\n",
+                                  ecc_request_names[i],
+                                  eccRequestStats[i].count,
+                                  eccRequestStats[i].lastUs,
+                                  eccRequestStats[i].maxUs,
+                                  eccRequestStats[i].totalMs);
+    }
+    (*pCmdIO->pCmdApi->msg)(cmdIoParam, "OK\r\n\4");
+}
+
+static void get_set_i2c_speed(SYS_CMD_DEVICE_NODE* pCmdIO, int argc, char** argv)
+{
+    const void* cmdIoParam = pCmdIO->cmdIoParam;
+    uint32_t    speed;
+
+    if (argc == 1)
+    {
+        (*pCmdIO->pCmdApi->print)(cmdIoParam, LINE_TERM "I2C bus speed %lu Hz\r\n\4", CRYPTO_CLIENT_getBusSpeed());
+        return;
+    }
+
+    speed = strtoul(argv[1], NULL, 10);
+
+    if (CRYPTO_CLIENT_setBusSpeed(speed) == NO_ERROR)
+    {
+        // Start a fresh set of timings for the new speed
+        memset(eccRequestStats, 0, sizeof(eccRequestStats));
+        (*pCmdIO->pCmdApi->msg)(cmdIoParam, LINE_TERM "OK\r\n\4");
+    }
+    else
+    {
+        (*pCmdIO->pCmdApi->print)(cmdIoParam,
+                                  LINE_TERM "I2C speed must be between %lu and %lu Hz\r\n\4",
+                                  (uint32_t)CRYPTO_CLIENT_I2C_SPEED_MIN,
+                                  (uint32_t)CRYPTO_CLIENT_I2C_SPEED_MAX);
+    }
+}
+
+static uint32_t spi_throughput(uint32_t bytes, uint64_t busyUs)
+{
+    return (busyUs == 0) ? 0 : (uint32_t)(((uint64_t)bytes * 1000000ULL) / busyUs);
+}
+
+static void get_spi_stats(SYS_CMD_DEVICE_NODE* pCmdIO, int argc, char** argv)
+{
+    const void*                cmdIoParam = pCmdIO->cmdIoParam;
+    const WDRV_WINC_SPI_STATS* stats      = WDRV_WINC_SPIStatsGet();
+
+    (*pCmdIO->pCmdApi->msg)(cmdIoParam, LINE_TERM "WINC SPI\r\n");
+    (*pCmdIO->pCmdApi->print)(cmdIoParam,
+                              "send %lu bytes in %lu transfers, %lu bytes/s\r\n",
+                              stats->txBytes,
+                              stats->txTransfers,
+                              spi_throughput(stats->txBytes, stats->txBusyUs));
+    (*pCmdIO->pCmdApi->print)(cmdIoParam,
+                              "recv %lu bytes in %lu transfers, %lu bytes/s\r\n",
+                              stats->rxBytes,
+                              stats->rxTransfers,
+                              spi_throughput(stats->rxBytes, stats->rxBusyUs));
+    (*pCmdIO->pCmdApi->msg)(cmdIoParam, "OK\r\n\4");
+}
+
+extern volatile uint32_t telemetryInterval;
+
+static void get_set_power(SYS_CMD_DEVICE_NODE* pCmdIO, int argc, char** argv)
+{
+    static const char* const power_state_names[POWER_STATE_COUNT] = {"awake", "wake ahead", "doze"};
+    const void*              cmdIoParam                           = pCmdIO->cmdIoParam;
+    uint32_t                 totalMs                              = 0;
+    uint16_t                 listenInterval;
+    uint8_t                  i;
+
+    if (argc == 2 && (strcmp(argv[1], "on") == 0 || strcmp(argv[1], "off") == 0))
+    {
+        POWER_enable(strcmp(argv[1], "on") == 0);
+        (*pCmdIO->pCmdApi->msg)(cmdIoParam, LINE_TERM "OK\r\n\4");
+        return;
+    }
+
+    if (argc >= 4 && strcmp(argv[1], "est") == 0)
+    {
+        listenInterval = (argc > 4) ? (uint16_t)strtoul(argv[4], NULL, 10) : CFG_WINC_PS_LISTEN_INTERVAL_MAX;
+        (*pCmdIO->pCmdApi->print)(cmdIoParam,
+                                  LINE_TERM "estimated WINC charge %lu uAh per hour\r\n\4",
+                                  POWER_estimateUa(strtoul(argv[2], NULL, 10), strtoul(argv[3], NULL, 10), listenInterval));
+        return;
+    }
+
+    (*pCmdIO->pCmdApi->print)(cmdIoParam,
+                              LINE_TERM "WINC power save %s, %s, listen interval %u, %lu mode changes\r\n",
+                              POWER_isEnabled() ? "on" : "off",
+                              power_state_names[POWER_getState()],
+                              powerStats.listenInterval,
+                              powerStats.modeChanges);
+
+    for (i = 0; i < POWER_STATE_COUNT; i++)
+    {
+        totalMs += powerStats.stateMs[i];
+    }
+
+    for (i = 0; i < POWER_STATE_COUNT; i++)
+    {
+        (*pCmdIO->pCmdApi->print)(cmdIoParam,
+                                  "%-10s %lu s (%lu%%)\r\n",
+                                  power_state_names[i],
+                                  powerStats.stateMs[i] / 1000,
+                                  (totalMs == 0) ? 0 : (uint32_t)(((uint64_t)powerStats.stateMs[i] * 100) / totalMs));
+    }
+
+    (*pCmdIO->pCmdApi->print)(cmdIoParam,
+                              "measured %lu uAh per hour, model %lu uAh per hour at %lu s telemetry\r\n",
+                              POWER_measuredUa(),
+                              POWER_estimateUa(telemetryInterval, AZ_IOT_DEFAULT_MQTT_CONNECT_KEEPALIVE_SECONDS, CFG_WINC_PS_LISTEN_INTERVAL_MAX),
+                              telemetryInterval);
+    (*pCmdIO->pCmdApi->msg)(cmdIoParam, "OK\r\n\4");
+}
+
+static void get_set_idle(SYS_CMD_DEVICE_NODE* pCmdIO, int argc, char** argv)
+{
+    const void* cmdIoParam = pCmdIO->cmdIoParam;
+
+    if (argc == 2)
+    {
+        if (strcmp(argv[1], "on") == 0 || strcmp(argv[1], "off") == 0)
+        {
+            IDLE_enable(strcmp(argv[1], "on") == 0);
+        }
+        // Start a fresh measurement window for the new setting
+        IDLE_resetStats();
+        (*pCmdIO->pCmdApi->msg)(cmdIoParam, LINE_TERM "OK\r\n\4");
+        return;
+    }
+
+    (*pCmdIO->pCmdApi->print)(cmdIoParam,
+                              LINE_TERM "MCU sleep %s, %lu wakeups/s over %lu s\r\n",
+                              IDLE_isEnabled() ? "on" : "off",
+                              IDLE_wakeupsPerSecond(),
+                              (uint32_t)(idleStats.elapsedUs / 1000000ULL));
+    (*pCmdIO->pCmdApi->print)(cmdIoParam,
+                              "idle %lu ms (%lu), standby %lu ms (%lu), standby blocked %lu\r\n",
+                              (uint32_t)(idleStats.sleepUs[IDLE_SLEEP_IDLE] / 1000ULL),
+                              idleStats.entries[IDLE_SLEEP_IDLE],
+                              (uint32_t)(idleStats.sleepUs[IDLE_SLEEP_STANDBY] / 1000ULL),
+                              idleStats.entries[IDLE_SLEEP_STANDBY],
+                              idleStats.busy);
+    (*pCmdIO->pCmdApi->print)(cmdIoParam, "estimated MCU current %lu uA\r\n", IDLE_averageUa());
+    (*pCmdIO->pCmdApi->msg)(cmdIoParam, "OK\r\n\4");
+}
+
+static void get_sched_stats(SYS_CMD_DEVICE_NODE* pCmdIO, int argc, char** argv)
+{
+    const void* cmdIoParam = pCmdIO->cmdIoParam;
+    uint8_t     event;
+
+    (*pCmdIO->pCmdApi->print)(cmdIoParam,
+                              LINE_TERM "queue depth %d, max %d of %d, overflows %lu\r\n",
+                              SCHED_depth(),
+                              schedStats.depthMax,
+                              SCHED_QUEUE_SIZE,
+                              schedStats.overflows);
+
+    for (event = 0; event < SCHED_EVENT_COUNT; event++)
+    {
+        sched_event_stats_t* stats = &schedStats.events[event];
+
+        if (stats->posted == 0)
+        {
+            continue;
+        }
+        (*pCmdIO->pCmdApi->print)(cmdIoParam,
+                                  "%-16s posted %lu, run %lu, coalesced %lu, latency max %lu us, run max %lu us\r\n",
+                                  SCHED_eventName((sched_event_t)event),
+                                  stats->posted,
+                                  stats->handled,
+                                  stats->coalesced,
+                                  stats->maxLatencyUs,
+                                  stats->maxRunUs);
+    }
+    (*pCmdIO->pCmdApi->msg)(cmdIoParam, "OK\r\n\4");
+}
+
+static void get_console_stats(SYS_CMD_DEVICE_NODE* pCmdIO, int argc, char** argv)
+{
+    const void* cmdIoParam = pCmdIO->cmdIoParam;
+
+    (*pCmdIO->pCmdApi->print)(cmdIoParam,
+                              LINE_TERM "tx pending %u of %u bytes, overflow %u bytes\r\n",
+                              CONSOLE_DMA_WriteCountGet(),
+                              CONSOLE_DMA_WriteBufferSizeGet(),
+                              CONSOLE_DMA_WriteOverflowCountGet());
+    (*pCmdIO->pCmdApi->msg)(cmdIoParam, "OK\r\n\4");
+}
+
+static void get_metrics(SYS_CMD_DEVICE_NODE* pCmdIO, int argc, char** argv)
+{
+    const void* cmdIoParam = pCmdIO->cmdIoParam;
+    uint8_t     i;
+    uint8_t     bucket;
+
+    (*pCmdIO->pCmdApi->msg)(cmdIoParam, LINE_TERM);
+
+    for (i = 0; i < METRIC_COUNTER_COUNT; i++)
+    {
+        (*pCmdIO->pCmdApi->print)(cmdIoParam, "%-16s %lu\r\n", METRICS_counterName((metric_counter_t)i), metricCounters[i]);
+    }
+
+    for (i = 0; i < METRIC_GAUGE_COUNT; i++)
+    {
+        (*pCmdIO->pCmdApi->print)(cmdIoParam, "%-16s %ld, max %ld\r\n", METRICS_gaugeName((metric_gauge_t)i), metricGauges[i].value, metricGauges[i].max);
+    }
+
+    for (i = 0; i < METRIC_HISTOGRAM_COUNT; i++)
+    {
+        metric_histogram_value_t* hist = &metricHistograms[i];
+
+        (*pCmdIO->pCmdApi->print)(cmdIoParam,
+                                  "%-16s count %lu, avg %lu, max %lu\r\n",
+                                  METRICS_histogramName((metric_histogram_t)i),
+                                  hist->count,
+                                  hist->count ? (uint32_t)(hist->sum / hist->count) : 0,
+                                  hist->max);
+        for (bucket = 0; bucket < METRIC_BUCKET_COUNT - 1; bucket++)
+        {
+            (*pCmdIO->pCmdApi->print)(cmdIoParam, "  <= %-9lu %lu\r\n", METRICS_bucketBound((metric_histogram_t)i, bucket), hist->buckets[bucket]);
+        }
+        (*pCmdIO->pCmdApi->print)(cmdIoParam, "  >  %-9lu %lu\r\n", METRICS_bucketBound((metric_histogram_t)i, bucket - 1), hist->buckets[bucket]);
+    }
+
+    if (argc == 2 && strcmp(argv[1], "reset") == 0)
+    {
+        METRICS_reset();
+    }
+    (*pCmdIO->pCmdApi->msg)(cmdIoParam, "OK\r\n\4");
+}
+
+static void get_memory(SYS_CMD_DEVICE_NODE* pCmdIO, int argc, char** argv)
+{
+    const void*      cmdIoParam = pCmdIO->cmdIoParam;
+    memwatch_stats_t mem;
+
+    MEMWATCH_get(&mem);
+    (*pCmdIO->pCmdApi->print)(cmdIoParam,
+                              LINE_TERM "stack %lu of %lu bytes, peak %lu (%lu%%)\r\n",
+                              mem.stackUsed,
+                              mem.stackSize,
+                              mem.stackPeak,
+                              mem.stackPeak * 100 / mem.stackSize);
+    (*pCmdIO->pCmdApi->print)(cmdIoParam,
+                              "heap  %lu of %lu bytes in %lu blocks, peak %lu (%lu%%), failed %lu\r\n",
+                              mem.heapUsed,
+                              mem.heapSize,
+                              mem.heapAllocs,
+                              mem.heapPeak,
+                              mem.heapPeak * 100 / mem.heapSize,
+                              mem.heapFailures);
+    (*pCmdIO->pCmdApi->msg)(cmdIoParam, "OK\r\n\4");
+}
+
+#if CFG_PERF_ENABLE
+static void get_perf_stats(SYS_CMD_DEVICE_NODE* pCmdIO, int argc, char** argv)
+{
+    const void* cmdIoParam = pCmdIO->cmdIoParam;
+    uint8_t     probe;
+
+    (*pCmdIO->pCmdApi->print)(cmdIoParam, LINE_TERM "probe overhead %lu cycles, removed below\r\n", PERF_overheadCycles());
+
+    for (probe = 0; probe < PERF_PROBE_COUNT; probe++)
+    {
+        perf_stats_t* stats = &perfStats[probe];
+
+        if (stats->calls == 0)
+        {
+            continue;
+        }
+        (*pCmdIO->pCmdApi->print)(cmdIoParam,
+                                  "%-16s calls %lu, cycles min %lu avg %lu max %lu, total %lu us\r\n",
+                                  PERF_probeName((perf_probe_t)probe),
+                                  stats->calls,
+                                  stats->minCycles,
+                                  (uint32_t)(stats->totalCycles / stats->calls),
+                                  stats->maxCycles,
+                                  PERF_cyclesToUs(stats->totalCycles));
+    }
+
+    if (argc == 2 && strcmp(argv[1], "reset") == 0)
+    {
+        PERF_reset();
+    }
+    (*pCmdIO->pCmdApi->msg)(cmdIoParam, "OK\r\n\4");
+}
+#endif
+
 static void reconnect_cmd(SYS_CMD_DEVICE_NODE* pCmdIO, int argc, char** argv)
 {
     const void* cmdIoParam = pCmdIO->cmdIoParam;
@@ -276,7 +729,7 @@ static void get_set_dps_idscope(SYS_CMD_DEVICE_NODE* pCmdIO, int argc, char** ar
 {
 
     char*       dps_param;
-    char        atca_id_scope[12];   //idscope 0ne12345678
+    char        atca_id_scope[CRYPTO_CLIENT_ID_SCOPE_LENGTH];   //idscope 0ne12345678
     const void* cmdIoParam = pCmdIO->cmdIoParam;
 
     (*pCmdIO->pCmdApi->msg)(cmdIoParam, LINE_TERM "Get/Set DPS ID Scope\r\n");
@@ -285,7 +738,7 @@ static void get_set_dps_idscope(SYS_CMD_DEVICE_NODE* pCmdIO, int argc, char** ar
 
     if (dps_param == NULL)
     {
-        atcab_read_bytes_zone(ATCA_ZONE_DATA, ATCA_SLOT_DPS_IDSCOPE, 0, (uint8_t*)atca_id_scope, sizeof(atca_id_scope));
+        CRYPTO_CLIENT_readIdScope(atca_id_scope);
         (*pCmdIO->pCmdApi->print)(cmdIoParam, "Current ID Scope : %s \r\n", atca_id_scope);
     }
     else
@@ -314,11 +767,11 @@ static void get_set_dps_idscope(SYS_CMD_DEVICE_NODE* pCmdIO, int argc, char** ar
         }
 
         (*pCmdIO->pCmdApi->print)(cmdIoParam, "Writing ID Scope %s to ATCA\r\n", dps_param);
-        atcab_write_bytes_zone(ATCA_ZONE_DATA, ATCA_SLOT_DPS_IDSCOPE, 0, (uint8_t*)dps_param, sizeof(atca_id_scope));
+        CRYPTO_CLIENT_writeIdScope(dps_param);
         atca_delay_ms(500);
-        atcab_read_bytes_zone(ATCA_ZONE_DATA, ATCA_SLOT_DPS_IDSCOPE, 0, (uint8_t*)atca_id_scope, sizeof(atca_id_scope));
+        CRYPTO_CLIENT_readIdScope(atca_id_scope);
         (*pCmdIO->pCmdApi->print)(cmdIoParam, "New ID Scope : %s\r\n", atca_id_scope);
     }
 
     return;
-}
\ No newline at end of file
+}
\ No newline at end of file
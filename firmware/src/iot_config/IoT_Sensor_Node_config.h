@@ -3,8 +3,20 @@
 
 #define CFG_DEFAULT_TELEMETRY_INTERVAL_SEC 10
 
+#define CFG_DIAG_TELEMETRY_INTERVAL_SEC 0   // publish the "stats" metrics as diagnostics telemetry this often, 0 to disable
+
 #define IOT_DEBUG_PRINT 1
 
+// Most verbose severity compiled in per module, calls above it compile to nothing
+#define CFG_DEBUG_LEVEL_APP    SEVERITY_TRACE
+#define CFG_DEBUG_LEVEL_CLOUD  SEVERITY_TRACE
+#define CFG_DEBUG_LEVEL_MQTT   SEVERITY_TRACE
+#define CFG_DEBUG_LEVEL_BSD    SEVERITY_TRACE
+#define CFG_DEBUG_LEVEL_AZUTIL SEVERITY_TRACE
+
+#define CFG_DEBUG_BINARY_LOG      0      // queue the format address and raw arguments, decode on the host with tools/debug_log_decode.py
+#define CFG_DEBUG_BINARY_LOG_SIZE 1024   // binary log ring in bytes, power of two
+
 //#define CFG_MQTT_DEBUG_MSG 1    //set to enable debug print messages MQTT
 
 #define CFG_ENABLE_CLI 1
@@ -13,7 +25,43 @@
 
 #define CFG_LED_DEBUG 0
 
+#define CFG_DPS_CACHE_ENABLE 1    // cache the DPS assignment in NVM and connect straight to the hub on boot
+
+#define CFG_DPS_CACHE_TTL_SEC (7L * 24L * 60L * 60L)   // re-provision through DPS after a week, 0 to never expire
+
+#define CFG_DNS_CACHE_TTL_SEC (60L * 60L)   // reuse a resolved MQTT host IP for an hour, 0 to always resolve
+
+#define CFG_TLS_SESSION_CACHE_ENABLE 1                    // let the WINC resume TLS sessions on reconnect
+#define CFG_TLS_SESSION_MAX_RESUMES  20                   // full handshake after this many resumptions
+#define CFG_TLS_SESSION_MAX_AGE_SEC  (24L * 60L * 60L)   // full handshake when the session is older than a day
+
+#define CFG_TLS_VERIFY_CACHE_ENABLE  0                    // skip the secure element for certificate signatures it already accepted
+#define CFG_TLS_VERIFY_CACHE_SIZE    4                    // cached signatures, one per certificate in the server chains
+#define CFG_TLS_VERIFY_CACHE_TTL_SEC (24L * 60L * 60L)   // re-verify a cached signature after a day
+
+#define CFG_TLS_ECDH_PRECOMPUTE 1   // ATECC508: generate the next TLS ephemeral key in an ECDH slot while idle
+
+#define CFG_I2C_BUS_SPEED_HZ 400000   // SERCOM3 speed after the ATECC608 wake pulse, 100000 to 400000 (MCP9808 limit)
+
+#define CFG_WINC_POWER_SAVE_ENABLE      0      // let the WINC doze between MQTT deadlines, for the battery SKUs
+#define CFG_WINC_PS_WAKE_AHEAD_MS       2000   // turn power save off this long before a send or retry
+#define CFG_WINC_PS_LISTEN_INTERVAL_MAX 30     // most beacon periods to sleep through, bounds downlink latency (~3 s)
+#define CFG_WINC_PS_SEND_ACTIVE_MS      300    // radio on time for one publish or PINGREQ round trip, for estimates
+#define CFG_WINC_PS_BEACON_RX_US        2000   // radio on time per beacon received while dozing, for estimates
+#define CFG_WINC_CURRENT_AWAKE_UA       60000  // WINC1510 receive current, datasheet typical
+#define CFG_WINC_CURRENT_DOZE_UA        380    // WINC1510 doze current, datasheet typical
+
+#define CFG_IDLE_SLEEP_ENABLE       1      // stop the CPU clock in the super-loop until the next interrupt
+#define CFG_IDLE_STANDBY_ENABLE     0      // use STANDBY when nothing is in flight, the console loses the first character typed
+#define CFG_MCU_CURRENT_ACTIVE_UA   3800   // SAMD21 at 48 MHz, datasheet typical
+#define CFG_MCU_CURRENT_IDLE_UA     1900   // SAMD21 IDLE0 at 48 MHz, datasheet typical
+#define CFG_MCU_CURRENT_STANDBY_UA  70     // SAMD21 STANDBY with OSC8M running for SYS_TIME
+#define CFG_PERF_ENABLE             0      // SysTick hot-path probes and the "perf" command, compiled out when 0
+
+#define CFG_CONSOLE_TX_BUFFER_SIZE 512   // console transmit ring drained by DMAC channel 2, holds one byte less
+#define CFG_CONSOLE_TX_DROP_OLDEST 0     // when the ring is full: 0 drops the new bytes, 1 the oldest not yet handed to the DMAC
+
 // Comment out or remove IOT_PLUG_AND_PLAY_MODEL_ID to run as non-IoT Plug and Play client
-#define IOT_PLUG_AND_PLAY_MODEL_ID "dtmi:com:Microchip:SAM_IoT_WM;1"
+#define IOT_PLUG_AND_PLAY_MODEL_ID "dtmi:com:Microchip:SAM_IoT_WM;2"
 
 #endif   // IOT_SENSOR_NODE_CONFIG_H
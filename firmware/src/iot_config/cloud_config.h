@@ -6,7 +6,9 @@
 // <s> mqtt port
 // <i> mqtt port value
 // <id> mqtt_port
+#ifndef CFG_MQTT_PORT
 #define CFG_MQTT_PORT AZ_IOT_DEFAULT_MQTT_CONNECT_PORT
+#endif
 
 // <s> mqtt hub host
 // <i> mqtt hub host address
@@ -27,6 +27,8 @@
 #include <stdlib.h>        // Defines EXIT_FAILURE
 #include "definitions.h"   // SYS function prototypes
 #include "azure/core/az_span.h"
+#include "idle.h"
+#include "debug_print.h"
 
 // *****************************************************************************
 // *****************************************************************************
@@ -43,6 +45,12 @@ int main(void)
     {
         /* Maintain state machines of all polled MPLAB Harmony modules. */
         SYS_Tasks();
+
+        /* Send queued binary log records to the console */
+        debug_drain();
+
+        /* Sleep until the next interrupt brings more work */
+        IDLE_task();
     }
 
     /* Execution should not come here during normal operation */
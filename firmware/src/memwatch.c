@@ -0,0 +1,142 @@
+/*
+    \file   memwatch.c
+
+    \brief  memwatch.ceader file.
+
+    (c) 2018 Microchip Technology Inc. and its subsidiaries.
+
+    Subject to your compliance with these terms, you may use Microchip software and any
+    derivatives exclusively with Microchip products. It is your responsibility to comply with third party
+    license terms applicable to your use of third party software (including open source software) that
+    may accompany Microchip software.
+
+    THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+    EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY
+    IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS
+    FOR A PARTICULAR PURPOSE.
+
+    IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
+    INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND
+    WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP
+    HAS BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO
+    THE FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL
+    CLAIMS IN ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT
+    OF FEES, IF ANY, THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS
+    SOFTWARE.
+*/
+
+
+#include <stdint.h>
+#include <stdlib.h>
+#include "memwatch.h"
+#include "metrics.h"
+#include "definitions.h"
+
+#define MEMWATCH_PAINT 0xC5C5C5C5UL
+
+// Provided by the XC32 linker, the sizes come from the heap-size and
+// stack-size project options as --defsym values
+extern uint32_t _stack;
+extern uint32_t _min_stack_size;
+extern uint32_t _min_heap_size;
+
+// Keeps the size of the block and the 8-byte alignment malloc promised
+typedef union
+{
+    size_t   size;
+    uint64_t align;
+} mem_header_t;
+
+static uint32_t mem_heapUsed;
+static uint32_t mem_heapPeak;
+static uint32_t mem_heapAllocs;
+static uint32_t mem_heapFailures;
+
+static uint32_t* memwatch_stackBottom(void)
+{
+    return (uint32_t*)((uintptr_t)&_stack - (uintptr_t)&_min_stack_size);
+}
+
+// Runs before .data and .bss are initialized, so it only touches memory below
+// the stack pointer and keeps its state in registers.  The volatile store
+// stops the loop from becoming a memset call, whose frame would land in the
+// area being painted.
+void MEMWATCH_paintStack(void)
+{
+    volatile uint32_t* word = memwatch_stackBottom();
+    uint32_t*          top  = (uint32_t*)(uintptr_t)__get_MSP();
+
+    while ((uint32_t*)word < top)
+    {
+        *word++ = MEMWATCH_PAINT;
+    }
+}
+
+#ifdef __XC32
+// Optional XC32 startup hook, called by Reset_Handler right after the stack
+// pointer is loaded
+void __attribute__((long_call)) _on_reset(void)
+{
+    MEMWATCH_paintStack();
+}
+#endif
+
+void MEMWATCH_get(memwatch_stats_t* stats)
+{
+    const uint32_t* bottom = memwatch_stackBottom();
+    const uint32_t* word   = bottom;
+    const uint32_t* top    = &_stack;
+
+    while (word < top && *word == MEMWATCH_PAINT)
+    {
+        word++;
+    }
+
+    stats->stackSize    = (uint32_t)(uintptr_t)&_min_stack_size;
+    stats->stackUsed    = (uint32_t)((uintptr_t)top - __get_MSP());
+    stats->stackPeak    = (uint32_t)((uintptr_t)top - (uintptr_t)word);
+    stats->heapSize     = (uint32_t)(uintptr_t)&_min_heap_size;
+    stats->heapUsed     = mem_heapUsed;
+    stats->heapPeak     = mem_heapPeak;
+    stats->heapAllocs   = mem_heapAllocs;
+    stats->heapFailures = mem_heapFailures;
+}
+
+void* MEM_malloc(size_t size)
+{
+    mem_header_t* block = malloc(sizeof(mem_header_t) + size);
+
+    if (block == NULL)
+    {
+        mem_heapFailures++;
+        return NULL;
+    }
+
+    block->size = sizeof(mem_header_t) + size;
+    mem_heapUsed += block->size;
+    mem_heapAllocs++;
+    if (mem_heapUsed > mem_heapPeak)
+    {
+        mem_heapPeak = mem_heapUsed;
+    }
+    METRIC_SET(HEAP_USED, (int32_t)mem_heapUsed);
+
+    return block + 1;
+}
+
+void MEM_free(void* ptr)
+{
+    mem_header_t* block;
+
+    if (ptr == NULL)
+    {
+        return;
+    }
+
+    block = (mem_header_t*)ptr - 1;
+    mem_heapUsed -= block->size;
+    mem_heapAllocs--;
+    METRIC_SET(HEAP_USED, (int32_t)mem_heapUsed);
+
+    free(block);
+}
@@ -0,0 +1,58 @@
+/*
+    \file   memwatch.h
+
+    \brief  memwatch.header file.
+
+    (c) 2018 Microchip Technology Inc. and its subsidiaries.
+
+    Subject to your compliance with these terms, you may use Microchip software and any
+    derivatives exclusively with Microchip products. It is your responsibility to comply with third party
+    license terms applicable to your use of third party software (including open source software) that
+    may accompany Microchip software.
+
+    THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+    EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY
+    IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS
+    FOR A PARTICULAR PURPOSE.
+
+    IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
+    INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND
+    WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP
+    HAS BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO
+    THE FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL
+    CLAIMS IN ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT
+    OF FEES, IF ANY, THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS
+    SOFTWARE.
+*/
+
+
+
+#ifndef MEMWATCH_H_
+#define MEMWATCH_H_
+#include <stddef.h>
+#include <stdint.h>
+
+// RAM high-water marks.  The stack is painted from its linker-reserved bottom
+// up to the reset stack pointer before .data and .bss are set up, and the
+// first word that no longer holds the pattern marks the deepest the stack has
+// been.  Heap use is counted by MEM_malloc/MEM_free, which prefix each block
+// with its size; call them in place of malloc/free so the figures stay exact.
+
+typedef struct
+{
+    uint32_t stackSize;        // bytes reserved by the linker
+    uint32_t stackUsed;        // bytes in use at the call
+    uint32_t stackPeak;        // deepest use since reset
+    uint32_t heapSize;         // bytes reserved by the linker
+    uint32_t heapUsed;         // bytes handed out, headers included
+    uint32_t heapPeak;         // most ever handed out at once
+    uint32_t heapAllocs;       // blocks currently allocated
+    uint32_t heapFailures;     // MEM_malloc calls that returned NULL
+} memwatch_stats_t;
+
+void  MEMWATCH_paintStack(void);
+void  MEMWATCH_get(memwatch_stats_t* stats);
+void* MEM_malloc(size_t size);
+void  MEM_free(void* ptr);
+
+#endif /* MEMWATCH_H_ */
@@ -0,0 +1,117 @@
+/*
+    \file   metrics.c
+
+    \brief  metrics.ceader file.
+
+    (c) 2018 Microchip Technology Inc. and its subsidiaries.
+
+    Subject to your compliance with these terms, you may use Microchip software and any
+    derivatives exclusively with Microchip products. It is your responsibility to comply with third party
+    license terms applicable to your use of third party software (including open source software) that
+    may accompany Microchip software.
+
+    THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+    EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY
+    IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS
+    FOR A PARTICULAR PURPOSE.
+
+    IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
+    INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND
+    WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP
+    HAS BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO
+    THE FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL
+    CLAIMS IN ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT
+    OF FEES, IF ANY, THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS
+    SOFTWARE.
+*/
+
+
+
+#include <stdint.h>
+#include <string.h>
+#include "metrics.h"
+
+uint32_t                 metricCounters[METRIC_COUNTER_COUNT];
+metric_gauge_value_t     metricGauges[METRIC_GAUGE_COUNT];
+metric_histogram_value_t metricHistograms[METRIC_HISTOGRAM_COUNT];
+
+static const char* const metrics_counterNames[METRIC_COUNTER_COUNT] = {
+    "mqttTxPackets", "mqttRxPackets", "socketTxBytes", "socketRxBytes", "socketErrors", "mqttReconnects", "dnsFailures", "wifiDisconnects",
+};
+
+static const char* const metrics_gaugeNames[METRIC_GAUGE_COUNT] = {
+    "heapUsed",
+};
+
+static const char* const metrics_histogramNames[METRIC_HISTOGRAM_COUNT] = {
+    "pubackLatencyMs",
+};
+
+// Upper bound of each bucket but the last
+static const uint32_t metrics_bounds[METRIC_HISTOGRAM_COUNT][METRIC_BUCKET_COUNT - 1] = {
+    {100, 250, 500, 1000, 5000},
+};
+
+void METRICS_reset(void)
+{
+    uint8_t gauge;
+
+    memset(metricCounters, 0, sizeof(metricCounters));
+    memset(metricHistograms, 0, sizeof(metricHistograms));
+    // Gauges keep their value, only the high-water mark restarts
+    for (gauge = 0; gauge < METRIC_GAUGE_COUNT; gauge++)
+    {
+        metricGauges[gauge].max = metricGauges[gauge].value;
+    }
+}
+
+void METRICS_gaugeSet(metric_gauge_t gauge, int32_t value)
+{
+    metricGauges[gauge].value = value;
+    if (value > metricGauges[gauge].max)
+    {
+        metricGauges[gauge].max = value;
+    }
+}
+
+void METRICS_observe(metric_histogram_t histogram, uint32_t value)
+{
+    metric_histogram_value_t* hist = &metricHistograms[histogram];
+    uint8_t                   bucket;
+
+    for (bucket = 0; bucket < METRIC_BUCKET_COUNT - 1; bucket++)
+    {
+        if (value <= metrics_bounds[histogram][bucket])
+        {
+            break;
+        }
+    }
+    hist->buckets[bucket]++;
+    hist->count++;
+    hist->sum += value;
+    if (value > hist->max)
+    {
+        hist->max = value;
+    }
+}
+
+const char* METRICS_counterName(metric_counter_t counter)
+{
+    return counter < METRIC_COUNTER_COUNT ? metrics_counterNames[counter] : "?";
+}
+
+const char* METRICS_gaugeName(metric_gauge_t gauge)
+{
+    return gauge < METRIC_GAUGE_COUNT ? metrics_gaugeNames[gauge] : "?";
+}
+
+const char* METRICS_histogramName(metric_histogram_t histogram)
+{
+    return histogram < METRIC_HISTOGRAM_COUNT ? metrics_histogramNames[histogram] : "?";
+}
+
+// UINT32_MAX for the open-ended last bucket
+uint32_t METRICS_bucketBound(metric_histogram_t histogram, uint8_t bucket)
+{
+    return bucket < METRIC_BUCKET_COUNT - 1 ? metrics_bounds[histogram][bucket] : UINT32_MAX;
+}
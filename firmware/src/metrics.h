@@ -0,0 +1,98 @@
+/*
+    \file   metrics.h
+
+    \brief  metrics.header file.
+
+    (c) 2018 Microchip Technology Inc. and its subsidiaries.
+
+    Subject to your compliance with these terms, you may use Microchip software and any
+    derivatives exclusively with Microchip products. It is your responsibility to comply with third party
+    license terms applicable to your use of third party software (including open source software) that
+    may accompany Microchip software.
+
+    THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+    EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY
+    IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS
+    FOR A PARTICULAR PURPOSE.
+
+    IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
+    INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND
+    WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP
+    HAS BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO
+    THE FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL
+    CLAIMS IN ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT
+    OF FEES, IF ANY, THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS
+    SOFTWARE.
+*/
+
+
+
+#ifndef METRICS_H_
+#define METRICS_H_
+#include <stdint.h>
+
+// Static metrics registry.  Counters and gauges are plain array slots so an
+// update is a single increment; histograms bucket a value against fixed upper
+// bounds.  Updates come from the main loop, SYS_TIME callbacks only post
+// events, so nothing here is locked.
+
+typedef enum
+{
+    METRIC_MQTT_TX_PACKETS = 0,
+    METRIC_MQTT_RX_PACKETS,
+    METRIC_SOCKET_TX_BYTES,
+    METRIC_SOCKET_RX_BYTES,
+    METRIC_SOCKET_ERRORS,
+    METRIC_MQTT_RECONNECTS,
+    METRIC_DNS_FAILURES,
+    METRIC_WIFI_DISCONNECTS,
+    METRIC_COUNTER_COUNT
+} metric_counter_t;
+
+typedef enum
+{
+    METRIC_HEAP_USED = 0,   // bytes held through MEM_malloc, set by memwatch.c
+    METRIC_GAUGE_COUNT
+} metric_gauge_t;
+
+typedef enum
+{
+    METRIC_PUBACK_LATENCY_MS = 0,
+    METRIC_HISTOGRAM_COUNT
+} metric_histogram_t;
+
+#define METRIC_BUCKET_COUNT 6   // the last bucket takes everything above the bounds
+
+typedef struct
+{
+    int32_t value;
+    int32_t max;
+} metric_gauge_value_t;
+
+typedef struct
+{
+    uint32_t buckets[METRIC_BUCKET_COUNT];
+    uint32_t count;
+    uint32_t max;
+    uint64_t sum;
+} metric_histogram_value_t;
+
+extern uint32_t                 metricCounters[METRIC_COUNTER_COUNT];
+extern metric_gauge_value_t     metricGauges[METRIC_GAUGE_COUNT];
+extern metric_histogram_value_t metricHistograms[METRIC_HISTOGRAM_COUNT];
+
+void        METRICS_reset(void);
+void        METRICS_gaugeSet(metric_gauge_t gauge, int32_t value);
+void        METRICS_observe(metric_histogram_t histogram, uint32_t value);
+const char* METRICS_counterName(metric_counter_t counter);
+const char* METRICS_gaugeName(metric_gauge_t gauge);
+const char* METRICS_histogramName(metric_histogram_t histogram);
+uint32_t    METRICS_bucketBound(metric_histogram_t histogram, uint8_t bucket);
+
+#define METRIC_INC(counter)         (metricCounters[METRIC_##counter]++)
+#define METRIC_ADD(counter, n)      (metricCounters[METRIC_##counter] += (uint32_t)(n))
+#define METRIC_SET(gauge, v)        METRICS_gaugeSet(METRIC_##gauge, (v))
+#define METRIC_GAUGE_ADD(gauge, n)  METRICS_gaugeSet(METRIC_##gauge, metricGauges[METRIC_##gauge].value + (n))
+#define METRIC_OBSERVE(hist, v)     METRICS_observe(METRIC_##hist, (v))
+
+#endif /* METRICS_H_ */
@@ -25,31 +25,35 @@
     SOFTWARE.
 */
 
+#define DEBUG_MODULE MQTT
+
 #include <string.h>
 #include <stdio.h>
 #include "mqtt_comm_layer.h"
 #include "../../iot_config/IoT_Sensor_Node_config.h"
 #include "../mqtt_core/mqtt_core.h"
 #include "../../services/iot/cloud/bsd_adapter/bsdWINC.h"
+#include "socket.h"
 #include "debug_print.h"
+#include "metrics.h"
 
-#define TX_BUFF_SIZE         400
 #define RX_BUFF_SIZE         2096
 #define USER_LENGTH          0
 #define MQTT_KEEP_ALIVE_TIME 120
 
-static mqttContext mqttConn;
-static uint8_t     mqttTxBuff[TX_BUFF_SIZE];
-static uint8_t     mqttRxBuff[RX_BUFF_SIZE];
 static int8_t      mqqtSocket = -1;
+static mqttContext mqttConn   = {.tcpClientSocket = &mqqtSocket};   // CLOUD_task() reads the socket before the first reInit()
+static uint8_t     mqttTxBuff[MQTT_TX_BUFF_SIZE];
+static uint8_t     mqttRxBuff[RX_BUFF_SIZE];
+static uint8_t     mqttRxStaging[SOCKET_BUFFER_MAX_LENGTH];
 
 void MQTT_ClientInitialize(void)
 {
     MQTT_initialiseState();
-    memset(mqttTxBuff, 0, sizeof(TX_BUFF_SIZE));
-    memset(mqttRxBuff, 0, sizeof(RX_BUFF_SIZE));
+    memset(mqttTxBuff, 0, sizeof(mqttTxBuff));
+    memset(mqttRxBuff, 0, sizeof(mqttRxBuff));
     mqttConn.mqttDataExchangeBuffers.txbuff.start           = mqttTxBuff;
-    mqttConn.mqttDataExchangeBuffers.txbuff.bufferLength    = TX_BUFF_SIZE;
+    mqttConn.mqttDataExchangeBuffers.txbuff.bufferLength    = MQTT_TX_BUFF_SIZE;
     mqttConn.mqttDataExchangeBuffers.txbuff.currentLocation = mqttConn.mqttDataExchangeBuffers.txbuff.start;
     mqttConn.mqttDataExchangeBuffers.txbuff.dataLength      = 0;
     mqttConn.mqttDataExchangeBuffers.rxbuff.start           = mqttRxBuff;
@@ -72,6 +76,7 @@ bool MQTT_Send(mqttContext* connectionPtr)
     int  sendRet;
     if ((sendRet = BSD_send(*connectionPtr->tcpClientSocket, connectionPtr->mqttDataExchangeBuffers.txbuff.start, connectionPtr->mqttDataExchangeBuffers.txbuff.dataLength, 0)) > BSD_SUCCESS)
     {
+        METRIC_INC(MQTT_TX_PACKETS);
         ret = true;
     }
 
@@ -83,6 +88,9 @@ bool MQTT_Close(mqttContext* connectionPtr)
 {
     debug_printGood(" MQTT: MQTT Close");
     bool ret = false;
+
+    // Whatever is still buffered belongs to the connection being closed
+    MQTT_ExchangeBufferInit(&connectionPtr->mqttDataExchangeBuffers.rxbuff);
     if (BSD_close(*connectionPtr->tcpClientSocket) == BSD_SUCCESS)
     {
         ret = true;
@@ -90,8 +98,67 @@ bool MQTT_Close(mqttContext* connectionPtr)
     return ret;
 }
 
+// Post the socket receive straight into the free part of the receive ring so
+// the WINC driver writes the bytes where the MQTT parser reads them. That is
+// only done when a whole WINC chunk fits before the ring wraps; otherwise the
+// chunk lands in the staging buffer and is copied in around the wrap.
+bool MQTT_Receive(mqttContext* connectionPtr)
+{
+    exchangeBuffer* rxbuff = &connectionPtr->mqttDataExchangeBuffers.rxbuff;
+    uint16_t        freeLength;
+    uint8_t*        freeRegion;
+
+    if (rxbuff->dataLength == 0)
+    {
+        // Start an empty ring over so the whole buffer is contiguous
+        MQTT_ExchangeBufferInit(rxbuff);
+    }
+
+    freeRegion = MQTT_ExchangeBufferFreeRegion(rxbuff, &freeLength);
+    if (freeLength == 0)
+    {
+        // A full ring always starts with a whole packet, leave the bytes with
+        // the socket until MQTT_ReceptionHandler() has consumed it
+        return false;
+    }
+
+    if (freeLength < SOCKET_BUFFER_MAX_LENGTH)
+    {
+        freeRegion = mqttRxStaging;
+        freeLength = sizeof(mqttRxStaging);
+    }
+
+    return (BSD_recv(*connectionPtr->tcpClientSocket, freeRegion, freeLength, 0) == BSD_SUCCESS);
+}
+
 void MQTT_GetReceivedData(uint8_t* pData, uint16_t len)
 {
-    MQTT_ExchangeBufferInit(&mqttConn.mqttDataExchangeBuffers.rxbuff);
-    MQTT_ExchangeBufferWrite(&mqttConn.mqttDataExchangeBuffers.rxbuff, pData, len);
+    exchangeBuffer* rxbuff = &mqttConn.mqttDataExchangeBuffers.rxbuff;
+    uint16_t        freeLength;
+
+    if (pData >= rxbuff->start && pData < rxbuff->start + rxbuff->bufferLength)
+    {
+        // Received in place. Reads leave the free region where the receive
+        // was posted; only MQTT_Close() and MQTT_ClientInitialize() empty the
+        // ring under it, and then the new bytes are all there is.
+        if (rxbuff->dataLength == 0)
+        {
+            rxbuff->currentLocation = pData;
+        }
+        if (pData == MQTT_ExchangeBufferFreeRegion(rxbuff, &freeLength) && len <= freeLength)
+        {
+            MQTT_ExchangeBufferCommit(rxbuff, len);
+            return;
+        }
+    }
+    else if (len <= rxbuff->bufferLength - rxbuff->dataLength)
+    {
+        // Staged receive, copied in around the wrap
+        MQTT_ExchangeBufferWrite(rxbuff, pData, len);
+        return;
+    }
+
+    // The MQTT stream cannot be parsed past missing bytes
+    debug_printError(" MQTT: No room for %d received bytes, closing", len);
+    MQTT_Close(&mqttConn);
 }
@@ -44,11 +44,15 @@ typedef struct
     int8_t*     tcpClientSocket;
 } mqttContext;
 
+// A whole outgoing packet has to fit; the largest is the diagnostics PUBLISH
+#define MQTT_TX_BUFF_SIZE 512
+
 
 void         MQTT_ClientInitialize(void);
 mqttContext* MQTT_GetClientConnectionInfo();
 
 bool MQTT_Send(mqttContext* connectionPtr);
 bool MQTT_Close(mqttContext* connectionPtr);
+bool MQTT_Receive(mqttContext* connectionPtr);
 void MQTT_GetReceivedData(uint8_t* pData, uint16_t len);
 #endif /* MQTT_COMM_LAYER_H */
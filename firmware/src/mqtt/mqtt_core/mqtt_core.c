@@ -31,6 +31,8 @@ IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
  *
  ******************************************************************************/
 
+#define DEBUG_MODULE MQTT
+
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -41,7 +43,10 @@ IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
 #include "../../iot_config/mqtt_config.h"
 #include "../../iot_config/IoT_Sensor_Node_config.h"
 #include "debug_print.h"
-#include "services/iot/cloud/mqtt_packetPopulation/mqtt_packetPopulate.h"
+#include "scheduler.h"
+#include "perf.h"
+#include "metrics.h"
+#include "memwatch.h"
 
 extern pf_MQTT_CLIENT* pf_mqtt_client;
 
@@ -50,6 +55,8 @@ extern pf_MQTT_CLIENT* pf_mqtt_client;
 #define MQTT_TX_PACKET_DECISION_CONSTANT 0x01
 #define KEEP_ALIVE_CALCULATION_CONSTANT  0x01
 #define CONNECT_CLEAN_SESSION_MASK       0x02
+#define REMAINING_LENGTH_MAX_BYTES       4      // MQTT 3.1.1, section 2.2.3
+#define FIXED_HEADER_MALFORMED           0xFF
 
 
 // MQTT packet transmission flags. The creation and transmission processes of
@@ -130,6 +137,9 @@ static newTxDataFlags mqttTxFlags;
 /** \brief MQTT packet reception flags. */
 static newRxDataFlags mqttRxFlags;
 
+/** \brief Bytes still to arrive of a packet too large for the receive buffer. */
+static uint32_t mqttRxDiscardLength;
+
 /** \brief CONNECT packet to be transmitted. */
 static mqttConnectPacket txConnectPacket;
 
@@ -137,6 +147,7 @@ static mqttConnectPacket txConnectPacket;
 //static mqttPublishPacket txPublishPacket;
 static volatile mqttPublishPacket* txPublishPacketHead    = NULL;
 static volatile mqttPublishPacket* txPublishPacketPending = NULL;
+static uint32_t                    txPublishSentCount;   // SYS_TIME counter when the pending PUBLISH went out
 
 /** \brief SUBSCRIBE packet to be transmitted. */
 static mqttSubscribePacket txSubscribePacket;
@@ -200,7 +211,8 @@ static uint8_t mqttEncodeLength(uint16_t length, uint8_t* output);
 /** \brief Decode the MQTT packet length.
  *
  * This function decodes the MQTT packet length available in the remainingLength
- * field of the received packet.
+ * field of the received packet. At most REMAINING_LENGTH_MAX_BYTES are read, a
+ * continuation bit on the last of them is left for the caller to reject.
  *
  * @param *data
  *
@@ -209,6 +221,35 @@ static uint8_t mqttEncodeLength(uint16_t length, uint8_t* output);
  */
 static uint32_t mqttDecodeLength(uint8_t* encodedData);
 
+/** \brief Read the fixed header of the next received packet.
+ *
+ * TCP may deliver a packet in several segments. This function peeks at the
+ * fixed header of the packet at the head of rxbuff and decodes its remaining
+ * length without consuming anything.
+ *
+ * @param *rxbuff
+ * @param *remainingLength
+ *
+ * @return
+ *  - The size of the fixed header
+ *  - 0 while the fixed header is incomplete
+ *  - FIXED_HEADER_MALFORMED for more than REMAINING_LENGTH_MAX_BYTES of length
+ */
+static uint8_t mqttRxFixedHeader(exchangeBuffer* rxbuff, uint32_t* remainingLength);
+
+/** \brief Check the remaining length of a received packet.
+ *
+ * The packet handlers read the fixed size fields of a packet without further
+ * checks, so the remaining length has to cover them (MQTT RFC, chapter 3).
+ *
+ * @param packetType
+ * @param remainingLength
+ *
+ * @return
+ *  - true when the packet can be handed to its handler
+ */
+static bool mqttRxLengthValid(uint8_t packetType, uint32_t remainingLength);
+
 /** \brief Send the MQTT CONNECT packet.
  *
  * This function sends the MQTT CONNECT packet using the underlying
@@ -366,7 +407,6 @@ within 30s.
 void checkConnackTimeoutState(void);
 //timerstruct_t connackTimer = {checkConnackTimeoutState, NULL};
 SYS_TIME_HANDLE checkConnackTimeoutStateHandle     = SYS_TIME_HANDLE_INVALID;
-volatile bool   checkConnackTimeoutStateTmrExpired = false;
 
 /** \brief Check whether timeout has occurred after receiving CONNACK
 or PINGRESP packet.
@@ -384,7 +424,6 @@ packet to the broker within (keepAliveTime)s time period.
 void checkPingreqTimeoutState(void);
 //timerstruct_t pingreqTimer = {checkPingreqTimeoutState, NULL};
 SYS_TIME_HANDLE checkPingreqTimeoutStateHandle     = SYS_TIME_HANDLE_INVALID;
-volatile bool   checkPingreqTimeoutStateTmrExpired = false;
 
 /** \brief Check whether timeout has occurred after sending PINGREQ
 packet.
@@ -403,7 +442,6 @@ packet.
 void checkPingrespTimeoutState(void);
 //timerstruct_t pingrespTimer = {checkPingrespTimeoutState, NULL};
 SYS_TIME_HANDLE checkPingrespTimeoutStateHandle     = SYS_TIME_HANDLE_INVALID;
-volatile bool   checkPingrespTimeoutStateTmrExpired = false;
 
 /** \brief Check whether timeout has occurred after sending SUBSCRIBE
 packet.
@@ -426,7 +464,6 @@ Connection by checking subackTimeoutOccured flag (MQTT RFC, section 4.8).
 void checkSubackTimeoutState(void);
 //timerstruct_t subackTimer = {checkSubackTimeoutState, NULL};
 SYS_TIME_HANDLE checkSubackTimeoutStateHandle     = SYS_TIME_HANDLE_INVALID;
-volatile bool   checkSubackTimeoutStateTmrExpired = false;
 
 /** \brief Check whether timeout has occurred after sending UNSUBSCRIBE
 packet.
@@ -449,32 +486,62 @@ Connection by checking unsubackTimeoutOccured flag (MQTT RFC, section 4.8).
 void checkUnsubackTimeoutState(void);
 //timerstruct_t unsubackTimer = {checkUnsubackTimeoutState, NULL};
 SYS_TIME_HANDLE checkUnsubackTimeoutStateHandle     = SYS_TIME_HANDLE_INVALID;
-volatile bool   checkUnsubackTimeoutStateTmrExpired = false;
 
-static MQTTPubAckCallbackPtr mqttPubackCallback = NULL;
+static MQTTPubAckCallbackPtr        mqttPubackCallback        = NULL;
+static MQTTConnackRefusedCallbackPtr mqttConnackRefusedCallback = NULL;
 
 /**********************Local function definitions*(END)************************/
 
 /**********************Function implementations********************************/
 void checkConnackTimeoutStatecb(uintptr_t context)
 {
-    checkConnackTimeoutStateTmrExpired = true;
+    SCHED_post(SCHED_EVENT_MQTT_CONNACK_TIMEOUT);
 }
 void checkPingreqTimeoutStatecb(uintptr_t context)
 {
-    checkPingreqTimeoutStateTmrExpired = true;
+    SCHED_post(SCHED_EVENT_MQTT_PINGREQ);
 }
 void checkSubackTimeoutStatecb(uintptr_t context)
 {
-    checkSubackTimeoutStateTmrExpired = true;
+    SCHED_post(SCHED_EVENT_MQTT_SUBACK_TIMEOUT);
 }
 void checkUnsubackTimeoutStatecb(uintptr_t context)
 {
-    checkUnsubackTimeoutStateTmrExpired = true;
+    SCHED_post(SCHED_EVENT_MQTT_UNSUBACK_TIMEOUT);
 }
 void checkPingrespTimeoutStatecb(uintptr_t context)
 {
-    checkPingrespTimeoutStateTmrExpired = true;
+    SCHED_post(SCHED_EVENT_MQTT_PINGRESP_TIMEOUT);
+}
+
+static void connackTimeoutEvent(void)
+{
+    debug_printWarn(" MQTT: CONNACK Timeout");
+    checkConnackTimeoutState();
+}
+
+static void pingreqTimeoutEvent(void)
+{
+    debug_printInfo(" MQTT: PINGREQ Timeout");
+    checkPingreqTimeoutState();
+}
+
+static void subackTimeoutEvent(void)
+{
+    debug_printWarn(" MQTT: SUBACK Timeout");
+    checkSubackTimeoutState();
+}
+
+static void unsubackTimeoutEvent(void)
+{
+    debug_printWarn(" MQTT: UNSUBACK Timeout");
+    checkUnsubackTimeoutState();
+}
+
+static void pingrespTimeoutEvent(void)
+{
+    debug_printWarn(" MQTT: PINGRESP Timeout");
+    checkPingrespTimeoutState();
 }
 void stopDestroyTimer(SYS_TIME_HANDLE timerHandle)
 {
@@ -499,6 +566,28 @@ int32_t MQTT_getConnectionAge()
     return age;
 }
 
+// Time left before the keep-alive PINGREQ is due, -1 when no keep-alive is running
+int32_t MQTT_msUntilPingreq(void)
+{
+    uint32_t periodMs;
+    uint32_t elapsed;
+
+    if (mqttState != CONNECTED || checkPingreqTimeoutStateHandle == SYS_TIME_HANDLE_INVALID || txConnectPacket.connectVariableHeader.keepAliveTimer == 0)
+    {
+        return -1;
+    }
+
+    if (SYS_TIME_TimerCounterGet(checkPingreqTimeoutStateHandle, &elapsed) != SYS_TIME_SUCCESS)
+    {
+        return -1;
+    }
+
+    periodMs = (ntohs(txConnectPacket.connectVariableHeader.keepAliveTimer) - KEEP_ALIVE_CALCULATION_CONSTANT) * SECONDS;
+    elapsed  = SYS_TIME_CountToMS(elapsed);
+
+    return (elapsed >= periodMs) ? 0 : (int32_t)(periodMs - elapsed);
+}
+
 void checkConnackTimeoutState(void)
 {
     connackTimeoutOccured = true;   // Mark that timer has executed
@@ -531,6 +620,21 @@ void checkUnsubackTimeoutState(void)
 void MQTT_initialiseState(void)
 {
     mqttState = DISCONNECTED;
+    // Nothing is pending on a new connection; a SUBACK still awaited from a
+    // dropped one would otherwise block every later SUBSCRIBE
+    mqttRxFlags.All        = 0;
+    mqttTxFlags.All        = 0;
+    mqttRxDiscardLength    = 0;
+    connackTimeoutOccured  = false;
+    pingreqTimeoutOccured  = false;
+    pingrespTimeoutOccured = false;
+    subackTimeoutOccured   = false;
+    unsubackTimeoutOccured = false;
+    SCHED_register(SCHED_EVENT_MQTT_CONNACK_TIMEOUT, connackTimeoutEvent);
+    SCHED_register(SCHED_EVENT_MQTT_PINGRESP_TIMEOUT, pingrespTimeoutEvent);
+    SCHED_register(SCHED_EVENT_MQTT_SUBACK_TIMEOUT, subackTimeoutEvent);
+    SCHED_register(SCHED_EVENT_MQTT_UNSUBACK_TIMEOUT, unsubackTimeoutEvent);
+    SCHED_register(SCHED_EVENT_MQTT_PINGREQ, pingreqTimeoutEvent);
 }
 
 mqttCurrentState MQTT_GetConnectionState(void)
@@ -685,7 +789,7 @@ bool MQTT_CreatePublishPacket(mqttPublishPacket* newPublishPacket)
 
     if (mqttState == CONNECTED)
     {
-        newPacket = malloc(sizeof(mqttPublishPacket));
+        newPacket = MEM_malloc(sizeof(mqttPublishPacket));
 
         if (newPacket == NULL)
         {
@@ -826,7 +930,6 @@ static bool mqttSendConnect(mqttContext* mqttConnectionPtr)
     bool ret = false;
 
     MQTT_ExchangeBufferInit(&mqttConnectionPtr->mqttDataExchangeBuffers.txbuff);
-    MQTT_ExchangeBufferInit(&mqttConnectionPtr->mqttDataExchangeBuffers.rxbuff);
 
     MQTT_ExchangeBufferWrite(&mqttConnectionPtr->mqttDataExchangeBuffers.txbuff, (uint8_t*)&txConnectPacket.connectFixedHeaderFlags.All, sizeof(txConnectPacket.connectFixedHeaderFlags.All));
     MQTT_ExchangeBufferWrite(&mqttConnectionPtr->mqttDataExchangeBuffers.txbuff, (uint8_t*)txConnectPacket.remainingLength, mqttEncodeLength(txConnectPacket.totalLength, txConnectPacket.remainingLength));
@@ -871,7 +974,6 @@ static bool mqttSendPublish(mqttContext* mqttConnectionPtr)
     }
 
     MQTT_ExchangeBufferInit(&mqttConnectionPtr->mqttDataExchangeBuffers.txbuff);
-    MQTT_ExchangeBufferInit(&mqttConnectionPtr->mqttDataExchangeBuffers.rxbuff);
 
     // Copy the txPublishPacket data in TCP Tx buffer
     MQTT_ExchangeBufferWrite(&mqttConnectionPtr->mqttDataExchangeBuffers.txbuff, &publishPacket->publishHeaderFlags.All, sizeof(publishPacket->publishHeaderFlags.All));
@@ -896,16 +998,17 @@ static bool mqttSendPublish(mqttContext* mqttConnectionPtr)
             if (publishPacket->publishHeaderFlags.qos == 1)
             {
                 txPublishPacketPending        = publishPacket;
+                txPublishSentCount            = SYS_TIME_CounterGet();
                 mqttRxFlags.newRxPubackPacket = 1;
             }
             else
             {
-                free(publishPacket);
+                MEM_free(publishPacket);
             }
         }
         else
         {
-            free(publishPacket);
+            MEM_free(publishPacket);
         }
     }
     return ret;
@@ -932,6 +1035,49 @@ static uint8_t mqttEncodeLength(uint16_t length, uint8_t* output)
     return i; /* Return the amount of bytes used */
 }
 
+static uint8_t mqttRxFixedHeader(exchangeBuffer* rxbuff, uint32_t* remainingLength)
+{
+    uint8_t  header[1 + REMAINING_LENGTH_MAX_BYTES];
+    uint16_t length;
+    uint8_t  i;
+
+    length = MQTT_ExchangeBufferPeek(rxbuff, header, sizeof(header));
+
+    // Control byte, then 1 to REMAINING_LENGTH_MAX_BYTES of remaining length
+    for (i = 1; i < length && i <= REMAINING_LENGTH_MAX_BYTES; i++)
+    {
+        if ((header[i] & 0x80) == 0)
+        {
+            *remainingLength = mqttDecodeLength(&header[1]);
+            return 1 + i;
+        }
+    }
+
+    return (i > REMAINING_LENGTH_MAX_BYTES) ? FIXED_HEADER_MALFORMED : 0;
+}
+
+static bool mqttRxLengthValid(uint8_t packetType, uint32_t remainingLength)
+{
+    switch (packetType)
+    {
+        case CONNACK:
+        case PUBACK:
+        case UNSUBACK:
+            return (remainingLength == 2);
+        case PINGRESP:
+            return (remainingLength == 0);
+        case SUBACK:
+            // Packet identifier and at least one return code
+            return (remainingLength >= 3);
+        case PUBLISH:
+            // Topic length, the handler checks the rest
+            return (remainingLength >= 2);
+        default:
+            // Not read, only skipped
+            return true;
+    }
+}
+
 static uint32_t mqttDecodeLength(uint8_t* encodedData)
 {
     uint32_t multiplier;
@@ -941,7 +1087,7 @@ static uint32_t mqttDecodeLength(uint8_t* encodedData)
     multiplier = 1;
     value      = 0;
 
-    for (i = 0; i == 0 || (encodedData[i - 1] & 0x80); i++)
+    for (i = 0; i < REMAINING_LENGTH_MAX_BYTES && (i == 0 || (encodedData[i - 1] & 0x80)); i++)
     {
         value += (encodedData[i] & 0x7f) * multiplier;
         multiplier *= 0x80;
@@ -978,9 +1124,6 @@ static void mqttProcessPingresp(mqttContext* mqttConnectionPtr)
     {
         mqttTxFlags.newTxPingreqPacket = 1;
     }
-    // Re-initialise the RX exchange buffer to be able to process the
-    // next incoming MQTT packet
-    MQTT_ExchangeBufferInit(&mqttConnectionPtr->mqttDataExchangeBuffers.rxbuff);
 }
 
 static mqttCurrentState mqttProcessSuback(mqttContext* mqttConnectionPtr)
@@ -1040,9 +1183,6 @@ static mqttCurrentState mqttProcessSuback(mqttContext* mqttConnectionPtr)
     }
 
     mqttRxFlags.newRxSubackPacket = 0;
-    // Re-initialize the RX exchange buffer to be able to process the
-    // next incoming MQTT packet
-    MQTT_ExchangeBufferInit(&mqttConnectionPtr->mqttDataExchangeBuffers.rxbuff);
 
     if (ret == CONNECTED)
     {
@@ -1085,9 +1225,6 @@ static mqttCurrentState mqttProcessUnsuback(mqttContext* mqttConnectionPtr)
     }
 
     mqttRxFlags.newRxUnsubackPacket = 0;
-    // Re-initialize the RX exchange buffer to be able to process the
-    // next incoming MQTT packet
-    MQTT_ExchangeBufferInit(&mqttConnectionPtr->mqttDataExchangeBuffers.rxbuff);
     return ret;
 }
 
@@ -1098,10 +1235,6 @@ bool matchTopicSubscribe(char* SubTopic, char* publishTopic)
         int   subTopicLen, publishTopicLen;
         char* endSubTopic     = strchr(SubTopic, '/');
         char* endPublishTopic = strchr(publishTopic, '/');
-        if (endSubTopic == NULL && endPublishTopic == NULL)
-        {
-            return true;
-        }
 
         if (endSubTopic == NULL)
         {
@@ -1129,11 +1262,17 @@ bool matchTopicSubscribe(char* SubTopic, char* publishTopic)
         {
             return true;   // end wild card
         }
-        else if (memcmp(SubTopic, publishTopic, publishTopicLen) != 0 || publishTopicLen != subTopicLen)
+        else if (publishTopicLen != subTopicLen || memcmp(SubTopic, publishTopic, publishTopicLen) != 0)
         {
             break;
         }
 
+        // Match only when both topics run out on the same level
+        if (endSubTopic == NULL || endPublishTopic == NULL)
+        {
+            return endSubTopic == endPublishTopic;
+        }
+
         SubTopic     = endSubTopic + 1;
         publishTopic = endPublishTopic + 1;
     }
@@ -1145,6 +1284,7 @@ static mqttCurrentState mqttProcessPublish(mqttContext* mqttConnectionPtr)
 {
     mqttCurrentState                 ret;
     uint32_t                         decodedLength;
+    uint16_t                         topicLength;
     mqttPublishPacket                rxPublishPacket;
     const publishReceptionHandler_t* publishRecvHandlerInfo;
     uint8_t                          i;
@@ -1169,16 +1309,34 @@ static mqttCurrentState mqttProcessPublish(mqttContext* mqttConnectionPtr)
 
     // Variable header
     MQTT_ExchangeBufferRead(&mqttConnectionPtr->mqttDataExchangeBuffers.rxbuff, (uint8_t*)&rxPublishPacket.topicLength, sizeof(rxPublishPacket.topicLength));
-    decodedLength -= sizeof(rxPublishPacket.topicLength);
+    topicLength = ntohs(rxPublishPacket.topicLength);
+
+    // Lengths come from the wire, check them against the packet and the local
+    // buffers before copying. The terminator needs the last byte of each buffer.
+    if (decodedLength < sizeof(rxPublishPacket.topicLength) + topicLength)
+    {
+        // A topic running past the packet is a protocol violation, and the
+        // stream cannot be trusted past it (MQTT RFC, section 4.8)
+        debug_printError(" MQTT: Malformed PUBLISH, length %lu topic %u", decodedLength, topicLength);
+        MQTT_Close(mqttConnectionPtr);
+        return DISCONNECTED;
+    }
+    decodedLength -= sizeof(rxPublishPacket.topicLength) + topicLength;
+    if (topicLength >= sizeof(mqttTopic) || decodedLength >= sizeof(mqttPayload))
+    {
+        // Well formed but more than the local buffers hold: skip it,
+        // MQTT_ReceptionHandler() drops the unread rest of the packet
+        debug_printError(" MQTT: PUBLISH too large, topic %u payload %lu", topicLength, decodedLength);
+        return CONNECTED;
+    }
 
     // Topic
     rxPublishPacket.topic = (uint8_t*)mqttTopic;
-    MQTT_ExchangeBufferRead(&mqttConnectionPtr->mqttDataExchangeBuffers.rxbuff, rxPublishPacket.topic, ntohs(rxPublishPacket.topicLength));
-    decodedLength -= ntohs(rxPublishPacket.topicLength);
+    MQTT_ExchangeBufferRead(&mqttConnectionPtr->mqttDataExchangeBuffers.rxbuff, rxPublishPacket.topic, topicLength);
 
     // Payload
     rxPublishPacket.payload = (uint8_t*)mqttPayload;
-    MQTT_ExchangeBufferRead(&mqttConnectionPtr->mqttDataExchangeBuffers.rxbuff, rxPublishPacket.payload, decodedLength);
+    MQTT_ExchangeBufferRead(&mqttConnectionPtr->mqttDataExchangeBuffers.rxbuff, rxPublishPacket.payload, (uint16_t)decodedLength);
 
     mqttPayload[sizeof(mqttPayload) - 1] = 0;   // make sure buffer is null terminated
     mqttTopic[sizeof(mqttTopic) - 1]     = 0;   // make sure buffer is null terminated
@@ -1198,9 +1356,6 @@ static mqttCurrentState mqttProcessPublish(mqttContext* mqttConnectionPtr)
         publishRecvHandlerInfo++;
     }
 
-    // Re-initialize the RX exchange buffer to be able to process the
-    // next incoming MQTT packet
-    MQTT_ExchangeBufferInit(&mqttConnectionPtr->mqttDataExchangeBuffers.rxbuff);
     ret = CONNECTED;
     return ret;
 }
@@ -1226,7 +1381,8 @@ static void mqttProcessPuback(mqttContext* mqttConnectionPtr)
                 mqttPubackCallback(&rxPubackPacket);
             }
             mqttRxFlags.newRxPubackPacket = 0;
-            free((void*)txPublishPacketPending);
+            METRIC_OBSERVE(PUBACK_LATENCY_MS, SYS_TIME_CountToMS(SYS_TIME_CounterGet() - txPublishSentCount));
+            MEM_free((void*)txPublishPacketPending);
             txPublishPacketPending = NULL;
         }
     }
@@ -1327,11 +1483,17 @@ mqttCurrentState MQTT_TransmissionHandler(mqttContext* mqttConnectionPtr)
 
 mqttCurrentState MQTT_ReceptionHandler(mqttContext* mqttConnectionPtr)
 {
+    exchangeBuffer* rxbuff = &mqttConnectionPtr->mqttDataExchangeBuffers.rxbuff;
     uint16_t        keepAliveTimeout;
     mqttHeaderFlags receivedPacketHeader;
+    uint32_t        remainingLength;
+    uint32_t        packetLength;
+    uint16_t        consumed;
+    uint8_t         headerLength;
 
     keepAliveTimeout         = 0;
     receivedPacketHeader.All = 0;
+    remainingLength          = 0;
 
     if (pingrespTimeoutOccured == true || subackTimeoutOccured == true || unsubackTimeoutOccured == true)
     {
@@ -1342,10 +1504,44 @@ mqttCurrentState MQTT_ReceptionHandler(mqttContext* mqttConnectionPtr)
         mqttState = DISCONNECTED;
         MQTT_Close(mqttConnectionPtr);
     }
+    // Drop the rest of a packet too large for the receive buffer as it arrives
+    if (mqttRxDiscardLength != 0)
+    {
+        mqttRxDiscardLength -= MQTT_ExchangeBufferDiscard(rxbuff, (mqttRxDiscardLength < rxbuff->bufferLength) ? mqttRxDiscardLength : rxbuff->bufferLength);
+    }
+
     // If nothing to process
-    if (mqttConnectionPtr->mqttDataExchangeBuffers.rxbuff.dataLength == 0)
+    if (rxbuff->dataLength == 0)
+        return mqttState;
+
+    // Leave a packet split across TCP segments until the rest arrives
+    headerLength = mqttRxFixedHeader(rxbuff, &remainingLength);
+    if (headerLength == 0)
+        return mqttState;
+
+    MQTT_ExchangeBufferPeek(rxbuff, &receivedPacketHeader.All, sizeof(receivedPacketHeader.All));
+    if (headerLength == FIXED_HEADER_MALFORMED || !mqttRxLengthValid(receivedPacketHeader.controlPacketType, remainingLength))
+    {
+        // The stream cannot be parsed any further (MQTT RFC, section 4.8)
+        debug_printError(" MQTT: Malformed packet type %d length %lu", receivedPacketHeader.controlPacketType, remainingLength);
+        mqttState = DISCONNECTED;
+        MQTT_Close(mqttConnectionPtr);
+        return mqttState;
+    }
+
+    packetLength = headerLength + remainingLength;
+    if (packetLength > rxbuff->bufferLength)
+    {
+        debug_printError(" MQTT: Dropping packet type %d of %lu bytes", receivedPacketHeader.controlPacketType, packetLength);
+        mqttRxDiscardLength = packetLength - MQTT_ExchangeBufferDiscard(rxbuff, rxbuff->dataLength);
+        return mqttState;
+    }
+    if (packetLength > rxbuff->dataLength)
         return mqttState;
 
+    METRIC_INC(MQTT_RX_PACKETS);
+    consumed = rxbuff->dataLength;
+
     switch (mqttState)
     {
         case WAITFORCONNACK:
@@ -1356,8 +1552,6 @@ mqttCurrentState MQTT_ReceptionHandler(mqttContext* mqttConnectionPtr)
                 // services timeout driver and START timeout driver
                 stopDestroyTimer(checkConnackTimeoutStateHandle);
                 // Check the type of packet
-                uint16_t len = MQTT_ExchangeBufferPeek(&mqttConnectionPtr->mqttDataExchangeBuffers.rxbuff, &receivedPacketHeader.All, sizeof(receivedPacketHeader.All));
-
                 if (receivedPacketHeader.controlPacketType == CONNACK)
                 {
                     mqttState = mqttProcessConnack(mqttConnectionPtr);
@@ -1381,11 +1575,13 @@ mqttCurrentState MQTT_ReceptionHandler(mqttContext* mqttConnectionPtr)
                     else
                     {
                         debug_printError(" MQTT: CONNACK Refused :(");
+                        // The server closes the Network Connection after a refusal (MQTT RFC, section 3.2.2.3).
+                        MQTT_Close(mqttConnectionPtr);
                     }
                 }
                 else
                 {
-                    debug_printError(" MQTT: DISCONNECT (%d) from (%d)", receivedPacketHeader.controlPacketType, len);
+                    debug_printError(" MQTT: DISCONNECT (%d) from (%lu)", receivedPacketHeader.controlPacketType, packetLength);
                     //If the Client does not receive a CONNACK Packet from the Server within a reasonable amount of time,
                     //the Client SHOULD close the Network Connection.
                     mqttState = DISCONNECTED;
@@ -1402,8 +1598,6 @@ mqttCurrentState MQTT_ReceptionHandler(mqttContext* mqttConnectionPtr)
 
         case CONNECTED:
             // Check the type of packet
-            MQTT_ExchangeBufferPeek(&mqttConnectionPtr->mqttDataExchangeBuffers.rxbuff, &receivedPacketHeader.All, sizeof(receivedPacketHeader.All));
-
             switch (receivedPacketHeader.controlPacketType)
             {
                 case PINGRESP:
@@ -1430,16 +1624,20 @@ mqttCurrentState MQTT_ReceptionHandler(mqttContext* mqttConnectionPtr)
                         mqttState = mqttProcessUnsuback(mqttConnectionPtr);
                     }
                     break;
-                case PUBLISH:
+                case PUBLISH: {
                     // PUBLISH received
-                    mqttProcessPublish(mqttConnectionPtr);
+                    PERF_BEGIN(MQTT_PUBLISH_RX);
+                    mqttState = mqttProcessPublish(mqttConnectionPtr);
+                    PERF_END(MQTT_PUBLISH_RX);
                     break;
+                }
                 case PUBACK:
                     // PUBACK received
                     mqttProcessPuback(mqttConnectionPtr);
                     break;
 
                 default:
+                    debug_printWarn(" MQTT: Skipping packet type %d", receivedPacketHeader.controlPacketType);
                     break;
             }
             break;
@@ -1452,6 +1650,15 @@ mqttCurrentState MQTT_ReceptionHandler(mqttContext* mqttConnectionPtr)
             break;
     }
 
+    // Take exactly this packet off the receive buffer, also when its handler
+    // read only part of it or it was not expected. MQTT_Close() has already
+    // emptied the buffer when the connection ended.
+    consumed -= rxbuff->dataLength;
+    if (consumed < packetLength)
+    {
+        MQTT_ExchangeBufferDiscard(rxbuff, packetLength - consumed);
+    }
+
     return mqttState;
 }
 
@@ -1462,7 +1669,6 @@ static bool mqttSendSubscribe(mqttContext* mqttConnectionPtr)
     uint8_t topicCount = 0;
 
     MQTT_ExchangeBufferInit(&mqttConnectionPtr->mqttDataExchangeBuffers.txbuff);
-    MQTT_ExchangeBufferInit(&mqttConnectionPtr->mqttDataExchangeBuffers.rxbuff);
 
     // Copy the txSubscribePacket data in TCP Tx buffer
     MQTT_ExchangeBufferWrite(&mqttConnectionPtr->mqttDataExchangeBuffers.txbuff, &txSubscribePacket.subscribeHeaderFlags.All, sizeof(txSubscribePacket.subscribeHeaderFlags.All));
@@ -1499,7 +1705,6 @@ static bool mqttSendUnsubscribe(mqttContext* mqttConnectionPtr)
     uint8_t topicCount = 0;
 
     MQTT_ExchangeBufferInit(&mqttConnectionPtr->mqttDataExchangeBuffers.txbuff);
-    MQTT_ExchangeBufferInit(&mqttConnectionPtr->mqttDataExchangeBuffers.rxbuff);
 
     // Copy the txUnsubscribePacket data in TCP Tx buffer
     MQTT_ExchangeBufferWrite(&mqttConnectionPtr->mqttDataExchangeBuffers.txbuff, &txUnsubscribePacket.unsubscribeHeaderFlags.All, sizeof(txUnsubscribePacket.unsubscribeHeaderFlags.All));
@@ -1537,7 +1742,6 @@ static bool mqttSendPingreq(mqttContext* mqttConnectionPtr)
     ret = false;
     memset(&txPingreqPacket, 0, sizeof(txPingreqPacket));
     MQTT_ExchangeBufferInit(&mqttConnectionPtr->mqttDataExchangeBuffers.txbuff);
-    MQTT_ExchangeBufferInit(&mqttConnectionPtr->mqttDataExchangeBuffers.rxbuff);
 
     // Send a PINGREQ packet here
     txPingreqPacket.pingFixedHeader.controlPacketType = PINGREQ;
@@ -1575,7 +1779,6 @@ static bool mqttSendDisconnect(mqttContext* mqttConnectionPtr)
 
     memset(&txDisconnectPacket, 0, sizeof(txDisconnectPacket));
     MQTT_ExchangeBufferInit(&mqttConnectionPtr->mqttDataExchangeBuffers.txbuff);
-    MQTT_ExchangeBufferInit(&mqttConnectionPtr->mqttDataExchangeBuffers.rxbuff);
 
     txDisconnectPacket.disconnectFixedHeader.controlPacketType = DISCONNECT;
     txDisconnectPacket.disconnectFixedHeader.retain            = 0;
@@ -1613,49 +1816,20 @@ static mqttCurrentState mqttProcessConnack(mqttContext* mqttConnectionPtr)
     else
     {
         debug_printError(" MQTT: CONNACK refused %d", mqttConnackPacket.connackVariableHeader.connackReturnCode);
+        if (mqttConnackRefusedCallback != NULL)
+        {
+            mqttConnackRefusedCallback(mqttConnackPacket.connackVariableHeader.connackReturnCode);
+        }
         return DISCONNECTED;
     }
 }
 
-void MQTT_sched(void)
-{
-    if (checkConnackTimeoutStateTmrExpired == true)
-    {
-        debug_printWarn(" MQTT: CONNACK Timeout");
-        checkConnackTimeoutStateTmrExpired = false;
-        checkConnackTimeoutState();
-    }
-
-    if (checkPingreqTimeoutStateTmrExpired == true)
-    {
-        debug_printInfo(" MQTT: PINGREQ Timeout");
-        checkPingreqTimeoutStateTmrExpired = false;
-        checkPingreqTimeoutState();
-    }
-
-    if (checkSubackTimeoutStateTmrExpired == true)
-    {
-        debug_printWarn(" MQTT: SUBACK Timeout");
-        checkSubackTimeoutStateTmrExpired = false;
-        checkSubackTimeoutState();
-    }
-
-    if (checkUnsubackTimeoutStateTmrExpired == true)
-    {
-        debug_printWarn(" MQTT: UNSUBACK Timeout");
-        checkUnsubackTimeoutStateTmrExpired = false;
-        checkUnsubackTimeoutState();
-    }
-
-    if (checkPingrespTimeoutStateTmrExpired == true)
-    {
-        debug_printWarn(" MQTT: PINGRESP Timeout");
-        checkPingrespTimeoutStateTmrExpired = false;
-        checkPingrespTimeoutState();
-    }
-}
-
 void MQTT_Set_Puback_callback(MQTTPubAckCallbackPtr callback)
 {
     mqttPubackCallback = callback;
-}
\ No newline at end of file
+}
+
+void MQTT_Set_ConnackRefused_callback(MQTTConnackRefusedCallbackPtr callback)
+{
+    mqttConnackRefusedCallback = callback;
+}
\ No newline at end of file
@@ -379,6 +379,7 @@ typedef struct
 /***********************MQTT Client definitions*(END)**************************/
 
 int32_t MQTT_getConnectionAge(void);
+int32_t MQTT_msUntilPingreq(void);
 bool    MQTT_CreateConnectPacket(mqttConnectPacket* newConnectPacket);
 bool    MQTT_CreatePublishPacket(mqttPublishPacket* newPublishPacket);
 bool    MQTT_CreateSubscribePacket(mqttSubscribePacket* newSubscribePacket);
@@ -393,6 +394,9 @@ mqttCurrentState MQTT_GetConnectionState(void);
 typedef void (*MQTTPubAckCallbackPtr)(mqttPubackPacket* data);
 
 void MQTT_Set_Puback_callback(MQTTPubAckCallbackPtr callback);
-void MQTT_sched(void);
+
+typedef void (*MQTTConnackRefusedCallbackPtr)(uint8_t returnCode);
+
+void MQTT_Set_ConnackRefused_callback(MQTTConnackRefusedCallbackPtr callback);
 
 #endif /* MQTT_CORE_H */
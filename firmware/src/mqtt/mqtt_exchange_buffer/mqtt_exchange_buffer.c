@@ -66,7 +66,8 @@ uint16_t MQTT_ExchangeBufferPeek(exchangeBuffer* buffer, uint8_t* data, uint16_t
 
     for (i = 0; i < length && i < buffer->dataLength; i++)
     {
-        data[i] = ptr[i];
+        data[i] = *ptr;
+        ptr++;
         if (ptr > bend)
         {
             ptr = buffer->start;
@@ -93,3 +94,50 @@ uint16_t MQTT_ExchangeBufferRead(exchangeBuffer* buffer, uint8_t* data, uint16_t
     }
     return i;
 }
+
+// Drops up to length bytes from the head, for packets nobody reads
+uint16_t MQTT_ExchangeBufferDiscard(exchangeBuffer* buffer, uint16_t length)
+{
+    if (length > buffer->dataLength)
+    {
+        length = buffer->dataLength;
+    }
+    buffer->currentLocation = buffer->start + (buffer->currentLocation - buffer->start + length) % buffer->bufferLength;
+    buffer->dataLength -= length;
+
+    return length;
+}
+
+// Contiguous free space after the buffered data, so a receiver can fill the
+// buffer in place and then account for the bytes with MQTT_ExchangeBufferCommit().
+// The region does not move while data is only read from the buffer.
+uint8_t* MQTT_ExchangeBufferFreeRegion(exchangeBuffer* buffer, uint16_t* length)
+{
+    uint16_t head;
+    uint16_t tail;
+
+    head = buffer->currentLocation - buffer->start;
+    tail = (head + buffer->dataLength) % buffer->bufferLength;
+
+    if (buffer->dataLength >= buffer->bufferLength)
+    {
+        *length = 0;
+    }
+    else if (tail >= head)
+    {
+        *length = buffer->bufferLength - tail;
+    }
+    else
+    {
+        *length = head - tail;
+    }
+
+    return buffer->start + tail;
+}
+
+void MQTT_ExchangeBufferCommit(exchangeBuffer* buffer, uint16_t length)
+{
+    uint16_t space = buffer->bufferLength - buffer->dataLength;
+
+    buffer->dataLength += (length < space) ? length : space;
+}
@@ -48,3 +48,6 @@ void     MQTT_ExchangeBufferInit(exchangeBuffer* buffer);
 uint16_t MQTT_ExchangeBufferPeek(exchangeBuffer* buffer, uint8_t* data, uint16_t length);
 uint16_t MQTT_ExchangeBufferWrite(exchangeBuffer* buffer, uint8_t* data, uint16_t length);
 uint16_t MQTT_ExchangeBufferRead(exchangeBuffer* buffer, uint8_t* data, uint16_t length);
+uint16_t MQTT_ExchangeBufferDiscard(exchangeBuffer* buffer, uint16_t length);
+uint8_t* MQTT_ExchangeBufferFreeRegion(exchangeBuffer* buffer, uint16_t* length);
+void     MQTT_ExchangeBufferCommit(exchangeBuffer* buffer, uint16_t length);
@@ -32,6 +32,8 @@
  * 
  ******************************************************************************/
 
+#define DEBUG_MODULE MQTT
+
 #include <stdint.h>
 #include <string.h>
 #include "mqtt_packetTransfer_interface.h"
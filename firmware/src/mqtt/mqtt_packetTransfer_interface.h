@@ -28,6 +28,7 @@
 #ifndef MQTT_PACKET_TRANSFER_INTERFACE_H
 #define MQTT_PACKET_TRANSFER_INTERFACE_H
 
+#include <stdbool.h>
 #include <stdint.h>
 
 
@@ -50,6 +51,18 @@ typedef struct
     imqttHandlePublishDataFuncPtr mqttHandlePublishDataCallBack;
 } publishReceptionHandler_t;
 
+// Packet population hooks of the cloud client (IoT Hub or DPS) that the MQTT
+// core and cloud_service call into
+typedef struct
+{
+    void (*MQTT_CLIENT_publish)(uint8_t* topic, uint8_t* payload, uint16_t payload_len, int qos);
+    void (*MQTT_CLIENT_receive)(uint8_t* data, uint16_t len);
+    void (*MQTT_CLIENT_connect)(char* device_id);
+    bool (*MQTT_CLIENT_subscribe)();
+    void (*MQTT_CLIENT_connected)();
+    void (*MQTT_CLIENT_task_completed)();
+} pf_MQTT_CLIENT;
+
 /*******************MQTT Interface layer definitions*(END)*********************/
 
 /** \brief Set the publish reception handler table information.
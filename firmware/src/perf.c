@@ -0,0 +1,135 @@
+/*
+    \file   perf.c
+
+    \brief  perf.ceader file.
+
+    (c) 2018 Microchip Technology Inc. and its subsidiaries.
+
+    Subject to your compliance with these terms, you may use Microchip software and any
+    derivatives exclusively with Microchip products. It is your responsibility to comply with third party
+    license terms applicable to your use of third party software (including open source software) that
+    may accompany Microchip software.
+
+    THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+    EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY
+    IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS
+    FOR A PARTICULAR PURPOSE.
+
+    IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
+    INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND
+    WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP
+    HAS BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO
+    THE FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL
+    CLAIMS IN ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT
+    OF FEES, IF ANY, THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS
+    SOFTWARE.
+*/
+
+
+#include <stdint.h>
+#include <string.h>
+#include "perf.h"
+
+#if CFG_PERF_ENABLE
+#include "definitions.h"
+
+#define PERF_SYSTICK_MAX 0x00FFFFFFUL   // 24-bit reload, wraps every 349 ms at 48 MHz
+
+perf_stats_t perfStats[PERF_PROBE_COUNT];
+
+static const char* const perf_probeNames[PERF_PROBE_COUNT] = {
+    "APP_Tasks", "CLOUD_task", "MQTT publish rx", "telemetry json", "twin parse", "reported prop",
+    "WINC spi tx", "WINC spi rx",
+};
+
+static uint32_t perf_cyclesPerCount;   // CPU cycles per SYS_TIME counter tick
+static uint32_t perf_overhead;         // cost of an empty begin/end pair
+
+void PERF_init(void)
+{
+    perf_stamp_t start;
+    perf_stamp_t end;
+    uint32_t     cycles;
+
+    // No interrupt, SysTick only counts
+    SysTick->LOAD = PERF_SYSTICK_MAX;
+    SysTick->VAL  = 0;
+    SysTick->CTRL = SysTick_CTRL_CLKSOURCE_Msk | SysTick_CTRL_ENABLE_Msk;
+
+    perf_cyclesPerCount = SYS_TIME_CPU_CLOCK_FREQUENCY / SYS_TIME_FrequencyGet();
+
+    start         = PERF_stamp();
+    end           = PERF_stamp();
+    cycles        = (start.tick - end.tick) & PERF_SYSTICK_MAX;
+    perf_overhead = cycles;
+
+    PERF_reset();
+}
+
+void PERF_reset(void)
+{
+    uint8_t probe;
+
+    memset(perfStats, 0, sizeof(perfStats));
+    for (probe = 0; probe < PERF_PROBE_COUNT; probe++)
+    {
+        perfStats[probe].minCycles = UINT32_MAX;
+    }
+}
+
+perf_stamp_t PERF_stamp(void)
+{
+    perf_stamp_t stamp;
+
+    stamp.count = SYS_TIME_Counter64Get();
+    stamp.tick  = SysTick->VAL;
+    return stamp;
+}
+
+void PERF_record(perf_probe_t probe, const perf_stamp_t* start)
+{
+    perf_stamp_t  end   = PERF_stamp();
+    perf_stats_t* stats = &perfStats[probe];
+    uint64_t      countCycles;
+    uint32_t      cycles;
+
+    cycles      = (start->tick - end.tick) & PERF_SYSTICK_MAX;
+    countCycles = (end.count - start->count) * perf_cyclesPerCount;
+
+    // The counter is only good to a tick either side.  Beyond that SysTick
+    // wrapped or the CPU clock stopped in sleep, and the counter is the better
+    // measure.
+    if (countCycles > (uint64_t)cycles + 2 * perf_cyclesPerCount)
+    {
+        cycles = (countCycles > UINT32_MAX) ? UINT32_MAX : (uint32_t)countCycles;
+    }
+    cycles = (cycles > perf_overhead) ? cycles - perf_overhead : 0;
+
+    stats->calls++;
+    stats->totalCycles += cycles;
+    if (cycles < stats->minCycles)
+    {
+        stats->minCycles = cycles;
+    }
+    if (cycles > stats->maxCycles)
+    {
+        stats->maxCycles = cycles;
+    }
+}
+
+uint32_t PERF_overheadCycles(void)
+{
+    return perf_overhead;
+}
+
+uint32_t PERF_cyclesToUs(uint64_t cycles)
+{
+    return (uint32_t)(cycles / (SYS_TIME_CPU_CLOCK_FREQUENCY / 1000000UL));
+}
+
+const char* PERF_probeName(perf_probe_t probe)
+{
+    return (probe < PERF_PROBE_COUNT) ? perf_probeNames[probe] : "?";
+}
+
+#endif /* CFG_PERF_ENABLE */
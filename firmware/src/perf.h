@@ -0,0 +1,85 @@
+/*
+    \file   perf.h
+
+    \brief  perf.header file.
+
+    (c) 2018 Microchip Technology Inc. and its subsidiaries.
+
+    Subject to your compliance with these terms, you may use Microchip software and any
+    derivatives exclusively with Microchip products. It is your responsibility to comply with third party
+    license terms applicable to your use of third party software (including open source software) that
+    may accompany Microchip software.
+
+    THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+    EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY
+    IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS
+    FOR A PARTICULAR PURPOSE.
+
+    IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
+    INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND
+    WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP
+    HAS BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO
+    THE FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL
+    CLAIMS IN ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT
+    OF FEES, IF ANY, THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS
+    SOFTWARE.
+*/
+
+
+#ifndef PERF_H_
+#define PERF_H_
+#include <stdint.h>
+#include "iot_config/IoT_Sensor_Node_config.h"
+
+// Hot-path probes.  The M0+ has no DWT cycle counter, so SysTick free-runs as
+// a 24-bit cycle counter and the SYS_TIME 64-bit counter covers spans where
+// SysTick wrapped or stopped in sleep.  Probes are for the main loop only, not
+// for interrupt handlers.  With CFG_PERF_ENABLE 0 the macros expand to nothing.
+
+typedef enum
+{
+    PERF_PROBE_APP_TASKS = 0,
+    PERF_PROBE_CLOUD_TASK,
+    PERF_PROBE_MQTT_PUBLISH_RX,
+    PERF_PROBE_TELEMETRY_JSON,
+    PERF_PROBE_TWIN_PARSE,
+    PERF_PROBE_REPORTED_PROPERTY,
+    PERF_PROBE_WINC_SPI_TX,
+    PERF_PROBE_WINC_SPI_RX,
+    PERF_PROBE_COUNT
+} perf_probe_t;
+
+typedef struct
+{
+    uint32_t calls;
+    uint64_t totalCycles;
+    uint32_t minCycles;
+    uint32_t maxCycles;
+} perf_stats_t;
+
+typedef struct
+{
+    uint32_t tick;    // SysTick, counts down
+    uint64_t count;   // SYS_TIME counter
+} perf_stamp_t;
+
+#if CFG_PERF_ENABLE
+extern perf_stats_t perfStats[PERF_PROBE_COUNT];
+
+void         PERF_init(void);
+void         PERF_reset(void);
+perf_stamp_t PERF_stamp(void);
+void         PERF_record(perf_probe_t probe, const perf_stamp_t* start);
+uint32_t     PERF_overheadCycles(void);
+uint32_t     PERF_cyclesToUs(uint64_t cycles);
+const char*  PERF_probeName(perf_probe_t probe);
+
+#define PERF_BEGIN(probe) perf_stamp_t perfStamp_##probe = PERF_stamp()
+#define PERF_END(probe)   PERF_record(PERF_PROBE_##probe, &perfStamp_##probe)
+#else
+#define PERF_init()
+#define PERF_BEGIN(probe)
+#define PERF_END(probe)
+#endif
+
+#endif /* PERF_H_ */
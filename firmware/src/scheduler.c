@@ -0,0 +1,212 @@
+/*
+    \file   scheduler.c
+
+    \brief  scheduler.ceader file.
+
+    (c) 2018 Microchip Technology Inc. and its subsidiaries.
+
+    Subject to your compliance with these terms, you may use Microchip software and any
+    derivatives exclusively with Microchip products. It is your responsibility to comply with third party
+    license terms applicable to your use of third party software (including open source software) that
+    may accompany Microchip software.
+
+    THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+    EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY
+    IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS
+    FOR A PARTICULAR PURPOSE.
+
+    IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
+    INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND
+    WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP
+    HAS BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO
+    THE FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL
+    CLAIMS IN ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT
+    OF FEES, IF ANY, THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS
+    SOFTWARE.
+*/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "scheduler.h"
+#include "definitions.h"
+
+typedef struct
+{
+    uint8_t  event;
+    uint32_t count;   // SYS_TIME counter at post
+} sched_entry_t;
+
+sched_stats_t schedStats;
+
+static const char* const sched_eventNames[SCHED_EVENT_COUNT] = {
+    "mqtt connack", "mqtt pingresp", "mqtt suback", "mqtt unsuback", "mqtt pingreq",
+    "cloud wifi", "cloud mqtt", "cloud reset", "dps retry",
+    "wifi handler", "wifi checkback", "wifi softap", "wifi ntp",
+    "app cloud", "app data"};
+
+static sched_handler_t sched_handlers[SCHED_EVENT_COUNT];
+
+// Single producer / single consumer ring.  Timer callbacks all run from the
+// SYS_TIME (TC3) interrupt and only ever advance head; SCHED_run() only
+// advances tail.  Posts from thread context are wrapped in a critical section
+// so they cannot interleave with the interrupt.
+static sched_entry_t     sched_queue[SCHED_QUEUE_SIZE];
+static volatile uint8_t  sched_head = 0;
+static volatile uint8_t  sched_tail = 0;
+static volatile uint32_t sched_overflowMask;   // events that did not fit, delivered without a timestamp
+
+// Events drained from the queue and waiting for their handler
+static uint32_t sched_pendingMask;
+static uint32_t sched_pendingCount[SCHED_EVENT_COUNT];
+
+static void sched_enqueue(sched_event_t event)
+{
+    uint8_t head = sched_head;
+    uint8_t next = (head + 1) & (SCHED_QUEUE_SIZE - 1);
+    uint8_t depth;
+
+    schedStats.events[event].posted++;
+
+    if (next == sched_tail)
+    {
+        schedStats.overflows++;
+        sched_overflowMask |= (1UL << event);
+        return;
+    }
+
+    sched_queue[head].event = (uint8_t)event;
+    sched_queue[head].count = SYS_TIME_CounterGet();
+    sched_head              = next;
+
+    depth = (next - sched_tail) & (SCHED_QUEUE_SIZE - 1);
+    if (depth > schedStats.depthMax)
+    {
+        schedStats.depthMax = depth;
+    }
+}
+
+void SCHED_init(void)
+{
+    memset(sched_handlers, 0, sizeof(sched_handlers));
+    memset(&schedStats, 0, sizeof(schedStats));
+    sched_head         = 0;
+    sched_tail         = 0;
+    sched_overflowMask = 0;
+    sched_pendingMask  = 0;
+}
+
+void SCHED_register(sched_event_t event, sched_handler_t handler)
+{
+    if (event < SCHED_EVENT_COUNT)
+    {
+        sched_handlers[event] = handler;
+    }
+}
+
+void SCHED_post(sched_event_t event)
+{
+    if (event >= SCHED_EVENT_COUNT)
+    {
+        return;
+    }
+
+    if (__get_IPSR() != 0)
+    {
+        sched_enqueue(event);
+    }
+    else
+    {
+        __disable_irq();
+        sched_enqueue(event);
+        __enable_irq();
+    }
+}
+
+uint8_t SCHED_depth(void)
+{
+    return (sched_head - sched_tail) & (SCHED_QUEUE_SIZE - 1);
+}
+
+const char* SCHED_eventName(sched_event_t event)
+{
+    return (event < SCHED_EVENT_COUNT) ? sched_eventNames[event] : "?";
+}
+
+// Called from the application loop.  Drains whatever was posted, then runs
+// one handler per pending event in priority order, so the cost of a pass is
+// proportional to the events waiting rather than to the number of sources.
+void SCHED_run(void)
+{
+    uint32_t now = SYS_TIME_CounterGet();
+    uint32_t latencyUs;
+    uint32_t start;
+    uint32_t runUs;
+    uint32_t overflow;
+    uint8_t  tail = sched_tail;
+    uint8_t  event;
+
+    while (tail != sched_head)
+    {
+        event = sched_queue[tail].event;
+
+        if (sched_pendingMask & (1UL << event))
+        {
+            schedStats.events[event].coalesced++;
+        }
+        else
+        {
+            sched_pendingMask |= (1UL << event);
+            sched_pendingCount[event] = sched_queue[tail].count;
+        }
+
+        tail       = (tail + 1) & (SCHED_QUEUE_SIZE - 1);
+        sched_tail = tail;
+    }
+
+    if (sched_overflowMask != 0)
+    {
+        __disable_irq();
+        overflow           = sched_overflowMask;
+        sched_overflowMask = 0;
+        __enable_irq();
+
+        for (event = 0; event < SCHED_EVENT_COUNT; event++)
+        {
+            if ((overflow & (1UL << event)) && !(sched_pendingMask & (1UL << event)))
+            {
+                sched_pendingMask |= (1UL << event);
+                sched_pendingCount[event] = now;
+            }
+        }
+    }
+
+    for (event = 0; sched_pendingMask != 0 && event < SCHED_EVENT_COUNT; event++)
+    {
+        if (!(sched_pendingMask & (1UL << event)))
+        {
+            continue;
+        }
+
+        sched_pendingMask &= ~(1UL << event);
+
+        start     = SYS_TIME_CounterGet();
+        latencyUs = SYS_TIME_CountToUS(start - sched_pendingCount[event]);
+        if (latencyUs > schedStats.events[event].maxLatencyUs)
+        {
+            schedStats.events[event].maxLatencyUs = latencyUs;
+        }
+
+        if (sched_handlers[event] != NULL)
+        {
+            sched_handlers[event]();
+        }
+
+        runUs = SYS_TIME_CountToUS(SYS_TIME_CounterGet() - start);
+        if (runUs > schedStats.events[event].maxRunUs)
+        {
+            schedStats.events[event].maxRunUs = runUs;
+        }
+        schedStats.events[event].handled++;
+    }
+}
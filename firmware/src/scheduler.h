@@ -0,0 +1,84 @@
+/*
+    \file   scheduler.h
+
+    \brief  scheduler.header file.
+
+    (c) 2018 Microchip Technology Inc. and its subsidiaries.
+
+    Subject to your compliance with these terms, you may use Microchip software and any
+    derivatives exclusively with Microchip products. It is your responsibility to comply with third party
+    license terms applicable to your use of third party software (including open source software) that
+    may accompany Microchip software.
+
+    THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+    EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY
+    IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS
+    FOR A PARTICULAR PURPOSE.
+
+    IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
+    INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND
+    WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP
+    HAS BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO
+    THE FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL
+    CLAIMS IN ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT
+    OF FEES, IF ANY, THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS
+    SOFTWARE.
+*/
+
+
+#ifndef SCHEDULER_H_
+#define SCHEDULER_H_
+#include <stdint.h>
+#include <stdbool.h>
+
+#define SCHED_QUEUE_SIZE 16   // power of two
+
+// Events in priority order, lowest value runs first
+typedef enum
+{
+    SCHED_EVENT_MQTT_CONNACK_TIMEOUT = 0,
+    SCHED_EVENT_MQTT_PINGRESP_TIMEOUT,
+    SCHED_EVENT_MQTT_SUBACK_TIMEOUT,
+    SCHED_EVENT_MQTT_UNSUBACK_TIMEOUT,
+    SCHED_EVENT_MQTT_PINGREQ,
+    SCHED_EVENT_CLOUD_WIFI_TIMEOUT,
+    SCHED_EVENT_CLOUD_MQTT_TIMEOUT,
+    SCHED_EVENT_CLOUD_RESET,
+    SCHED_EVENT_DPS_RETRY,
+    SCHED_EVENT_WIFI_HANDLER,
+    SCHED_EVENT_WIFI_CHECKBACK,
+    SCHED_EVENT_WIFI_SOFTAP_CONNECT,
+    SCHED_EVENT_WIFI_NTP_FETCH,
+    SCHED_EVENT_APP_CLOUD_TASK,
+    SCHED_EVENT_APP_DATA_TASK,
+    SCHED_EVENT_COUNT
+} sched_event_t;
+
+typedef void (*sched_handler_t)(void);
+
+typedef struct
+{
+    uint32_t posted;
+    uint32_t handled;
+    uint32_t coalesced;       // posted again before the handler ran
+    uint32_t maxLatencyUs;    // post to handler start
+    uint32_t maxRunUs;
+} sched_event_stats_t;
+
+typedef struct
+{
+    uint32_t            overflows;    // posts that found the queue full
+    uint8_t             depthMax;
+    sched_event_stats_t events[SCHED_EVENT_COUNT];
+} sched_stats_t;
+
+extern sched_stats_t schedStats;
+
+void        SCHED_init(void);
+void        SCHED_register(sched_event_t event, sched_handler_t handler);
+void        SCHED_post(sched_event_t event);
+void        SCHED_run(void);
+uint8_t     SCHED_depth(void);
+const char* SCHED_eventName(sched_event_t event);
+
+#endif /* SCHEDULER_H_ */
@@ -0,0 +1,136 @@
+/*
+\file   backoff.c
+
+\brief  Reconnect backoff policy source file.
+
+(c) 2018 Microchip Technology Inc. and its subsidiaries.
+
+Subject to your compliance with these terms, you may use Microchip software and any
+derivatives exclusively with Microchip products. It is your responsibility to comply with third party
+license terms applicable to your use of third party software (including open source software) that
+may accompany Microchip software.
+
+THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY
+IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS
+FOR A PARTICULAR PURPOSE.
+
+IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
+INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND
+WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP
+HAS BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO
+THE FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL
+CLAIMS IN ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT
+OF FEES, IF ANY, THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS
+SOFTWARE.
+*/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "backoff.h"
+#include "definitions.h"
+
+static backoff_t* backoff_policies[BACKOFF_MAX_POLICIES];
+static uint8_t    backoff_policyCount = 0;
+
+// xorshift32 state.  Seeded from the secure element RNG so devices do not retry in lockstep.
+static uint32_t backoff_state = 0x2545F491UL;
+
+static uint32_t backoff_random(void)
+{
+    uint32_t x = backoff_state;
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    backoff_state = x;
+
+    return x;
+}
+
+void BACKOFF_seed(uint32_t seed)
+{
+    // xorshift must never be seeded with 0
+    if (seed != 0)
+    {
+        backoff_state = seed;
+    }
+}
+
+void BACKOFF_init(backoff_t* backoff, const char* name, uint32_t baseMs, uint32_t capMs)
+{
+    uint8_t i;
+
+    memset(backoff, 0, sizeof(backoff_t));
+    backoff->name   = name;
+    backoff->baseMs = baseMs;
+    backoff->capMs  = capMs;
+
+    for (i = 0; i < backoff_policyCount; i++)
+    {
+        if (backoff_policies[i] == backoff)
+        {
+            return;
+        }
+    }
+
+    if (backoff_policyCount < BACKOFF_MAX_POLICIES)
+    {
+        backoff_policies[backoff_policyCount++] = backoff;
+    }
+}
+
+uint32_t BACKOFF_next(backoff_t* backoff)
+{
+    uint32_t window = backoff->baseMs;
+    uint32_t n;
+
+    // window = min(cap, base * 2^attempts), without overflowing
+    for (n = 0; n < backoff->attempts && window < backoff->capMs; n++)
+    {
+        window <<= 1;
+    }
+
+    if (window > backoff->capMs)
+    {
+        window = backoff->capMs;
+    }
+
+    // Never hand out 0, SYS_TIME rejects zero length timers
+    backoff->lastDelayMs    = 1 + backoff_random() % window;
+    backoff->nextRetryCount = SYS_TIME_CounterGet() + SYS_TIME_MSToCount(backoff->lastDelayMs);
+    backoff->attempts++;
+    backoff->totalRetries++;
+
+    // No logging here, callers log the delay they were given
+    return backoff->lastDelayMs;
+}
+
+void BACKOFF_reset(backoff_t* backoff)
+{
+    backoff->attempts = 0;
+}
+
+int32_t BACKOFF_msUntilRetry(const backoff_t* backoff)
+{
+    int32_t count = (int32_t)(backoff->nextRetryCount - SYS_TIME_CounterGet());
+
+    if (backoff->attempts == 0 || count <= 0)
+    {
+        return 0;
+    }
+
+    return (int32_t)SYS_TIME_CountToMS((uint32_t)count);
+}
+
+uint8_t BACKOFF_getCount(void)
+{
+    return backoff_policyCount;
+}
+
+const backoff_t* BACKOFF_get(uint8_t index)
+{
+    return (index < backoff_policyCount) ? backoff_policies[index] : NULL;
+}
@@ -0,0 +1,58 @@
+/*
+\file   backoff.h
+
+\brief  Reconnect backoff policy header file.
+
+(c) 2018 Microchip Technology Inc. and its subsidiaries.
+
+Subject to your compliance with these terms, you may use Microchip software and any
+derivatives exclusively with Microchip products. It is your responsibility to comply with third party
+license terms applicable to your use of third party software (including open source software) that
+may accompany Microchip software.
+
+THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY
+IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS
+FOR A PARTICULAR PURPOSE.
+
+IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
+INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND
+WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP
+HAS BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO
+THE FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL
+CLAIMS IN ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT
+OF FEES, IF ANY, THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS
+SOFTWARE.
+*/
+
+#ifndef BACKOFF_H_
+#define BACKOFF_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define BACKOFF_MAX_POLICIES 4
+
+// Exponential backoff with full jitter: attempt n waits a random time in (0, min(cap, base * 2^n)]
+typedef struct
+{
+    const char* name;
+    uint32_t    baseMs;
+    uint32_t    capMs;
+    uint32_t    attempts;         // attempts since the last success
+    uint32_t    totalRetries;     // lifetime count of delays handed out
+    uint32_t    lastDelayMs;
+    uint32_t    nextRetryCount;   // SYS_TIME counter value when the retry is due
+} backoff_t;
+
+void     BACKOFF_seed(uint32_t seed);
+void     BACKOFF_init(backoff_t* backoff, const char* name, uint32_t baseMs, uint32_t capMs);
+uint32_t BACKOFF_next(backoff_t* backoff);
+void     BACKOFF_reset(backoff_t* backoff);
+int32_t  BACKOFF_msUntilRetry(const backoff_t* backoff);
+
+// Registered policies, for reporting
+uint8_t          BACKOFF_getCount(void);
+const backoff_t* BACKOFF_get(uint8_t index);
+
+#endif /* BACKOFF_H_ */
@@ -0,0 +1,436 @@
+/********************************************************************
+ *
+ (c) [2018] Microchip Technology Inc. and its subsidiaries.
+
+   Subject to your compliance with these terms, you may use Microchip software  
+ * and any derivatives exclusively with Microchip products. It is your 
+ * responsibility to comply with third party license terms applicable to your 
+ * use of third party software (including open source software) that may 
+ * accompany Microchip software.
+   THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER  
+ * EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY IMPLIED 
+ * WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS FOR A PARTICULAR 
+ * PURPOSE.
+ * 
+   IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, 
+ * INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND 
+ * WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS 
+ * BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO THE 
+ * FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN 
+ * ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY, 
+ * THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+ *************************************************************************
+ *
+ *                           bsdPOSIX.c
+ *
+ * About: BSD adapter API over host sockets
+ *
+ ******************************************************************************/
+
+#ifdef BSD_POSIX_BACKEND
+
+#define DEBUG_MODULE BSD
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdio.h>
+#include "bsdWINC.h"
+#include "bsdPOSIX.h"
+#include "debug_print.h"
+
+#define MAX_SUPPORTED_SOCKETS 2
+
+// Same option values as bsdWINC.c, accepted so cloud_service configures the
+// socket unchanged. The host backend speaks plain TCP to a local broker.
+#define POSIX_TLS             0x01
+#define POSIX_SOL_SOCKET      1
+#define POSIX_SOL_SSL_SOCKET  2
+#define POSIX_SO_SSL_LAST     4
+
+// A receive posted by BSD_recv, completed later by BSD_POSIX_Tasks() the way
+// the WINC completes it with SOCKET_MSG_RECV
+typedef struct
+{
+    uint8_t* buf;
+    size_t   len;
+    bool     posted;
+} posixRecvRequest_t;
+
+/**********************BSD (Private) Global Variables ********************************/
+static bsdErrno_t bsdErrorNumber;
+
+static packetReceptionHandler_t* packetRecvInfo;
+
+static posixRecvRequest_t recvRequests[MAX_SUPPORTED_SOCKETS];
+
+/**********************BSD (Private) Function Implementations ************************/
+static void bsd_setErrNo(bsdErrno_t errorNumber)
+{
+    bsdErrorNumber = errorNumber;
+}
+
+static int bsd_getSocketSlot(int sock)
+{
+    uint8_t i;
+
+    if (sock < 0 || packetRecvInfo == NULL)
+    {
+        return -1;
+    }
+    for (i = 0; i < MAX_SUPPORTED_SOCKETS; i++)
+    {
+        if (packetRecvInfo[i].socket && *(packetRecvInfo[i].socket) == sock)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**********************BSD (Public) Function Implementations **************************/
+bsdErrno_t BSD_GetErrNo(void)
+{
+    return bsdErrorNumber;
+}
+
+void BSD_SetRecvHandlerTable(packetReceptionHandler_t* appRecvInfo)
+{
+    packetRecvInfo = appRecvInfo;
+    memset(recvRequests, 0, sizeof(recvRequests));
+}
+
+packetReceptionHandler_t* BSD_GetRecvHandlerTable()
+{
+    return packetRecvInfo;
+}
+
+int BSD_socket(int domain, int type, int protocol)
+{
+    int sock;
+
+    if ((bsdDomain_t)domain != PF_INET)
+    {
+        bsd_setErrNo(EAFNOSUPPORT);
+        return BSD_ERROR;
+    }
+    if ((bsdTypes_t)type != BSD_SOCK_STREAM && (bsdTypes_t)type != BSD_SOCK_DGRAM)
+    {
+        bsd_setErrNo(EAFNOSUPPORT);
+        return BSD_ERROR;
+    }
+    if (protocol == POSIX_TLS)
+    {
+        debug_printWarn("  BSD: TLS not available on the host backend, using plain TCP");
+    }
+    else if (protocol != 0)
+    {
+        bsd_setErrNo(EINVAL);
+        return BSD_ERROR;
+    }
+
+    sock = BSD_HOST_socket((bsdTypes_t)type == BSD_SOCK_STREAM);
+    if (sock < 0)
+    {
+        debug_printError("  BSD: host socket failed");
+        bsd_setErrNo(EACCES);
+        return BSD_ERROR;
+    }
+    return sock;
+}
+
+int BSD_connect(int socket, const struct bsd_sockaddr* name, socklen_t namelen)
+{
+    const struct bsd_sockaddr_in* addr = (const struct bsd_sockaddr_in*)name;
+    int                           slot = bsd_getSocketSlot(socket);
+
+    if (slot < 0)
+    {
+        debug_printError("  BSD: connect error unknown socket number");
+        bsd_setErrNo(ENOTSOCK);
+        return BSD_ERROR;
+    }
+    if (name == NULL || namelen < (socklen_t)sizeof(struct bsd_sockaddr_in))
+    {
+        bsd_setErrNo(EINVAL);
+        return BSD_ERROR;
+    }
+    if (name->sa_family != PF_INET)
+    {
+        bsd_setErrNo(EAFNOSUPPORT);
+        return BSD_ERROR;
+    }
+
+    switch (BSD_HOST_connect(socket, addr->sin_addr.s_addr, addr->sin_port))
+    {
+        case BSD_HOST_OK:
+        case BSD_HOST_PENDING:
+            // Reported as connected by BSD_POSIX_Tasks(), like SOCKET_MSG_CONNECT
+            debug_printInfo("  BSD: socket (%d) in progress", socket);
+            packetRecvInfo[slot].socketState = SOCKET_IN_PROGRESS;
+            return BSD_SUCCESS;
+        default:
+            debug_printError("  BSD: connect error");
+            bsd_setErrNo(ECONNREFUSED);
+            return BSD_ERROR;
+    }
+}
+
+int BSD_send(int socket, const void* msg, size_t len, int flags)
+{
+    if (flags != 0)
+    {
+        bsd_setErrNo(EINVAL);
+        return BSD_ERROR;
+    }
+    if (socket < 0)
+    {
+        bsd_setErrNo(ENOTSOCK);
+        return BSD_ERROR;
+    }
+    if (msg == NULL)
+    {
+        bsd_setErrNo(EFAULT);
+        return BSD_ERROR;
+    }
+
+    // All or nothing, as with the WINC send()
+    if (BSD_HOST_send(socket, msg, len) < 0)
+    {
+        debug_printError("  BSD: host send failed");
+        bsd_setErrNo(EIO);
+        return BSD_ERROR;
+    }
+    return len;
+}
+
+int BSD_recv(int socket, const void* buf, size_t len, int flags)
+{
+    int slot;
+
+    if (flags != 0)
+    {
+        bsd_setErrNo(EINVAL);
+        return BSD_ERROR;
+    }
+    slot = bsd_getSocketSlot(socket);
+    if (slot < 0)
+    {
+        bsd_setErrNo(ENOTSOCK);
+        return BSD_ERROR;
+    }
+    if (buf == NULL)
+    {
+        bsd_setErrNo(EFAULT);
+        return BSD_ERROR;
+    }
+    if (len == 0)
+    {
+        bsd_setErrNo(EMSGSIZE);
+        return BSD_ERROR;
+    }
+
+    recvRequests[slot].buf    = (uint8_t*)buf;
+    recvRequests[slot].len    = (len > UINT16_MAX) ? UINT16_MAX : len;   // SOCKET_MSG_RECV size is 16 bit
+    recvRequests[slot].posted = true;
+    return BSD_SUCCESS;
+}
+
+int BSD_close(int socket)
+{
+    int slot = bsd_getSocketSlot(socket);
+
+    debug_printGood("  BSD: BSD_close (%d) ", socket);
+    if (slot >= 0)
+    {
+        packetRecvInfo[slot].socketState = NOT_A_SOCKET;
+        recvRequests[slot].posted        = false;
+    }
+    if (socket < 0)
+    {
+        bsd_setErrNo(EBADF);
+        return BSD_ERROR;
+    }
+    BSD_HOST_close(socket);
+    return BSD_SUCCESS;
+}
+
+uint32_t BSD_htonl(uint32_t hostlong)
+{
+    return BSD_HOST_htonl(hostlong);
+}
+
+uint16_t BSD_htons(uint16_t hostshort)
+{
+    return BSD_HOST_htons(hostshort);
+}
+
+uint32_t BSD_ntohl(uint32_t netlong)
+{
+    return BSD_HOST_htonl(netlong);
+}
+
+uint16_t BSD_ntohs(uint16_t netshort)
+{
+    return BSD_HOST_htons(netshort);
+}
+
+int BSD_bind(int socket, const struct bsd_sockaddr* addr, socklen_t addrlen)
+{
+    bsd_setErrNo(ENOSYS);
+    return BSD_ERROR;
+}
+
+int BSD_recvfrom(int socket, void* buf, size_t len, int flags, struct bsd_sockaddr* from, socklen_t* fromlen)
+{
+    bsd_setErrNo(ENOSYS);
+    return BSD_ERROR;
+}
+
+int BSD_listen(int socket, int backlog)
+{
+    bsd_setErrNo(ENOSYS);
+    return BSD_ERROR;
+}
+
+int BSD_accept(int socket, struct bsd_sockaddr* addr, socklen_t* addrlen)
+{
+    bsd_setErrNo(ENOSYS);
+    return BSD_ERROR;
+}
+
+int BSD_getsockopt(int socket, int level, int optname, void* optval, socklen_t* optlen)
+{
+    bsd_setErrNo(ENOSYS);
+    return BSD_ERROR;
+}
+
+int BSD_setsockopt(int socket, int level, int optname, const void* optval, socklen_t optlen)
+{
+    if (level != POSIX_SOL_SOCKET && level != POSIX_SOL_SSL_SOCKET)
+    {
+        bsd_setErrNo(EIO);
+        return BSD_ERROR;
+    }
+    if (optname < 1 || optname > POSIX_SO_SSL_LAST)
+    {
+        bsd_setErrNo(EIO);
+        return BSD_ERROR;
+    }
+    if (socket < 0)
+    {
+        bsd_setErrNo(ENOTSOCK);
+        return BSD_ERROR;
+    }
+    // SSL options have nothing to act on over plain TCP
+    return BSD_SUCCESS;
+}
+
+int BSD_write(int fd, const void* buf, size_t nbytes)
+{
+    bsd_setErrNo(ENOSYS);
+    return BSD_ERROR;
+}
+
+int BSD_read(int fd, void* buf, size_t nbytes)
+{
+    bsd_setErrNo(ENOSYS);
+    return BSD_ERROR;
+}
+
+int BSD_poll(struct pollfd* ufds, unsigned int nfds, int timeout)
+{
+    bsd_setErrNo(ENOSYS);
+    return BSD_ERROR;
+}
+
+int BSD_sendto(int socket, const void* msg, size_t len, int flags, const struct bsd_sockaddr* to, socklen_t tolen)
+{
+    bsd_setErrNo(ENOSYS);
+    return BSD_ERROR;
+}
+
+// cloud_service marks a new socket SOCKET_CLOSED through this, as with bsdWINC.c
+packetReceptionHandler_t* getSocketInfo(uint8_t sock)
+{
+    int slot = bsd_getSocketSlot(sock);
+
+    return (slot < 0) ? NULL : &packetRecvInfo[slot];
+}
+
+socketState_t BSD_GetSocketState(int sock)
+{
+    int slot = bsd_getSocketSlot(sock);
+
+    return (slot < 0) ? NOT_A_SOCKET : packetRecvInfo[slot].socketState;
+}
+
+void BSD_SocketHandler(int8_t sock, uint8_t msgType, void* pMsg)
+{
+    // Socket events come from BSD_POSIX_Tasks() on the host
+    debug_printError("  BSD: msgType (%d) unexpected on the host backend", msgType);
+}
+
+void BSD_POSIX_Tasks(void)
+{
+    packetReceptionHandler_t* info;
+    posixRecvRequest_t*       request;
+    uint8_t                   i;
+    int                       sock;
+    int                       received;
+
+    if (packetRecvInfo == NULL)
+    {
+        return;
+    }
+
+    for (i = 0; i < MAX_SUPPORTED_SOCKETS; i++)
+    {
+        info    = &packetRecvInfo[i];
+        request = &recvRequests[i];
+        if (info->socket == NULL || *(info->socket) < 0)
+        {
+            continue;
+        }
+        sock = *(info->socket);
+
+        if (info->socketState == SOCKET_IN_PROGRESS)
+        {
+            switch (BSD_HOST_connectDone(sock))
+            {
+                case BSD_HOST_OK:
+                    debug_printGood("  BSD: MSG_CONNECT successful");
+                    info->socketState = SOCKET_CONNECTED;
+                    break;
+                case BSD_HOST_PENDING:
+                    break;
+                default:
+                    debug_printError("  BSD: Closing Socket in MSG_CONNECT error");
+                    BSD_close(sock);
+                    break;
+            }
+            continue;
+        }
+
+        if (info->socketState != SOCKET_CONNECTED || !request->posted)
+        {
+            continue;
+        }
+
+        received = BSD_HOST_recv(sock, request->buf, request->len);
+        if (received > 0)
+        {
+            debug_printTrace("  BSD: SOCKET (%d) SIZE %d", sock, received);
+            // The handler may post the next receive
+            request->posted = false;
+            info->recvCallBack(request->buf, (uint16_t)received);
+        }
+        else if (received < 0)
+        {
+            debug_printError("  BSD: SOCKET_MSG_RECV (%d) CLOSED", sock);
+            BSD_close(sock);
+        }
+    }
+}
+
+#endif /* BSD_POSIX_BACKEND */
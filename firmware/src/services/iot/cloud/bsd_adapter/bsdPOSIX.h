@@ -0,0 +1,67 @@
+/********************************************************************
+ *
+ (c) [2018] Microchip Technology Inc. and its subsidiaries.
+
+   Subject to your compliance with these terms, you may use Microchip software  
+ * and any derivatives exclusively with Microchip products. It is your 
+ * responsibility to comply with third party license terms applicable to your 
+ * use of third party software (including open source software) that may 
+ * accompany Microchip software.
+   THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER  
+ * EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY IMPLIED 
+ * WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS FOR A PARTICULAR 
+ * PURPOSE.
+ * 
+   IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, 
+ * INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND 
+ * WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS 
+ * BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO THE 
+ * FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN 
+ * ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY, 
+ * THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+ *************************************************************************
+ *
+ *                           bsdPOSIX.h
+ *
+ * About: Host socket backend for the BSD adapter
+ *
+ ******************************************************************************/
+
+#ifndef BSD_POSIX_H
+#define BSD_POSIX_H
+
+// The host backend replaces bsdWINC.c when the MQTT/cloud stack is built for a
+// workstation with BSD_POSIX_BACKEND defined. bsdWINC.h redefines socklen_t,
+// struct pollfd, PF_* and the errno names, so it cannot share a translation
+// unit with the system socket headers. bsdPOSIX.c implements the BSD_* API on
+// top of the primitives below, and bsdPOSIX_host.c implements the primitives
+// with the system headers. Only plain C types cross between the two.
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+typedef enum
+{
+    BSD_HOST_OK = 0,
+    BSD_HOST_PENDING,
+    BSD_HOST_ERROR,
+} bsdHostResult_t;
+
+/***************** Host Socket Primitives **************************************/
+int             BSD_HOST_socket(bool stream);
+bsdHostResult_t BSD_HOST_connect(int fd, uint32_t addr, uint16_t port);   // network byte order
+bsdHostResult_t BSD_HOST_connectDone(int fd);
+int             BSD_HOST_send(int fd, const void* msg, size_t len);       // len, or -1
+int             BSD_HOST_recv(int fd, void* buf, size_t len);             // bytes, 0 if none yet, -1 if closed
+void            BSD_HOST_close(int fd);
+uint32_t        BSD_HOST_resolve(const char* host);                       // IPv4 address in network byte order, 0 if unknown
+uint32_t        BSD_HOST_htonl(uint32_t hostlong);
+uint16_t        BSD_HOST_htons(uint16_t hostshort);
+
+/***************** Host Backend Public Functions *******************************/
+// Call from the host main loop where the firmware calls WDRV_WINC_Tasks(). It
+// completes pending connects and delivers data for receives posted by BSD_recv.
+void BSD_POSIX_Tasks(void);
+
+#endif /* BSD_POSIX_H */
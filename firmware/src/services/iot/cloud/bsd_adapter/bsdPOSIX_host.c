@@ -0,0 +1,189 @@
+/********************************************************************
+ *
+ (c) [2018] Microchip Technology Inc. and its subsidiaries.
+
+   Subject to your compliance with these terms, you may use Microchip software  
+ * and any derivatives exclusively with Microchip products. It is your 
+ * responsibility to comply with third party license terms applicable to your 
+ * use of third party software (including open source software) that may 
+ * accompany Microchip software.
+   THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER  
+ * EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY IMPLIED 
+ * WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS FOR A PARTICULAR 
+ * PURPOSE.
+ * 
+   IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, 
+ * INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND 
+ * WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS 
+ * BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO THE 
+ * FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN 
+ * ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY, 
+ * THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+ *************************************************************************
+ *
+ *                           bsdPOSIX_host.c
+ *
+ * About: Host socket primitives for bsdPOSIX.c
+ *
+ ******************************************************************************/
+
+#ifdef BSD_POSIX_BACKEND
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <string.h>
+#include <unistd.h>
+#include <netdb.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include "bsdPOSIX.h"
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+#define BSD_HOST_SEND_TIMEOUT_MS 5000
+#define BSD_HOST_MAX_FD          127   // socket numbers are int8_t in the application tables
+
+int BSD_HOST_socket(bool stream)
+{
+    int fd;
+    int one = 1;
+
+    fd = socket(AF_INET, stream ? SOCK_STREAM : SOCK_DGRAM, 0);
+    if (fd < 0)
+    {
+        return -1;
+    }
+    if (fd > BSD_HOST_MAX_FD || fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK) < 0)
+    {
+        close(fd);
+        return -1;
+    }
+    if (stream)
+    {
+        // MQTT packets are small and sent whole, as the WINC does
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    }
+    return fd;
+}
+
+bsdHostResult_t BSD_HOST_connect(int fd, uint32_t addr, uint16_t port)
+{
+    struct sockaddr_in sin;
+
+    memset(&sin, 0, sizeof(sin));
+    sin.sin_family      = AF_INET;
+    sin.sin_port        = port;
+    sin.sin_addr.s_addr = addr;
+
+    if (connect(fd, (struct sockaddr*)&sin, sizeof(sin)) == 0)
+    {
+        return BSD_HOST_OK;
+    }
+    return (errno == EINPROGRESS) ? BSD_HOST_PENDING : BSD_HOST_ERROR;
+}
+
+bsdHostResult_t BSD_HOST_connectDone(int fd)
+{
+    struct pollfd pfd = {.fd = fd, .events = POLLOUT};
+    int           error;
+    socklen_t     length = sizeof(error);
+
+    if (poll(&pfd, 1, 0) == 0)
+    {
+        return BSD_HOST_PENDING;
+    }
+    if (getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &length) < 0 || error != 0)
+    {
+        return BSD_HOST_ERROR;
+    }
+    return BSD_HOST_OK;
+}
+
+int BSD_HOST_send(int fd, const void* msg, size_t len)
+{
+    const uint8_t* data = msg;
+    size_t         sent = 0;
+    ssize_t        written;
+    struct pollfd  pfd = {.fd = fd, .events = POLLOUT};
+
+    while (sent < len)
+    {
+        written = send(fd, data + sent, len - sent, MSG_NOSIGNAL);
+        if (written > 0)
+        {
+            sent += (size_t)written;
+        }
+        else if (written < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        else if (written < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        {
+            if (poll(&pfd, 1, BSD_HOST_SEND_TIMEOUT_MS) <= 0)
+            {
+                return -1;
+            }
+        }
+        else
+        {
+            return -1;
+        }
+    }
+    return (int)len;
+}
+
+int BSD_HOST_recv(int fd, void* buf, size_t len)
+{
+    ssize_t received = recv(fd, buf, len, 0);
+
+    if (received > 0)
+    {
+        return (int)received;
+    }
+    if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR))
+    {
+        return 0;
+    }
+    // Orderly shutdown by the peer or a socket error
+    return -1;
+}
+
+void BSD_HOST_close(int fd)
+{
+    close(fd);
+}
+
+uint32_t BSD_HOST_resolve(const char* host)
+{
+    struct addrinfo  hints;
+    struct addrinfo* result;
+    uint32_t         addr = 0;
+
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family   = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+
+    if (getaddrinfo(host, NULL, &hints, &result) == 0)
+    {
+        addr = ((struct sockaddr_in*)result->ai_addr)->sin_addr.s_addr;
+        freeaddrinfo(result);
+    }
+    return addr;
+}
+
+uint32_t BSD_HOST_htonl(uint32_t hostlong)
+{
+    return htonl(hostlong);
+}
+
+uint16_t BSD_HOST_htons(uint16_t hostshort)
+{
+    return htons(hostshort);
+}
+
+#endif /* BSD_POSIX_BACKEND */
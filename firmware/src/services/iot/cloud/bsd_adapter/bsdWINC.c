@@ -27,6 +27,8 @@
  *
  * 
  ******************************************************************************/
+#define DEBUG_MODULE BSD
+
 #include <stdint.h>
 #include <stdbool.h>
 #include <string.h>
@@ -35,6 +37,7 @@
 #include "../../../../iot_config/IoT_Sensor_Node_config.h"
 #include "socket.h"
 #include "debug_print.h"
+#include "metrics.h"
 
 #define MAX_SUPPORTED_SOCKETS 2
 /**********************BSD (WINC) Enumerator Translators ********************************/
@@ -99,6 +102,7 @@ static packetReceptionHandler_t* packetRecvInfo;
 
 /**********************BSD (Private) Function Prototypes *****************************/
 static void bsd_setErrNo(bsdErrno_t errorNumber);
+static void bsd_setTransportErrNo(bsdErrno_t errorNumber);
 
 /**********************BSD (Private) Function Implementations ************************/
 static void bsd_setErrNo(bsdErrno_t errorNumber)
@@ -106,6 +110,14 @@ static void bsd_setErrNo(bsdErrno_t errorNumber)
     bsdErrorNumber = errorNumber;
 }
 
+// For failures the WINC reports on a valid request. Argument checks use
+// bsd_setErrNo() and stay out of the SOCKET_ERRORS count.
+static void bsd_setTransportErrNo(bsdErrno_t errorNumber)
+{
+    bsdErrorNumber = errorNumber;
+    METRIC_INC(SOCKET_ERRORS);
+}
+
 /**********************BSD (Public) Function Implementations **************************/
 bsdErrno_t BSD_GetErrNo(void)
 {
@@ -114,21 +126,21 @@ bsdErrno_t BSD_GetErrNo(void)
 
 packetReceptionHandler_t* getSocketInfo(uint8_t sock)
 {
-    uint8_t i = 0;
-    if (sock >= 0)
+    uint8_t                   i             = 0;
+    packetReceptionHandler_t* bsdSocketInfo = BSD_GetRecvHandlerTable();
+
+    // CLOUD_task() asks before the first reInit() sets the table
+    if (bsdSocketInfo == NULL)
     {
-        packetReceptionHandler_t* bsdSocketInfo = BSD_GetRecvHandlerTable();
-        for (i = 0; i < MAX_SUPPORTED_SOCKETS; i++)
+        return NULL;
+    }
+    for (i = 0; i < MAX_SUPPORTED_SOCKETS; i++)
+    {
+        if (bsdSocketInfo->socket && *(bsdSocketInfo->socket) == sock)
         {
-            if (bsdSocketInfo)
-            {
-                if (*(bsdSocketInfo->socket) == sock)
-                {
-                    return bsdSocketInfo;
-                }
-            }
-            bsdSocketInfo++;
+            return bsdSocketInfo;
         }
+        bsdSocketInfo++;
     }
     return NULL;
 }
@@ -229,7 +241,7 @@ int BSD_connect(int socket, const struct bsd_sockaddr* name, socklen_t namelen)
                         }
                         break;
                     case WINC_SOCK_ERR_INVALID:
-                        bsd_setErrNo(EIO);
+                        bsd_setTransportErrNo(EIO);
                         break;
                     default:
                         break;
@@ -299,7 +311,7 @@ int BSD_recv(int socket, const void* buf, size_t len, int flags)
                 break;
             case WINC_SOCK_ERR_BUFFER_FULL:
                 debug_printError("  BSD: BSD: ERR_BUFFER_FULL");
-                bsd_setErrNo(ENOBUFS);
+                bsd_setTransportErrNo(ENOBUFS);
                 break;
             default:
                 debug_printError("  BSD: BSD: (%d)", wincRecvReturn);
@@ -471,7 +483,7 @@ int BSD_recvfrom(int socket, void* buf, size_t len, int flags, struct bsd_sockad
                 }
                 break;
             case WINC_SOCK_ERR_BUFFER_FULL:
-                bsd_setErrNo(ENOBUFS);
+                bsd_setTransportErrNo(ENOBUFS);
                 break;
             default:
                 break;
@@ -696,7 +708,7 @@ int BSD_send(int socket, const void* msg, size_t len, int flags)
                 }
                 break;
             case WINC_SOCK_ERR_BUFFER_FULL:
-                bsd_setErrNo(ENOBUFS);
+                bsd_setTransportErrNo(ENOBUFS);
                 break;
             default:
                 break;
@@ -710,6 +722,7 @@ int BSD_send(int socket, const void* msg, size_t len, int flags)
         // successfully send the packet, 'len' number of bytes will
         // be transmitted. In this case, it is safe to return the
         // value of 'len' as the number of bytes sent.
+        METRIC_ADD(SOCKET_TX_BYTES, len);
         return len;
     }
 }
@@ -764,7 +777,7 @@ int BSD_sendto(int socket, const void* msg, size_t len, int flags, const struct
                 }
                 break;
             case SOCK_ERR_BUFFER_FULL:
-                bsd_setErrNo(ENOBUFS);
+                bsd_setTransportErrNo(ENOBUFS);
                 break;
             default:
                 break;
@@ -807,6 +820,7 @@ void BSD_SocketHandler(int8_t sock, uint8_t msgType, void* pMsg)
                 else
                 {
                     debug_printError("  BSD: Closing Socket in MSG_CONNECT error (%d)", pstrConnect->s8Error);
+                    METRIC_INC(SOCKET_ERRORS);
                     BSD_close(sock);
                 }
             }
@@ -825,12 +839,14 @@ void BSD_SocketHandler(int8_t sock, uint8_t msgType, void* pMsg)
 
                 if (pstrRecv->s16BufferSize > 0)
                 {
+                    METRIC_ADD(SOCKET_RX_BYTES, pstrRecv->s16BufferSize);
                     bsdSocketInfo->recvCallBack(pstrRecv->pu8Buffer, pstrRecv->s16BufferSize);
                     bsdSocketInfo->socketState = SOCKET_CONNECTED;
                 }
                 else
                 {
                     debug_printError("  BSD: SOCKET_MSG_RECV (%d) CLOSED for error %d", sock, pstrRecv->s16BufferSize);
+                    METRIC_INC(SOCKET_ERRORS);
                     BSD_close(sock);
                 }
             }
@@ -848,6 +864,7 @@ void BSD_SocketHandler(int8_t sock, uint8_t msgType, void* pMsg)
                 else
                 {
                     debug_printError("  BSD: SOCKET_MSG_RECVFROM (%d) CLOSED for error %d", sock, pstrRecv->s16BufferSize);
+                    METRIC_INC(SOCKET_ERRORS);
                     BSD_close(sock);
                 }
             }
@@ -0,0 +1,560 @@
+/********************************************************************
+ *
+ (c) [2018] Microchip Technology Inc. and its subsidiaries.
+
+   Subject to your compliance with these terms, you may use Microchip software  
+ * and any derivatives exclusively with Microchip products. It is your 
+ * responsibility to comply with third party license terms applicable to your 
+ * use of third party software (including open source software) that may 
+ * accompany Microchip software.
+   THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER  
+ * EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY IMPLIED 
+ * WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS FOR A PARTICULAR 
+ * PURPOSE.
+ * 
+   IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, 
+ * INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND 
+ * WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS 
+ * BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO THE 
+ * FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN 
+ * ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY, 
+ * THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+ *************************************************************************
+ *
+ *                           wincSocketSim.c
+ *
+ * About: Scripted WINC socket API for off-target runs
+ *
+ ******************************************************************************/
+
+#ifdef WINC_SOCKET_SIM
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "socket.h"
+#include "wincSocketSim.h"
+
+#define SIM_HOSTNAME_MAX 64
+
+typedef struct
+{
+    bool     used;
+    bool     connected;
+    bool     resetPending;   // reset arrived with no receive posted
+    uint8_t* recvBuf;
+    uint16_t recvLen;        // 0 when no receive is posted
+    uint32_t recvDeadlineMs;   // 0 waits forever, as recv() with no timeout
+} simSocket_t;
+
+typedef struct
+{
+    bool     used;
+    uint32_t sequence;   // keeps callbacks due at the same time in request order
+    uint32_t dueMs;
+    SOCKET   sock;
+    uint8_t  msg;
+    int32_t  value;
+} simEvent_t;
+
+wincSimStats_t wincSimStats;
+
+static tpfAppSocketCb  simSocketCb;
+static tpfAppResolveCb simResolveCb;
+
+static simSocket_t simSockets[TCP_SOCK_MAX];
+static simEvent_t  simEvents[WINC_SIM_MAX_EVENTS];
+static uint32_t    simSequence;
+static uint32_t    simNowMs;
+
+static const wincSimStep_t* simScript;
+static wincSimConfig_t      simConfig;
+static wincSimSendHook_t    simSendHook;
+static uint16_t             simStep;
+static uint32_t             simStepReadyMs;
+static uint32_t             simStepSent;
+static uint16_t             simStepOffset;
+static bool                 simStepCounted;
+static uint16_t             simRecvSteps;
+
+static SOCKET   simActiveSock = -1;   // the connection RECV and RESET steps act on
+static bool     simResolveRequested;
+static char     simResolveHost[SIM_HOSTNAME_MAX];
+static bool     simConnectRequested;
+static SOCKET   simConnectSock;
+
+static bool sim_validSocket(SOCKET sock)
+{
+    return (sock >= 0) && (sock < TCP_SOCK_MAX) && simSockets[sock].used;
+}
+
+static bool sim_queueEvent(SOCKET sock, uint8_t msg, int32_t value)
+{
+    uint8_t i;
+
+    for (i = 0; i < WINC_SIM_MAX_EVENTS; i++)
+    {
+        if (!simEvents[i].used)
+        {
+            simEvents[i].used     = true;
+            simEvents[i].sequence = simSequence++;
+            simEvents[i].dueMs    = simNowMs + simConfig.latencyMs;
+            simEvents[i].sock     = sock;
+            simEvents[i].msg      = msg;
+            simEvents[i].value    = value;
+            return true;
+        }
+    }
+    return false;
+}
+
+static void sim_deliverRecv(SOCKET sock, int16_t size)
+{
+    simSocket_t*      s = &simSockets[sock];
+    tstrSocketRecvMsg recvMsg;
+
+    memset(&recvMsg, 0, sizeof(recvMsg));
+    recvMsg.pu8Buffer     = s->recvBuf;
+    recvMsg.s16BufferSize = size;
+
+    // Cleared first, the callback may post the next receive
+    s->recvLen = 0;
+    if (size < 0)
+    {
+        s->connected = false;
+    }
+    if (simSocketCb)
+    {
+        simSocketCb(sock, SOCKET_MSG_RECV, &recvMsg);
+    }
+}
+
+static void sim_dispatch(simEvent_t* event)
+{
+    tstrSocketConnectMsg connectMsg;
+    int16_t              sent;
+
+    event->used = false;
+    switch (event->msg)
+    {
+        case SOCKET_MSG_DNS_RESOLVE:
+            if (simResolveCb)
+            {
+                simResolveCb((uint8_t*)simResolveHost, (uint32_t)event->value);
+            }
+            break;
+
+        case SOCKET_MSG_CONNECT:
+            if (!sim_validSocket(event->sock))
+            {
+                break;
+            }
+            connectMsg.sock    = event->sock;
+            connectMsg.s8Error = (int8_t)event->value;
+            if (event->value >= 0)
+            {
+                simSockets[event->sock].connected = true;
+                simActiveSock                     = event->sock;
+                wincSimStats.connectedMs          = simNowMs;
+            }
+            if (simSocketCb)
+            {
+                simSocketCb(event->sock, SOCKET_MSG_CONNECT, &connectMsg);
+            }
+            break;
+
+        case SOCKET_MSG_SEND:
+            sent = (int16_t)event->value;
+            if (sim_validSocket(event->sock) && simSocketCb)
+            {
+                simSocketCb(event->sock, SOCKET_MSG_SEND, &sent);
+            }
+            break;
+
+        case SOCKET_MSG_RECV:
+            if (sim_validSocket(event->sock) && simSockets[event->sock].recvLen != 0)
+            {
+                sim_deliverRecv(event->sock, (int16_t)event->value);
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+
+static void sim_dispatchDue(void)
+{
+    simEvent_t* next;
+    uint8_t     i;
+
+    do
+    {
+        next = NULL;
+        for (i = 0; i < WINC_SIM_MAX_EVENTS; i++)
+        {
+            if (simEvents[i].used && simEvents[i].dueMs <= simNowMs
+                && (next == NULL || simEvents[i].sequence < next->sequence))
+            {
+                next = &simEvents[i];
+            }
+        }
+        if (next)
+        {
+            sim_dispatch(next);
+        }
+    } while (next);
+}
+
+static void sim_nextStep(void)
+{
+    simStep++;
+    simStepReadyMs = simNowMs + simScript[simStep].delayMs;
+    simStepSent    = 0;
+    simStepOffset  = 0;
+    simStepCounted = false;
+}
+
+// Runs script steps until one has to wait for the application or the clock
+static void sim_runScript(void)
+{
+    const wincSimStep_t* step;
+    simSocket_t*         s;
+    uint16_t             chunk;
+    uint32_t             readyMs;
+
+    while (simScript)
+    {
+        step    = &simScript[simStep];
+        readyMs = simStepReadyMs;
+        if (step->type == WINC_SIM_RECV || step->type == WINC_SIM_RESET)
+        {
+            // Requests pick up the latency when their callback is queued
+            readyMs += simConfig.latencyMs;
+        }
+        if (step->type == WINC_SIM_END || simNowMs < readyMs)
+        {
+            return;
+        }
+
+        switch (step->type)
+        {
+            case WINC_SIM_RESOLVE:
+                if (!simResolveRequested)
+                {
+                    return;
+                }
+                simResolveRequested = false;
+                sim_queueEvent(-1, SOCKET_MSG_DNS_RESOLVE, step->value);
+                break;
+
+            case WINC_SIM_CONNECT:
+                if (!simConnectRequested)
+                {
+                    return;
+                }
+                simConnectRequested = false;
+                sim_queueEvent(simConnectSock, SOCKET_MSG_CONNECT, step->value);
+                break;
+
+            case WINC_SIM_AWAIT_SEND:
+                if (simStepSent == 0 || simStepSent < step->length)
+                {
+                    return;
+                }
+                break;
+
+            case WINC_SIM_RECV:
+                if (!simStepCounted)
+                {
+                    simStepCounted = true;
+                    simRecvSteps++;
+                    if (simConfig.dropEvery && (simRecvSteps % simConfig.dropEvery) == 0)
+                    {
+                        wincSimStats.dropped++;
+                        break;
+                    }
+                }
+                if (step->data == NULL || step->length == 0)
+                {
+                    break;
+                }
+                if (!sim_validSocket(simActiveSock))
+                {
+                    return;
+                }
+                s = &simSockets[simActiveSock];
+                if (!s->connected || s->recvLen == 0)
+                {
+                    return;
+                }
+                chunk = step->length - simStepOffset;
+                if (chunk > s->recvLen)
+                {
+                    chunk = s->recvLen;
+                }
+                if (simConfig.segmentMax && chunk > simConfig.segmentMax)
+                {
+                    chunk = simConfig.segmentMax;
+                }
+                memcpy(s->recvBuf, step->data + simStepOffset, chunk);
+                simStepOffset += chunk;
+                wincSimStats.recvSegments++;
+                wincSimStats.bytesReceived += chunk;
+                wincSimStats.lastRecvMs = simNowMs;
+                sim_deliverRecv(simActiveSock, (int16_t)chunk);
+                if (simStepOffset < step->length)
+                {
+                    // The rest waits for the next posted receive
+                    continue;
+                }
+                break;
+
+            case WINC_SIM_RESET:
+                wincSimStats.resets++;
+                wincSimStats.resetMs = simNowMs;
+                if (sim_validSocket(simActiveSock))
+                {
+                    s = &simSockets[simActiveSock];
+                    if (s->recvLen != 0)
+                    {
+                        sim_deliverRecv(simActiveSock, SOCK_ERR_CONN_ABORTED);
+                    }
+                    else
+                    {
+                        s->connected    = false;
+                        s->resetPending = true;
+                    }
+                }
+                break;
+
+            default:
+                return;
+        }
+        sim_nextStep();
+    }
+}
+
+static void sim_checkRecvTimeouts(void)
+{
+    SOCKET sock;
+
+    for (sock = 0; sock < TCP_SOCK_MAX; sock++)
+    {
+        simSocket_t* s = &simSockets[sock];
+
+        if (s->used && s->recvLen != 0 && s->recvDeadlineMs != 0 && simNowMs >= s->recvDeadlineMs)
+        {
+            sim_deliverRecv(sock, SOCK_ERR_TIMEOUT);
+        }
+    }
+}
+
+/**********************Simulator (Public) Function Implementations ********************/
+void WINC_SIM_init(const wincSimStep_t* script, const wincSimConfig_t* config, wincSimSendHook_t sendHook)
+{
+    socketInit();
+    memset(&wincSimStats, 0, sizeof(wincSimStats));
+    memset(&simConfig, 0, sizeof(simConfig));
+    if (config)
+    {
+        simConfig = *config;
+    }
+    simScript           = script;
+    simSendHook         = sendHook;
+    simNowMs            = 0;
+    simStep             = 0;
+    simStepSent         = 0;
+    simStepOffset       = 0;
+    simStepCounted      = false;
+    simRecvSteps        = 0;
+    simResolveRequested = false;
+    simConnectRequested = false;
+    simStepReadyMs      = script ? script[0].delayMs : 0;
+}
+
+void WINC_SIM_Tasks(uint32_t nowMs)
+{
+    simNowMs = nowMs;
+    sim_dispatchDue();
+    sim_runScript();
+    sim_checkRecvTimeouts();
+}
+
+bool WINC_SIM_done(void)
+{
+    return (simScript == NULL) || (simScript[simStep].type == WINC_SIM_END);
+}
+
+/**********************WINC socket.h API Implementations *****************************/
+void socketInit(void)
+{
+    memset(simSockets, 0, sizeof(simSockets));
+    memset(simEvents, 0, sizeof(simEvents));
+    simActiveSock = -1;
+}
+
+void socketDeinit(void)
+{
+    socketInit();
+    simSocketCb  = NULL;
+    simResolveCb = NULL;
+}
+
+uint8_t IsSocketReady(void)
+{
+    return 1;
+}
+
+void registerSocketCallback(tpfAppSocketCb socket_cb, tpfAppResolveCb resolve_cb)
+{
+    simSocketCb  = socket_cb;
+    simResolveCb = resolve_cb;
+}
+
+void registerSocketEventCallback(tpfAppSocketCb socket_cb)
+{
+    simSocketCb = socket_cb;
+}
+
+void registerSocketResolveCallback(tpfAppResolveCb resolve_cb)
+{
+    simResolveCb = resolve_cb;
+}
+
+SOCKET socket(uint16_t u16Domain, uint8_t u8Type, uint8_t u8Flags)
+{
+    SOCKET sock;
+
+    if (u16Domain != AF_INET || u8Type != SOCK_STREAM)
+    {
+        return -1;
+    }
+    for (sock = 0; sock < TCP_SOCK_MAX; sock++)
+    {
+        if (!simSockets[sock].used)
+        {
+            memset(&simSockets[sock], 0, sizeof(simSockets[sock]));
+            simSockets[sock].used = true;
+            return sock;
+        }
+    }
+    return -1;
+}
+
+int8_t connect(SOCKET sock, struct sockaddr* pstrAddr, uint8_t u8AddrLen)
+{
+    if (!sim_validSocket(sock) || pstrAddr == NULL || u8AddrLen == 0)
+    {
+        return SOCK_ERR_INVALID_ARG;
+    }
+    wincSimStats.connects++;
+    wincSimStats.connectRequestMs = simNowMs;
+    if (simScript == NULL || simScript[simStep].type != WINC_SIM_CONNECT)
+    {
+        wincSimStats.unanswered++;
+    }
+    simConnectRequested = true;
+    simConnectSock      = sock;
+    return SOCK_ERR_NO_ERROR;
+}
+
+int16_t send(SOCKET sock, void* pvSendBuffer, uint16_t u16SendLength, uint16_t u16Flags)
+{
+    if (!sim_validSocket(sock) || pvSendBuffer == NULL || u16SendLength == 0)
+    {
+        return SOCK_ERR_INVALID_ARG;
+    }
+    if (!simSockets[sock].connected)
+    {
+        return SOCK_ERR_INVALID;
+    }
+    if (!sim_queueEvent(sock, SOCKET_MSG_SEND, (int16_t)u16SendLength))
+    {
+        return SOCK_ERR_BUFFER_FULL;
+    }
+    if (simSendHook)
+    {
+        simSendHook(simNowMs, pvSendBuffer, u16SendLength);
+    }
+    wincSimStats.sends++;
+    wincSimStats.bytesSent += u16SendLength;
+    wincSimStats.lastSendMs = simNowMs;
+    simStepSent += u16SendLength;
+    return SOCK_ERR_NO_ERROR;
+}
+
+int16_t recv(SOCKET sock, void* pvRecvBuf, uint16_t u16BufLen, uint32_t u32Timeoutmsec)
+{
+    simSocket_t* s;
+
+    if (!sim_validSocket(sock) || pvRecvBuf == NULL || u16BufLen == 0)
+    {
+        return SOCK_ERR_INVALID_ARG;
+    }
+    s                 = &simSockets[sock];
+    s->recvBuf        = pvRecvBuf;
+    s->recvLen        = u16BufLen;
+    s->recvDeadlineMs = u32Timeoutmsec ? simNowMs + u32Timeoutmsec : 0;
+    if (s->resetPending)
+    {
+        s->resetPending = false;
+        sim_queueEvent(sock, SOCKET_MSG_RECV, SOCK_ERR_CONN_ABORTED);
+    }
+    return SOCK_ERR_NO_ERROR;
+}
+
+int8_t shutdown(SOCKET sock)
+{
+    uint8_t i;
+
+    if (!sim_validSocket(sock))
+    {
+        return SOCK_ERR_INVALID_ARG;
+    }
+    memset(&simSockets[sock], 0, sizeof(simSockets[sock]));
+    for (i = 0; i < WINC_SIM_MAX_EVENTS; i++)
+    {
+        if (simEvents[i].sock == sock)
+        {
+            simEvents[i].used = false;
+        }
+    }
+    if (simActiveSock == sock)
+    {
+        simActiveSock = -1;
+    }
+    if (simConnectRequested && simConnectSock == sock)
+    {
+        simConnectRequested = false;
+    }
+    return SOCK_ERR_NO_ERROR;
+}
+
+int8_t setsockopt(SOCKET socket, uint8_t u8Level, uint8_t option_name, const void* option_value, uint16_t u16OptionLen)
+{
+    if (!sim_validSocket(socket) || option_value == NULL)
+    {
+        return SOCK_ERR_INVALID_ARG;
+    }
+    return SOCK_ERR_NO_ERROR;
+}
+
+int8_t gethostbyname(const char* pcHostName)
+{
+    if (pcHostName == NULL)
+    {
+        return SOCK_ERR_INVALID_ARG;
+    }
+    wincSimStats.resolves++;
+    if (simScript == NULL || simScript[simStep].type != WINC_SIM_RESOLVE)
+    {
+        wincSimStats.unanswered++;
+    }
+    strncpy(simResolveHost, pcHostName, sizeof(simResolveHost) - 1);
+    simResolveHost[sizeof(simResolveHost) - 1] = '\0';
+    simResolveRequested                        = true;
+    return SOCK_ERR_NO_ERROR;
+}
+
+#endif /* WINC_SOCKET_SIM */
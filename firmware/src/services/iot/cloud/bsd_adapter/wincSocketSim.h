@@ -0,0 +1,99 @@
+/********************************************************************
+ *
+ (c) [2018] Microchip Technology Inc. and its subsidiaries.
+
+   Subject to your compliance with these terms, you may use Microchip software  
+ * and any derivatives exclusively with Microchip products. It is your 
+ * responsibility to comply with third party license terms applicable to your 
+ * use of third party software (including open source software) that may 
+ * accompany Microchip software.
+   THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER  
+ * EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY IMPLIED 
+ * WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS FOR A PARTICULAR 
+ * PURPOSE.
+ * 
+   IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, 
+ * INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND 
+ * WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS 
+ * BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO THE 
+ * FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN 
+ * ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY, 
+ * THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+ *************************************************************************
+ *
+ *                           wincSocketSim.h
+ *
+ * About: Scripted WINC socket API for off-target runs
+ *
+ ******************************************************************************/
+
+#ifndef WINC_SOCKET_SIM_H
+#define WINC_SOCKET_SIM_H
+
+// With WINC_SOCKET_SIM defined, wincSocketSim.c provides the socket.h API
+// (socket, connect, send, recv, shutdown, setsockopt, gethostbyname and the
+// callback registration) in place of the WINC driver's socket.c. Socket events
+// come from a script instead of the radio. The simulator uses no wall clock.
+// Everything happens in WINC_SIM_Tasks() at the time the harness passes in, so
+// a run repeats exactly.
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define WINC_SIM_MAX_EVENTS 8   // callbacks waiting out their latency
+
+typedef enum
+{
+    WINC_SIM_RESOLVE = 0,   // answer the next gethostbyname(), value is the IPv4 address, 0 fails
+    WINC_SIM_CONNECT,       // answer the next connect(), value is s8Error
+    WINC_SIM_AWAIT_SEND,    // wait until the application sent length bytes, 0 for any send
+    WINC_SIM_RECV,          // deliver data from the broker to posted receives
+    WINC_SIM_RESET,         // the connection is reset, posted receive fails with SOCK_ERR_CONN_ABORTED
+    WINC_SIM_END            // no further events, sockets stay as they are
+} wincSimStepType_t;
+
+typedef struct
+{
+    wincSimStepType_t type;
+    uint32_t          delayMs;   // after the previous step completed
+    int32_t           value;
+    const uint8_t*    data;
+    uint16_t          length;
+} wincSimStep_t;
+
+typedef struct
+{
+    uint32_t latencyMs;    // added to every driver callback
+    uint16_t segmentMax;   // split RECV data into chunks of at most this size, 0 for no split
+    uint16_t dropEvery;    // silently drop every Nth RECV step, 0 for none
+} wincSimConfig_t;
+
+typedef struct
+{
+    uint32_t resolves;
+    uint32_t connects;
+    uint32_t sends;
+    uint32_t bytesSent;
+    uint32_t recvSegments;
+    uint32_t bytesReceived;
+    uint32_t resets;
+    uint32_t dropped;
+    uint32_t unanswered;         // resolve or connect requests with no script step to answer them
+    uint32_t resetMs;            // time of the last reset
+    uint32_t connectRequestMs;   // time of the last connect()
+    uint32_t connectedMs;        // time of the last successful SOCKET_MSG_CONNECT
+    uint32_t lastRecvMs;
+    uint32_t lastSendMs;
+} wincSimStats_t;
+
+// Sees every send() with the simulated time, for recording a session
+typedef void (*wincSimSendHook_t)(uint32_t nowMs, const uint8_t* data, uint16_t length);
+
+extern wincSimStats_t wincSimStats;
+
+void WINC_SIM_init(const wincSimStep_t* script, const wincSimConfig_t* config, wincSimSendHook_t sendHook);
+// Call from the harness main loop where the firmware calls WDRV_WINC_Tasks()
+void WINC_SIM_Tasks(uint32_t nowMs);
+bool WINC_SIM_done(void);
+
+#endif /* WINC_SOCKET_SIM_H */
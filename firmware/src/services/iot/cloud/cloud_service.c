@@ -25,6 +25,8 @@
     SOFTWARE.
 */
 
+#define DEBUG_MODULE CLOUD
+
 #include <stdio.h>
 #include <string.h>
 #include <time.h>
@@ -35,18 +37,21 @@
 #include "crypto_client/crypto_client.h"
 #include "crypto_client/cryptoauthlib_main.h"
 #include "debug_print.h"
+#include "metrics.h"
 #include "m2m_wifi.h"
-#include "../../../app.h"
 #include "bsd_adapter/bsdWINC.h"
 #include "socket.h"
-#include "../cloud/mqtt_packetPopulation/mqtt_packetPopulate.h"
 #include "../../../mqtt/mqtt_core/mqtt_core.h"
 #include "wifi_service.h"
+#include "backoff.h"
+#include "power_manager.h"
 #include "../../../credentials_storage/credentials_storage.h"
 #include "../../../mqtt/mqtt_packetTransfer_interface.h"
 #include "definitions.h"
 #include "iot_config/mqtt_config.h"
 #include "led.h"
+#include "scheduler.h"
+#include "perf.h"
 #include "../../../config/SAMD21_WG_IOT/driver/winc/include/drv/driver/m2m_ssl.h"
 
 #define UNIX_OFFSET 946684800
@@ -71,14 +76,49 @@ bool sendSubscribe = true;
 #define DNS_RETRY_COUNT_MS          10000L / CLOUD_TASK_INTERVAL_MS
 #define WIFI_CONNECT_TIMEOUT_MS     5000L   // 5 seconds
 
+#define CLOUD_RESET_BACKOFF_CAP_MS  300000L   // 5 minutes
+#define DNS_RETRY_BACKOFF_BASE_MS   10000L    // gap after a failed lookup, the answer wait stays DNS_RETRY_COUNT_MS
+#define DNS_RETRY_BACKOFF_CAP_MS    120000L   // 2 minutes
+
+backoff_t cloudResetBackoff;
+backoff_t dnsRetryBackoff;
+
+#define DNS_CACHE_HOST_LENGTH 68
+
+typedef struct
+{
+    char     host[DNS_CACHE_HOST_LENGTH];
+    uint32_t ip;
+    uint32_t expires;   // uptime seconds
+} dns_cache_entry_t;
+
+static dns_cache_entry_t dnsCache[CLOUD_DNS_CACHE_SIZE];
+static bool              hostIpFromCache   = false;
+static bool              cachedIpAttempted = false;
+
+// Time from reInit() to CONNACK
+static uint32_t connectStartCount;
+static bool     connectTimingActive = false;
+static bool     connectUsedDnsCache = false;
+
+cloud_connect_stats_t cloudConnectStats;
+
+// TLS session resumption policy and handshake timing
+static bool     tlsForceFullHandshake = false;
+static uint32_t tlsResumeCount        = 0;
+static uint32_t tlsFullHandshakeTime  = 0;   // uptime seconds
+static char*    tlsSessionHost        = NULL;
+static uint32_t tlsHandshakeStartCount;
+static uint32_t tlsHandshakeEccUs;
+static uint8_t  tlsHandshakeEccRequests;
+static bool     tlsHandshakeActive = false;
+
+cloud_tls_stats_t cloudTlsStats;
+
 SYS_TIME_HANDLE cloudResetTaskHandle  = SYS_TIME_HANDLE_INVALID;
 SYS_TIME_HANDLE mqttTimeoutTaskHandle = SYS_TIME_HANDLE_INVALID;
 SYS_TIME_HANDLE wifiTimeoutTaskHandle = SYS_TIME_HANDLE_INVALID;
 
-volatile bool mqttTimeoutTaskTmrExpired = false;
-volatile bool cloudResetTaskTmrExpired  = false;
-volatile bool wifiTimeoutTaskTmrExpired = false;
-
 void mqttTimeoutTask(void);
 void cloudResetTask(void);
 void wifiTimeoutTask(void);
@@ -105,8 +145,14 @@ void NETWORK_wifiSslCallback(uint8_t u8MsgType, void* pvMsg)
     {
         case M2M_SSL_REQ_ECC: {
             tstrEccReqInfo* ecc_request = (tstrEccReqInfo*)pvMsg;
+            uint32_t        startCount  = SYS_TIME_CounterGet();
+
             CRYPTO_CLIENT_processEccRequest(ecc_request);
 
+            // A resumed session never asks for ECDH or signatures
+            tlsHandshakeEccUs += SYS_TIME_CountToUS(SYS_TIME_CounterGet() - startCount);
+            tlsHandshakeEccRequests++;
+
             break;
         }
 
@@ -122,6 +168,96 @@ void NETWORK_wifiSslCallback(uint8_t u8MsgType, void* pvMsg)
     }
 }
 
+static uint32_t uptimeSeconds(void)
+{
+    return (uint32_t)(SYS_TIME_Counter64Get() / SYS_TIME_MSToCount(1000));
+}
+
+//
+// Decide whether the next socket may resume the cached TLS session.
+//
+static int tlsUseSessionCache(void)
+{
+#if CFG_TLS_SESSION_CACHE_ENABLE
+    if (tlsSessionHost != mqtt_host)
+    {
+        // New server, there is nothing to resume yet.  Cache the session this handshake creates.
+        tlsSessionHost       = mqtt_host;
+        tlsResumeCount       = 0;
+        tlsFullHandshakeTime = uptimeSeconds();
+        return 1;
+    }
+
+    if (tlsResumeCount >= CFG_TLS_SESSION_MAX_RESUMES)
+    {
+        debug_printInfo("CLOUD: Session resumed %lu times, forcing full TLS handshake", tlsResumeCount);
+        tlsForceFullHandshake = true;
+    }
+    else if ((uptimeSeconds() - tlsFullHandshakeTime) > CFG_TLS_SESSION_MAX_AGE_SEC)
+    {
+        debug_printInfo("CLOUD: Session too old, forcing full TLS handshake");
+        tlsForceFullHandshake = true;
+    }
+
+    if (tlsForceFullHandshake)
+    {
+        // Leaving caching off for one socket makes the WINC run a full handshake.
+        // The next socket caches the new session.
+        tlsForceFullHandshake = false;
+        tlsResumeCount        = 0;
+        tlsFullHandshakeTime  = uptimeSeconds();
+        return 0;
+    }
+    return 1;
+#else
+    return 0;
+#endif
+}
+
+//
+// Socket events pass through here to time the TLS handshake, then go to the BSD adapter.
+//
+static void CLOUD_socketHandler(int8_t sock, uint8_t msgType, void* pMsg)
+{
+    if (msgType == SOCKET_MSG_CONNECT && tlsHandshakeActive && pMsg != NULL)
+    {
+        tstrSocketConnectMsg* pstrConnect = (tstrSocketConnectMsg*)pMsg;
+        uint32_t              elapsedMs   = SYS_TIME_CountToMS(SYS_TIME_CounterGet() - tlsHandshakeStartCount);
+
+        tlsHandshakeActive = false;
+
+        if (pstrConnect->s8Error < 0)
+        {
+            cloudTlsStats.failedHandshakes++;
+            tlsForceFullHandshake = true;
+            // Make the next attempt verify the whole server chain on the secure element
+            CRYPTO_CLIENT_flushVerifyCache();
+        }
+        else if (tlsHandshakeEccRequests == 0)
+        {
+            cloudTlsStats.resumedHandshakes++;
+            cloudTlsStats.lastResumedMs = elapsedMs;
+            tlsResumeCount++;
+        }
+        else
+        {
+            cloudTlsStats.fullHandshakes++;
+            cloudTlsStats.lastFullMs    = elapsedMs;
+            cloudTlsStats.lastFullEccMs = tlsHandshakeEccUs / 1000;
+            tlsResumeCount              = 0;
+            tlsFullHandshakeTime        = uptimeSeconds();
+        }
+
+        debug_printInfo("CLOUD: TLS %s in %lu ms, %u ECC requests took %lu ms",
+                        (pstrConnect->s8Error < 0) ? "failed" : ((tlsHandshakeEccRequests == 0) ? "resumed" : "full handshake"),
+                        elapsedMs,
+                        tlsHandshakeEccRequests,
+                        tlsHandshakeEccUs / 1000);
+    }
+
+    BSD_SocketHandler(sock, msgType, pMsg);
+}
+
 socketState_t getSocketState()
 {
     mqttContext*  context     = MQTT_GetClientConnectionInfo();
@@ -140,17 +276,109 @@ void CLOUD_setdeviceId(char* id)
 //
 void mqttTimeoutTaskcb(uintptr_t context)
 {
-    mqttTimeoutTaskTmrExpired = true;
+    SCHED_post(SCHED_EVENT_CLOUD_MQTT_TIMEOUT);
 }
 
 void wifiTimeoutTaskcb(uintptr_t context)
 {
-    wifiTimeoutTaskTmrExpired = true;
+    SCHED_post(SCHED_EVENT_CLOUD_WIFI_TIMEOUT);
 }
 
 void cloudResetTaskcb(uintptr_t context)
 {
-    cloudResetTaskTmrExpired = true;
+    SCHED_post(SCHED_EVENT_CLOUD_RESET);
+}
+
+static dns_cache_entry_t* dnsCacheFind(const char* host)
+{
+    uint8_t i;
+
+    for (i = 0; i < CLOUD_DNS_CACHE_SIZE; i++)
+    {
+        if (dnsCache[i].ip != 0 && strcmp(dnsCache[i].host, host) == 0)
+        {
+            return &dnsCache[i];
+        }
+    }
+    return NULL;
+}
+
+static uint32_t dnsCacheLookup(const char* host)
+{
+    dns_cache_entry_t* entry = dnsCacheFind(host);
+
+    if (entry == NULL)
+    {
+        return 0;
+    }
+
+    if ((int32_t)(uptimeSeconds() - entry->expires) >= 0)
+    {
+        debug_printInfo("CLOUD: Cached IP for %s expired", host);
+        entry->ip = 0;
+        return 0;
+    }
+
+    return entry->ip;
+}
+
+static void dnsCacheStore(const char* host, uint32_t ip)
+{
+#if CFG_DNS_CACHE_TTL_SEC > 0
+    dns_cache_entry_t* entry = dnsCacheFind(host);
+    uint8_t            i;
+
+    if (strlen(host) >= DNS_CACHE_HOST_LENGTH)
+    {
+        return;
+    }
+
+    // Reuse the entry for this host, else an empty one, else the oldest
+    if (entry == NULL)
+    {
+        entry = &dnsCache[0];
+        for (i = 0; i < CLOUD_DNS_CACHE_SIZE; i++)
+        {
+            if (dnsCache[i].ip == 0)
+            {
+                entry = &dnsCache[i];
+                break;
+            }
+            if ((int32_t)(dnsCache[i].expires - entry->expires) < 0)
+            {
+                entry = &dnsCache[i];
+            }
+        }
+    }
+
+    strcpy(entry->host, host);
+    entry->ip      = ip;
+    entry->expires = uptimeSeconds() + CFG_DNS_CACHE_TTL_SEC;
+#endif
+}
+
+static void dnsCacheEvict(const char* host)
+{
+    dns_cache_entry_t* entry = dnsCacheFind(host);
+
+    if (entry != NULL)
+    {
+        debug_printInfo("CLOUD: Dropping cached IP for %s", host);
+        entry->ip = 0;
+    }
+}
+
+bool CLOUD_getDnsCache(uint8_t index, char** host, uint32_t* ip, int32_t* ttl)
+{
+    if (index >= CLOUD_DNS_CACHE_SIZE || dnsCache[index].ip == 0)
+    {
+        return false;
+    }
+
+    *host = dnsCache[index].host;
+    *ip   = dnsCache[index].ip;
+    *ttl  = (int32_t)(dnsCache[index].expires - uptimeSeconds());
+    return true;
 }
 
 //
@@ -159,6 +387,8 @@ void cloudResetTaskcb(uintptr_t context)
 void CLOUD_reset(void)
 {
     debug_printInfo("CLOUD: Resetting cloud connection");
+    METRIC_INC(MQTT_RECONNECTS);
+
     cloudInitialized = false;
     CLOUD_disconnect();
 }
@@ -180,6 +410,11 @@ void mqttTimeoutTask(void)
     if (shared_networking_params.haveMqttConnection == 0)
     {
         debug_printWarn("CLOUD: MQTT Connection Timeout");
+        if (hostIpFromCache && cachedIpAttempted)
+        {
+            // No CONNACK from the cached address, resolve again after the reset
+            dnsCacheEvict(mqtt_host);
+        }
         CLOUD_reset();
         waitingForMQTT = false;
     }
@@ -205,6 +440,24 @@ void wifiTimeoutTask(void)
 //
 void CLOUD_init_host(char* host, char* attDeviceID, pf_MQTT_CLIENT* pf_table)
 {
+    static bool backoffInitialized = false;
+
+    if (!backoffInitialized)
+    {
+        backoffInitialized = true;
+        SCHED_register(SCHED_EVENT_CLOUD_WIFI_TIMEOUT, wifiTimeoutTask);
+        SCHED_register(SCHED_EVENT_CLOUD_MQTT_TIMEOUT, mqttTimeoutTask);
+        SCHED_register(SCHED_EVENT_CLOUD_RESET, cloudResetTask);
+        BACKOFF_init(&cloudResetBackoff, "cloud", CLOUD_RESET_TIMEOUT_MS, CLOUD_RESET_BACKOFF_CAP_MS);
+        BACKOFF_init(&dnsRetryBackoff, "dns", DNS_RETRY_BACKOFF_BASE_MS, DNS_RETRY_BACKOFF_CAP_MS);
+    }
+
+    if (host != mqtt_host)
+    {
+        // New host, start over
+        BACKOFF_reset(&dnsRetryBackoff);
+    }
+
     mqtt_host                           = host;
     mqttHostIP                          = 0;
     shared_networking_params.haveHostIp = 1;
@@ -272,6 +525,22 @@ static int8_t connectMQTTSocket(void)
 
         if (ret == BSD_SUCCESS)
         {
+            int optVal = tlsUseSessionCache();
+
+            ret = BSD_setsockopt(*context->tcpClientSocket,
+                                 SOL_SSL_SOCKET,
+                                 SO_SSL_ENABLE_SESSION_CACHING,
+                                 &optVal,
+                                 sizeof(optVal));
+        }
+
+        if (ret == BSD_SUCCESS)
+        {
+            tlsHandshakeEccUs       = 0;
+            tlsHandshakeEccRequests = 0;
+            tlsHandshakeActive      = true;
+            tlsHandshakeStartCount  = SYS_TIME_CounterGet();
+
             ret = BSD_connect(*context->tcpClientSocket,
                               (struct bsd_sockaddr*)&addr,
                               sizeof(struct bsd_sockaddr_in));
@@ -349,11 +618,36 @@ void CLOUD_disconnect(void)
 packetReceptionHandler_t* getSocketInfo(uint8_t sock);
 
 
+// Hand the MQTT and reconnect deadlines to the power manager so the WINC
+// can doze in between
+static void updatePowerSave(void)
+{
+    bool    connected = CLOUD_isConnected();
+    int32_t retryMs   = BACKOFF_msUntilRetry(&cloudResetBackoff);
+
+    POWER_setDeadline(POWER_DEADLINE_KEEPALIVE, connected ? MQTT_msUntilPingreq() : -1);
+    POWER_setDeadline(POWER_DEADLINE_BACKOFF, (!connected && retryMs > 0) ? retryMs : -1);
+    if (!connected)
+    {
+        POWER_setDeadline(POWER_DEADLINE_TELEMETRY, -1);
+    }
+
+    POWER_task(tlsHandshakeActive || (!connected && retryMs == 0));
+}
+
 void CLOUD_task(void)
 {
     mqttContext*  mqttConnnectionInfo = MQTT_GetClientConnectionInfo();
     socketState_t socketState         = BSD_GetSocketState(*mqttConnnectionInfo->tcpClientSocket);
 
+    PERF_BEGIN(CLOUD_TASK);
+
+    // Refill the ephemeral ECDH key while no handshake is waiting on the secure element
+    if (tlsHandshakeActive == false)
+    {
+        CRYPTO_CLIENT_precomputeEcdhKey();
+    }
+
     switch (socketState)
     {
         case NOT_A_SOCKET:   // 0
@@ -362,10 +656,23 @@ void CLOUD_task(void)
             {
                 if (shared_networking_params.cloudInitPending != 1)
                 {
+                    uint32_t resetDelay;
+
                     shared_networking_params.cloudInitPending = 1;
+
+                    // Back off on the link that failed.  The flags still describe the connection being reset.
+                    if (shared_networking_params.haveAPConnection == 0)
+                    {
+                        resetDelay = wifi_getRetryDelay();
+                    }
+                    else
+                    {
+                        resetDelay = BACKOFF_next(&cloudResetBackoff);
+                    }
+
                     // Start initialization
-                    debug_printInfo("CLOUD: Cloud Reset timer start with %d ms", CLOUD_RESET_TIMEOUT_MS);
-                    cloudResetTaskHandle = SYS_TIME_CallbackRegisterMS(cloudResetTaskcb, 0, CLOUD_RESET_TIMEOUT_MS, SYS_TIME_SINGLE);
+                    debug_printInfo("CLOUD: Cloud Reset timer start with %lu ms", resetDelay);
+                    cloudResetTaskHandle = SYS_TIME_CallbackRegisterMS(cloudResetTaskcb, 0, resetDelay, SYS_TIME_SINGLE);
                 }
             }
             else if (shared_networking_params.haveAPConnection == 0)
@@ -386,15 +693,34 @@ void CLOUD_task(void)
                 {
                     // still waiting for DNS look up
                     dnsRetryCount--;
+                    if (dnsRetryCount == 0)
+                    {
+                        // No answer within the retry window
+                        METRIC_INC(DNS_FAILURES);
+                        debug_printWarn("CLOUD: No DNS answer, next lookup in %lu ms", BACKOFF_next(&dnsRetryBackoff));
+                    }
                     break;
                 }
+                else if (BACKOFF_msUntilRetry(&dnsRetryBackoff) > 0)
+                {
+                    // backing off after a failed lookup
+                    break;
+                }
+                else if ((mqttHostIP = dnsCacheLookup(mqtt_host)) != 0)
+                {
+                    debug_printInfo("CLOUD: Using cached IP for %s", mqtt_host);
+                    hostIpFromCache                     = true;
+                    connectUsedDnsCache                 = true;
+                    shared_networking_params.haveHostIp = 1;
+                }
                 else
                 {
                     // send request to get Host IP
                     debug_printInfo("CLOUD: Getting IP for %s", mqtt_host);
                     if (gethostbyname((char*)mqtt_host) != M2M_SUCCESS)
                     {
-                        debug_printError("CLOUD: gethostbyname failed");
+                        METRIC_INC(DNS_FAILURES);
+                        debug_printError("CLOUD: gethostbyname failed, next lookup in %lu ms", BACKOFF_next(&dnsRetryBackoff));
                     }
                     else
                     {
@@ -411,6 +737,18 @@ void CLOUD_task(void)
                 // Ready to connect socket
                 assert(shared_networking_params.haveHostIp == 1);
 
+                if (hostIpFromCache && cachedIpAttempted)
+                {
+                    // The socket to the cached address closed before CONNACK, resolve again
+                    dnsCacheEvict(mqtt_host);
+                    hostIpFromCache                     = false;
+                    cachedIpAttempted                   = false;
+                    mqttHostIP                          = 0;
+                    shared_networking_params.haveHostIp = 0;
+                    break;
+                }
+                cachedIpAttempted = hostIpFromCache;
+
                 *mqttConnnectionInfo->tcpClientSocket = BSD_socket(PF_INET, BSD_SOCK_STREAM, 1);   // WINC_TLS
 
                 if (*mqttConnnectionInfo->tcpClientSocket >= 0)
@@ -461,17 +799,34 @@ void CLOUD_task(void)
                 mqttState = MQTT_TransmissionHandler(mqttConnnectionInfo);
                 //debug_printWarn("CLOUD: MQTT Transmission %d", mqttState);
 
-                // Todo: We already processed the data in place using PEEK, this just flushes the buffer
-                BSD_recv(*MQTT_GetClientConnectionInfo()->tcpClientSocket,
-                         MQTT_GetClientConnectionInfo()->mqttDataExchangeBuffers.rxbuff.start,
-                         MQTT_GetClientConnectionInfo()->mqttDataExchangeBuffers.rxbuff.bufferLength,
-                         0);
+                // Re-post the receive at the free end of the MQTT receive ring
+                MQTT_Receive(mqttConnnectionInfo);
             }
 
             if (mqttState == CONNECTED)
             {
                 waitingForMQTT                              = false;
                 shared_networking_params.haveMqttConnection = 1;
+                BACKOFF_reset(&cloudResetBackoff);
+                cachedIpAttempted = false;
+
+                if (connectTimingActive)
+                {
+                    uint32_t elapsedMs = SYS_TIME_CountToMS(SYS_TIME_CounterGet() - connectStartCount);
+
+                    connectTimingActive = false;
+                    if (connectUsedDnsCache)
+                    {
+                        cloudConnectStats.lastWithDnsCacheMs = elapsedMs;
+                        cloudConnectStats.connectsWithDnsCache++;
+                    }
+                    else
+                    {
+                        cloudConnectStats.lastWithoutDnsCacheMs = elapsedMs;
+                        cloudConnectStats.connectsWithoutDnsCache++;
+                    }
+                    debug_printGood("CLOUD: CONNACK %lu ms after reset (DNS %s)", elapsedMs, connectUsedDnsCache ? "cached" : "resolved");
+                }
 
                 if (mqttTimeoutTaskHandle != SYS_TIME_HANDLE_INVALID)
                 {
@@ -496,6 +851,10 @@ void CLOUD_task(void)
         case SOCKET_CLOSING:
             break;
     }
+
+    updatePowerSave();
+
+    PERF_END(CLOUD_TASK);
 }
 
 bool CLOUD_isConnected(void)
@@ -521,6 +880,9 @@ void dnsHandler(uint8_t* domainName, uint32_t serverIP)
     {
         dnsRetryCount                       = 0;
         shared_networking_params.haveHostIp = 1;
+        BACKOFF_reset(&dnsRetryBackoff);
+        hostIpFromCache = false;
+        dnsCacheStore((char*)domainName, serverIP);
         mqttHostIP                          = serverIP;
 
         debug_printGood(" WIFI: mqttHostIP '%lu.%lu.%lu.%lu'",
@@ -529,6 +891,12 @@ void dnsHandler(uint8_t* domainName, uint32_t serverIP)
                         (0x0FF & (serverIP >> 16)),
                         (0x0FF & (serverIP >> 24)));
     }
+    else
+    {
+        dnsRetryCount = 0;
+        METRIC_INC(DNS_FAILURES);
+        debug_printError("CLOUD: DNS lookup failed, next lookup in %lu ms", BACKOFF_next(&dnsRetryBackoff));
+    }
 }
 
 static uint8_t reInit(void)
@@ -539,6 +907,13 @@ static uint8_t reInit(void)
     waitingForMQTT                   = false;
     uint8_t wifi_creds;
 
+    hostIpFromCache     = false;
+    cachedIpAttempted   = false;
+    connectUsedDnsCache = false;
+    tlsHandshakeActive  = false;   // the socket may have died mid-handshake, without SOCKET_MSG_CONNECT
+    connectTimingActive = true;
+    connectStartCount   = SYS_TIME_CounterGet();
+
     // Clear LEDs
     LED_SetWiFi(LED_INDICATOR_OFF);
     LED_SetCloud(LED_INDICATOR_OFF);
@@ -548,7 +923,7 @@ static uint8_t reInit(void)
     socketDeinit();
     socketInit();
 
-    registerSocketCallback(BSD_SocketHandler, dnsHandler);
+    registerSocketCallback(CLOUD_socketHandler, dnsHandler);
 
     MQTT_ClientInitialize();
 
@@ -587,24 +962,3 @@ static uint8_t reInit(void)
 
     return true;
 }
-
-void CLOUD_sched(void)
-{
-    if (wifiTimeoutTaskTmrExpired == true)
-    {
-        wifiTimeoutTaskTmrExpired = false;
-        wifiTimeoutTask();
-    }
-
-    if (mqttTimeoutTaskTmrExpired == true)
-    {
-        mqttTimeoutTaskTmrExpired = false;
-        mqttTimeoutTask();
-    }
-
-    if (cloudResetTaskTmrExpired == true)
-    {
-        cloudResetTaskTmrExpired = false;
-        cloudResetTask();
-    }
-}
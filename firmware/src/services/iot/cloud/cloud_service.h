@@ -9,11 +9,38 @@
 #define CLOUD_SERVICE_H_
 
 #include <stdbool.h>
-#include "mqtt_packetPopulation/mqtt_packetPopulate.h"
+#include "../../../mqtt/mqtt_packetTransfer_interface.h"
 
 // this must be = to MAX_SUPPORTED_SOCKETS
 #define CLOUD_PACKET_RECV_TABLE_SIZE 2
 
+// Resolved MQTT host addresses kept across socket resets, DPS and IoT Hub
+#define CLOUD_DNS_CACHE_SIZE 2
+
+// Time to CONNACK after a reset, split by whether the host IP came from the DNS cache
+typedef struct
+{
+    uint32_t lastWithDnsCacheMs;
+    uint32_t lastWithoutDnsCacheMs;
+    uint32_t connectsWithDnsCache;
+    uint32_t connectsWithoutDnsCache;
+} cloud_connect_stats_t;
+
+extern cloud_connect_stats_t cloudConnectStats;
+
+// TLS handshakes, split by whether the WINC resumed the cached session
+typedef struct
+{
+    uint32_t fullHandshakes;
+    uint32_t resumedHandshakes;
+    uint32_t failedHandshakes;
+    uint32_t lastFullMs;
+    uint32_t lastFullEccMs;   // part of lastFullMs spent in the secure element
+    uint32_t lastResumedMs;
+} cloud_tls_stats_t;
+
+extern cloud_tls_stats_t cloudTlsStats;
+
 void CLOUD_init_host(char* host, char* deviceId, pf_MQTT_CLIENT* pf_table);
 void CLOUD_reset(void);
 void CLOUD_subscribe(void);
@@ -21,8 +48,8 @@ void CLOUD_disconnect(void);
 bool CLOUD_isConnected(void);
 void CLOUD_publishData(uint8_t* topic, uint8_t* payload, uint16_t payload_len, int qos);
 void CLOUD_task(void);
-void CLOUD_sched(void);
 void dnsHandler(uint8_t* domainName, uint32_t serverIP);
 void CLOUD_setdeviceId(char* id);
+bool CLOUD_getDnsCache(uint8_t index, char** host, uint32_t* ip, int32_t* ttl);
 
 #endif /* CLOUD_SERVICE_H_ */
@@ -25,12 +25,16 @@
     SOFTWARE.
 */
 #include <stdio.h>
+#include <string.h>
 #include "config/cryptoauthlib_config.h"
 #include "lib/tls/atcatls.h"
 #include "crypto_client.h"
 #include "../cloud_service.h"
 #include "debug_print.h"
 #include "lib/cryptoauthlib.h"
+#include "lib/crypto/atca_crypto_sw_sha2.h"
+#include "definitions.h"
+#include "../../../../iot_config/IoT_Sensor_Node_config.h"
 
 #ifndef ATCA_NO_HEAP
 #error : This project uses CryptoAuthLibrary V2. Please add "ATCA_NO_HEAP" to toolchain symbols.
@@ -52,6 +56,9 @@
 static uint32_t g_ecdh_key_slot_index = 0;
 static uint16_t g_ecdh_key_slot[]     = {2};
 
+// The index is unsigned, so wrapping at the slot count is the only range check
+#define ECDH_KEY_SLOT_COUNT (sizeof(g_ecdh_key_slot) / sizeof(g_ecdh_key_slot[0]))
+
 const uint8_t public_key_x509_header[] = {0x30, 0x59, 0x30, 0x13, 0x06, 0x07, 0x2A, 0x86,
                                           0x48, 0xCE, 0x3D, 0x02, 0x01, 0x06, 0x08, 0x2A,
                                           0x86, 0x48, 0xCE, 0x3D, 0x03, 0x01, 0x07, 0x03,
@@ -59,18 +66,230 @@ const uint8_t public_key_x509_header[] = {0x30, 0x59, 0x30, 0x13, 0x06, 0x07, 0x
 
 uint8_t g_serial_number[ATCA_SERIAL_NUM_SIZE];
 
+#if (CFG_I2C_BUS_SPEED_HZ < CRYPTO_CLIENT_I2C_SPEED_MIN) || (CFG_I2C_BUS_SPEED_HZ > CRYPTO_CLIENT_I2C_SPEED_MAX)
+#error "CFG_I2C_BUS_SPEED_HZ is outside what the MCP9808 and ATECC608 on SERCOM3 both support"
+#endif
+
 /** \brief custom configuration for an ECCx08A device */
 ATCAIfaceCfg cfg_ateccx08a_i2c_custom = {
     .iface_type            = ATCA_I2C_IFACE,
     .devtype               = ATECC608A,
     .atcai2c.slave_address = 0xB0,
     .atcai2c.bus           = 2,
-    .atcai2c.baud          = 100000,
+    .atcai2c.baud          = CFG_I2C_BUS_SPEED_HZ,
     .wake_delay            = 1500,
     .rx_retries            = 20};
 
 uint8_t cryptoDeviceInitialized = false;
 
+crypto_client_ecc_stats_t eccRequestStats[CRYPTO_CLIENT_ECC_REQ_COUNT];
+
+crypto_client_verify_cache_stats_t verifyCacheStats;
+
+crypto_client_ecdh_stats_t ecdhPrecomputeStats;
+
+#if CFG_TLS_ECDH_PRECOMPUTE
+// Ephemeral key pair generated ahead of the handshake, on the ATECC508 only.
+// The private key sits in ecdhReadySlot until the next client ECDH consumes
+// it; a key is used only once. The 608 keeps its ephemeral key in TempKey,
+// which does not outlive the commands in between, so it generates inline.
+static bool     ecdhKeyReady = false;
+static uint16_t ecdhReadySlot;
+static uint8_t  ecdhReadyPublicKey[ATCA_PUB_KEY_SIZE];
+#endif
+
+#if CFG_TLS_VERIFY_CACHE_ENABLE
+// Certificate signatures the secure element has already accepted, identified by
+// SHA-256(hash || signature || public key). Only successful verifications are stored.
+typedef struct
+{
+    uint8_t  digest[ATCA_SHA2_256_DIGEST_SIZE];
+    uint32_t expires;   // uptime in seconds, 0 for an unused entry
+} verify_cache_entry_t;
+
+static verify_cache_entry_t verifyCache[CFG_TLS_VERIFY_CACHE_SIZE];
+
+static uint32_t verifyCacheUptime(void)
+{
+    return (uint32_t)(SYS_TIME_Counter64Get() / SYS_TIME_MSToCount(1000));
+}
+
+static void verifyCacheDigest(const uint8_t* hash, const uint8_t* signature, const uint8_t* public_key, uint8_t* digest)
+{
+    atcac_sha2_256_ctx ctx;
+
+    atcac_sw_sha2_256_init(&ctx);
+    atcac_sw_sha2_256_update(&ctx, hash, ATCA_SHA2_256_DIGEST_SIZE);
+    atcac_sw_sha2_256_update(&ctx, signature, ATCA_SIG_SIZE);
+    atcac_sw_sha2_256_update(&ctx, public_key, ATCA_PUB_KEY_SIZE);
+    atcac_sw_sha2_256_finish(&ctx, digest);
+}
+
+static bool verifyCacheLookup(const uint8_t* digest)
+{
+    uint32_t now = verifyCacheUptime();
+    uint8_t  i;
+
+    for (i = 0; i < CFG_TLS_VERIFY_CACHE_SIZE; i++)
+    {
+        if (verifyCache[i].expires == 0)
+        {
+            continue;
+        }
+
+        if ((int32_t)(verifyCache[i].expires - now) <= 0)
+        {
+            verifyCache[i].expires = 0;
+            continue;
+        }
+
+        if (memcmp(verifyCache[i].digest, digest, ATCA_SHA2_256_DIGEST_SIZE) == 0)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static void verifyCacheStore(const uint8_t* digest)
+{
+    verify_cache_entry_t* slot = &verifyCache[0];
+    uint8_t               i;
+
+    // Reuse an empty entry, otherwise replace the one closest to expiry
+    for (i = 0; i < CFG_TLS_VERIFY_CACHE_SIZE; i++)
+    {
+        if (verifyCache[i].expires == 0)
+        {
+            slot = &verifyCache[i];
+            break;
+        }
+
+        if ((int32_t)(verifyCache[i].expires - slot->expires) < 0)
+        {
+            slot = &verifyCache[i];
+        }
+    }
+
+    memcpy(slot->digest, digest, ATCA_SHA2_256_DIGEST_SIZE);
+    slot->expires = verifyCacheUptime() + CFG_TLS_VERIFY_CACHE_TTL_SEC;
+
+    if (slot->expires == 0)
+    {
+        slot->expires = 1;
+    }
+}
+#endif
+
+void CRYPTO_CLIENT_flushVerifyCache(void)
+{
+#if CFG_TLS_VERIFY_CACHE_ENABLE
+    memset(verifyCache, 0, sizeof(verifyCache));
+#endif
+}
+
+// Device commands a cached read replaces
+#define CRYPTO_CLIENT_CMDS_INIT      1   // chip mode read done by atcab_init()
+#define CRYPTO_CLIENT_CMDS_SERIAL    1   // config zone block read
+#define CRYPTO_CLIENT_CMDS_PUBKEY    1   // GenKey public key calculation
+#define CRYPTO_CLIENT_CMDS_ID_SCOPE  3   // three 4-byte data zone reads
+
+// Immutable or rarely written device data, read once per session
+static struct
+{
+    bool    serialValid;
+    bool    publicKeyValid;
+    bool    idScopeValid;
+    uint8_t publicKey[ATCA_PUB_KEY_SIZE];
+    char    idScope[CRYPTO_CLIENT_ID_SCOPE_LENGTH];
+} cryptoCache;
+
+crypto_client_cache_stats_t cryptoCacheStats;
+
+static void cryptoCacheHit(uint8_t commands)
+{
+    cryptoCacheStats.hits++;
+    cryptoCacheStats.commandsAvoided += commands;
+}
+
+// Bring up the device once and reuse the session for every later call
+static ATCA_STATUS cryptoSessionOpen(void)
+{
+    ATCA_STATUS retVal;
+
+    if (cryptoDeviceInitialized == true)
+    {
+        cryptoCacheStats.sessionReuse++;
+        cryptoCacheStats.commandsAvoided += CRYPTO_CLIENT_CMDS_INIT;
+        return ATCA_SUCCESS;
+    }
+
+    retVal = atcab_init(&cfg_ateccx08a_i2c_custom);
+    if (retVal == ATCA_SUCCESS)
+    {
+        cryptoDeviceInitialized = true;
+    }
+
+    return retVal;
+}
+
+void CRYPTO_CLIENT_invalidateCache(void)
+{
+    cryptoCache.serialValid    = false;
+    cryptoCache.publicKeyValid = false;
+    cryptoCache.idScopeValid   = false;
+}
+
+uint8_t CRYPTO_CLIENT_readIdScope(char* idScope)
+{
+    if (cryptoCache.idScopeValid == true)
+    {
+        cryptoCacheHit(CRYPTO_CLIENT_CMDS_ID_SCOPE);
+    }
+    else
+    {
+        if (cryptoSessionOpen() != ATCA_SUCCESS)
+        {
+            return ERROR;
+        }
+
+        cryptoCacheStats.misses++;
+        if (atcab_read_bytes_zone(ATCA_ZONE_DATA, ATCA_SLOT_DPS_IDSCOPE, 0, (uint8_t*)cryptoCache.idScope, sizeof(cryptoCache.idScope)) != ATCA_SUCCESS)
+        {
+            return ERROR;
+        }
+
+        cryptoCache.idScope[sizeof(cryptoCache.idScope) - 1] = '\0';
+        cryptoCache.idScopeValid                             = true;
+    }
+
+    memcpy(idScope, cryptoCache.idScope, sizeof(cryptoCache.idScope));
+    return NO_ERROR;
+}
+
+uint8_t CRYPTO_CLIENT_writeIdScope(const char* idScope)
+{
+    char slot[CRYPTO_CLIENT_ID_SCOPE_LENGTH] = {0};
+
+    if (cryptoSessionOpen() != ATCA_SUCCESS)
+    {
+        return ERROR;
+    }
+
+    strncpy(slot, idScope, sizeof(slot) - 1);
+
+    // Read back from the device on the next access
+    cryptoCache.idScopeValid = false;
+
+    if (atcab_write_bytes_zone(ATCA_ZONE_DATA, ATCA_SLOT_DPS_IDSCOPE, 0, (uint8_t*)slot, sizeof(slot)) != ATCA_SUCCESS)
+    {
+        return ERROR;
+    }
+
+    return NO_ERROR;
+}
+
 uint8_t CRYPTO_CLIENT_printPublicKey(char* s)
 {
     char        buf[128];
@@ -78,24 +297,35 @@ uint8_t CRYPTO_CLIENT_printPublicKey(char* s)
     size_t      bufferLen = sizeof(buf);
     ATCA_STATUS retVal;
 
-    if (ATCA_SUCCESS != atcab_init(&cfg_ateccx08a_i2c_custom))
+    if (cryptoCache.publicKeyValid == true)
     {
-        return ERROR;
+        cryptoCacheHit(CRYPTO_CLIENT_CMDS_PUBKEY);
+    }
+    else
+    {
+        if (ATCA_SUCCESS != cryptoSessionOpen())
+        {
+            return ERROR;
+        }
+
+        /* Get public key without private key generation */
+        cryptoCacheStats.misses++;
+        retVal = atcab_get_pubkey(DEVICE_KEY_SLOT, cryptoCache.publicKey);
+
+        if (ATCA_SUCCESS != retVal)
+        {
+            return ERROR;
+        }
+
+        cryptoCache.publicKeyValid = true;
     }
 
     /* Calculate where the raw data will fit into the buffer */
     tmp = (uint8_t*)buf + sizeof(buf) - ATCA_PUB_KEY_SIZE - sizeof(public_key_x509_header);
 
-    /* Copy the header */
+    /* Copy the header and key */
     memcpy(tmp, public_key_x509_header, sizeof(public_key_x509_header));
-
-    /* Get public key without private key generation */
-    retVal = atcab_get_pubkey(0, tmp + sizeof(public_key_x509_header));
-
-    if (ATCA_SUCCESS != retVal)
-    {
-        return ERROR;
-    }
+    memcpy(tmp + sizeof(public_key_x509_header), cryptoCache.publicKey, ATCA_PUB_KEY_SIZE);
 
     /* Convert to base 64 */
     retVal = atcab_base64encode(tmp, ATCA_PUB_KEY_SIZE + sizeof(public_key_x509_header), buf, &bufferLen);
@@ -116,42 +346,131 @@ uint8_t CRYPTO_CLIENT_printPublicKey(char* s)
 
 uint8_t CRYPTO_CLIENT_printSerialNumber(char* s)
 {
-    ATCA_STATUS status = ATCA_SUCCESS;
-    uint8_t     i      = 0;
+    uint8_t i = 0;
 
-    ATCA_STATUS retVal = atcab_init(&cfg_ateccx08a_i2c_custom);
-
-    if (ATCA_SUCCESS != retVal)
+    if (cryptoCache.serialValid == true)
     {
-        return retVal;
+        cryptoCacheHit(CRYPTO_CLIENT_CMDS_SERIAL);
     }
+    else
+    {
+        ATCA_STATUS retVal = cryptoSessionOpen();
 
-    status = atcatls_get_sn(g_serial_number);
+        if (ATCA_SUCCESS != retVal)
+        {
+            return retVal;
+        }
 
-    if (status == ATCA_SUCCESS)
-    {
-        for (i = 0; i < ATCA_SERIAL_NUM_SIZE; i++)
+        cryptoCacheStats.misses++;
+        if (atcatls_get_sn(g_serial_number) != ATCA_SUCCESS)
         {
-            sprintf(s, "%02X", g_serial_number[i]);
-            s += 2;
+            return ERROR;
         }
+
+        cryptoCache.serialValid = true;
     }
-    else
+
+    for (i = 0; i < ATCA_SERIAL_NUM_SIZE; i++)
+    {
+        sprintf(s, "%02X", g_serial_number[i]);
+        s += 2;
+    }
+
+    return NO_ERROR;
+}
+
+uint32_t CRYPTO_CLIENT_getBusSpeed(void)
+{
+    return cfg_ateccx08a_i2c_custom.atcai2c.baud;
+}
+
+// The HAL switches to the new speed on the next wake
+uint8_t CRYPTO_CLIENT_setBusSpeed(uint32_t speed)
+{
+    if ((speed < CRYPTO_CLIENT_I2C_SPEED_MIN) || (speed > CRYPTO_CLIENT_I2C_SPEED_MAX))
+    {
+        return ERROR;
+    }
+
+    cfg_ateccx08a_i2c_custom.atcai2c.baud = speed;
+    return NO_ERROR;
+}
+
+uint8_t CRYPTO_CLIENT_getRandom32(uint32_t* value)
+{
+    uint8_t random_number[RANDOM_NUM_SIZE];
+
+    if (atcab_random(random_number) != ATCA_SUCCESS)
     {
         return ERROR;
     }
 
+    memcpy(value, random_number, sizeof(uint32_t));
     return NO_ERROR;
 }
 
+void CRYPTO_CLIENT_precomputeEcdhKey(void)
+{
+#if CFG_TLS_ECDH_PRECOMPUTE
+    uint32_t start_count;
+
+    if ((cryptoDeviceInitialized == false) || (ecdhKeyReady == true))
+    {
+        return;
+    }
+
+    // A slot key on the 608 would cost an EEPROM write per connection and
+    // keep the private key across resets
+    if (_gDevice->mIface->mIfaceCFG->devtype == ATECC608A)
+    {
+        return;
+    }
+
+    if (g_ecdh_key_slot_index >= ECDH_KEY_SLOT_COUNT)
+    {
+        g_ecdh_key_slot_index = 0;
+    }
+
+    ecdhReadySlot = g_ecdh_key_slot[g_ecdh_key_slot_index];
+    start_count   = SYS_TIME_CounterGet();
+
+    if (atcab_genkey(ecdhReadySlot, ecdhReadyPublicKey) == ATCA_SUCCESS)
+    {
+        g_ecdh_key_slot_index++;
+        ecdhPrecomputeStats.lastGenUs = SYS_TIME_CountToUS(SYS_TIME_CounterGet() - start_count);
+        ecdhPrecomputeStats.precomputed++;
+        ecdhKeyReady = true;
+    }
+#endif
+}
+
 int8_t ecdh_derive_client_shared_secret(tstrECPoint* server_public_key, uint8_t* ecdh_shared_secret, tstrECPoint* client_public_key)
 {
     int8_t   status = M2M_ERR_FAIL;
     uint8_t  ecdh_mode;
     uint16_t key_id;
 
-    if ((g_ecdh_key_slot_index < 0) ||
-        (g_ecdh_key_slot_index >= (sizeof(g_ecdh_key_slot) / sizeof(g_ecdh_key_slot[0]))))
+#if CFG_TLS_ECDH_PRECOMPUTE
+    if (ecdhKeyReady == true)
+    {
+        // Key generation already happened at idle time, only the ECDH is left
+        ecdhKeyReady = false;
+        memcpy(client_public_key->X, ecdhReadyPublicKey, ATCA_PUB_KEY_SIZE);
+        client_public_key->u16Size = 32;
+
+        if (atcab_ecdh(ecdhReadySlot, server_public_key->X, ecdh_shared_secret) == ATCA_SUCCESS)
+        {
+            ecdhPrecomputeStats.used++;
+            ecdhPrecomputeStats.movedMs += ecdhPrecomputeStats.lastGenUs / 1000;
+            return M2M_SUCCESS;
+        }
+
+        return M2M_ERR_FAIL;
+    }
+    ecdhPrecomputeStats.inlineGen++;
+#endif
+
+    if (g_ecdh_key_slot_index >= ECDH_KEY_SLOT_COUNT)
     {
         g_ecdh_key_slot_index = 0;
     }
@@ -188,12 +507,16 @@ int8_t ecdh_derive_key_pair(tstrECPoint* server_public_key)
 {
     int8_t status = M2M_ERR_FAIL;
 
-    if ((g_ecdh_key_slot_index < 0) ||
-        (g_ecdh_key_slot_index >= (sizeof(g_ecdh_key_slot) / sizeof(g_ecdh_key_slot[0]))))
+    if (g_ecdh_key_slot_index >= ECDH_KEY_SLOT_COUNT)
     {
         g_ecdh_key_slot_index = 0;
     }
 
+#if CFG_TLS_ECDH_PRECOMPUTE
+    // The slot is about to be overwritten
+    ecdhKeyReady = false;
+#endif
+
     if ((status = atcab_genkey(g_ecdh_key_slot[g_ecdh_key_slot_index], server_public_key->X)) == ATCA_SUCCESS)
     {
         server_public_key->u16Size      = 32;
@@ -229,6 +552,17 @@ int8_t ecdsa_process_sign_verify_request(uint32_t number_of_signatures)
         if (curve_type == EC_SECP256R1)
         {
             bool is_verified = false;
+#if CFG_TLS_VERIFY_CACHE_ENABLE
+            uint8_t digest[ATCA_SHA2_256_DIGEST_SIZE];
+
+            verifyCacheDigest(hash, signature, Key.X, digest);
+            if (verifyCacheLookup(digest))
+            {
+                verifyCacheStats.hits++;
+                continue;
+            }
+            verifyCacheStats.misses++;
+#endif
 
             status = atcab_verify_extern(hash, signature, Key.X, &is_verified);
             if (status == ATCA_SUCCESS)
@@ -238,6 +572,12 @@ int8_t ecdsa_process_sign_verify_request(uint32_t number_of_signatures)
                 {
                     debug_printInfo("ECDSA SigVerif FAILED");
                 }
+#if CFG_TLS_VERIFY_CACHE_ENABLE
+                else
+                {
+                    verifyCacheStore(digest);
+                }
+#endif
             }
             else
             {
@@ -301,6 +641,7 @@ void CRYPTO_CLIENT_processEccRequest(tstrEccReqInfo* ecc_request)
     uint8_t        signature[80];
     uint16_t       response_data_size   = 0;
     uint8_t*       response_data_buffer = NULL;
+    uint32_t       start_count          = SYS_TIME_CounterGet();
 
     ecc_response.u16Status = 1;
 
@@ -337,10 +678,23 @@ void CRYPTO_CLIENT_processEccRequest(tstrEccReqInfo* ecc_request)
             break;
     }
 
+    if (ecc_request->u16REQ < CRYPTO_CLIENT_ECC_REQ_COUNT)
+    {
+        crypto_client_ecc_stats_t* stats = &eccRequestStats[ecc_request->u16REQ];
+
+        stats->lastUs = SYS_TIME_CountToUS(SYS_TIME_CounterGet() - start_count);
+        stats->count++;
+        stats->totalMs += stats->lastUs / 1000;
+        if (stats->lastUs > stats->maxUs)
+        {
+            stats->maxUs = stats->lastUs;
+        }
+    }
+
     ecc_response.u16REQ      = ecc_request->u16REQ;
     ecc_response.u32UserData = ecc_request->u32UserData;
     ecc_response.u32SeqNo    = ecc_request->u32SeqNo;
 
     m2m_ssl_ecc_process_done();
     m2m_ssl_handshake_rsp(&ecc_response, response_data_buffer, response_data_size);
-}
\ No newline at end of file
+}
\ No newline at end of file
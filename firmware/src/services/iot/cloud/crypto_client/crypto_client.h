@@ -36,15 +36,75 @@
 #include "../../../../config/SAMD21_WG_IOT/driver/winc/include/drv/driver/m2m_ssl.h"
 #include "../../../../config/SAMD21_WG_IOT/driver/winc/include/drv/driver/ecc_types.h"
 
-extern uint8_t      cryptoDeviceInitialized;
-extern ATCAIfaceCfg cfg_ateccx08a_i2c_custom;
-
-uint8_t CRYPTO_CLIENT_printPublicKey(char* s);
-uint8_t CRYPTO_CLIENT_printSerialNumber(char* s);
-void    CRYPTO_CLIENT_processEccRequest(tstrEccReqInfo* ecc_request);
-int8_t  ecdsa_process_sign_verify_request(uint32_t number_of_signatures);
-int8_t  ecdh_derive_key_pair(tstrECPoint* server_public_key);
-int8_t  ecdh_derive_client_shared_secret(tstrECPoint* server_public_key, uint8_t* ecdh_shared_secret, tstrECPoint* client_public_key);
-int8_t  ecdsa_process_sign_gen_request(tstrEcdsaSignReqInfo* sign_request, uint8_t* signature, uint16_t* signature_size);
-int8_t  ecdh_derive_server_shared_secret(uint16_t private_key_id, tstrECPoint* client_public_key, uint8_t* ecdh_shared_secret);
+#define ATCA_SLOT_DPS_IDSCOPE 8   // Slot # in ATECC608A SE which stores the ID Scope
+
+#define CRYPTO_CLIENT_ID_SCOPE_LENGTH (11 + 1)
+#define CRYPTO_CLIENT_ECC_REQ_COUNT   (ECC_REQ_SIGN_VERIFY + 1)
+
+// Secure element time spent on each WINC ECC request type, indexed by tenuEccREQ
+typedef struct
+{
+    uint32_t count;
+    uint32_t lastUs;
+    uint32_t maxUs;
+    uint32_t totalMs;
+} crypto_client_ecc_stats_t;
+
+// Certificate signature checks answered from the verified-chain cache (hits)
+// versus forwarded to the secure element (misses)
+typedef struct
+{
+    uint32_t hits;
+    uint32_t misses;
+} crypto_client_verify_cache_stats_t;
+
+// Reads answered from the session cache (hits) versus the device (misses), and
+// calls that found the device already initialized (sessionReuse)
+typedef struct
+{
+    uint32_t hits;
+    uint32_t misses;
+    uint32_t sessionReuse;
+    uint32_t commandsAvoided;
+} crypto_client_cache_stats_t;
+
+// Client ECDH requests served with a key generated at idle time (used) versus
+// ones that had to generate the key during the handshake (inlineGen). movedMs
+// is key generation taken out of handshakes; CLOUD_task() still spends it.
+typedef struct
+{
+    uint32_t precomputed;
+    uint32_t used;
+    uint32_t inlineGen;
+    uint32_t lastGenUs;
+    uint32_t movedMs;
+} crypto_client_ecdh_stats_t;
+
+// SERCOM3 is shared with the MCP9808, which is only specified to 400 kHz
+#define CRYPTO_CLIENT_I2C_SPEED_MIN 100000
+#define CRYPTO_CLIENT_I2C_SPEED_MAX 400000
+
+extern uint8_t                            cryptoDeviceInitialized;
+extern crypto_client_cache_stats_t        cryptoCacheStats;
+extern ATCAIfaceCfg                       cfg_ateccx08a_i2c_custom;
+extern crypto_client_ecc_stats_t          eccRequestStats[CRYPTO_CLIENT_ECC_REQ_COUNT];
+extern crypto_client_verify_cache_stats_t verifyCacheStats;
+extern crypto_client_ecdh_stats_t         ecdhPrecomputeStats;
+
+uint8_t  CRYPTO_CLIENT_printPublicKey(char* s);
+uint8_t  CRYPTO_CLIENT_printSerialNumber(char* s);
+uint8_t  CRYPTO_CLIENT_readIdScope(char* idScope);
+uint8_t  CRYPTO_CLIENT_writeIdScope(const char* idScope);
+void     CRYPTO_CLIENT_invalidateCache(void);
+uint8_t  CRYPTO_CLIENT_getRandom32(uint32_t* value);
+uint32_t CRYPTO_CLIENT_getBusSpeed(void);
+uint8_t  CRYPTO_CLIENT_setBusSpeed(uint32_t speed);
+void     CRYPTO_CLIENT_flushVerifyCache(void);
+void     CRYPTO_CLIENT_precomputeEcdhKey(void);
+void     CRYPTO_CLIENT_processEccRequest(tstrEccReqInfo* ecc_request);
+int8_t   ecdsa_process_sign_verify_request(uint32_t number_of_signatures);
+int8_t   ecdh_derive_key_pair(tstrECPoint* server_public_key);
+int8_t   ecdh_derive_client_shared_secret(tstrECPoint* server_public_key, uint8_t* ecdh_shared_secret, tstrECPoint* client_public_key);
+int8_t   ecdsa_process_sign_gen_request(tstrEcdsaSignReqInfo* sign_request, uint8_t* signature, uint16_t* signature_size);
+int8_t   ecdh_derive_server_shared_secret(uint16_t private_key_id, tstrECPoint* client_public_key, uint8_t* ecdh_shared_secret);
 #endif /* CRYPTO_CLIENT_H */
@@ -18,9 +18,15 @@
 #include "led.h"
 #include "azure/iot/az_iot_provisioning_client.h"
 #include "azure/core/az_span.h"
+#include "credentials_storage/dps_cache.h"
+#include "services/iot/cloud/crypto_client/crypto_client.h"
+#include "services/iot/cloud/backoff.h"
+#include "scheduler.h"
 
 #ifdef CFG_MQTT_PROVISIONING_HOST
 #define HALF_SECOND_MS 500L
+#define DPS_RETRY_BACKOFF_BASE_MS 120000L   // 2 minutes
+#define DPS_RETRY_BACKOFF_CAP_MS  960000L   // 16 minutes
 
 pf_MQTT_CLIENT pf_mqtt_iotprovisioning_client = {
     MQTT_CLIENT_iotprovisioning_publish,
@@ -56,8 +62,11 @@ char                                         register_payload_buffer[1024];
 az_span                                      span_remainder;
 
 static uint16_t        dps_retry_counter;
+static uint16_t        dps_retry_ticks;
+backoff_t              dps_retry_backoff;
 static SYS_TIME_HANDLE dps_retry_timer_handle = SYS_TIME_HANDLE_INVALID;
 static void            dps_retry_task(uintptr_t context);
+static void            dps_retry_event(void);
 
 static SYS_TIME_HANDLE dps_assigning_timer_handle = SYS_TIME_HANDLE_INVALID;
 static void            dps_assigning_task(uintptr_t context);
@@ -94,7 +103,7 @@ void MQTT_CLIENT_iotprovisioning_connect(char* device_id)
 
     // Create a span for ID Scope.
     // Read the ID Scope from the secure element (e.g. ATECC608A)
-    atcab_read_bytes_zone(ATCA_ZONE_DATA, ATCA_SLOT_DPS_IDSCOPE, 0, atca_dps_id_scope, sizeof(atca_dps_id_scope));
+    CRYPTO_CLIENT_readIdScope((char*)atca_dps_id_scope);
     const az_span id_scope_span = az_span_create_from_str((char*)atca_dps_id_scope);
 
     debug_printGood("  DPS: ID Scope=%s from secure element", atca_dps_id_scope);
@@ -177,7 +186,9 @@ void dps_client_register(uint8_t* topic, uint8_t* payload)
 
             case AZ_IOT_PROVISIONING_STATUS_ASSIGNED:
                 SYS_TIME_TimerDestroy(dps_retry_timer_handle);
+                dps_retry_timer_handle = SYS_TIME_HANDLE_INVALID;
                 SYS_TIME_TimerDestroy(dps_assigning_timer_handle);
+                BACKOFF_reset(&dps_retry_backoff);
                 az_span_to_str(hub_hostname_buffer,
                                sizeof(hub_hostname_buffer),
                                dps_register_response.registration_state.assigned_hub_hostname);
@@ -185,6 +196,22 @@ void dps_client_register(uint8_t* topic, uint8_t* payload)
 
                 debug_printGood("  DPS: ASSIGNED to %s", hub_hostname);
 
+#if CFG_DPS_CACHE_ENABLE
+                {
+                    char      assigned_device_id[DPS_CACHE_DEVICE_ID_LENGTH];
+                    struct tm sys_time;
+
+                    az_span_to_str(assigned_device_id,
+                                   sizeof(assigned_device_id),
+                                   dps_register_response.registration_state.device_id);
+                    RTC_RTCCTimeGet(&sys_time);
+                    DPS_CACHE_store((char*)atca_dps_id_scope,
+                                    (char*)device_id_buffer,
+                                    hub_hostname,
+                                    assigned_device_id,
+                                    (uint32_t)mktime(&sys_time));
+                }
+#endif
                 pf_mqtt_iotprovisioning_client.MQTT_CLIENT_task_completed();
                 LED_SetCloud(LED_INDICATOR_PENDING);
                 break;
@@ -289,7 +316,13 @@ void MQTT_CLIENT_iotprovisioning_connected()
 #endif
 
             // keep retrying connecting to DPS
+            if (dps_retry_backoff.name == NULL)
+            {
+                BACKOFF_init(&dps_retry_backoff, "dps", DPS_RETRY_BACKOFF_BASE_MS, DPS_RETRY_BACKOFF_CAP_MS);
+            }
+            SCHED_register(SCHED_EVENT_DPS_RETRY, dps_retry_event);
             dps_retry_counter      = 0;
+            dps_retry_ticks        = BACKOFF_next(&dps_retry_backoff) / HALF_SECOND_MS;
             dps_retry_timer_handle = SYS_TIME_CallbackRegisterMS(dps_retry_task, 0, HALF_SECOND_MS, SYS_TIME_PERIODIC);
         }
     }
@@ -342,13 +375,38 @@ static void dps_assigning_task(uintptr_t context)
     return;
 }
 
+// Runs from the TC3 interrupt, so only count ticks here and leave the backoff
+// RNG and the reconnect to the scheduler
 static void dps_retry_task(uintptr_t context)
 {
-    if (++dps_retry_counter % 240 > 0)   // retry every 2 mins
+    if (++dps_retry_counter < dps_retry_ticks)   // retry after a randomized, growing delay
         return;
 
-    MQTT_CLIENT_iotprovisioning_connect((char*)device_id_buffer);
+    dps_retry_counter = 0;
+    dps_retry_ticks   = UINT16_MAX;   // hold off until the event picks the next delay
+    SCHED_post(SCHED_EVENT_DPS_RETRY);
     return;
 }
 
+static void dps_retry_event(void)
+{
+    uint16_t ticks;
+
+    // Posted just before the device was assigned
+    if (dps_retry_timer_handle == SYS_TIME_HANDLE_INVALID)
+    {
+        return;
+    }
+
+    ticks = BACKOFF_next(&dps_retry_backoff) / HALF_SECOND_MS;
+
+    __disable_irq();
+    dps_retry_counter = 0;
+    dps_retry_ticks   = ticks;
+    __enable_irq();
+
+    debug_printInfo("  DPS: Retrying, next attempt in %lu ms", dps_retry_backoff.lastDelayMs);
+    MQTT_CLIENT_iotprovisioning_connect((char*)device_id_buffer);
+}
+
 #endif   // CFG_MQTT_PROVISIONING_HOST
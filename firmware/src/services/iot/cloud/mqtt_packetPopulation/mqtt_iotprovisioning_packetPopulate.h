@@ -33,8 +33,6 @@
 #include <stdint.h>
 #include "iot_config/cloud_config.h"
 
-#define ATCA_SLOT_DPS_IDSCOPE 8   // Slot # in ATECC608A SE which stores the ID Scope
-
 void MQTT_CLIENT_iotprovisioning_publish(uint8_t* topic, uint8_t* payload, uint16_t payload_len, int qos);
 void MQTT_CLIENT_iotprovisioning_receive(uint8_t* data, uint16_t len);
 void MQTT_CLIENT_iotprovisioning_connect(char* deviceID);
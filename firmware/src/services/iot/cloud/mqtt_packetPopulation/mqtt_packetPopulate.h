@@ -29,6 +29,7 @@
 #include <stdint.h>
 #include "azure/core/az_span.h"
 #include "azure/iot/az_iot_pnp_client.h"
+#include "mqtt/mqtt_packetTransfer_interface.h"
 
 extern char*             hub_hostname;
 extern uint8_t           device_id_buffer[128 + 1];
@@ -36,16 +37,6 @@ extern az_span           device_id_span;
 extern az_iot_pnp_client pnp_client;
 extern char              mqtt_username_buffer[203 + 1];
 
-typedef struct
-{
-    void (*MQTT_CLIENT_publish)(uint8_t* topic, uint8_t* payload, uint16_t payload_len, int qos);
-    void (*MQTT_CLIENT_receive)(uint8_t* data, uint16_t len);
-    void (*MQTT_CLIENT_connect)(char* device_id);
-    bool (*MQTT_CLIENT_subscribe)();
-    void (*MQTT_CLIENT_connected)();
-    void (*MQTT_CLIENT_task_completed)();
-} pf_MQTT_CLIENT;
-
 static const az_span twin_request_id_span = AZ_SPAN_LITERAL_FROM_STR("initial_get");
 
 #endif /* MQTT_PACKET_POPULATE_H */
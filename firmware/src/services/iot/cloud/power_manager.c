@@ -0,0 +1,251 @@
+/*
+\file   power_manager.c
+
+\brief  WINC power save manager source file.
+
+(c) 2018 Microchip Technology Inc. and its subsidiaries.
+
+Subject to your compliance with these terms, you may use Microchip software and any
+derivatives exclusively with Microchip products. It is your responsibility to comply with third party
+license terms applicable to your use of third party software (including open source software) that
+may accompany Microchip software.
+
+THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY
+IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS
+FOR A PARTICULAR PURPOSE.
+
+IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
+INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND
+WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP
+HAS BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO
+THE FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL
+CLAIMS IN ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT
+OF FEES, IF ANY, THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS
+SOFTWARE.
+*/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "power_manager.h"
+#include "definitions.h"
+#include "wdrv_winc_powersave.h"
+#include "../../../iot_config/IoT_Sensor_Node_config.h"
+#include "debug_print.h"
+
+// 802.11 beacon period, 100 TU of 1.024 ms
+#define POWER_BEACON_PERIOD_US 102400UL
+
+power_stats_t powerStats;
+
+static DRV_HANDLE    power_wdrvHandle = DRV_HANDLE_INVALID;
+static bool          power_enabled    = (CFG_WINC_POWER_SAVE_ENABLE != 0);
+static power_state_t power_state      = POWER_STATE_AWAKE;
+static bool          power_dozing     = false;
+static uint32_t      power_lastCount;
+static bool          power_deadlineSet[POWER_DEADLINE_COUNT];
+static uint32_t      power_deadlineCount[POWER_DEADLINE_COUNT];   // SYS_TIME counter value when due
+
+static void power_setMode(bool doze, uint16_t listenInterval)
+{
+    if (doze)
+    {
+        // The listen interval only matters while dozing, set it before the mode
+        if (listenInterval != powerStats.listenInterval)
+        {
+            if (WDRV_WINC_PowerSaveSetBeaconInterval(power_wdrvHandle, listenInterval) == WDRV_WINC_STATUS_OK)
+            {
+                powerStats.listenInterval = listenInterval;
+            }
+        }
+
+        if (!power_dozing && WDRV_WINC_PowerSaveSetMode(power_wdrvHandle, WDRV_WINC_PS_MODE_AUTO_LOW_POWER) == WDRV_WINC_STATUS_OK)
+        {
+            power_dozing = true;
+            powerStats.modeChanges++;
+            debug_printTrace("POWER: doze, listen interval %u", listenInterval);
+        }
+    }
+    else if (power_dozing)
+    {
+        if (WDRV_WINC_PowerSaveSetMode(power_wdrvHandle, WDRV_WINC_PS_MODE_OFF) == WDRV_WINC_STATUS_OK)
+        {
+            power_dozing = false;
+            powerStats.modeChanges++;
+            debug_printTrace("POWER: awake");
+        }
+    }
+}
+
+// Nearest pending deadline in ms, -1 when nothing is scheduled
+static int32_t power_msUntilNextDeadline(void)
+{
+    int32_t  next = -1;
+    int32_t  ms;
+    uint32_t now = SYS_TIME_CounterGet();
+    uint8_t  i;
+
+    for (i = 0; i < POWER_DEADLINE_COUNT; i++)
+    {
+        if (power_deadlineSet[i])
+        {
+            ms = (int32_t)(power_deadlineCount[i] - now);
+            ms = (ms <= 0) ? 0 : (int32_t)SYS_TIME_CountToMS((uint32_t)ms);
+
+            if (next < 0 || ms < next)
+            {
+                next = ms;
+            }
+        }
+    }
+
+    return next;
+}
+
+void POWER_init(DRV_HANDLE wdrvHandle)
+{
+    power_wdrvHandle = wdrvHandle;
+    power_dozing     = false;
+    power_state      = POWER_STATE_AWAKE;
+    power_lastCount  = SYS_TIME_CounterGet();
+    memset(&powerStats, 0, sizeof(powerStats));
+    memset(power_deadlineSet, 0, sizeof(power_deadlineSet));
+}
+
+void POWER_enable(bool enable)
+{
+    power_enabled = enable;
+
+    if (!enable && power_wdrvHandle != DRV_HANDLE_INVALID)
+    {
+        power_setMode(false, 0);
+        power_state = POWER_STATE_AWAKE;
+    }
+}
+
+bool POWER_isEnabled(void)
+{
+    return power_enabled;
+}
+
+void POWER_setDeadline(power_deadline_t deadline, int32_t msFromNow)
+{
+    if (deadline >= POWER_DEADLINE_COUNT)
+    {
+        return;
+    }
+
+    if (msFromNow < 0)
+    {
+        power_deadlineSet[deadline] = false;
+        return;
+    }
+
+    power_deadlineSet[deadline]   = true;
+    power_deadlineCount[deadline] = SYS_TIME_CounterGet() + SYS_TIME_MSToCount((uint32_t)msFromNow);
+}
+
+// Called once a second from CLOUD_task.  linkBusy keeps the radio awake while
+// a connection, handshake or exchange is in progress.
+void POWER_task(bool linkBusy)
+{
+    uint32_t now = SYS_TIME_CounterGet();
+    int32_t  msNext;
+    uint32_t listenInterval;
+
+    powerStats.stateMs[power_state] += SYS_TIME_CountToMS(now - power_lastCount);
+    power_lastCount = now;
+
+    if (!power_enabled || power_wdrvHandle == DRV_HANDLE_INVALID)
+    {
+        power_state = POWER_STATE_AWAKE;
+        return;
+    }
+
+    msNext = power_msUntilNextDeadline();
+
+    if (linkBusy || msNext < 0)
+    {
+        power_state = POWER_STATE_AWAKE;
+        power_setMode(false, 0);
+    }
+    else if (msNext <= CFG_WINC_PS_WAKE_AHEAD_MS)
+    {
+        // Up and associated before the send, so it does not wait for a wake-up
+        power_state = POWER_STATE_WAKE_AHEAD;
+        power_setMode(false, 0);
+    }
+    else
+    {
+        // Skip as many beacons as fit before the wake-ahead point
+        listenInterval = ((uint32_t)(msNext - CFG_WINC_PS_WAKE_AHEAD_MS) * 1000UL) / POWER_BEACON_PERIOD_US;
+        if (listenInterval < 1)
+        {
+            listenInterval = 1;
+        }
+        else if (listenInterval > CFG_WINC_PS_LISTEN_INTERVAL_MAX)
+        {
+            listenInterval = CFG_WINC_PS_LISTEN_INTERVAL_MAX;
+        }
+
+        if (power_state != POWER_STATE_DOZE)
+        {
+            powerStats.lastDozeMs = (uint32_t)msNext;
+        }
+        power_state = POWER_STATE_DOZE;
+        power_setMode(true, (uint16_t)listenInterval);
+    }
+}
+
+power_state_t POWER_getState(void)
+{
+    return power_state;
+}
+
+// Doze floor plus the beacon receptions at the given listen interval
+static uint32_t power_dozeUa(uint16_t listenInterval)
+{
+    uint32_t beaconUs = (uint32_t)(listenInterval ? listenInterval : 1) * POWER_BEACON_PERIOD_US;
+
+    return CFG_WINC_CURRENT_DOZE_UA + (uint32_t)(((uint64_t)CFG_WINC_CURRENT_AWAKE_UA * CFG_WINC_PS_BEACON_RX_US) / beaconUs);
+}
+
+uint32_t POWER_estimateUa(uint32_t telemetrySec, uint32_t keepAliveSec, uint16_t listenInterval)
+{
+    uint64_t awakeMsPerHour = 0;
+    uint32_t wakesPerHour   = 0;
+
+    if (telemetrySec > 0)
+    {
+        wakesPerHour += 3600UL / telemetrySec;
+    }
+
+    // A publish restarts the keep-alive timer, so pings only go out when telemetry is slower
+    if (keepAliveSec > 0 && (telemetrySec == 0 || telemetrySec >= keepAliveSec))
+    {
+        wakesPerHour += 3600UL / keepAliveSec;
+    }
+
+    awakeMsPerHour = (uint64_t)wakesPerHour * (CFG_WINC_PS_WAKE_AHEAD_MS + CFG_WINC_PS_SEND_ACTIVE_MS);
+    if (awakeMsPerHour > 3600000ULL)
+    {
+        awakeMsPerHour = 3600000ULL;
+    }
+
+    return (uint32_t)((awakeMsPerHour * CFG_WINC_CURRENT_AWAKE_UA + (3600000ULL - awakeMsPerHour) * power_dozeUa(listenInterval)) / 3600000ULL);
+}
+
+uint32_t POWER_measuredUa(void)
+{
+    uint64_t awakeMs = (uint64_t)powerStats.stateMs[POWER_STATE_AWAKE] + powerStats.stateMs[POWER_STATE_WAKE_AHEAD];
+    uint64_t dozeMs  = powerStats.stateMs[POWER_STATE_DOZE];
+
+    if (awakeMs + dozeMs == 0)
+    {
+        return 0;
+    }
+
+    return (uint32_t)((awakeMs * CFG_WINC_CURRENT_AWAKE_UA + dozeMs * power_dozeUa(powerStats.listenInterval)) / (awakeMs + dozeMs));
+}
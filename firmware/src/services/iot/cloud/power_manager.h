@@ -0,0 +1,75 @@
+/*
+\file   power_manager.h
+
+\brief  WINC power save manager header file.
+
+(c) 2018 Microchip Technology Inc. and its subsidiaries.
+
+Subject to your compliance with these terms, you may use Microchip software and any
+derivatives exclusively with Microchip products. It is your responsibility to comply with third party
+license terms applicable to your use of third party software (including open source software) that
+may accompany Microchip software.
+
+THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY
+IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS
+FOR A PARTICULAR PURPOSE.
+
+IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
+INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND
+WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP
+HAS BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO
+THE FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL
+CLAIMS IN ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT
+OF FEES, IF ANY, THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS
+SOFTWARE.
+*/
+
+#ifndef POWER_MANAGER_H_
+#define POWER_MANAGER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "driver/driver_common.h"
+
+// Events the radio has to be awake for
+typedef enum
+{
+    POWER_DEADLINE_TELEMETRY = 0,
+    POWER_DEADLINE_KEEPALIVE,
+    POWER_DEADLINE_BACKOFF,
+    POWER_DEADLINE_COUNT
+} power_deadline_t;
+
+// Where the radio time goes
+typedef enum
+{
+    POWER_STATE_AWAKE = 0,   // connecting or traffic in flight, power save off
+    POWER_STATE_WAKE_AHEAD,  // power save off ahead of the next deadline
+    POWER_STATE_DOZE,        // deep automatic power save between deadlines
+    POWER_STATE_COUNT
+} power_state_t;
+
+typedef struct
+{
+    uint32_t stateMs[POWER_STATE_COUNT];
+    uint32_t modeChanges;
+    uint16_t listenInterval;   // beacon periods used for the last doze
+    uint32_t lastDozeMs;       // time to the deadline when the last doze started
+} power_stats_t;
+
+extern power_stats_t powerStats;
+
+void          POWER_init(DRV_HANDLE wdrvHandle);
+void          POWER_enable(bool enable);
+bool          POWER_isEnabled(void);
+void          POWER_setDeadline(power_deadline_t deadline, int32_t msFromNow);
+void          POWER_task(bool linkBusy);
+power_state_t POWER_getState(void);
+
+// Average WINC current in uA for a traffic pattern, from the CFG_WINC_CURRENT_* figures
+uint32_t POWER_estimateUa(uint32_t telemetrySec, uint32_t keepAliveSec, uint16_t listenInterval);
+// Average WINC current in uA over the time budget measured so far
+uint32_t POWER_measuredUa(void);
+
+#endif /* POWER_MANAGER_H_ */
@@ -33,15 +33,20 @@ SOFTWARE.
 #include "wifi_service.h"
 #include "app.h"
 #include "debug_print.h"
+#include "metrics.h"
 #include "../../../iot_config/IoT_Sensor_Node_config.h"
 #include "../../../iot_config/mqtt_config.h"
 #include "socket.h"
 #include "../../../credentials_storage/credentials_storage.h"
 #include "led.h"
+#include "backoff.h"
+#include "scheduler.h"
 
 #define CLOUD_WIFI_TASK_INTERVAL       50L
 #define CLOUD_NTP_TASK_INTERVAL        500L
 #define SOFT_AP_CONNECT_RETRY_INTERVAL 1000L
+#define WIFI_RETRY_BACKOFF_BASE_MS     2000L
+#define WIFI_RETRY_BACKOFF_CAP_MS      120000L   // 2 minutes
 
 #define CFG_WLAN_AP_NAME "SAM.IoT"
 #define CFG_WLAN_AP_IP_ADDRESS \
@@ -54,11 +59,6 @@ SYS_TIME_HANDLE wifiHandlerTaskHandle   = SYS_TIME_HANDLE_INVALID;
 SYS_TIME_HANDLE softApConnectTaskHandle = SYS_TIME_HANDLE_INVALID;
 SYS_TIME_HANDLE checkBackTaskHandle     = SYS_TIME_HANDLE_INVALID;
 
-volatile bool ntpTimeFetchTaskTmrExpired  = false;
-volatile bool wifiHandlerTaskTmrExpired   = false;
-volatile bool softApConnectTaskTmrExpired = false;
-volatile bool checkBackTaskTmrExpired     = false;
-
 // Scheduler
 void ntpTimeFetchTask(void);
 void wifiHandlerTask(void);
@@ -67,6 +67,8 @@ void checkBackTask(void);
 
 static bool responseFromProvisionConnect = false;
 
+backoff_t wifiConnectBackoff;
+
 void (*callback_funcPtr)(uint8_t);
 void enable_provision_ap(void);
 
@@ -78,22 +80,40 @@ int8_t hif_deinit(void* arg);
 
 void ntpTimeFetchTaskcb(uintptr_t context)
 {
-    ntpTimeFetchTaskTmrExpired = true;
+    SCHED_post(SCHED_EVENT_WIFI_NTP_FETCH);
 }
 
 void wifiHandlerTaskcb(uintptr_t context)
 {
-    wifiHandlerTaskTmrExpired = true;
+    SCHED_post(SCHED_EVENT_WIFI_HANDLER);
 }
 
 void softApConnectTaskcb(uintptr_t context)
 {
-    softApConnectTaskTmrExpired = true;
+    SCHED_post(SCHED_EVENT_WIFI_SOFTAP_CONNECT);
 }
 
 void checkBackTaskcb(uintptr_t context)
 {
-    checkBackTaskTmrExpired = true;
+    SCHED_post(SCHED_EVENT_WIFI_CHECKBACK);
+}
+
+static void wifiHandlerTaskEvent(void)
+{
+    debug_printWarn(" WIFI: Handler Timeout");
+    wifiHandlerTask();
+}
+
+static void checkBackTaskEvent(void)
+{
+    debug_printTrace(" WIFI: Checkback Timeout");
+    checkBackTask();
+}
+
+static void softApConnectTaskEvent(void)
+{
+    debug_printWarn(" WIFI: SoftAP Timeout");
+    softApConnectTask();
 }
 
 // funcPtr passed in here will be called indicating AP state changes with the following values
@@ -103,6 +123,11 @@ void checkBackTaskcb(uintptr_t context)
 void wifi_init(void (*funcPtr)(uint8_t), uint8_t mode)
 {
     wifiConnectionStateChangedCallback = funcPtr;
+    SCHED_register(SCHED_EVENT_WIFI_NTP_FETCH, ntpTimeFetchTask);
+    SCHED_register(SCHED_EVENT_WIFI_HANDLER, wifiHandlerTaskEvent);
+    SCHED_register(SCHED_EVENT_WIFI_CHECKBACK, checkBackTaskEvent);
+    SCHED_register(SCHED_EVENT_WIFI_SOFTAP_CONNECT, softApConnectTaskEvent);
+    BACKOFF_init(&wifiConnectBackoff, "wifi", WIFI_RETRY_BACKOFF_BASE_MS, WIFI_RETRY_BACKOFF_CAP_MS);
 
     // Mode == 0 means AP configuration mode
     if (mode == WIFI_SOFT_AP)
@@ -120,6 +145,11 @@ bool wifi_connectToAp(uint8_t passed_wifi_creds)
 {
     int8_t e = M2M_SUCCESS;
 
+    if (wifiConnectBackoff.attempts > 0)
+    {
+        debug_printInfo(" WIFI: Connect retry %lu", wifiConnectBackoff.attempts);
+    }
+
     if (passed_wifi_creds == NEW_CREDENTIALS)
     {
         e = m2m_wifi_connect((char*)ssid, sizeof(ssid), atoi((char*)authType), (char*)pass, M2M_WIFI_CH_ALL);
@@ -139,6 +169,12 @@ bool wifi_connectToAp(uint8_t passed_wifi_creds)
     return true;
 }
 
+// Delay before the next wifi_connectToAp() after a failed connection
+uint32_t wifi_getRetryDelay(void)
+{
+    return BACKOFF_next(&wifiConnectBackoff);
+}
+
 bool wifi_disconnectFromAp(void)
 {
     int8_t m2mDisconnectError;
@@ -223,11 +259,13 @@ void WiFi_ConStateCb(tenuM2mConnState status)
 
         LED_SetWiFi(LED_INDICATOR_SUCCESS);
         shared_networking_params.haveAPConnection = 1;
+        BACKOFF_reset(&wifiConnectBackoff);
         debug_printGood(" WIFI: Connection Status: CONNECTED");
         CREDENTIALS_STORAGE_clearWifiCredentials();
     }
     else if (status == M2M_WIFI_DISCONNECTED)
     {
+        METRIC_INC(WIFI_DISCONNECTS);
         checkBackTaskHandle = SYS_TIME_CallbackRegisterMS(checkBackTaskcb, 0, CLOUD_WIFI_TASK_INTERVAL, SYS_TIME_SINGLE);
         LED_SetWiFi(LED_INDICATOR_OFF);
         shared_networking_params.amDisconnecting = 1;
@@ -251,33 +289,6 @@ void WiFi_ProvisionCb(uint8_t sectype, uint8_t* SSID, uint8_t* password)
     softApConnectTaskHandle = SYS_TIME_CallbackRegisterMS(softApConnectTaskcb, 0, SOFT_AP_CONNECT_RETRY_INTERVAL, SYS_TIME_PERIODIC);
 }
 
-void wifi_sched(void)
-{
-    if (ntpTimeFetchTaskTmrExpired == true)
-    {
-        ntpTimeFetchTaskTmrExpired = false;
-        ntpTimeFetchTask();
-    }
-    if (wifiHandlerTaskTmrExpired == true)
-    {
-        debug_printWarn(" WIFI: Handler Timeout");
-        wifiHandlerTaskTmrExpired = false;
-        wifiHandlerTask();
-    }
-    if (checkBackTaskTmrExpired == true)
-    {
-        debug_printTrace(" WIFI: Checkback Timeout");
-        checkBackTaskTmrExpired = false;
-        checkBackTask();
-    }
-    if (softApConnectTaskTmrExpired == true)
-    {
-        debug_printWarn(" WIFI: SoftAP Timeout");
-        softApConnectTaskTmrExpired = false;
-        softApConnectTask();
-    }
-}
-
 bool wifi_getIpAddressByHostName(uint8_t* host_name)
 {
     debug_printGood(" WIFI: Getting IP for %s", host_name);
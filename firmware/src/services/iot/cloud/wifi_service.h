@@ -30,6 +30,7 @@ SOFTWARE.
 
 #include <stdint.h>
 #include <stdbool.h>
+#include "m2m_types.h"
 
 #define MAX_WIFI_CRED_LENGTH 31
 #define DEFAULT_CREDENTIALS  0
@@ -45,12 +46,32 @@ struct wifi_params
 };
 extern struct wifi_params wifi_params;
 
+// Connection progress shared by the application, wifi_service and cloud_service
+typedef union
+{
+    uint16_t allBits;
+    struct
+    {
+        uint16_t haveAPConnection : 1;
+        uint16_t haveIpAddress : 1;
+        uint16_t haveHostIp : 1;
+        uint16_t haveSocketConnection : 1;
+        uint16_t haveMqttConnection : 1;
+        uint16_t amDisconnecting : 1;
+        uint16_t haveERROR : 1;
+        uint16_t cloudInitPending : 1;
+        uint16_t : 8;
+    };
+} shared_networking_params_t;
+
+extern shared_networking_params_t shared_networking_params;
+
 // If you pass a callback function in here it will be called when the AP state changes. Pass NULL if you do not want that.
 void wifi_init(void (*funcPtr)(uint8_t), uint8_t mode);
 bool wifi_connectToAp(uint8_t passed_wifi_creds);
+uint32_t wifi_getRetryDelay(void);
 bool wifi_disconnectFromAp(void);
 void WiFi_ConStateCb(tenuM2mConnState status);
 void WiFi_ProvisionCb(uint8_t sectype, uint8_t* SSID, uint8_t* password);
-void wifi_sched(void);
 bool wifi_getIpAddressByHostName(uint8_t* host_name);
 #endif /* WIFI_SERVICE_H_ */
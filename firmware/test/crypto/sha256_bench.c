@@ -0,0 +1,105 @@
+/*
+    \file   sha256_bench.c
+
+    \brief  sha256_bench.ceader file.
+
+    (c) 2018 Microchip Technology Inc. and its subsidiaries.
+
+    Subject to your compliance with these terms, you may use Microchip software and any
+    derivatives exclusively with Microchip products. It is your responsibility to comply with third party
+    license terms applicable to your use of third party software (including open source software) that
+    may accompany Microchip software.
+
+    THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+    EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY
+    IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS
+    FOR A PARTICULAR PURPOSE.
+
+    IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
+    INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND
+    WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP
+    HAS BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO
+    THE FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL
+    CLAIMS IN ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT
+    OF FEES, IF ANY, THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS
+    SOFTWARE.
+*/
+
+
+/* Throughput of the cryptoauthlib software SHA-256 on the build host, in
+ * cycles per byte where the host has a time stamp counter and nanoseconds per
+ * byte always. The absolute numbers are for the host CPU; the ratio between
+ * the sha256_bench_fast and sha256_bench_compact builds is what carries over
+ * to the target, where the same comparison is made with the PERF probes.
+ *
+ *   sha256_bench [--quick]
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "host_bench.h"
+#include "sha2_routines.h"
+
+#define BENCH_RUNS 5
+
+static const uint32_t messageSizes[] = {64, 1024, 16384};
+
+int main(int argc, char** argv)
+{
+    uint32_t totalBytes = (argc > 1 && strcmp(argv[1], "--quick") == 0) ? (1UL << 20) : (64UL << 20);
+    uint8_t digest[SHA256_DIGEST_SIZE];
+    static uint8_t message[16384 + 1];
+    size_t s;
+
+    for (s = 0; s < sizeof(message); s++)
+    {
+        message[s] = (uint8_t)(s * 131u);
+    }
+
+    printf("%-8s %7s %10s %10s\n", "size", "offset", "cyc/byte", "ns/byte");
+    for (s = 0; s < sizeof(messageSizes) / sizeof(messageSizes[0]); s++)
+    {
+        uint32_t size = messageSizes[s];
+        uint32_t offset;
+
+        for (offset = 0; offset < 2; offset++)
+        {
+            uint64_t bestNs = UINT64_MAX;
+            uint64_t bestCycles = UINT64_MAX;
+            uint32_t iterations = totalBytes / size;
+            int run;
+
+            // Best of several runs, the minimum is the least disturbed by the host
+            for (run = 0; run < BENCH_RUNS; run++)
+            {
+                uint64_t startNs = HOST_BENCH_nowNs();
+                uint64_t startCycles = HOST_BENCH_cycles();
+                uint64_t cycles, ns;
+                uint32_t i;
+
+                for (i = 0; i < iterations; i++)
+                {
+                    sw_sha256(&message[offset], size, digest);
+                    message[offset] ^= digest[0];
+                }
+                cycles = HOST_BENCH_cycles() - startCycles;
+                ns = HOST_BENCH_nowNs() - startNs;
+                if (cycles < bestCycles)
+                {
+                    bestCycles = cycles;
+                }
+                if (ns < bestNs)
+                {
+                    bestNs = ns;
+                }
+            }
+
+            printf("%-8u %7u %10.2f %10.3f\n", (unsigned)size, (unsigned)offset,
+                   HOST_BENCH_HAVE_CYCLES ? (double)bestCycles / ((double)iterations * size) : 0.0,
+                   (double)bestNs / ((double)iterations * size));
+        }
+    }
+    return 0;
+}
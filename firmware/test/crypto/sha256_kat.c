@@ -0,0 +1,135 @@
+/*
+    \file   sha256_kat.c
+
+    \brief  sha256_kat.ceader file.
+
+    (c) 2018 Microchip Technology Inc. and its subsidiaries.
+
+    Subject to your compliance with these terms, you may use Microchip software and any
+    derivatives exclusively with Microchip products. It is your responsibility to comply with third party
+    license terms applicable to your use of third party software (including open source software) that
+    may accompany Microchip software.
+
+    THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+    EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY
+    IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS
+    FOR A PARTICULAR PURPOSE.
+
+    IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
+    INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND
+    WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP
+    HAS BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO
+    THE FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL
+    CLAIMS IN ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT
+    OF FEES, IF ANY, THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS
+    SOFTWARE.
+*/
+
+
+/* NIST FIPS 180-2 SHA-256 known answers for the cryptoauthlib software hash.
+ * Every vector is hashed in one call from each byte offset, so aligned and
+ * unaligned block loads are both covered, and again fed in uneven pieces so
+ * the partial block path in sw_sha256_update() is exercised as well.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sha2_routines.h"
+
+#define MILLION_A_LENGTH 1000000
+
+typedef struct
+{
+    const char* name;
+    const char* message;        // NULL for the million 'a' vector
+    const char* digest;
+} sha256_vector_t;
+
+static const sha256_vector_t vectors[] = {
+    {"empty", "", "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855"},
+    {"abc", "abc", "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad"},
+    {"448-bit", "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq",
+     "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1"},
+    {"million a", NULL, "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0"},
+};
+
+static int failures;
+
+static void check(const sha256_vector_t* vector, const char* how, const uint8_t digest[SHA256_DIGEST_SIZE])
+{
+    char hex[SHA256_DIGEST_SIZE * 2 + 1];
+    int i;
+
+    for (i = 0; i < SHA256_DIGEST_SIZE; i++)
+    {
+        sprintf(&hex[i * 2], "%02x", digest[i]);
+    }
+    if (strcmp(hex, vector->digest) != 0)
+    {
+        printf("FAIL %s (%s)\n  got  %s\n  want %s\n", vector->name, how, hex, vector->digest);
+        failures++;
+    }
+}
+
+int main(void)
+{
+    static const uint32_t pieces[] = {1, 3, 63, 64, 65, 127, 1000};
+    uint8_t digest[SHA256_DIGEST_SIZE];
+    uint8_t* buffer;
+    size_t v;
+
+    // Room for the longest message at every offset up to 3
+    buffer = malloc(MILLION_A_LENGTH + 4);
+    if (buffer == NULL)
+    {
+        return 2;
+    }
+
+    for (v = 0; v < sizeof(vectors) / sizeof(vectors[0]); v++)
+    {
+        const sha256_vector_t* vector = &vectors[v];
+        uint32_t length = vector->message ? (uint32_t)strlen(vector->message) : MILLION_A_LENGTH;
+        uint32_t offset;
+        size_t p;
+
+        for (offset = 0; offset < 4; offset++)
+        {
+            char how[32];
+
+            if (vector->message)
+            {
+                memcpy(&buffer[offset], vector->message, length);
+            }
+            else
+            {
+                memset(&buffer[offset], 'a', length);
+            }
+            sw_sha256(&buffer[offset], length, digest);
+            sprintf(how, "one call, offset %u", (unsigned)offset);
+            check(vector, how, digest);
+        }
+
+        for (p = 0; p < sizeof(pieces) / sizeof(pieces[0]); p++)
+        {
+            sw_sha256_ctx ctx;
+            uint32_t done;
+            char how[32];
+
+            sw_sha256_init(&ctx);
+            for (done = 0; done < length; done += pieces[p])
+            {
+                uint32_t size = length - done < pieces[p] ? length - done : pieces[p];
+                sw_sha256_update(&ctx, &buffer[3 + done], size);
+            }
+            sw_sha256_final(&ctx, digest);
+            sprintf(how, "%u byte pieces", (unsigned)pieces[p]);
+            check(vector, how, digest);
+        }
+    }
+
+    free(buffer);
+    printf("%s\n", failures ? "FAILED" : "PASSED");
+    return failures ? 1 : 0;
+}
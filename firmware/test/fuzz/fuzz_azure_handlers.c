@@ -0,0 +1,171 @@
+/*
+    \file   fuzz_azure_handlers.c
+
+    \brief  fuzz_azure_handlers.ceader file.
+
+    (c) 2018 Microchip Technology Inc. and its subsidiaries.
+
+    Subject to your compliance with these terms, you may use Microchip software and any
+    derivatives exclusively with Microchip products. It is your responsibility to comply with third party
+    license terms applicable to your use of third party software (including open source software) that
+    may accompany Microchip software.
+
+    THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+    EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY
+    IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS
+    FOR A PARTICULAR PURPOSE.
+
+    IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
+    INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND
+    WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP
+    HAS BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO
+    THE FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL
+    CLAIMS IN ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT
+    OF FEES, IF ANY, THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS
+    SOFTWARE.
+*/
+
+
+
+/* Fuzz harness for the IoT Hub message handlers. APP_ReceivedFromCloud_*()
+ * in app.c hand the topic and payload of a received PUBLISH, both NUL
+ * terminated by mqtt_core, to the parsers in azutil.c. app.c pulls in the
+ * board drivers, so the harness makes the same calls the handlers make:
+ *
+ *   methods  az_iot_pnp_client_commands_parse_received_topic(), then
+ *            process_direct_method_command(), which runs the command and
+ *            builds its response
+ *   patch    process_device_twin_property() on a desired property patch,
+ *            then update_leds() and send_reported_property()
+ *   twin     the same for the twin document GET response
+ *
+ * The input is one selector byte (0 methods, 1 patch, 2 twin, modulo 3),
+ * then the topic, a NUL, and the payload up to the end of the input.
+ * Responses go to a CLOUD_publishData() that only reads them.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include "definitions.h"
+#include "host_time.h"
+#include "azutil.h"
+#include "led.h"
+
+#define FUZZ_HUB_HOST  "fuzz.azure-devices.net"
+#define FUZZ_DEVICE_ID "fuzz"
+#define FUZZ_TEXT_MAX  (TOPIC_SIZE + PAYLOAD_SIZE)
+
+az_iot_pnp_client        pnp_client;
+az_iot_hub_client        iothub_client;
+volatile uint32_t        telemetryInterval = CFG_DEFAULT_TELEMETRY_INTERVAL_SEC;
+led_status_t             led_status;
+uint16_t                 packet_identifier;
+static volatile uint32_t fuzzSink;
+
+/**********************What azutil.c calls outside of itself ***********************/
+void CLOUD_publishData(uint8_t* topic, uint8_t* payload, uint16_t payload_len, int qos)
+{
+    uint16_t i;
+
+    fuzzSink += strlen((char*)topic);
+    for (i = 0; i < payload_len; i++)
+    {
+        fuzzSink += payload[i];
+    }
+}
+
+float APP_GetTempSensorValue(void)
+{
+    return 21.5f;
+}
+
+int32_t APP_GetLightSensorValue(void)
+{
+    return 100;
+}
+
+/**********************Harness ******************************************************/
+static void fuzz_methods(uint8_t* topic, uint8_t* payload)
+{
+    az_iot_pnp_client_command_request command_request;
+    az_span                           command_topic_span = az_span_create(topic, (int32_t)strlen((char*)topic));
+
+    if (az_result_succeeded(az_iot_pnp_client_commands_parse_received_topic(&pnp_client, command_topic_span, &command_request)))
+    {
+        process_direct_method_command(payload, &command_request);
+    }
+}
+
+static void fuzz_twin(uint8_t* topic, uint8_t* payload, bool patch)
+{
+    twin_properties_t twin_properties;
+
+    init_twin_data(&twin_properties);
+    if (patch)
+    {
+        twin_properties.flag.is_initial_get = 0;
+    }
+    if (az_result_succeeded(process_device_twin_property(topic, payload, &twin_properties)))
+    {
+        update_leds(&twin_properties);
+        send_reported_property(&twin_properties);
+    }
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+    static bool initialized = false;
+    uint8_t*    text;
+    uint8_t*    payload;
+    size_t      length;
+    uint8_t     selector;
+
+    if (!initialized)
+    {
+        initialized = true;
+        az_iot_pnp_client_init(&pnp_client,
+                               AZ_SPAN_FROM_STR(FUZZ_HUB_HOST),
+                               AZ_SPAN_FROM_STR(FUZZ_DEVICE_ID),
+                               AZ_SPAN_FROM_STR(IOT_PLUG_AND_PLAY_MODEL_ID),
+                               NULL);
+    }
+    if (size < 1 || size - 1 > FUZZ_TEXT_MAX)
+    {
+        return 0;
+    }
+    selector = data[0] % 3;
+    length   = size - 1;
+
+    // Topic and payload as mqtt_core passes them: NUL terminated, in buffers
+    // of exactly that size
+    text = malloc(length + 2);
+    if (text == NULL)
+    {
+        return 0;
+    }
+    memcpy(text, data + 1, length);
+    text[length]     = '\0';
+    text[length + 1] = '\0';
+    payload          = text + strlen((char*)text) + 1;
+
+    HOST_TIME_reset();
+    telemetryInterval = CFG_DEFAULT_TELEMETRY_INTERVAL_SEC;
+    memset(&led_status, 0, sizeof(led_status));
+
+    switch (selector)
+    {
+        case 0:
+            fuzz_methods(text, payload);
+            break;
+        case 1:
+            fuzz_twin(text, payload, true);
+            break;
+        default:
+            fuzz_twin(text, payload, false);
+            break;
+    }
+    free(text);
+    return 0;
+}
@@ -0,0 +1,314 @@
+/*
+    \file   fuzz_main.c
+
+    \brief  fuzz_main.ceader file.
+
+    (c) 2018 Microchip Technology Inc. and its subsidiaries.
+
+    Subject to your compliance with these terms, you may use Microchip software and any
+    derivatives exclusively with Microchip products. It is your responsibility to comply with third party
+    license terms applicable to your use of third party software (including open source software) that
+    may accompany Microchip software.
+
+    THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+    EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY
+    IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS
+    FOR A PARTICULAR PURPOSE.
+
+    IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
+    INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND
+    WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP
+    HAS BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO
+    THE FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL
+    CLAIMS IN ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT
+    OF FEES, IF ANY, THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS
+    SOFTWARE.
+*/
+
+
+
+/* Stand-alone driver for the fuzz harnesses, for compilers without libFuzzer.
+ * It calls the same LLVMFuzzerTestOneInput() that libFuzzer would:
+ *
+ *   harness FILE|DIR...               run each file, and each file in each DIR
+ *   harness --mutate N FILE|DIR...    then N mutations of those inputs
+ *   harness < FILE                    one input from stdin, as afl-fuzz runs it
+ *
+ * Every input is copied into a buffer of exactly its size, so AddressSanitizer
+ * catches a read past the end. Mutations come from a fixed seed (--seed to
+ * change it): bit flips, byte overwrites with boundary values, inserted and
+ * deleted runs, and splices of two inputs. The same run replays exactly.
+ */
+
+#include <dirent.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#define FUZZ_INPUT_MAX  65536
+#define FUZZ_INPUTS_MAX 1024
+
+int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size);
+
+typedef struct
+{
+    uint8_t* data;
+    size_t   size;
+} fuzzInput_t;
+
+static fuzzInput_t inputs[FUZZ_INPUTS_MAX];
+static size_t      inputCount;
+static uint32_t    fuzzState = 0x2545F491UL;
+
+static uint32_t fuzz_random(void)
+{
+    uint32_t x = fuzzState;
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    fuzzState = x;
+    return x;
+}
+
+static void fuzz_run(const uint8_t* data, size_t size)
+{
+    uint8_t* copy = malloc(size ? size : 1);
+
+    if (copy == NULL)
+    {
+        exit(1);
+    }
+    memcpy(copy, data, size);
+    LLVMFuzzerTestOneInput(copy, size);
+    free(copy);
+}
+
+static int fuzz_readFile(const char* path)
+{
+    FILE*    f = fopen(path, "rb");
+    uint8_t* data;
+    size_t   size;
+
+    if (f == NULL)
+    {
+        perror(path);
+        return -1;
+    }
+    data = malloc(FUZZ_INPUT_MAX);
+    if (data == NULL)
+    {
+        fclose(f);
+        return -1;
+    }
+    size = fread(data, 1, FUZZ_INPUT_MAX, f);
+    fclose(f);
+
+    fuzz_run(data, size);
+    if (inputCount < FUZZ_INPUTS_MAX)
+    {
+        inputs[inputCount].data = data;
+        inputs[inputCount].size = size;
+        inputCount++;
+    }
+    else
+    {
+        free(data);
+    }
+    return 0;
+}
+
+static int compareNames(const void* a, const void* b)
+{
+    return strcmp(*(char* const*)a, *(char* const*)b);
+}
+
+// Files of a directory in name order, so runs do not depend on the file system
+static int fuzz_readDir(const char* path)
+{
+    DIR*           dir = opendir(path);
+    struct dirent* entry;
+    char**         names = NULL;
+    size_t         count = 0;
+    size_t         i;
+    int            ret = 0;
+
+    if (dir == NULL)
+    {
+        perror(path);
+        return -1;
+    }
+    while ((entry = readdir(dir)) != NULL)
+    {
+        char** grown;
+
+        if (entry->d_name[0] == '.')
+        {
+            continue;
+        }
+        grown = realloc(names, (count + 1) * sizeof(names[0]));
+        if (grown == NULL)
+        {
+            ret = -1;
+            break;
+        }
+        names        = grown;
+        names[count] = malloc(strlen(path) + strlen(entry->d_name) + 2);
+        if (names[count] == NULL)
+        {
+            ret = -1;
+            break;
+        }
+        sprintf(names[count], "%s/%s", path, entry->d_name);
+        count++;
+    }
+    closedir(dir);
+
+    qsort(names, count, sizeof(names[0]), compareNames);
+    for (i = 0; i < count; i++)
+    {
+        if (ret == 0 && fuzz_readFile(names[i]) != 0)
+        {
+            ret = -1;
+        }
+        free(names[i]);
+    }
+    free(names);
+    return ret;
+}
+
+static size_t fuzz_mutate(uint8_t* data, size_t size, size_t max)
+{
+    static const uint8_t interesting[] = {0x00, 0x01, 0x7F, 0x80, 0xFF, '"', '{', '}', '/', '#'};
+    uint32_t             rounds        = 1 + fuzz_random() % 4;
+    size_t               pos;
+    size_t               length;
+
+    while (rounds--)
+    {
+        pos = size ? fuzz_random() % size : 0;
+        switch (fuzz_random() % 5)
+        {
+            case 0:
+                if (size)
+                {
+                    data[pos] ^= (uint8_t)(1 << (fuzz_random() % 8));
+                }
+                break;
+            case 1:
+                if (size)
+                {
+                    data[pos] = interesting[fuzz_random() % sizeof(interesting)];
+                }
+                break;
+            case 2:
+                // Insert a run of one random byte
+                length = 1 + fuzz_random() % 8;
+                if (size + length <= max)
+                {
+                    memmove(&data[pos + length], &data[pos], size - pos);
+                    memset(&data[pos], (int)(fuzz_random() & 0xFF), length);
+                    size += length;
+                }
+                break;
+            case 3:
+                // Delete a run
+                length = 1 + fuzz_random() % 8;
+                if (pos + length <= size)
+                {
+                    memmove(&data[pos], &data[pos + length], size - pos - length);
+                    size -= length;
+                }
+                break;
+            default:
+                // Splice the tail of another input
+                if (inputCount)
+                {
+                    const fuzzInput_t* other = &inputs[fuzz_random() % inputCount];
+                    size_t             from  = other->size ? fuzz_random() % other->size : 0;
+
+                    length = other->size - from;
+                    if (pos + length > max)
+                    {
+                        length = max - pos;
+                    }
+                    memcpy(&data[pos], &other->data[from], length);
+                    size = pos + length;
+                }
+                break;
+        }
+    }
+    return size;
+}
+
+int main(int argc, char** argv)
+{
+    unsigned long mutations = 0;
+    unsigned long n;
+    uint8_t*      buffer;
+    size_t        size;
+    int           files = 0;
+    int           arg;
+    struct stat   st;
+
+    for (arg = 1; arg < argc; arg++)
+    {
+        if (strcmp(argv[arg], "--mutate") == 0 && arg + 1 < argc)
+        {
+            mutations = strtoul(argv[++arg], NULL, 0);
+        }
+        else if (strcmp(argv[arg], "--seed") == 0 && arg + 1 < argc)
+        {
+            fuzzState = (uint32_t)strtoul(argv[++arg], NULL, 0);
+            if (fuzzState == 0)
+            {
+                fuzzState = 1;
+            }
+        }
+        else if (stat(argv[arg], &st) == 0)
+        {
+            if ((S_ISDIR(st.st_mode) ? fuzz_readDir(argv[arg]) : fuzz_readFile(argv[arg])) != 0)
+            {
+                return 1;
+            }
+            files++;
+        }
+        else
+        {
+            printf("usage: %s [--mutate N] [--seed S] [FILE|DIR]...\n", argv[0]);
+            return 2;
+        }
+    }
+
+    buffer = malloc(FUZZ_INPUT_MAX);
+    if (buffer == NULL)
+    {
+        return 1;
+    }
+    if (files == 0)
+    {
+        size = fread(buffer, 1, FUZZ_INPUT_MAX, stdin);
+        fuzz_run(buffer, size);
+        free(buffer);
+        return 0;
+    }
+
+    for (n = 0; n < mutations && inputCount; n++)
+    {
+        const fuzzInput_t* base = &inputs[n % inputCount];
+
+        memcpy(buffer, base->data, base->size);
+        size = fuzz_mutate(buffer, base->size, FUZZ_INPUT_MAX);
+        fuzz_run(buffer, size);
+    }
+    printf("%u inputs, %lu mutations\n", (unsigned)inputCount, mutations);
+
+    free(buffer);
+    for (n = 0; n < inputCount; n++)
+    {
+        free(inputs[n].data);
+    }
+    return 0;
+}
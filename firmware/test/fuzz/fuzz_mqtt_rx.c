@@ -0,0 +1,222 @@
+/*
+    \file   fuzz_mqtt_rx.c
+
+    \brief  fuzz_mqtt_rx.ceader file.
+
+    (c) 2018 Microchip Technology Inc. and its subsidiaries.
+
+    Subject to your compliance with these terms, you may use Microchip software and any
+    derivatives exclusively with Microchip products. It is your responsibility to comply with third party
+    license terms applicable to your use of third party software (including open source software) that
+    may accompany Microchip software.
+
+    THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+    EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY
+    IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS
+    FOR A PARTICULAR PURPOSE.
+
+    IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
+    INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND
+    WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP
+    HAS BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO
+    THE FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL
+    CLAIMS IN ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT
+    OF FEES, IF ANY, THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS
+    SOFTWARE.
+*/
+
+
+
+/* Fuzz harness for MQTT_ReceptionHandler(). The input is what the broker
+ * sends, preceded by one control byte:
+ *
+ *   bits 0-1  session state before the bytes arrive: 0 waiting for CONNACK,
+ *             1 waiting for SUBACK, 2 or 3 subscribed
+ *   bits 2-7  segment size in units of 8 bytes, 0 for whole WINC buffers
+ *
+ * Each input starts from a fresh client, goes through CONNECT, CONNACK,
+ * SUBSCRIBE and SUBACK as far as the state asks, and then hands the bytes to
+ * the receive path the socket callback uses, MQTT_GetReceivedData(), one
+ * segment at a time. After each segment the harness runs the reception and
+ * transmission handlers the way CLOUD_task() does. Publishes are routed
+ * through the IoT Hub topic filters the firmware subscribes to; DPS and
+ * cloud-to-device topics take the no-match path.
+ *
+ * mqtt_comm_layer.c is built as it is; only the BSD socket calls under it
+ * are replaced, and sends always succeed.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "definitions.h"
+#include "host_time.h"
+#include "scheduler.h"
+#include "mqtt/mqtt_core/mqtt_core.h"
+#include "mqtt/mqtt_comm_bsd/mqtt_comm_layer.h"
+#include "mqtt/mqtt_packetTransfer_interface.h"
+#include "services/iot/cloud/bsd_adapter/bsdWINC.h"
+
+#define FUZZ_STATE_CONNACK    0
+#define FUZZ_STATE_SUBACK     1
+#define FUZZ_SEGMENT_UNIT     8
+#define FUZZ_HANDLER_PASSES   64   // more than the packets a segment can hold
+
+// The subscriptions of mqtt_iothub_packetPopulate.c, as the Azure SDK
+// spells them
+#define FUZZ_TOPIC_METHODS "$iothub/methods/POST/#"
+#define FUZZ_TOPIC_PATCH   "$iothub/twin/PATCH/properties/desired/#"
+#define FUZZ_TOPIC_TWIN    "$iothub/twin/res/#"
+
+static const uint8_t connack[] = {0x20, 0x02, 0x00, 0x00};
+static const uint8_t suback[]  = {0x90, 0x05, 0x00, 0x01, 0x00, 0x00, 0x00};
+
+static int8_t   fuzzSocket = 0;
+static bool     fuzzSubscribed;
+static volatile size_t fuzzSink;
+
+pf_MQTT_CLIENT* pf_mqtt_client;
+
+/**********************BSD socket calls of mqtt_comm_layer.c *********************/
+int BSD_send(int socket, const void* msg, size_t len, int flags)
+{
+    return (int)len;
+}
+
+int BSD_recv(int socket, const void* msg, size_t len, int flags)
+{
+    return BSD_SUCCESS;
+}
+
+int BSD_close(int socket)
+{
+    return BSD_SUCCESS;
+}
+
+/**********************Cloud client callbacks **************************************/
+// Handlers read the whole topic and payload, as the APP_ReceivedFromCloud_*
+// handlers do with strlen(), so AddressSanitizer sees a missing terminator
+static void fuzz_publishHandler(uint8_t* topic, uint8_t* payload)
+{
+    fuzzSink += strlen((char*)topic) + strlen((char*)payload);
+}
+
+static void fuzz_connected(void)
+{
+    fuzzSubscribed = true;
+}
+
+static void fuzz_pubackHandler(mqttPubackPacket* data)
+{
+    fuzzSink += data->packetIdentifierLSB;
+}
+
+static pf_MQTT_CLIENT fuzzClient = {
+    NULL,
+    NULL,
+    NULL,
+    NULL,
+    fuzz_connected,
+    NULL};
+
+static publishReceptionHandler_t fuzzHandlers[MAX_NUM_TOPICS_SUBSCRIBE] = {
+    {(uint8_t*)FUZZ_TOPIC_METHODS, fuzz_publishHandler},
+    {(uint8_t*)FUZZ_TOPIC_PATCH, fuzz_publishHandler},
+    {(uint8_t*)FUZZ_TOPIC_TWIN, fuzz_publishHandler}};
+
+/**********************Harness ******************************************************/
+static void fuzz_receive(mqttContext* context, const uint8_t* data, size_t size)
+{
+    uint16_t passes;
+    uint16_t before;
+
+    MQTT_GetReceivedData((uint8_t*)data, (uint16_t)size);
+
+    // CLOUD_task() handles one packet per pass; stop once a pass consumes nothing
+    for (passes = 0; passes < FUZZ_HANDLER_PASSES; passes++)
+    {
+        before = context->mqttDataExchangeBuffers.rxbuff.dataLength;
+        if (before == 0 || MQTT_GetConnectionState() == DISCONNECTED)
+        {
+            break;
+        }
+        MQTT_ReceptionHandler(context);
+        MQTT_TransmissionHandler(context);
+        if (context->mqttDataExchangeBuffers.rxbuff.dataLength == before)
+        {
+            break;
+        }
+    }
+}
+
+static void fuzz_startSession(mqttContext* context, uint8_t state)
+{
+    mqttConnectPacket   connectPacket;
+    mqttSubscribePacket subscribePacket;
+    uint8_t             i;
+
+    HOST_TIME_reset();
+    SCHED_init();
+    MQTT_ClientInitialize();
+    context->tcpClientSocket = &fuzzSocket;
+    pf_mqtt_client           = &fuzzClient;
+    fuzzSubscribed           = false;
+    MQTT_SetPublishReceptionHandlerTable(fuzzHandlers);
+    MQTT_Set_Puback_callback(fuzz_pubackHandler);
+
+    memset(&connectPacket, 0, sizeof(connectPacket));
+    connectPacket.connectVariableHeader.keepAliveTimer = 60;
+    connectPacket.clientID                             = (uint8_t*)"fuzz";
+    MQTT_CreateConnectPacket(&connectPacket);
+    MQTT_TransmissionHandler(context);
+    if (state == FUZZ_STATE_CONNACK)
+    {
+        return;
+    }
+
+    fuzz_receive(context, connack, sizeof(connack));
+    memset(&subscribePacket, 0, sizeof(subscribePacket));
+    subscribePacket.packetIdentifierLSB = 1;
+    for (i = 0; i < MAX_NUM_TOPICS_SUBSCRIBE; i++)
+    {
+        subscribePacket.subscribePayload[i].topic       = fuzzHandlers[i].topic;
+        subscribePacket.subscribePayload[i].topicLength = strlen((char*)fuzzHandlers[i].topic);
+    }
+    MQTT_CreateSubscribePacket(&subscribePacket);
+    MQTT_TransmissionHandler(context);
+    if (state == FUZZ_STATE_SUBACK)
+    {
+        return;
+    }
+
+    fuzz_receive(context, suback, sizeof(suback));
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+    mqttContext* context = MQTT_GetClientConnectionInfo();
+    size_t       segment;
+    size_t       chunk;
+
+    if (size < 1)
+    {
+        return 0;
+    }
+    fuzz_startSession(context, data[0] & 0x03);
+    segment = (size_t)(data[0] >> 2) * FUZZ_SEGMENT_UNIT;
+    data++;
+    size--;
+
+    while (size > 0 && MQTT_GetConnectionState() != DISCONNECTED)
+    {
+        chunk = (segment == 0 || segment > SOCKET_BUFFER_MAX_LENGTH) ? SOCKET_BUFFER_MAX_LENGTH : segment;
+        if (chunk > size)
+        {
+            chunk = size;
+        }
+        fuzz_receive(context, data, chunk);
+        data += chunk;
+        size -= chunk;
+    }
+    return 0;
+}
@@ -0,0 +1,128 @@
+#!/usr/bin/env python3
+"""Write the seed corpus of the fuzz harnesses.
+
+    make_corpus.py [--out-dir corpus]
+
+The seeds follow the packets IoT Hub and DPS send to a device as documented
+for the MQTT interface (CONNACK, SUBACK, PUBACK, PINGRESP, twin responses,
+desired property patches, direct methods, cloud-to-device messages and DPS
+registration results).  They are rebuilt from those formats, not captured,
+so the client ids, request ids and versions are made up.  Re-run after
+changing a harness input format and commit the output with it.
+"""
+
+import argparse
+import os
+import struct
+
+TOOLS_DIR = os.path.dirname(os.path.abspath(__file__))
+DEFAULT_OUT_DIR = os.path.join(TOOLS_DIR, "corpus")
+
+# fuzz_mqtt_rx control byte, see fuzz_mqtt_rx.c
+STATE_CONNACK = 0
+STATE_SUBACK = 1
+STATE_SUBSCRIBED = 2
+
+# fuzz_azure_handlers selector byte, see fuzz_azure_handlers.c
+SELECT_METHODS = 0
+SELECT_PATCH = 1
+SELECT_TWIN = 2
+
+TWIN_DOCUMENT = (
+    b'{"desired":{"telemetryInterval":10,"led_y":{"value":2},"$version":4},'
+    b'"reported":{"led_b":{"value":1},"led_g":{"value":3},"led_r":{"value":3},'
+    b'"led_y":{"ac":200,"av":3,"value":{"value":2}},'
+    b'"telemetryInterval":{"ac":200,"av":3,"value":10},"$version":7}}'
+)
+PATCH_DOCUMENT = b'{"telemetryInterval":5,"led_y":{"value":3},"$version":4}'
+
+
+def remaining_length(n):
+    out = bytearray()
+    while True:
+        digit, n = n % 128, n // 128
+        out.append(digit | (0x80 if n else 0))
+        if not n:
+            return bytes(out)
+
+
+def publish(topic, payload, qos=0, packet_id=1):
+    body = struct.pack(">H", len(topic)) + topic
+    if qos:
+        body += struct.pack(">H", packet_id)
+    body += payload
+    return bytes([0x30 | (qos << 1)]) + remaining_length(len(body)) + body
+
+
+def mqtt_seed(state, packets, segment=0):
+    return bytes([state | (segment << 2)]) + b"".join(packets)
+
+
+def mqtt_seeds():
+    connack_ok = b"\x20\x02\x00\x00"
+    suback = b"\x90\x05\x00\x01\x00\x00\x00"
+    twin = publish(b"$iothub/twin/res/200/?$rid=1", TWIN_DOCUMENT)
+    patch = publish(b"$iothub/twin/PATCH/properties/desired/?$version=4", PATCH_DOCUMENT)
+    method = publish(b"$iothub/methods/POST/reboot/?$rid=1", b'{"delay":"PT5S"}')
+    return {
+        "connack_accepted": mqtt_seed(STATE_CONNACK, [connack_ok]),
+        "connack_not_authorized": mqtt_seed(STATE_CONNACK, [b"\x20\x02\x00\x05"]),
+        "connack_then_suback": mqtt_seed(STATE_CONNACK, [connack_ok, suback]),
+        "suback": mqtt_seed(STATE_SUBACK, [suback]),
+        "suback_failure": mqtt_seed(STATE_SUBACK, [b"\x90\x05\x00\x01\x80\x00\x80"]),
+        "twin_get_response": mqtt_seed(STATE_SUBSCRIBED, [twin]),
+        "twin_get_response_segmented": mqtt_seed(STATE_SUBSCRIBED, [twin], segment=4),
+        "twin_reported_ack": mqtt_seed(STATE_SUBSCRIBED, [publish(b"$iothub/twin/res/204/?$rid=2&$version=8", b"")]),
+        "desired_patch": mqtt_seed(STATE_SUBSCRIBED, [patch]),
+        "direct_method": mqtt_seed(STATE_SUBSCRIBED, [method]),
+        "c2d_qos1": mqtt_seed(STATE_SUBSCRIBED, [
+            publish(b"devices/fuzz/messages/devicebound/%24.mid=1&%24.to=%2Fdevices%2Ffuzz", b"hello", qos=1, packet_id=7)]),
+        "puback_pingresp": mqtt_seed(STATE_SUBSCRIBED, [b"\x40\x02\x00\x02", b"\xd0\x00"]),
+        "long_publish": mqtt_seed(STATE_SUBSCRIBED, [
+            publish(b"$iothub/twin/res/200/?$rid=3", b'{"desired":{"$version":1},"pad":"' + b"x" * 200 + b'"}')]),
+        "coalesced": mqtt_seed(STATE_SUBSCRIBED, [patch, method, b"\xd0\x00"], segment=1),
+        "dps_assigning": mqtt_seed(STATE_SUBSCRIBED, [publish(
+            b"$dps/registrations/res/202/?$rid=1&retry-after=3",
+            b'{"operationId":"4.0f1e2d3c4b5a6978.0a1b2c3d","status":"assigning"}')]),
+        "dps_assigned": mqtt_seed(STATE_SUBSCRIBED, [publish(
+            b"$dps/registrations/res/200/?$rid=2",
+            b'{"operationId":"4.0f1e2d3c4b5a6978.0a1b2c3d","status":"assigned",'
+            b'"registrationState":{"registrationId":"fuzz","assignedHub":"fuzz.azure-devices.net",'
+            b'"deviceId":"fuzz","status":"assigned","substatus":"initialAssignment"}}')]),
+    }
+
+
+def azure_seeds():
+    def seed(selector, topic, payload):
+        return bytes([selector]) + topic + b"\0" + payload
+
+    return {
+        "method_reboot": seed(SELECT_METHODS, b"$iothub/methods/POST/reboot/?$rid=1", b'{"delay":"PT5S"}'),
+        "method_reboot_bad_delay": seed(SELECT_METHODS, b"$iothub/methods/POST/reboot/?$rid=2", b'{"delay":"5 seconds"}'),
+        "method_unknown": seed(SELECT_METHODS, b"$iothub/methods/POST/blink/?$rid=3", b"{}"),
+        "patch": seed(SELECT_PATCH, b"$iothub/twin/PATCH/properties/desired/?$version=4", PATCH_DOCUMENT),
+        "patch_out_of_range": seed(SELECT_PATCH, b"$iothub/twin/PATCH/properties/desired/?$version=5",
+                                   b'{"telemetryInterval":-1,"led_y":{"value":9},"$version":5}'),
+        "twin_document": seed(SELECT_TWIN, b"$iothub/twin/res/200/?$rid=1", TWIN_DOCUMENT),
+        "twin_reported_ack": seed(SELECT_TWIN, b"$iothub/twin/res/204/?$rid=2&$version=8", b""),
+    }
+
+
+def write(directory, seeds):
+    os.makedirs(directory, exist_ok=True)
+    for name, data in sorted(seeds.items()):
+        with open(os.path.join(directory, name), "wb") as f:
+            f.write(data)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--out-dir", default=DEFAULT_OUT_DIR, help="corpus root (default %(default)s)")
+    args = parser.parse_args()
+
+    write(os.path.join(args.out_dir, "fuzz_mqtt_rx"), mqtt_seeds())
+    write(os.path.join(args.out_dir, "fuzz_azure_handlers"), azure_seeds())
+
+
+if __name__ == "__main__":
+    main()
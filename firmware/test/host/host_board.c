@@ -0,0 +1,86 @@
+/*
+    \file   host_board.c
+
+    \brief  host_board.ceader file.
+
+    (c) 2018 Microchip Technology Inc. and its subsidiaries.
+
+    Subject to your compliance with these terms, you may use Microchip software and any
+    derivatives exclusively with Microchip products. It is your responsibility to comply with third party
+    license terms applicable to your use of third party software (including open source software) that
+    may accompany Microchip software.
+
+    THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+    EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY
+    IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS
+    FOR A PARTICULAR PURPOSE.
+
+    IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
+    INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND
+    WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP
+    HAS BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO
+    THE FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL
+    CLAIMS IN ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT
+    OF FEES, IF ANY, THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS
+    SOFTWARE.
+*/
+
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "definitions.h"
+#include "led.h"
+#include "m2m_ssl.h"
+#include "services/iot/cloud/wifi_service.h"
+#include "services/iot/cloud/power_manager.h"
+
+// What cloud_service needs from the board outside the socket API. The host is
+// on the network already, so joining the access point succeeds at once, and
+// there are no LEDs to drive or a WINC to put in power save.
+
+shared_networking_params_t shared_networking_params;
+
+uint16_t HOST_mqttPort = 1883;
+
+bool wifi_connectToAp(uint8_t passed_wifi_creds)
+{
+    shared_networking_params.haveAPConnection = 1;
+    shared_networking_params.haveIpAddress    = 1;
+    return true;
+}
+
+// Joining never fails here; the shortest delay BACKOFF_next() gives, as a
+// zero length SYS_TIME callback is refused
+uint32_t wifi_getRetryDelay(void)
+{
+    return 1;
+}
+
+int8_t m2m_ssl_init(tpfAppSSLCb pfAppSSLCb)
+{
+    return M2M_SUCCESS;
+}
+
+void POWER_setDeadline(power_deadline_t deadline, int32_t msFromNow)
+{
+}
+
+void POWER_task(bool linkBusy)
+{
+}
+
+void LED_SetYellow(led_set_state_t newState)
+{
+}
+
+void LED_SetRed(led_set_state_t newState)
+{
+}
+
+void LED_SetWiFi(led_indicator_name_t state)
+{
+}
+
+void LED_SetCloud(led_indicator_name_t state)
+{
+}
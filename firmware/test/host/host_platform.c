@@ -0,0 +1,71 @@
+/*
+    \file   host_platform.c
+
+    \brief  host_platform.ceader file.
+
+    (c) 2018 Microchip Technology Inc. and its subsidiaries.
+
+    Subject to your compliance with these terms, you may use Microchip software and any
+    derivatives exclusively with Microchip products. It is your responsibility to comply with third party
+    license terms applicable to your use of third party software (including open source software) that
+    may accompany Microchip software.
+
+    THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+    EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY
+    IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS
+    FOR A PARTICULAR PURPOSE.
+
+    IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
+    INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND
+    WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP
+    HAS BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO
+    THE FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL
+    CLAIMS IN ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT
+    OF FEES, IF ANY, THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS
+    SOFTWARE.
+*/
+
+
+#include <stdint.h>
+#include <stdio.h>
+#include "definitions.h"
+#include "host_platform.h"
+#include "host_time.h"
+
+// Fri Jan 01 2021 00:00:00 UTC, any fixed date keeps runs repeatable
+#define HOST_RTC_DEFAULT_EPOCH 1609459200
+
+// The XC32 linker symbols memwatch.c refers to. MEMWATCH_get() has no meaning
+// on the host; MEM_malloc() and MEM_free() work as on the target.
+uint32_t _stack;
+uint32_t _min_stack_size;
+uint32_t _min_heap_size;
+
+static bool   host_consoleEnabled = true;
+static time_t host_rtcEpoch       = HOST_RTC_DEFAULT_EPOCH;
+
+void HOST_consoleEnable(bool enable)
+{
+    host_consoleEnabled = enable;
+}
+
+void HOST_rtcSetEpoch(time_t epoch)
+{
+    host_rtcEpoch = epoch;
+}
+
+ssize_t SYS_CONSOLE_Write(const SYS_CONSOLE_HANDLE handle, const void* buf, size_t count)
+{
+    if (host_consoleEnabled)
+    {
+        fwrite(buf, 1, count, stderr);
+    }
+    return (ssize_t)count;
+}
+
+void RTC_RTCCTimeGet(struct tm* currentTime)
+{
+    time_t now = host_rtcEpoch + (time_t)(HOST_TIME_nowUs() / HOST_TIME_FREQUENCY_HZ);
+
+    gmtime_r(&now, currentTime);
+}
@@ -0,0 +1,81 @@
+/*
+    \file   host_socket.c
+
+    \brief  host_socket.ceader file.
+
+    (c) 2018 Microchip Technology Inc. and its subsidiaries.
+
+    Subject to your compliance with these terms, you may use Microchip software and any
+    derivatives exclusively with Microchip products. It is your responsibility to comply with third party
+    license terms applicable to your use of third party software (including open source software) that
+    may accompany Microchip software.
+
+    THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+    EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY
+    IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS
+    FOR A PARTICULAR PURPOSE.
+
+    IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
+    INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND
+    WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP
+    HAS BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO
+    THE FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL
+    CLAIMS IN ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT
+    OF FEES, IF ANY, THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS
+    SOFTWARE.
+*/
+
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "socket.h"
+#include "services/iot/cloud/bsd_adapter/bsdPOSIX.h"
+#include "host_socket.h"
+
+static tpfAppResolveCb host_resolveCallback;
+static char            host_resolveName[HOSTNAME_MAX_SIZE];
+static bool            host_resolvePending;
+
+void socketInit(void)
+{
+}
+
+void socketDeinit(void)
+{
+    host_resolveCallback = NULL;
+    host_resolvePending  = false;
+}
+
+// Socket events come from BSD_POSIX_Tasks() straight into the BSD adapter, only
+// the resolver callback is used
+void registerSocketCallback(tpfAppSocketCb socket_cb, tpfAppResolveCb resolve_cb)
+{
+    host_resolveCallback = resolve_cb;
+}
+
+int8_t gethostbyname(const char* pcHostName)
+{
+    if (pcHostName == NULL || strlen(pcHostName) >= sizeof(host_resolveName))
+    {
+        return SOCK_ERR_INVALID_ARG;
+    }
+    strcpy(host_resolveName, pcHostName);
+    host_resolvePending = true;
+    return SOCK_ERR_NO_ERROR;
+}
+
+void HOST_SOCKET_Tasks(void)
+{
+    if (host_resolvePending)
+    {
+        uint32_t addr = BSD_HOST_resolve(host_resolveName);
+
+        host_resolvePending = false;
+        if (host_resolveCallback != NULL)
+        {
+            host_resolveCallback((uint8_t*)host_resolveName, addr);
+        }
+    }
+    BSD_POSIX_Tasks();
+}
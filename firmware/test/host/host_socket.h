@@ -0,0 +1,42 @@
+/*
+    \file   host_socket.h
+
+    \brief  host_socket.header file.
+
+    (c) 2018 Microchip Technology Inc. and its subsidiaries.
+
+    Subject to your compliance with these terms, you may use Microchip software and any
+    derivatives exclusively with Microchip products. It is your responsibility to comply with third party
+    license terms applicable to your use of third party software (including open source software) that
+    may accompany Microchip software.
+
+    THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+    EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY
+    IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS
+    FOR A PARTICULAR PURPOSE.
+
+    IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
+    INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND
+    WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP
+    HAS BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO
+    THE FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL
+    CLAIMS IN ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT
+    OF FEES, IF ANY, THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS
+    SOFTWARE.
+*/
+
+
+#ifndef HOST_SOCKET_H
+#define HOST_SOCKET_H
+
+// The part of the WINC socket API cloud_service calls directly, for the build
+// against the POSIX backend: socketInit(), registerSocketCallback() and
+// gethostbyname(). Names resolve through the host resolver and the answer
+// comes back from HOST_SOCKET_Tasks(), as the WINC answers from its event
+// handler, so cloud_service sees the same order of events.
+
+// Call from the harness main loop where the firmware calls WDRV_WINC_Tasks().
+// Also runs BSD_POSIX_Tasks().
+void HOST_SOCKET_Tasks(void);
+
+#endif /* HOST_SOCKET_H */
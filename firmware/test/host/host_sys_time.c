@@ -0,0 +1,341 @@
+/*
+    \file   host_sys_time.c
+
+    \brief  host_sys_time.ceader file.
+
+    (c) 2018 Microchip Technology Inc. and its subsidiaries.
+
+    Subject to your compliance with these terms, you may use Microchip software and any
+    derivatives exclusively with Microchip products. It is your responsibility to comply with third party
+    license terms applicable to your use of third party software (including open source software) that
+    may accompany Microchip software.
+
+    THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+    EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY
+    IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS
+    FOR A PARTICULAR PURPOSE.
+
+    IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
+    INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND
+    WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP
+    HAS BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO
+    THE FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL
+    CLAIMS IN ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT
+    OF FEES, IF ANY, THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS
+    SOFTWARE.
+*/
+
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "definitions.h"
+#include "host_time.h"
+
+typedef struct
+{
+    bool                   inUse;
+    bool                   running;
+    bool                   isDelay;
+    bool                   expired;      // period elapsed since the last SYS_TIME_TimerPeriodHasExpired()
+    SYS_TIME_CALLBACK_TYPE type;
+    uint32_t               period;       // counts
+    uint64_t               deadline;     // virtual time of the next expiry, in counts
+    SYS_TIME_CALLBACK      callback;
+    uintptr_t              context;
+} host_timer_t;
+
+static host_timer_t host_timers[SYS_TIME_MAX_TIMERS];
+static uint64_t     host_now;
+static uint64_t     host_wallStart;
+static bool         host_wallStarted;
+
+static host_timer_t* host_timer(SYS_TIME_HANDLE handle)
+{
+    if (handle >= SYS_TIME_MAX_TIMERS || !host_timers[handle].inUse)
+    {
+        return NULL;
+    }
+    return &host_timers[handle];
+}
+
+static host_timer_t* host_nextDue(uint64_t until)
+{
+    host_timer_t* next = NULL;
+    uint32_t      i;
+
+    for (i = 0; i < SYS_TIME_MAX_TIMERS; i++)
+    {
+        host_timer_t* timer = &host_timers[i];
+
+        if (timer->inUse && timer->running && timer->deadline <= until && (next == NULL || timer->deadline < next->deadline))
+        {
+            next = timer;
+        }
+    }
+    return next;
+}
+
+/************************** Harness control ************************************/
+uint64_t HOST_TIME_nowUs(void)
+{
+    return host_now;
+}
+
+void HOST_TIME_advanceToUs(uint64_t us)
+{
+    host_timer_t* timer;
+
+    while ((timer = host_nextDue(us)) != NULL)
+    {
+        host_now       = timer->deadline;
+        timer->expired = true;
+        if (timer->type == SYS_TIME_PERIODIC && timer->period > 0)
+        {
+            timer->deadline += timer->period;
+        }
+        else
+        {
+            timer->running = false;
+        }
+        if (timer->callback)
+        {
+            timer->callback(timer->context);
+        }
+    }
+    if (us > host_now)
+    {
+        host_now = us;
+    }
+}
+
+void HOST_TIME_advanceUs(uint64_t us)
+{
+    HOST_TIME_advanceToUs(host_now + us);
+}
+
+uint64_t HOST_TIME_nextDeadlineUs(void)
+{
+    host_timer_t* next = host_nextDue(HOST_TIME_NEVER - 1);
+
+    return next ? next->deadline : HOST_TIME_NEVER;
+}
+
+void HOST_TIME_followWallClock(void)
+{
+    struct timespec ts;
+    uint64_t        wall;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    wall = (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000ULL;
+    if (!host_wallStarted)
+    {
+        host_wallStarted = true;
+        host_wallStart   = wall - host_now;
+    }
+    HOST_TIME_advanceToUs(wall - host_wallStart);
+}
+
+void HOST_TIME_reset(void)
+{
+    memset(host_timers, 0, sizeof(host_timers));
+    host_now         = 0;
+    host_wallStarted = false;
+}
+
+/************************** SYS_TIME API ***************************************/
+uint32_t SYS_TIME_FrequencyGet(void)
+{
+    return HOST_TIME_FREQUENCY_HZ;
+}
+
+uint32_t SYS_TIME_CounterGet(void)
+{
+    return (uint32_t)host_now;
+}
+
+uint64_t SYS_TIME_Counter64Get(void)
+{
+    return host_now;
+}
+
+uint32_t SYS_TIME_CountToUS(uint32_t count)
+{
+    return count;
+}
+
+uint32_t SYS_TIME_CountToMS(uint32_t count)
+{
+    return count / 1000U;
+}
+
+uint32_t SYS_TIME_USToCount(uint32_t us)
+{
+    return us;
+}
+
+uint32_t SYS_TIME_MSToCount(uint32_t ms)
+{
+    return ms * 1000U;
+}
+
+SYS_TIME_HANDLE SYS_TIME_TimerCreate(uint32_t count, uint32_t period, SYS_TIME_CALLBACK callback, uintptr_t context, SYS_TIME_CALLBACK_TYPE type)
+{
+    SYS_TIME_HANDLE handle;
+
+    for (handle = 0; handle < SYS_TIME_MAX_TIMERS; handle++)
+    {
+        if (!host_timers[handle].inUse)
+        {
+            memset(&host_timers[handle], 0, sizeof(host_timers[handle]));
+            host_timers[handle].inUse = true;
+            SYS_TIME_TimerReload(handle, count, period, callback, context, type);
+            return handle;
+        }
+    }
+    return SYS_TIME_HANDLE_INVALID;
+}
+
+SYS_TIME_RESULT SYS_TIME_TimerReload(SYS_TIME_HANDLE handle, uint32_t count, uint32_t period, SYS_TIME_CALLBACK callback, uintptr_t context, SYS_TIME_CALLBACK_TYPE type)
+{
+    host_timer_t* timer = host_timer(handle);
+
+    if (timer == NULL || period == 0)
+    {
+        return SYS_TIME_ERROR;
+    }
+    timer->type     = type;
+    timer->period   = period;
+    timer->callback = callback;
+    timer->context  = context;
+    timer->expired  = false;
+    // count is the starting value, the first expiry is period - count away
+    timer->deadline = host_now + ((count < period) ? (period - count) : 0);
+    return SYS_TIME_SUCCESS;
+}
+
+SYS_TIME_RESULT SYS_TIME_TimerDestroy(SYS_TIME_HANDLE handle)
+{
+    host_timer_t* timer = host_timer(handle);
+
+    if (timer == NULL)
+    {
+        return SYS_TIME_ERROR;
+    }
+    memset(timer, 0, sizeof(*timer));
+    return SYS_TIME_SUCCESS;
+}
+
+SYS_TIME_RESULT SYS_TIME_TimerStart(SYS_TIME_HANDLE handle)
+{
+    host_timer_t* timer = host_timer(handle);
+
+    if (timer == NULL)
+    {
+        return SYS_TIME_ERROR;
+    }
+    if (!timer->running)
+    {
+        timer->deadline = host_now + timer->period;
+        timer->running  = true;
+    }
+    return SYS_TIME_SUCCESS;
+}
+
+SYS_TIME_RESULT SYS_TIME_TimerStop(SYS_TIME_HANDLE handle)
+{
+    host_timer_t* timer = host_timer(handle);
+
+    if (timer == NULL)
+    {
+        return SYS_TIME_ERROR;
+    }
+    timer->running = false;
+    return SYS_TIME_SUCCESS;
+}
+
+SYS_TIME_RESULT SYS_TIME_TimerCounterGet(SYS_TIME_HANDLE handle, uint32_t* count)
+{
+    host_timer_t* timer = host_timer(handle);
+
+    if (timer == NULL || count == NULL)
+    {
+        return SYS_TIME_ERROR;
+    }
+    // Counts left until the next expiry, as the firmware timer reports
+    *count = (timer->running && timer->deadline > host_now) ? (uint32_t)(timer->deadline - host_now) : 0;
+    return SYS_TIME_SUCCESS;
+}
+
+bool SYS_TIME_TimerPeriodHasExpired(SYS_TIME_HANDLE handle)
+{
+    host_timer_t* timer = host_timer(handle);
+    bool          expired;
+
+    if (timer == NULL)
+    {
+        return false;
+    }
+    expired        = timer->expired;
+    timer->expired = false;
+    return expired;
+}
+
+SYS_TIME_HANDLE SYS_TIME_CallbackRegisterUS(SYS_TIME_CALLBACK callback, uintptr_t context, uint32_t us, SYS_TIME_CALLBACK_TYPE type)
+{
+    SYS_TIME_HANDLE handle;
+
+    if (us == 0)
+    {
+        return SYS_TIME_HANDLE_INVALID;
+    }
+    handle = SYS_TIME_TimerCreate(0, SYS_TIME_USToCount(us), callback, context, type);
+    if (handle != SYS_TIME_HANDLE_INVALID)
+    {
+        SYS_TIME_TimerStart(handle);
+    }
+    return handle;
+}
+
+SYS_TIME_HANDLE SYS_TIME_CallbackRegisterMS(SYS_TIME_CALLBACK callback, uintptr_t context, uint32_t ms, SYS_TIME_CALLBACK_TYPE type)
+{
+    return SYS_TIME_CallbackRegisterUS(callback, context, ms * 1000U, type);
+}
+
+SYS_TIME_RESULT SYS_TIME_DelayUS(uint32_t us, SYS_TIME_HANDLE* handle)
+{
+    if (handle == NULL || us == 0)
+    {
+        return SYS_TIME_ERROR;
+    }
+    *handle = SYS_TIME_CallbackRegisterUS(NULL, 0, us, SYS_TIME_SINGLE);
+    if (*handle == SYS_TIME_HANDLE_INVALID)
+    {
+        return SYS_TIME_ERROR;
+    }
+    host_timers[*handle].isDelay = true;
+    return SYS_TIME_SUCCESS;
+}
+
+SYS_TIME_RESULT SYS_TIME_DelayMS(uint32_t ms, SYS_TIME_HANDLE* handle)
+{
+    return SYS_TIME_DelayUS(ms * 1000U, handle);
+}
+
+// Nothing else moves the virtual clock while the caller spins on a delay, so
+// polling a delay fast-forwards to its end, as the wait would on the target
+bool SYS_TIME_DelayIsComplete(SYS_TIME_HANDLE handle)
+{
+    host_timer_t* timer = host_timer(handle);
+
+    if (timer == NULL || !timer->isDelay)
+    {
+        return true;
+    }
+    if (timer->running)
+    {
+        HOST_TIME_advanceToUs(timer->deadline);
+    }
+    SYS_TIME_TimerDestroy(handle);
+    return true;
+}
@@ -0,0 +1,53 @@
+/*
+    \file   host_time.h
+
+    \brief  host_time.header file.
+
+    (c) 2018 Microchip Technology Inc. and its subsidiaries.
+
+    Subject to your compliance with these terms, you may use Microchip software and any
+    derivatives exclusively with Microchip products. It is your responsibility to comply with third party
+    license terms applicable to your use of third party software (including open source software) that
+    may accompany Microchip software.
+
+    THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+    EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY
+    IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS
+    FOR A PARTICULAR PURPOSE.
+
+    IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
+    INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND
+    WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP
+    HAS BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO
+    THE FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL
+    CLAIMS IN ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT
+    OF FEES, IF ANY, THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS
+    SOFTWARE.
+*/
+
+
+#ifndef HOST_TIME_H
+#define HOST_TIME_H
+
+// Virtual clock behind the host SYS_TIME. It runs at the 1 MHz the firmware's
+// TC3 counts at and only moves when the harness advances it, so a run replays
+// exactly. Due timer callbacks fire from HOST_TIME_advanceUs(), in deadline
+// order, where the firmware would take the TC3 interrupt.
+
+#include <stdint.h>
+
+#define HOST_TIME_FREQUENCY_HZ 1000000UL
+#define HOST_TIME_NEVER        UINT64_MAX
+
+uint64_t HOST_TIME_nowUs(void);
+void     HOST_TIME_advanceUs(uint64_t us);
+void     HOST_TIME_advanceToUs(uint64_t us);
+uint64_t HOST_TIME_nextDeadlineUs(void);   // HOST_TIME_NEVER when no timer runs
+
+// For runs against real sockets: moves the virtual clock up to the wall clock
+// time elapsed since the first call
+void HOST_TIME_followWallClock(void);
+
+void HOST_TIME_reset(void);
+
+#endif /* HOST_TIME_H */
@@ -0,0 +1,161 @@
+/*
+    \file   definitions.h
+
+    \brief  definitions.header file.
+
+    (c) 2018 Microchip Technology Inc. and its subsidiaries.
+
+    Subject to your compliance with these terms, you may use Microchip software and any
+    derivatives exclusively with Microchip products. It is your responsibility to comply with third party
+    license terms applicable to your use of third party software (including open source software) that
+    may accompany Microchip software.
+
+    THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+    EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY
+    IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS
+    FOR A PARTICULAR PURPOSE.
+
+    IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
+    INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND
+    WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP
+    HAS BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO
+    THE FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL
+    CLAIMS IN ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT
+    OF FEES, IF ANY, THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS
+    SOFTWARE.
+*/
+
+
+#ifndef HOST_DEFINITIONS_H
+#define HOST_DEFINITIONS_H
+
+// Host stand-in for the MHC generated definitions.h. It declares only the
+// Harmony services the host-built modules call, with the firmware signatures,
+// and test/host implements them: SYS_TIME on a virtual clock, the console on
+// stderr and the RTC from the virtual clock.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <sys/types.h>
+#include <time.h>
+#include <assert.h>
+#include "configuration.h"
+
+/************************** SYS_TIME (host_sys_time.c) *************************/
+typedef uintptr_t SYS_TIME_HANDLE;
+#define SYS_TIME_HANDLE_INVALID ((SYS_TIME_HANDLE)(-1))
+
+typedef enum
+{
+    SYS_TIME_SUCCESS,
+    SYS_TIME_ERROR
+} SYS_TIME_RESULT;
+
+typedef enum
+{
+    SYS_TIME_SINGLE,
+    SYS_TIME_PERIODIC
+} SYS_TIME_CALLBACK_TYPE;
+
+typedef void (*SYS_TIME_CALLBACK)(uintptr_t context);
+
+uint32_t        SYS_TIME_FrequencyGet(void);
+uint32_t        SYS_TIME_CounterGet(void);
+uint64_t        SYS_TIME_Counter64Get(void);
+uint32_t        SYS_TIME_CountToUS(uint32_t count);
+uint32_t        SYS_TIME_CountToMS(uint32_t count);
+uint32_t        SYS_TIME_USToCount(uint32_t us);
+uint32_t        SYS_TIME_MSToCount(uint32_t ms);
+SYS_TIME_HANDLE SYS_TIME_TimerCreate(uint32_t count, uint32_t period, SYS_TIME_CALLBACK callback, uintptr_t context, SYS_TIME_CALLBACK_TYPE type);
+SYS_TIME_RESULT SYS_TIME_TimerReload(SYS_TIME_HANDLE handle, uint32_t count, uint32_t period, SYS_TIME_CALLBACK callback, uintptr_t context, SYS_TIME_CALLBACK_TYPE type);
+SYS_TIME_RESULT SYS_TIME_TimerDestroy(SYS_TIME_HANDLE handle);
+SYS_TIME_RESULT SYS_TIME_TimerStart(SYS_TIME_HANDLE handle);
+SYS_TIME_RESULT SYS_TIME_TimerStop(SYS_TIME_HANDLE handle);
+SYS_TIME_RESULT SYS_TIME_TimerCounterGet(SYS_TIME_HANDLE handle, uint32_t* count);
+bool            SYS_TIME_TimerPeriodHasExpired(SYS_TIME_HANDLE handle);
+SYS_TIME_HANDLE SYS_TIME_CallbackRegisterUS(SYS_TIME_CALLBACK callback, uintptr_t context, uint32_t us, SYS_TIME_CALLBACK_TYPE type);
+SYS_TIME_HANDLE SYS_TIME_CallbackRegisterMS(SYS_TIME_CALLBACK callback, uintptr_t context, uint32_t ms, SYS_TIME_CALLBACK_TYPE type);
+SYS_TIME_RESULT SYS_TIME_DelayUS(uint32_t us, SYS_TIME_HANDLE* handle);
+SYS_TIME_RESULT SYS_TIME_DelayMS(uint32_t ms, SYS_TIME_HANDLE* handle);
+bool            SYS_TIME_DelayIsComplete(SYS_TIME_HANDLE handle);
+
+/************************** Console, RTC (host_platform.c) *********************/
+typedef uintptr_t SYS_CONSOLE_HANDLE;
+
+ssize_t SYS_CONSOLE_Write(const SYS_CONSOLE_HANDLE handle, const void* buf, size_t count);
+void    RTC_RTCCTimeGet(struct tm* currentTime);
+
+/************************** Cloud configuration (host_board.c) ****************/
+// The host build compiles cloud_service.c with CFG_MQTT_PORT=HOST_mqttPort so a
+// harness can point it at a broker on any port
+extern uint16_t HOST_mqttPort;
+
+/************************** OSAL, bare metal flavour ***************************/
+typedef uint8_t OSAL_MUTEX_HANDLE_TYPE;
+#define OSAL_WAIT_FOREVER (uint16_t)0xFFFF
+
+typedef enum OSAL_RESULT
+{
+    OSAL_RESULT_NOT_IMPLEMENTED = -1,
+    OSAL_RESULT_FALSE           = 0,
+    OSAL_RESULT_TRUE            = 1
+} OSAL_RESULT;
+
+static inline OSAL_RESULT OSAL_MUTEX_Create(OSAL_MUTEX_HANDLE_TYPE* mutexID)
+{
+    *mutexID = 1;
+    return OSAL_RESULT_TRUE;
+}
+
+static inline OSAL_RESULT OSAL_MUTEX_Lock(OSAL_MUTEX_HANDLE_TYPE* mutexID, uint16_t waitMS)
+{
+    if (*mutexID == 0)
+    {
+        return OSAL_RESULT_FALSE;
+    }
+    *mutexID = 0;
+    return OSAL_RESULT_TRUE;
+}
+
+static inline OSAL_RESULT OSAL_MUTEX_Unlock(OSAL_MUTEX_HANDLE_TYPE* mutexID)
+{
+    *mutexID = 1;
+    return OSAL_RESULT_TRUE;
+}
+
+/************************** CMSIS core *****************************************/
+// The host has no interrupts: everything, SYS_TIME callbacks included, runs on
+// the harness thread, so masking is a no-op and the code is never in an ISR.
+static inline void __disable_irq(void)
+{
+}
+
+static inline void __enable_irq(void)
+{
+}
+
+static inline uint32_t __get_IPSR(void)
+{
+    return 0;
+}
+
+static inline uint32_t __get_MSP(void)
+{
+    return (uint32_t)(uintptr_t)__builtin_frame_address(0);
+}
+
+// Harnesses never advance the clock to a scheduled reboot; stop if one does
+static inline void NVIC_SystemReset(void)
+{
+    abort();
+}
+
+/************************** Application ****************************************/
+// The MHC definitions.h ends with app.h, which needs the Azure SDK headers
+#ifdef HOST_AZURE_SDK
+#include "app.h"
+#endif
+
+#endif /* HOST_DEFINITIONS_H */
@@ -0,0 +1,54 @@
+/*
+    \file   wdrv_winc_powersave.h
+
+    \brief  wdrv_winc_powersave.header file.
+
+    (c) 2018 Microchip Technology Inc. and its subsidiaries.
+
+    Subject to your compliance with these terms, you may use Microchip software and any
+    derivatives exclusively with Microchip products. It is your responsibility to comply with third party
+    license terms applicable to your use of third party software (including open source software) that
+    may accompany Microchip software.
+
+    THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+    EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY
+    IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS
+    FOR A PARTICULAR PURPOSE.
+
+    IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
+    INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND
+    WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP
+    HAS BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO
+    THE FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL
+    CLAIMS IN ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT
+    OF FEES, IF ANY, THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS
+    SOFTWARE.
+*/
+
+
+#ifndef HOST_WDRV_WINC_POWERSAVE_H
+#define HOST_WDRV_WINC_POWERSAVE_H
+
+// Host stand-in for the WINC driver power save API, the calls power_manager.c
+// makes. The real header pulls in the SAMD21 device headers; the test that
+// builds power_manager.c implements these.
+
+#include <stdint.h>
+#include "driver/driver_common.h"
+
+typedef enum
+{
+    WDRV_WINC_STATUS_OK = 0,
+    WDRV_WINC_STATUS_REQUEST_ERROR
+} WDRV_WINC_STATUS;
+
+typedef enum
+{
+    WDRV_WINC_PS_MODE_OFF = 0,
+    WDRV_WINC_PS_MODE_AUTO_LOW_POWER
+} WDRV_WINC_PS_MODE;
+
+WDRV_WINC_STATUS WDRV_WINC_PowerSaveSetMode(DRV_HANDLE handle, WDRV_WINC_PS_MODE mode);
+WDRV_WINC_STATUS WDRV_WINC_PowerSaveSetBeaconInterval(DRV_HANDLE handle, uint16_t numBeaconIntervals);
+
+#endif /* HOST_WDRV_WINC_POWERSAVE_H */
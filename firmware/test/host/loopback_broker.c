@@ -0,0 +1,392 @@
+/*
+    \file   loopback_broker.c
+
+    \brief  loopback_broker.ceader file.
+
+    (c) 2018 Microchip Technology Inc. and its subsidiaries.
+
+    Subject to your compliance with these terms, you may use Microchip software and any
+    derivatives exclusively with Microchip products. It is your responsibility to comply with third party
+    license terms applicable to your use of third party software (including open source software) that
+    may accompany Microchip software.
+
+    THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+    EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY
+    IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS
+    FOR A PARTICULAR PURPOSE.
+
+    IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
+    INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND
+    WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP
+    HAS BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO
+    THE FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL
+    CLAIMS IN ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT
+    OF FEES, IF ANY, THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS
+    SOFTWARE.
+*/
+
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include "loopback_broker.h"
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+#define BROKER_BUFFER_SIZE    4096
+#define BROKER_MAX_SUBSCRIBE  4
+#define BROKER_TOPIC_SIZE     128
+
+#define MQTT_CONNECT     1
+#define MQTT_CONNACK     2
+#define MQTT_PUBLISH     3
+#define MQTT_PUBACK      4
+#define MQTT_SUBSCRIBE   8
+#define MQTT_SUBACK      9
+#define MQTT_UNSUBSCRIBE 10
+#define MQTT_UNSUBACK    11
+#define MQTT_PINGREQ     12
+#define MQTT_PINGRESP    13
+#define MQTT_DISCONNECT  14
+
+loopbackBrokerStats_t loopbackBrokerStats;
+
+static int      broker_listenFd = -1;
+static int      broker_clientFd = -1;
+static uint8_t  broker_in[BROKER_BUFFER_SIZE];
+static size_t   broker_inLength;
+static char     broker_topics[BROKER_MAX_SUBSCRIBE][BROKER_TOPIC_SIZE];
+static uint8_t  broker_topicCount;
+
+static void broker_dropClient(void)
+{
+    if (broker_clientFd >= 0)
+    {
+        close(broker_clientFd);
+    }
+    broker_clientFd   = -1;
+    broker_inLength   = 0;
+    broker_topicCount = 0;
+}
+
+static void broker_send(const uint8_t* data, size_t length)
+{
+    // Loopback socket buffers hold far more than the benchmarks have in flight
+    if (send(broker_clientFd, data, length, MSG_NOSIGNAL) != (ssize_t)length)
+    {
+        broker_dropClient();
+    }
+}
+
+static size_t broker_encodeLength(uint32_t length, uint8_t* out)
+{
+    size_t i = 0;
+
+    do
+    {
+        out[i] = length % 128;
+        length /= 128;
+        if (length > 0)
+        {
+            out[i] |= 0x80;
+        }
+        i++;
+    } while (length > 0);
+    return i;
+}
+
+// Subscription filters match exactly, or up to a trailing '#'
+static bool broker_subscribed(const uint8_t* topic, uint16_t length)
+{
+    uint8_t i;
+
+    for (i = 0; i < broker_topicCount; i++)
+    {
+        const char* filter       = broker_topics[i];
+        size_t      filterLength = strlen(filter);
+
+        if (filterLength > 0 && filter[filterLength - 1] == '#')
+        {
+            if (length >= filterLength - 1 && memcmp(filter, topic, filterLength - 1) == 0)
+            {
+                return true;
+            }
+        }
+        else if (length == filterLength && memcmp(filter, topic, length) == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void broker_publish(uint8_t flags, const uint8_t* body, uint32_t length)
+{
+    uint8_t  qos = (flags >> 1) & 0x03;
+    uint16_t topicLength;
+    uint32_t payloadOffset;
+
+    if (length < 2)
+    {
+        loopbackBrokerStats.malformed++;
+        broker_dropClient();
+        return;
+    }
+    topicLength   = (uint16_t)(body[0] << 8 | body[1]);
+    payloadOffset = 2u + topicLength + (qos > 0 ? 2u : 0u);
+    if (payloadOffset > length)
+    {
+        loopbackBrokerStats.malformed++;
+        broker_dropClient();
+        return;
+    }
+
+    loopbackBrokerStats.publishes++;
+    loopbackBrokerStats.publishBytes += length - payloadOffset;
+
+    if (qos == 1)
+    {
+        uint8_t puback[4] = {MQTT_PUBACK << 4, 2, body[2 + topicLength], body[3 + topicLength]};
+
+        broker_send(puback, sizeof(puback));
+    }
+
+    if (broker_clientFd >= 0 && broker_subscribed(&body[2], topicLength))
+    {
+        uint8_t  header[5];
+        uint32_t echoLength = 2u + topicLength + (length - payloadOffset);
+        size_t   headerLength;
+
+        header[0]    = MQTT_PUBLISH << 4;
+        headerLength = 1 + broker_encodeLength(echoLength, &header[1]);
+        broker_send(header, headerLength);
+        if (broker_clientFd >= 0)
+        {
+            broker_send(body, 2u + topicLength);
+        }
+        if (broker_clientFd >= 0)
+        {
+            broker_send(&body[payloadOffset], length - payloadOffset);
+        }
+        loopbackBrokerStats.echoes++;
+    }
+}
+
+static void broker_subscribe(const uint8_t* body, uint32_t length)
+{
+    uint8_t  suback[4 + BROKER_MAX_SUBSCRIBE];
+    uint8_t  granted = 0;
+    uint32_t offset  = 2;
+
+    if (length < 2)
+    {
+        loopbackBrokerStats.malformed++;
+        broker_dropClient();
+        return;
+    }
+
+    while (offset + 3 <= length && granted < BROKER_MAX_SUBSCRIBE)
+    {
+        uint16_t topicLength = (uint16_t)(body[offset] << 8 | body[offset + 1]);
+
+        if (offset + 3 + topicLength > length)
+        {
+            break;
+        }
+        if (topicLength < BROKER_TOPIC_SIZE && broker_topicCount < BROKER_MAX_SUBSCRIBE)
+        {
+            memcpy(broker_topics[broker_topicCount], &body[offset + 2], topicLength);
+            broker_topics[broker_topicCount][topicLength] = 0;
+            broker_topicCount++;
+            suback[4 + granted] = 0;   // granted QoS 0
+        }
+        else
+        {
+            suback[4 + granted] = 0x80;
+        }
+        granted++;
+        offset += 3u + topicLength;
+    }
+
+    suback[0] = MQTT_SUBACK << 4;
+    suback[1] = 2 + granted;
+    suback[2] = body[0];
+    suback[3] = body[1];
+    broker_send(suback, 4u + granted);
+}
+
+// Handles one complete packet, returns false when the client is gone
+static bool broker_handle(uint8_t header, const uint8_t* body, uint32_t length)
+{
+    switch (header >> 4)
+    {
+        case MQTT_CONNECT: {
+            uint8_t connack[4] = {MQTT_CONNACK << 4, 2, 0, 0};
+
+            loopbackBrokerStats.connects++;
+            broker_topicCount = 0;
+            broker_send(connack, sizeof(connack));
+            break;
+        }
+        case MQTT_PUBLISH:
+            broker_publish(header & 0x0F, body, length);
+            break;
+        case MQTT_SUBSCRIBE:
+            broker_subscribe(body, length);
+            break;
+        case MQTT_UNSUBSCRIBE: {
+            uint8_t unsuback[4] = {MQTT_UNSUBACK << 4, 2, length > 1 ? body[0] : 0, length > 1 ? body[1] : 0};
+
+            broker_topicCount = 0;
+            broker_send(unsuback, sizeof(unsuback));
+            break;
+        }
+        case MQTT_PINGREQ: {
+            uint8_t pingresp[2] = {MQTT_PINGRESP << 4, 0};
+
+            broker_send(pingresp, sizeof(pingresp));
+            break;
+        }
+        case MQTT_DISCONNECT:
+            broker_dropClient();
+            break;
+        default:
+            break;
+    }
+    return broker_clientFd >= 0;
+}
+
+static void broker_parse(void)
+{
+    size_t offset = 0;
+
+    while (broker_clientFd >= 0 && broker_inLength - offset >= 2)
+    {
+        uint32_t length     = 0;
+        uint32_t multiplier = 1;
+        size_t   i          = offset + 1;
+
+        // Remaining length, at most four bytes
+        for (;;)
+        {
+            if (i >= broker_inLength)
+            {
+                goto incomplete;
+            }
+            length += (broker_in[i] & 0x7F) * multiplier;
+            if ((broker_in[i++] & 0x80) == 0)
+            {
+                break;
+            }
+            multiplier *= 128;
+            if (i - offset > 4)
+            {
+                loopbackBrokerStats.malformed++;
+                broker_dropClient();
+                return;
+            }
+        }
+        if (length > sizeof(broker_in) - (i - offset))
+        {
+            loopbackBrokerStats.malformed++;
+            broker_dropClient();
+            return;
+        }
+        if (broker_inLength - i < length)
+        {
+            break;
+        }
+        if (!broker_handle(broker_in[offset], &broker_in[i], length))
+        {
+            return;
+        }
+        offset = i + length;
+    }
+
+incomplete:
+    memmove(broker_in, &broker_in[offset], broker_inLength - offset);
+    broker_inLength -= offset;
+}
+
+bool LOOPBACK_BROKER_start(uint16_t* port)
+{
+    struct sockaddr_in addr;
+    socklen_t          length = sizeof(addr);
+    int                one    = 1;
+
+    memset(&loopbackBrokerStats, 0, sizeof(loopbackBrokerStats));
+
+    broker_listenFd = socket(AF_INET, SOCK_STREAM, 0);
+    if (broker_listenFd < 0)
+    {
+        return false;
+    }
+    setsockopt(broker_listenFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family      = AF_INET;
+    addr.sin_port        = htons(*port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    if (bind(broker_listenFd, (struct sockaddr*)&addr, sizeof(addr)) < 0
+        || listen(broker_listenFd, 1) < 0
+        || getsockname(broker_listenFd, (struct sockaddr*)&addr, &length) < 0
+        || fcntl(broker_listenFd, F_SETFL, fcntl(broker_listenFd, F_GETFL, 0) | O_NONBLOCK) < 0)
+    {
+        LOOPBACK_BROKER_stop();
+        return false;
+    }
+    *port = ntohs(addr.sin_port);
+    return true;
+}
+
+void LOOPBACK_BROKER_poll(void)
+{
+    ssize_t received;
+
+    if (broker_listenFd < 0)
+    {
+        return;
+    }
+
+    if (broker_clientFd < 0)
+    {
+        int one = 1;
+
+        broker_clientFd = accept(broker_listenFd, NULL, NULL);
+        if (broker_clientFd < 0)
+        {
+            return;
+        }
+        setsockopt(broker_clientFd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        fcntl(broker_clientFd, F_SETFL, fcntl(broker_clientFd, F_GETFL, 0) | O_NONBLOCK);
+    }
+
+    received = recv(broker_clientFd, &broker_in[broker_inLength], sizeof(broker_in) - broker_inLength, 0);
+    if (received > 0)
+    {
+        broker_inLength += (size_t)received;
+        broker_parse();
+    }
+    else if (received == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR))
+    {
+        broker_dropClient();
+    }
+}
+
+void LOOPBACK_BROKER_stop(void)
+{
+    broker_dropClient();
+    if (broker_listenFd >= 0)
+    {
+        close(broker_listenFd);
+    }
+    broker_listenFd = -1;
+}
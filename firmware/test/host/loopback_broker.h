@@ -0,0 +1,57 @@
+/*
+    \file   loopback_broker.h
+
+    \brief  loopback_broker.header file.
+
+    (c) 2018 Microchip Technology Inc. and its subsidiaries.
+
+    Subject to your compliance with these terms, you may use Microchip software and any
+    derivatives exclusively with Microchip products. It is your responsibility to comply with third party
+    license terms applicable to your use of third party software (including open source software) that
+    may accompany Microchip software.
+
+    THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+    EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY
+    IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS
+    FOR A PARTICULAR PURPOSE.
+
+    IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
+    INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND
+    WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP
+    HAS BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO
+    THE FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL
+    CLAIMS IN ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT
+    OF FEES, IF ANY, THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS
+    SOFTWARE.
+*/
+
+
+#ifndef LOOPBACK_BROKER_H
+#define LOOPBACK_BROKER_H
+
+// Just enough of an MQTT 3.1.1 broker on 127.0.0.1 for the host benchmarks to
+// run without a network. One client at a time: CONNECT gets CONNACK, SUBSCRIBE
+// gets SUBACK, PINGREQ gets PINGRESP and a QoS 1 PUBLISH gets PUBACK. A PUBLISH
+// on a topic the client subscribed to goes back to it at QoS 0. It runs on the
+// harness thread from LOOPBACK_BROKER_poll(), next to the firmware tasks.
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef struct
+{
+    uint32_t connects;
+    uint32_t publishes;
+    uint32_t publishBytes;   // payload only
+    uint32_t echoes;
+    uint32_t malformed;      // packets that made the broker drop the client
+} loopbackBrokerStats_t;
+
+extern loopbackBrokerStats_t loopbackBrokerStats;
+
+// Listens on *port, or on a free port when *port is 0 and returns it there
+bool LOOPBACK_BROKER_start(uint16_t* port);
+void LOOPBACK_BROKER_poll(void);
+void LOOPBACK_BROKER_stop(void);
+
+#endif /* LOOPBACK_BROKER_H */
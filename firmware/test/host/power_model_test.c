@@ -0,0 +1,253 @@
+/*
+    \file   power_model_test.c
+
+    \brief  power_model_test.ceader file.
+
+    (c) 2018 Microchip Technology Inc. and its subsidiaries.
+
+    Subject to your compliance with these terms, you may use Microchip software and any
+    derivatives exclusively with Microchip products. It is your responsibility to comply with third party
+    license terms applicable to your use of third party software (including open source software) that
+    may accompany Microchip software.
+
+    THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+    EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY
+    IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS
+    FOR A PARTICULAR PURPOSE.
+
+    IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
+    INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND
+    WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP
+    HAS BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO
+    THE FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL
+    CLAIMS IN ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT
+    OF FEES, IF ANY, THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS
+    SOFTWARE.
+*/
+
+
+/* The WINC energy model behind the cli "power" estimate, checked against the
+ * same arithmetic done in floating point, and the doze / wake-ahead decisions
+ * POWER_task() makes on the virtual clock, with the driver calls recorded.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include "definitions.h"
+#include "host_time.h"
+#include "wdrv_winc_powersave.h"
+#include "services/iot/cloud/power_manager.h"
+#include "iot_config/IoT_Sensor_Node_config.h"
+
+#define BEACON_PERIOD_US 102400.0
+#define HOUR_MS          3600000.0
+#define TEST_HANDLE      ((DRV_HANDLE)1)
+
+static int failures;
+
+#define CHECK(condition)                                                  \
+    do                                                                    \
+    {                                                                     \
+        if (!(condition))                                                 \
+        {                                                                 \
+            printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #condition);   \
+            failures++;                                                   \
+        }                                                                 \
+    } while (0)
+
+static WDRV_WINC_PS_MODE winc_mode;
+static uint16_t          winc_listenInterval;
+static uint32_t          winc_calls;
+
+WDRV_WINC_STATUS WDRV_WINC_PowerSaveSetMode(DRV_HANDLE handle, WDRV_WINC_PS_MODE mode)
+{
+    winc_mode = mode;
+    winc_calls++;
+    return WDRV_WINC_STATUS_OK;
+}
+
+WDRV_WINC_STATUS WDRV_WINC_PowerSaveSetBeaconInterval(DRV_HANDLE handle, uint16_t numBeaconIntervals)
+{
+    winc_listenInterval = numBeaconIntervals;
+    winc_calls++;
+    return WDRV_WINC_STATUS_OK;
+}
+
+static double reference_dozeUa(uint16_t listenInterval)
+{
+    double beaconUs = (listenInterval ? listenInterval : 1) * BEACON_PERIOD_US;
+
+    return CFG_WINC_CURRENT_DOZE_UA + CFG_WINC_CURRENT_AWAKE_UA * (CFG_WINC_PS_BEACON_RX_US / beaconUs);
+}
+
+static double reference_estimateUa(uint32_t telemetrySec, uint32_t keepAliveSec, uint16_t listenInterval)
+{
+    double wakes = 0;
+    double awakeMs;
+
+    if (telemetrySec > 0)
+    {
+        wakes += 3600 / telemetrySec;
+    }
+    if (keepAliveSec > 0 && (telemetrySec == 0 || telemetrySec >= keepAliveSec))
+    {
+        wakes += 3600 / keepAliveSec;
+    }
+
+    awakeMs = wakes * (CFG_WINC_PS_WAKE_AHEAD_MS + CFG_WINC_PS_SEND_ACTIVE_MS);
+    if (awakeMs > HOUR_MS)
+    {
+        awakeMs = HOUR_MS;
+    }
+
+    return (awakeMs * CFG_WINC_CURRENT_AWAKE_UA + (HOUR_MS - awakeMs) * reference_dozeUa(listenInterval)) / HOUR_MS;
+}
+
+// Integer rounding in the firmware loses at most one uA per term
+static int close_to(uint32_t actual, double expected)
+{
+    double diff = actual - expected;
+
+    return diff > -2.0 && diff < 2.0;
+}
+
+static void test_estimate_matches_reference(void)
+{
+    static const struct
+    {
+        uint32_t telemetrySec;
+        uint32_t keepAliveSec;
+        uint16_t listenInterval;
+    } cases[] = {
+        {0, 0, 1},   {0, 240, 10}, {60, 240, 10}, {600, 240, 10},
+        {5, 240, 3}, {300, 60, 30}, {0, 240, 0},  {3600, 3600, 30},
+    };
+    size_t i;
+
+    for (i = 0; i < sizeof(cases) / sizeof(cases[0]); i++)
+    {
+        uint32_t ua = POWER_estimateUa(cases[i].telemetrySec, cases[i].keepAliveSec, cases[i].listenInterval);
+        double   expected = reference_estimateUa(cases[i].telemetrySec, cases[i].keepAliveSec, cases[i].listenInterval);
+
+        if (!close_to(ua, expected))
+        {
+            printf("FAIL estimate(%u, %u, %u) = %u uA, expected %.1f\n",
+                   (unsigned)cases[i].telemetrySec,
+                   (unsigned)cases[i].keepAliveSec,
+                   (unsigned)cases[i].listenInterval,
+                   (unsigned)ua,
+                   expected);
+            failures++;
+        }
+    }
+}
+
+static void test_estimate_shape(void)
+{
+    // Nothing to send leaves the doze floor plus beacons
+    CHECK(close_to(POWER_estimateUa(0, 0, 10), reference_dozeUa(10)));
+
+    // Listening to fewer beacons and sending less often both save current
+    CHECK(POWER_estimateUa(60, 240, 30) < POWER_estimateUa(60, 240, 1));
+    CHECK(POWER_estimateUa(600, 240, 10) < POWER_estimateUa(60, 240, 10));
+
+    // Telemetry faster than the keep-alive means no PINGREQs
+    CHECK(POWER_estimateUa(60, 240, 10) == POWER_estimateUa(60, 0, 10));
+    CHECK(POWER_estimateUa(600, 240, 10) > POWER_estimateUa(600, 0, 10));
+
+    // A radio that never gets to doze draws the awake current
+    CHECK(POWER_estimateUa(1, 240, 10) == CFG_WINC_CURRENT_AWAKE_UA);
+}
+
+static void test_task_doze_and_wake_ahead(void)
+{
+    uint32_t dozeMs = 60000;
+
+    HOST_TIME_reset();
+    winc_mode  = WDRV_WINC_PS_MODE_OFF;
+    winc_calls = 0;
+    POWER_init(TEST_HANDLE);
+    POWER_enable(true);
+
+    // Nothing scheduled, the radio stays up
+    POWER_task(false);
+    CHECK(POWER_getState() == POWER_STATE_AWAKE);
+    CHECK(winc_calls == 0);
+
+    // A far deadline dozes at the longest listen interval allowed
+    POWER_setDeadline(POWER_DEADLINE_TELEMETRY, (int32_t)dozeMs);
+    POWER_task(false);
+    CHECK(POWER_getState() == POWER_STATE_DOZE);
+    CHECK(winc_mode == WDRV_WINC_PS_MODE_AUTO_LOW_POWER);
+    CHECK(winc_listenInterval == CFG_WINC_PS_LISTEN_INTERVAL_MAX);
+    CHECK(powerStats.lastDozeMs == dozeMs);
+    CHECK(powerStats.modeChanges == 1);
+
+    // Close to the deadline the listen interval shrinks to what still fits
+    HOST_TIME_advanceUs((uint64_t)(dozeMs - CFG_WINC_PS_WAKE_AHEAD_MS - 1000) * 1000);
+    POWER_task(false);
+    CHECK(POWER_getState() == POWER_STATE_DOZE);
+    CHECK(winc_listenInterval == (uint16_t)(1000000 / BEACON_PERIOD_US));
+    CHECK(powerStats.modeChanges == 1);
+
+    // Inside the wake-ahead window power save is off before the send
+    HOST_TIME_advanceUs(1500 * 1000);
+    POWER_task(false);
+    CHECK(POWER_getState() == POWER_STATE_WAKE_AHEAD);
+    CHECK(winc_mode == WDRV_WINC_PS_MODE_OFF);
+    CHECK(powerStats.modeChanges == 2);
+
+    // Traffic in flight keeps it awake whatever the deadline
+    POWER_setDeadline(POWER_DEADLINE_TELEMETRY, (int32_t)dozeMs);
+    POWER_task(true);
+    CHECK(POWER_getState() == POWER_STATE_AWAKE);
+    CHECK(winc_mode == WDRV_WINC_PS_MODE_OFF);
+
+    CHECK(powerStats.stateMs[POWER_STATE_DOZE] == dozeMs - CFG_WINC_PS_WAKE_AHEAD_MS + 500);
+    CHECK(powerStats.stateMs[POWER_STATE_WAKE_AHEAD] == 0);
+}
+
+static void test_measured_follows_state_time(void)
+{
+    HOST_TIME_reset();
+    POWER_init(TEST_HANDLE);
+    POWER_enable(true);
+    CHECK(POWER_measuredUa() == 0);
+
+    // Twenty minutes in doze and nothing else. The 32-bit microsecond
+    // counter wraps after 71 minutes, so keep every interval below that.
+    POWER_setDeadline(POWER_DEADLINE_KEEPALIVE, 30 * 60 * 1000);
+    POWER_task(false);
+    HOST_TIME_advanceUs(20ULL * 60 * 1000000);
+    POWER_task(false);
+    CHECK(close_to(POWER_measuredUa(), reference_dozeUa(CFG_WINC_PS_LISTEN_INTERVAL_MAX)));
+
+    // Then as long awake, the average lands half way
+    POWER_task(true);
+    HOST_TIME_advanceUs(20ULL * 60 * 1000000);
+    POWER_task(true);
+    CHECK(close_to(POWER_measuredUa(), (CFG_WINC_CURRENT_AWAKE_UA + reference_dozeUa(CFG_WINC_PS_LISTEN_INTERVAL_MAX)) / 2));
+
+    // Turning power save off wakes a dozing radio, and from then on the
+    // manager leaves the driver alone
+    POWER_setDeadline(POWER_DEADLINE_KEEPALIVE, 30 * 60 * 1000);
+    POWER_task(false);
+    CHECK(POWER_getState() == POWER_STATE_DOZE);
+    winc_calls = 0;
+    POWER_enable(false);
+    CHECK(winc_calls == 1 && winc_mode == WDRV_WINC_PS_MODE_OFF);
+    POWER_task(false);
+    CHECK(POWER_getState() == POWER_STATE_AWAKE);
+    CHECK(winc_calls == 1);
+}
+
+int main(void)
+{
+    test_estimate_matches_reference();
+    test_estimate_shape();
+    test_task_doze_and_wake_ahead();
+    test_measured_follows_state_time();
+
+    printf("%s\n", failures ? "FAILED" : "PASSED");
+    return failures ? 1 : 0;
+}
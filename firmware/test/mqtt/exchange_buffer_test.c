@@ -0,0 +1,439 @@
+/*
+    \file   exchange_buffer_test.c
+
+    \brief  exchange_buffer_test.ceader file.
+
+    (c) 2018 Microchip Technology Inc. and its subsidiaries.
+
+    Subject to your compliance with these terms, you may use Microchip software and any
+    derivatives exclusively with Microchip products. It is your responsibility to comply with third party
+    license terms applicable to your use of third party software (including open source software) that
+    may accompany Microchip software.
+
+    THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+    EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY
+    IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS
+    FOR A PARTICULAR PURPOSE.
+
+    IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
+    INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND
+    WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP
+    HAS BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO
+    THE FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL
+    CLAIMS IN ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT
+    OF FEES, IF ANY, THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS
+    SOFTWARE.
+*/
+
+
+/* Ring buffer behaviour the MQTT receive path depends on: peek and read
+ * across the wrap point, and the free region / commit pair used to receive
+ * socket data in place. The second half feeds broker packets through
+ * MQTT_GetReceivedData() and checks that MQTT_ReceptionHandler() takes each
+ * one off the ring whole, so the packets behind it survive.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "definitions.h"
+#include "host_time.h"
+#include "scheduler.h"
+#include "mqtt/mqtt_core/mqtt_core.h"
+#include "mqtt/mqtt_comm_bsd/mqtt_comm_layer.h"
+#include "mqtt/mqtt_packetTransfer_interface.h"
+#include "services/iot/cloud/bsd_adapter/bsdWINC.h"
+
+#define RING_SIZE      16
+#define TEST_TOPIC     "test/topic"
+#define HANDLER_PASSES 8
+
+static int failures;
+
+#define CHECK(condition)                                                  \
+    do                                                                    \
+    {                                                                     \
+        if (!(condition))                                                 \
+        {                                                                 \
+            printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #condition);   \
+            failures++;                                                   \
+        }                                                                 \
+    } while (0)
+
+static uint8_t        ring[RING_SIZE];
+static exchangeBuffer buffer;
+
+static void reset(void)
+{
+    memset(ring, 0, sizeof(ring));
+    buffer.start        = ring;
+    buffer.bufferLength = RING_SIZE;
+    MQTT_ExchangeBufferInit(&buffer);
+}
+
+// Leaves the ring holding "0123456789" starting at index 11, so it wraps after five bytes
+static void fill_wrapped(void)
+{
+    uint8_t scratch[RING_SIZE];
+
+    reset();
+    MQTT_ExchangeBufferWrite(&buffer, (uint8_t*)"abcdefghijk", 11);
+    MQTT_ExchangeBufferRead(&buffer, scratch, 11);
+    MQTT_ExchangeBufferWrite(&buffer, (uint8_t*)"0123456789", 10);
+}
+
+static void test_peek_wraps(void)
+{
+    uint8_t data[RING_SIZE] = {0};
+
+    fill_wrapped();
+    CHECK(buffer.currentLocation == &ring[11]);
+    CHECK(MQTT_ExchangeBufferPeek(&buffer, data, 10) == 10);
+    CHECK(memcmp(data, "0123456789", 10) == 0);
+
+    // Peek leaves the data where it was
+    CHECK(buffer.dataLength == 10);
+    CHECK(buffer.currentLocation == &ring[11]);
+
+    // Never returns more than is buffered
+    CHECK(MQTT_ExchangeBufferPeek(&buffer, data, sizeof(data)) == 10);
+}
+
+static void test_read_wraps(void)
+{
+    uint8_t data[RING_SIZE] = {0};
+
+    fill_wrapped();
+    CHECK(MQTT_ExchangeBufferRead(&buffer, data, 3) == 3);
+    CHECK(memcmp(data, "012", 3) == 0);
+    CHECK(MQTT_ExchangeBufferRead(&buffer, data, sizeof(data)) == 7);
+    CHECK(memcmp(data, "3456789", 7) == 0);
+    CHECK(buffer.dataLength == 0);
+}
+
+static void test_write_stops_when_full(void)
+{
+    uint8_t data[RING_SIZE + 4];
+
+    reset();
+    MQTT_ExchangeBufferWrite(&buffer, (uint8_t*)"0123456789abcdefXYZ", 19);
+    CHECK(buffer.dataLength == RING_SIZE);
+    CHECK(MQTT_ExchangeBufferRead(&buffer, data, sizeof(data)) == RING_SIZE);
+    CHECK(memcmp(data, "0123456789abcdef", RING_SIZE) == 0);
+}
+
+static void test_free_region(void)
+{
+    uint16_t length;
+    uint8_t* region;
+    uint8_t  data[RING_SIZE] = {0};
+
+    // Empty ring: the whole buffer from the start
+    reset();
+    region = MQTT_ExchangeBufferFreeRegion(&buffer, &length);
+    CHECK(region == ring && length == RING_SIZE);
+
+    // Data at the front: free space runs to the end of the buffer
+    memcpy(region, "hello", 5);
+    MQTT_ExchangeBufferCommit(&buffer, 5);
+    region = MQTT_ExchangeBufferFreeRegion(&buffer, &length);
+    CHECK(region == &ring[5] && length == RING_SIZE - 5);
+
+    // Wrapped data: free space is the gap before the head
+    fill_wrapped();
+    region = MQTT_ExchangeBufferFreeRegion(&buffer, &length);
+    CHECK(region == &ring[5] && length == 6);
+    memcpy(region, "ABCDEF", 6);
+    MQTT_ExchangeBufferCommit(&buffer, 6);
+    CHECK(buffer.dataLength == RING_SIZE);
+    MQTT_ExchangeBufferFreeRegion(&buffer, &length);
+    CHECK(length == 0);
+    CHECK(MQTT_ExchangeBufferPeek(&buffer, data, RING_SIZE) == RING_SIZE);
+    CHECK(memcmp(data, "0123456789ABCDEF", RING_SIZE) == 0);
+
+    // Commit never accounts for more than the free space
+    MQTT_ExchangeBufferCommit(&buffer, 4);
+    CHECK(buffer.dataLength == RING_SIZE);
+
+    // Reading does not move the free region, also when it empties the ring
+    fill_wrapped();
+    MQTT_ExchangeBufferRead(&buffer, data, sizeof(data));
+    region = MQTT_ExchangeBufferFreeRegion(&buffer, &length);
+    CHECK(region == &ring[5] && length == RING_SIZE - 5);
+}
+
+static void test_discard_wraps(void)
+{
+    uint8_t data[RING_SIZE] = {0};
+
+    fill_wrapped();
+    CHECK(MQTT_ExchangeBufferDiscard(&buffer, 7) == 7);
+    CHECK(buffer.currentLocation == &ring[2]);
+    CHECK(MQTT_ExchangeBufferRead(&buffer, data, sizeof(data)) == 3);
+    CHECK(memcmp(data, "789", 3) == 0);
+
+    // Never drops more than is buffered
+    fill_wrapped();
+    CHECK(MQTT_ExchangeBufferDiscard(&buffer, RING_SIZE) == 10);
+    CHECK(buffer.dataLength == 0);
+}
+
+/**********************BSD socket calls of mqtt_comm_layer.c *********************/
+static int8_t testSocket = 0;
+static int    closes;
+
+int BSD_send(int socket, const void* msg, size_t len, int flags)
+{
+    return (int)len;
+}
+
+int BSD_recv(int socket, const void* msg, size_t len, int flags)
+{
+    return BSD_SUCCESS;
+}
+
+int BSD_close(int socket)
+{
+    closes++;
+    return BSD_SUCCESS;
+}
+
+/**********************MQTT client ***************************************************/
+pf_MQTT_CLIENT* pf_mqtt_client;
+
+static int     subacks;
+static int     publishes;
+static uint8_t lastPayload[16];
+
+static void test_connected(void)
+{
+    subacks++;
+}
+
+static void test_publishHandler(uint8_t* topic, uint8_t* payload)
+{
+    publishes++;
+    strncpy((char*)lastPayload, (char*)payload, sizeof(lastPayload) - 1);
+}
+
+static pf_MQTT_CLIENT testClient = {NULL, NULL, NULL, NULL, test_connected, NULL};
+
+static publishReceptionHandler_t testHandlers[MAX_NUM_TOPICS_SUBSCRIBE] = {
+    {(uint8_t*)TEST_TOPIC, test_publishHandler}};
+
+static const uint8_t connack[] = {0x20, 0x02, 0x00, 0x00};
+static const uint8_t suback[]  = {0x90, 0x03, 0x00, 0x01, 0x00};
+
+// Hands bytes to the receive path and runs the handlers the way CLOUD_task() does
+static void receive(const uint8_t* data, uint16_t length)
+{
+    mqttContext* context = MQTT_GetClientConnectionInfo();
+    uint8_t      pass;
+
+    MQTT_GetReceivedData((uint8_t*)data, length);
+    for (pass = 0; pass < HANDLER_PASSES; pass++)
+    {
+        MQTT_ReceptionHandler(context);
+        MQTT_TransmissionHandler(context);
+    }
+}
+
+static uint16_t publishPacket(uint8_t* packet, const char* payload)
+{
+    uint16_t topicLength   = sizeof(TEST_TOPIC) - 1;
+    uint16_t payloadLength = strlen(payload);
+
+    packet[0] = 0x30;
+    packet[1] = 2 + topicLength + payloadLength;
+    packet[2] = 0;
+    packet[3] = topicLength;
+    memcpy(&packet[4], TEST_TOPIC, topicLength);
+    memcpy(&packet[4 + topicLength], payload, payloadLength);
+
+    return 4 + topicLength + payloadLength;
+}
+
+// Connected and, when asked, with the SUBACK of the one subscription received
+static void startSession(bool subscribed)
+{
+    mqttContext*        context = MQTT_GetClientConnectionInfo();
+    mqttConnectPacket   connectPacket;
+    mqttSubscribePacket subscribePacket;
+
+    HOST_TIME_reset();
+    SCHED_init();
+    MQTT_ClientInitialize();
+    context->tcpClientSocket = &testSocket;
+    pf_mqtt_client           = &testClient;
+    MQTT_SetPublishReceptionHandlerTable(testHandlers);
+    subacks   = 0;
+    publishes = 0;
+    closes    = 0;
+    memset(lastPayload, 0, sizeof(lastPayload));
+
+    memset(&connectPacket, 0, sizeof(connectPacket));
+    connectPacket.clientID = (uint8_t*)"test";
+    MQTT_CreateConnectPacket(&connectPacket);
+    MQTT_TransmissionHandler(context);
+    receive(connack, sizeof(connack));
+
+    memset(&subscribePacket, 0, sizeof(subscribePacket));
+    subscribePacket.packetIdentifierLSB            = 1;
+    subscribePacket.subscribePayload[0].topic       = (uint8_t*)TEST_TOPIC;
+    subscribePacket.subscribePayload[0].topicLength = sizeof(TEST_TOPIC) - 1;
+    MQTT_CreateSubscribePacket(&subscribePacket);
+    MQTT_TransmissionHandler(context);
+    if (subscribed)
+    {
+        receive(suback, sizeof(suback));
+    }
+}
+
+static void test_suback_and_publish_in_one_segment(void)
+{
+    uint8_t  segment[64];
+    uint16_t length;
+
+    startSession(false);
+    memcpy(segment, suback, sizeof(suback));
+    length = sizeof(suback) + publishPacket(&segment[sizeof(suback)], "one");
+    receive(segment, length);
+
+    CHECK(subacks == 1);
+    CHECK(publishes == 1);
+    CHECK(strcmp((char*)lastPayload, "one") == 0);
+    CHECK(MQTT_GetConnectionState() == CONNECTED);
+    CHECK(MQTT_GetClientConnectionInfo()->mqttDataExchangeBuffers.rxbuff.dataLength == 0);
+}
+
+static void test_stray_suback_then_publish(void)
+{
+    uint8_t  packet[64];
+    uint16_t length;
+
+    // No SUBSCRIBE outstanding, so the second SUBACK is not read, only skipped
+    startSession(true);
+    receive(suback, sizeof(suback));
+    length = publishPacket(packet, "two");
+    receive(packet, length);
+
+    CHECK(subacks == 1);
+    CHECK(publishes == 1);
+    CHECK(strcmp((char*)lastPayload, "two") == 0);
+    CHECK(MQTT_GetClientConnectionInfo()->mqttDataExchangeBuffers.rxbuff.dataLength == 0);
+
+    // Same with both in one segment
+    memcpy(packet, suback, sizeof(suback));
+    length = sizeof(suback) + publishPacket(&packet[sizeof(suback)], "three");
+    receive(packet, length);
+
+    CHECK(publishes == 2);
+    CHECK(strcmp((char*)lastPayload, "three") == 0);
+    CHECK(closes == 0);
+}
+
+static void test_publish_split_across_segments(void)
+{
+    uint8_t  packet[64];
+    uint16_t length;
+
+    startSession(true);
+    length = publishPacket(packet, "four");
+    receive(packet, 3);
+    CHECK(publishes == 0);
+    receive(&packet[3], length - 3);
+
+    CHECK(publishes == 1);
+    CHECK(strcmp((char*)lastPayload, "four") == 0);
+}
+
+static void test_packet_larger_than_ring(void)
+{
+    static uint8_t filler[1000];
+    uint8_t        packet[64];
+    uint16_t       length;
+
+    // A 3000 byte PUBLISH cannot be buffered; it is dropped as it arrives
+    // and the packet after it is handled
+    startSession(true);
+    memset(filler, 'x', sizeof(filler));
+    packet[0] = 0x30;
+    packet[1] = (2997 & 0x7F) | 0x80;
+    packet[2] = 2997 >> 7;
+    receive(packet, 3);
+    receive(filler, sizeof(filler));
+    receive(filler, sizeof(filler));
+    receive(filler, sizeof(filler) - 3);
+    CHECK(MQTT_GetClientConnectionInfo()->mqttDataExchangeBuffers.rxbuff.dataLength == 0);
+
+    length = publishPacket(packet, "five");
+    receive(packet, length);
+
+    CHECK(publishes == 1);
+    CHECK(strcmp((char*)lastPayload, "five") == 0);
+    CHECK(closes == 0);
+}
+
+static void test_publish_lengths(void)
+{
+    static uint8_t large[4 + sizeof(TEST_TOPIC) + PAYLOAD_SIZE];
+    uint8_t        packet[64];
+    uint16_t       length;
+
+    // More payload than the handler buffers is skipped, the next PUBLISH is not
+    startSession(true);
+    length   = sizeof(TEST_TOPIC) - 1;
+    large[0] = 0x30;
+    large[1] = ((2 + length + PAYLOAD_SIZE) & 0x7F) | 0x80;
+    large[2] = (2 + length + PAYLOAD_SIZE) >> 7;
+    large[3] = 0;
+    large[4] = length;
+    memcpy(&large[5], TEST_TOPIC, length);
+    memset(&large[5 + length], 'x', PAYLOAD_SIZE);
+    receive(large, 5 + length + PAYLOAD_SIZE);
+    length = publishPacket(packet, "six");
+    receive(packet, length);
+
+    CHECK(publishes == 1);
+    CHECK(strcmp((char*)lastPayload, "six") == 0);
+    CHECK(closes == 0);
+
+    // A topic running past the end of the packet closes the connection
+    length    = publishPacket(packet, "seven");
+    packet[3] = length;
+    receive(packet, length);
+
+    CHECK(publishes == 1);
+    CHECK(closes == 1);
+    CHECK(MQTT_GetConnectionState() == DISCONNECTED);
+}
+
+static void test_malformed_length_closes(void)
+{
+    static const uint8_t pingresp[] = {0xD0, 0x01, 0x00};
+
+    // A PINGRESP has no payload; the stream cannot be trusted past one that does
+    startSession(true);
+    receive(pingresp, sizeof(pingresp));
+
+    CHECK(closes == 1);
+    CHECK(MQTT_GetConnectionState() == DISCONNECTED);
+}
+
+int main(void)
+{
+    test_peek_wraps();
+    test_read_wraps();
+    test_write_stops_when_full();
+    test_free_region();
+    test_discard_wraps();
+    test_suback_and_publish_in_one_segment();
+    test_stray_suback_then_publish();
+    test_publish_split_across_segments();
+    test_packet_larger_than_ring();
+    test_publish_lengths();
+    test_malformed_length_closes();
+
+    printf("%s\n", failures ? "FAILED" : "PASSED");
+    return failures ? 1 : 0;
+}
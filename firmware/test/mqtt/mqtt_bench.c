@@ -0,0 +1,324 @@
+/*
+    \file   mqtt_bench.c
+
+    \brief  mqtt_bench.ceader file.
+
+    (c) 2018 Microchip Technology Inc. and its subsidiaries.
+
+    Subject to your compliance with these terms, you may use Microchip software and any
+    derivatives exclusively with Microchip products. It is your responsibility to comply with third party
+    license terms applicable to your use of third party software (including open source software) that
+    may accompany Microchip software.
+
+    THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+    EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY
+    IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS
+    FOR A PARTICULAR PURPOSE.
+
+    IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
+    INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND
+    WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP
+    HAS BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO
+    THE FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL
+    CLAIMS IN ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT
+    OF FEES, IF ANY, THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS
+    SOFTWARE.
+*/
+
+
+/* Publish throughput and round trip latency of the firmware MQTT stack on the
+ * build host. cloud_service.c, mqtt_core.c and the MQTT receive path run
+ * unchanged on the POSIX socket backend and talk plain MQTT to a broker: the
+ * in-process loopback broker by default, or a local one such as mosquitto.
+ *
+ *   QoS 1 publishes go out back to back, each after the PUBACK of the one
+ *   before, which is as fast as mqtt_core allows one to be in flight.
+ *   For the round trip the bench subscribes to its own topic and times each
+ *   QoS 0 publish until mqtt_core hands the echo to the publish handler.
+ *
+ * CLOUD_task() runs on every pass of the main loop instead of from the 1 s
+ * application timer, so the numbers are the cost of the stack and the socket
+ * path, not of the firmware's polling interval.
+ *
+ *   mqtt_bench [--quick] [--count N] [--payload BYTES] [--broker HOST:PORT] [--verbose]
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "definitions.h"
+#include "host_bench.h"
+#include "host_platform.h"
+#include "host_socket.h"
+#include "host_time.h"
+#include "loopback_broker.h"
+#include "scheduler.h"
+#include "debug_print.h"
+#include "mqtt/mqtt_core/mqtt_core.h"
+#include "mqtt/mqtt_packetTransfer_interface.h"
+#include "services/iot/cloud/cloud_service.h"
+
+#define BENCH_CLIENT_ID    "mqtt_bench"
+#define BENCH_ECHO_TOPIC   "bench/echo"
+#define BENCH_SINK_TOPIC   "bench/sink"
+#define BENCH_KEEPALIVE_S  60
+#define BENCH_PAYLOAD_MAX  256   // with the topic and header inside TX_BUFF_SIZE
+#define BENCH_TIMEOUT_NS   5000000000ULL
+
+static bool     useLoopback = true;
+static bool     subscribed;
+static uint32_t pubacks;
+static uint32_t echoes;
+
+static uint8_t payload[BENCH_PAYLOAD_MAX];
+
+static void bench_publish(uint8_t* topic, uint8_t* data, uint16_t length, int qos)
+{
+    static uint16_t   packetId;
+    mqttPublishPacket packet;
+
+    memset(&packet, 0, sizeof(packet));
+    packet.publishHeaderFlags.qos = qos;
+    if (qos == 1)
+    {
+        packetId++;
+        packet.packetIdentifierLSB = packetId & 0xFF;
+        packet.packetIdentifierMSB = packetId >> 8;
+    }
+    packet.topic         = topic;
+    packet.payload       = data;
+    packet.payloadLength = length;
+
+    if (!MQTT_CreatePublishPacket(&packet))
+    {
+        printf("FAIL: MQTT_CreatePublishPacket()\n");
+    }
+}
+
+static void bench_receive(uint8_t* data, uint16_t length)
+{
+    MQTT_GetReceivedData(data, length);
+}
+
+static void bench_connect(char* deviceId)
+{
+    mqttConnectPacket packet;
+
+    memset(&packet, 0, sizeof(packet));
+    packet.connectVariableHeader.keepAliveTimer = BENCH_KEEPALIVE_S;
+    packet.clientID                             = (uint8_t*)deviceId;
+    MQTT_CreateConnectPacket(&packet);
+}
+
+static void bench_echoHandler(uint8_t* topic, uint8_t* data)
+{
+    echoes++;
+}
+
+static void bench_pubackHandler(mqttPubackPacket* data)
+{
+    pubacks++;
+}
+
+static bool bench_subscribe(void)
+{
+    static publishReceptionHandler_t handlers[MAX_NUM_TOPICS_SUBSCRIBE];
+    mqttSubscribePacket              packet;
+
+    memset(&packet, 0, sizeof(packet));
+    packet.packetIdentifierLSB                 = 1;
+    packet.subscribePayload[0].topic           = (uint8_t*)BENCH_ECHO_TOPIC;
+    packet.subscribePayload[0].topicLength     = sizeof(BENCH_ECHO_TOPIC) - 1;
+    packet.subscribePayload[0].requestedQoS    = 0;
+    handlers[0].topic                          = (uint8_t*)BENCH_ECHO_TOPIC;
+    handlers[0].mqttHandlePublishDataCallBack  = bench_echoHandler;
+    MQTT_SetPublishReceptionHandlerTable(handlers);
+
+    return MQTT_CreateSubscribePacket(&packet);
+}
+
+// Called by mqtt_core on SUBACK
+static void bench_connected(void)
+{
+    MQTT_Set_Puback_callback(bench_pubackHandler);
+    subscribed = true;
+}
+
+static pf_MQTT_CLIENT benchClient = {
+    bench_publish,
+    bench_receive,
+    bench_connect,
+    bench_subscribe,
+    bench_connected,
+    NULL};
+
+// One pass of the firmware main loop
+static void bench_step(void)
+{
+    HOST_TIME_followWallClock();
+    HOST_SOCKET_Tasks();
+    SCHED_run();
+    CLOUD_task();
+    if (useLoopback)
+    {
+        LOOPBACK_BROKER_poll();
+    }
+}
+
+static bool bench_waitFor(const uint32_t* counter, uint32_t target)
+{
+    uint64_t start = HOST_BENCH_nowNs();
+
+    while (*counter < target)
+    {
+        if (HOST_BENCH_nowNs() - start > BENCH_TIMEOUT_NS)
+        {
+            return false;
+        }
+        bench_step();
+    }
+    return true;
+}
+
+static int compareU64(const void* a, const void* b)
+{
+    uint64_t x = *(const uint64_t*)a;
+    uint64_t y = *(const uint64_t*)b;
+
+    return (x > y) - (x < y);
+}
+
+int main(int argc, char** argv)
+{
+    char*     host        = "127.0.0.1";
+    uint32_t  count       = 1000;
+    uint32_t  payloadSize = 64;
+    uint16_t  port        = 0;
+    uint64_t  start;
+    uint64_t  ns;
+    uint64_t* latencies;
+    uint32_t  i;
+    int       arg;
+
+    HOST_consoleEnable(false);
+    for (arg = 1; arg < argc; arg++)
+    {
+        if (strcmp(argv[arg], "--quick") == 0)
+        {
+            count = 50;
+        }
+        else if (strcmp(argv[arg], "--count") == 0 && arg + 1 < argc)
+        {
+            count = (uint32_t)strtoul(argv[++arg], NULL, 0);
+        }
+        else if (strcmp(argv[arg], "--payload") == 0 && arg + 1 < argc)
+        {
+            payloadSize = (uint32_t)strtoul(argv[++arg], NULL, 0);
+        }
+        else if (strcmp(argv[arg], "--broker") == 0 && arg + 1 < argc)
+        {
+            char* colon;
+
+            host        = argv[++arg];
+            colon       = strrchr(host, ':');
+            useLoopback = false;
+            port        = 1883;
+            if (colon != NULL)
+            {
+                *colon = 0;
+                port   = (uint16_t)strtoul(colon + 1, NULL, 0);
+            }
+        }
+        else if (strcmp(argv[arg], "--verbose") == 0)
+        {
+            HOST_consoleEnable(true);
+            debug_init(BENCH_CLIENT_ID);
+            debug_setSeverity(SEVERITY_TRACE);
+        }
+        else
+        {
+            printf("usage: %s [--quick] [--count N] [--payload BYTES] [--broker HOST:PORT] [--verbose]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (count == 0 || payloadSize > BENCH_PAYLOAD_MAX)
+    {
+        printf("FAIL: count must be > 0 and payload at most %d bytes\n", BENCH_PAYLOAD_MAX);
+        return 2;
+    }
+    for (i = 0; i < payloadSize; i++)
+    {
+        payload[i] = (uint8_t)('a' + i % 26);
+    }
+
+    if (useLoopback && !LOOPBACK_BROKER_start(&port))
+    {
+        printf("FAIL: loopback broker did not start\n");
+        return 1;
+    }
+    HOST_mqttPort = port;
+
+    SCHED_init();
+    CLOUD_init_host(host, BENCH_CLIENT_ID, &benchClient);
+
+    start = HOST_BENCH_nowNs();
+    while (!subscribed)
+    {
+        if (HOST_BENCH_nowNs() - start > BENCH_TIMEOUT_NS)
+        {
+            printf("FAIL: no SUBACK from %s:%u\n", host, (unsigned)port);
+            return 1;
+        }
+        bench_step();
+    }
+    printf("connect to %s:%u, CONNACK and SUBACK in %.3f ms\n", host, (unsigned)port, (double)(HOST_BENCH_nowNs() - start) / 1e6);
+
+    // QoS 1 publish throughput
+    start = HOST_BENCH_nowNs();
+    for (i = 0; i < count; i++)
+    {
+        CLOUD_publishData((uint8_t*)BENCH_SINK_TOPIC, payload, (uint16_t)payloadSize, 1);
+        if (!bench_waitFor(&pubacks, i + 1))
+        {
+            printf("FAIL: no PUBACK for publish %u\n", (unsigned)i);
+            return 1;
+        }
+    }
+    ns = HOST_BENCH_nowNs() - start;
+    printf("%-10s %8s %8s %12s %12s\n", "test", "payload", "count", "msgs/s", "bytes/s");
+    printf("%-10s %8u %8u %12.0f %12.0f\n", "qos1", (unsigned)payloadSize, (unsigned)count,
+           count * 1e9 / (double)ns, (double)count * payloadSize * 1e9 / (double)ns);
+
+    // QoS 0 round trip through the broker
+    latencies = malloc(count * sizeof(latencies[0]));
+    if (latencies == NULL)
+    {
+        return 1;
+    }
+    for (i = 0; i < count; i++)
+    {
+        start = HOST_BENCH_nowNs();
+        CLOUD_publishData((uint8_t*)BENCH_ECHO_TOPIC, payload, (uint16_t)payloadSize, 0);
+        if (!bench_waitFor(&echoes, i + 1))
+        {
+            printf("FAIL: no echo for publish %u\n", (unsigned)i);
+            free(latencies);
+            return 1;
+        }
+        latencies[i] = HOST_BENCH_nowNs() - start;
+    }
+    qsort(latencies, count, sizeof(latencies[0]), compareU64);
+    printf("\n%-10s %8s %8s %10s %10s %10s\n", "test", "payload", "count", "p50 us", "p99 us", "max us");
+    printf("%-10s %8u %8u %10.1f %10.1f %10.1f\n", "roundtrip", (unsigned)payloadSize, (unsigned)count,
+           latencies[count / 2] / 1e3, latencies[(count * 99) / 100] / 1e3, latencies[count - 1] / 1e3);
+    free(latencies);
+
+    // DISCONNECT goes out at once
+    CLOUD_disconnect();
+    if (useLoopback)
+    {
+        LOOPBACK_BROKER_stop();
+    }
+    return 0;
+}
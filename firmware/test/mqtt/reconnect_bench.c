@@ -0,0 +1,406 @@
+/*
+    \file   reconnect_bench.c
+
+    \brief  reconnect_bench.ceader file.
+
+    (c) 2018 Microchip Technology Inc. and its subsidiaries.
+
+    Subject to your compliance with these terms, you may use Microchip software and any
+    derivatives exclusively with Microchip products. It is your responsibility to comply with third party
+    license terms applicable to your use of third party software (including open source software) that
+    may accompany Microchip software.
+
+    THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+    EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY
+    IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS
+    FOR A PARTICULAR PURPOSE.
+
+    IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
+    INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND
+    WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP
+    HAS BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO
+    THE FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL
+    CLAIMS IN ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT
+    OF FEES, IF ANY, THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS
+    SOFTWARE.
+*/
+
+
+
+/* Reconnect time and message latency of cloud_service.c on the scripted WINC
+ * socket simulator. The firmware's bsdWINC.c, cloud_service.c and mqtt_core.c
+ * run unchanged on wincSocketSim.c, and everything happens on the virtual
+ * clock in 1 ms steps, so every run gives the same numbers.
+ *
+ * Each link profile runs in its own child process, which starts from a fresh
+ * firmware state as a device does after boot, and goes through:
+ *
+ *   connect    DNS lookup, TCP/TLS connect, CONNECT/CONNACK, SUBSCRIBE/SUBACK
+ *   reconnect  the broker resets the connection; time from the reset until
+ *              the SUBACK of the new session, backoff included
+ *   latency    QoS 0 publishes that the broker echoes back, from
+ *              CLOUD_publishData() to the publish handler
+ *
+ * CLOUD_task() runs from a periodic timer as in app.c, once with the
+ * firmware's APP_CLOUDTASK_INTERVAL of 1000 ms and once at 100 ms, which
+ * shows how much of each figure is polling rather than the link. A profile
+ * with loss drops every Nth broker response; those echoes count as lost.
+ *
+ *   reconnect_bench [--quick] [--count N] [--verbose]
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "definitions.h"
+#include "host_platform.h"
+#include "host_time.h"
+#include "scheduler.h"
+#include "debug_print.h"
+#include "mqtt/mqtt_core/mqtt_core.h"
+#include "mqtt/mqtt_packetTransfer_interface.h"
+#include "services/iot/cloud/cloud_service.h"
+#include "services/iot/cloud/bsd_adapter/wincSocketSim.h"
+
+#define BENCH_HOST         "bench.example.net"
+#define BENCH_HOST_IP      0x0100007FUL   // 127.0.0.1 as the WINC reports it
+#define BENCH_CLIENT_ID    "reconnect_bench"
+#define BENCH_ECHO_TOPIC   "bench/echo"
+#define BENCH_KEEPALIVE_S  3600   // no PINGREQ within a run
+#define BENCH_PAYLOAD_SIZE 64
+#define BENCH_COUNT_MAX    1000
+#define BENCH_RESET_MS     500    // connection held this long before the reset
+#define BENCH_TIMEOUT_MS   60000
+#define BENCH_ECHO_WAIT_MS 5000   // an echo not back by then is lost
+
+typedef struct
+{
+    const char*     name;
+    uint32_t        taskMs;   // CLOUD_task() period
+    wincSimConfig_t link;
+} benchProfile_t;
+
+// Drops start at the 5th broker response, after both handshakes, so only
+// echoes are lost
+static const benchProfile_t profiles[] = {
+    {"lan", 1000, {1, 0, 0}},
+    {"wifi", 1000, {20, 0, 0}},
+    {"slow", 1000, {150, 64, 0}},
+    {"lossy", 1000, {50, 0, 7}},
+    {"lan", 100, {1, 0, 0}},
+    {"wifi", 100, {20, 0, 0}},
+    {"slow", 100, {150, 64, 0}},
+    {"lossy", 100, {50, 0, 7}},
+};
+
+static const uint8_t connack[] = {0x20, 0x02, 0x00, 0x00};
+static const uint8_t suback[]  = {0x90, 0x03, 0x00, 0x01, 0x00};
+
+static uint8_t       payload[BENCH_PAYLOAD_SIZE];
+static uint8_t       echo[2 + 2 + sizeof(BENCH_ECHO_TOPIC) - 1 + BENCH_PAYLOAD_SIZE];
+static wincSimStep_t script[16 + 2 * BENCH_COUNT_MAX];
+
+static bool     subscribed;
+static uint32_t subackMs;
+static uint32_t echoes;
+static uint32_t echoMs;
+
+static uint32_t bench_nowMs(void)
+{
+    return (uint32_t)(HOST_TIME_nowUs() / 1000);
+}
+
+static void bench_publish(uint8_t* topic, uint8_t* data, uint16_t length, int qos)
+{
+    mqttPublishPacket packet;
+
+    memset(&packet, 0, sizeof(packet));
+    packet.publishHeaderFlags.qos = qos;
+    packet.topic                  = topic;
+    packet.payload                = data;
+    packet.payloadLength          = length;
+
+    if (!MQTT_CreatePublishPacket(&packet))
+    {
+        printf("FAIL: MQTT_CreatePublishPacket()\n");
+    }
+}
+
+static void bench_receive(uint8_t* data, uint16_t length)
+{
+    MQTT_GetReceivedData(data, length);
+}
+
+static void bench_connect(char* deviceId)
+{
+    mqttConnectPacket packet;
+
+    memset(&packet, 0, sizeof(packet));
+    packet.connectVariableHeader.keepAliveTimer = BENCH_KEEPALIVE_S;
+    packet.clientID                             = (uint8_t*)deviceId;
+    MQTT_CreateConnectPacket(&packet);
+}
+
+static void bench_echoHandler(uint8_t* topic, uint8_t* data)
+{
+    echoes++;
+    echoMs = bench_nowMs();
+}
+
+static bool bench_subscribe(void)
+{
+    static publishReceptionHandler_t handlers[MAX_NUM_TOPICS_SUBSCRIBE];
+    mqttSubscribePacket              packet;
+
+    memset(&packet, 0, sizeof(packet));
+    packet.packetIdentifierLSB                 = 1;
+    packet.subscribePayload[0].topic           = (uint8_t*)BENCH_ECHO_TOPIC;
+    packet.subscribePayload[0].topicLength     = sizeof(BENCH_ECHO_TOPIC) - 1;
+    packet.subscribePayload[0].requestedQoS    = 0;
+    handlers[0].topic                          = (uint8_t*)BENCH_ECHO_TOPIC;
+    handlers[0].mqttHandlePublishDataCallBack  = bench_echoHandler;
+    MQTT_SetPublishReceptionHandlerTable(handlers);
+
+    return MQTT_CreateSubscribePacket(&packet);
+}
+
+// Called by mqtt_core on SUBACK
+static void bench_connected(void)
+{
+    subscribed = true;
+    subackMs   = bench_nowMs();
+}
+
+static pf_MQTT_CLIENT benchClient = {
+    bench_publish,
+    bench_receive,
+    bench_connect,
+    bench_subscribe,
+    bench_connected,
+    NULL};
+
+// APP_CloudTaskcb() in app.c
+static void bench_cloudTaskcb(uintptr_t context)
+{
+    SCHED_post(SCHED_EVENT_APP_CLOUD_TASK);
+}
+
+// One millisecond of the firmware main loop
+static void bench_step(void)
+{
+    HOST_TIME_advanceUs(1000);
+    WINC_SIM_Tasks(bench_nowMs());
+    SCHED_run();
+}
+
+static bool bench_waitFor(const bool* flag, uint32_t timeoutMs)
+{
+    uint32_t start = bench_nowMs();
+
+    while (!*flag)
+    {
+        if (bench_nowMs() - start > timeoutMs)
+        {
+            return false;
+        }
+        bench_step();
+    }
+    return true;
+}
+
+static uint16_t bench_buildScript(uint32_t count)
+{
+    uint16_t n = 0;
+    uint32_t i;
+
+    // First session, resolving the host
+    script[n++] = (wincSimStep_t){WINC_SIM_RESOLVE, 0, (int32_t)BENCH_HOST_IP, NULL, 0};
+    script[n++] = (wincSimStep_t){WINC_SIM_CONNECT, 0, 0, NULL, 0};
+    script[n++] = (wincSimStep_t){WINC_SIM_AWAIT_SEND, 0, 0, NULL, 0};
+    script[n++] = (wincSimStep_t){WINC_SIM_RECV, 0, 0, connack, sizeof(connack)};
+    script[n++] = (wincSimStep_t){WINC_SIM_AWAIT_SEND, 0, 0, NULL, 0};
+    script[n++] = (wincSimStep_t){WINC_SIM_RECV, 0, 0, suback, sizeof(suback)};
+    script[n++] = (wincSimStep_t){WINC_SIM_RESET, BENCH_RESET_MS, 0, NULL, 0};
+
+    // Second session, the address comes from the DNS cache
+    script[n++] = (wincSimStep_t){WINC_SIM_CONNECT, 0, 0, NULL, 0};
+    script[n++] = (wincSimStep_t){WINC_SIM_AWAIT_SEND, 0, 0, NULL, 0};
+    script[n++] = (wincSimStep_t){WINC_SIM_RECV, 0, 0, connack, sizeof(connack)};
+    script[n++] = (wincSimStep_t){WINC_SIM_AWAIT_SEND, 0, 0, NULL, 0};
+    script[n++] = (wincSimStep_t){WINC_SIM_RECV, 0, 0, suback, sizeof(suback)};
+
+    for (i = 0; i < count; i++)
+    {
+        script[n++] = (wincSimStep_t){WINC_SIM_AWAIT_SEND, 0, 0, NULL, 0};
+        script[n++] = (wincSimStep_t){WINC_SIM_RECV, 0, 0, echo, sizeof(echo)};
+    }
+    script[n++] = (wincSimStep_t){WINC_SIM_END, 0, 0, NULL, 0};
+    return n;
+}
+
+static int compareU32(const void* a, const void* b)
+{
+    uint32_t x = *(const uint32_t*)a;
+    uint32_t y = *(const uint32_t*)b;
+
+    return (x > y) - (x < y);
+}
+
+// Runs in a child process and prints one row of the table
+static int bench_run(const benchProfile_t* profile, uint32_t count)
+{
+    static uint32_t latencies[BENCH_COUNT_MAX];
+    uint32_t        connectMs;
+    uint32_t        reconnectMs;
+    uint32_t        received = 0;
+    uint32_t        lost     = 0;
+    uint32_t        start;
+    uint32_t        i;
+
+    HOST_TIME_reset();
+    bench_buildScript(count);
+    WINC_SIM_init(script, &profile->link, NULL);
+    SCHED_init();
+    SCHED_register(SCHED_EVENT_APP_CLOUD_TASK, CLOUD_task);
+    SYS_TIME_CallbackRegisterMS(bench_cloudTaskcb, 0, profile->taskMs, SYS_TIME_PERIODIC);
+    CLOUD_init_host(BENCH_HOST, BENCH_CLIENT_ID, &benchClient);
+
+    if (!bench_waitFor(&subscribed, BENCH_TIMEOUT_MS))
+    {
+        printf("FAIL: %s no SUBACK on the first connection\n", profile->name);
+        return 1;
+    }
+    connectMs = subackMs;
+
+    subscribed = false;
+    if (!bench_waitFor(&subscribed, BENCH_TIMEOUT_MS))
+    {
+        printf("FAIL: %s no SUBACK after the reset\n", profile->name);
+        return 1;
+    }
+    reconnectMs = subackMs - wincSimStats.resetMs;
+
+    for (i = 0; i < count; i++)
+    {
+        bool     echoed;
+        uint32_t target = echoes + 1;
+
+        start = bench_nowMs();
+        CLOUD_publishData((uint8_t*)BENCH_ECHO_TOPIC, payload, BENCH_PAYLOAD_SIZE, 0);
+        while (echoes < target && bench_nowMs() - start <= BENCH_ECHO_WAIT_MS)
+        {
+            bench_step();
+        }
+        echoed = (echoes == target);
+        if (echoed)
+        {
+            latencies[received++] = echoMs - start;
+        }
+        else
+        {
+            lost++;
+        }
+    }
+    if (received == 0 || !WINC_SIM_done())
+    {
+        printf("FAIL: %s %u of %u echoes, script %s\n", profile->name, (unsigned)received, (unsigned)count,
+               WINC_SIM_done() ? "done" : "not done");
+        return 1;
+    }
+    if (wincSimStats.unanswered != 0)
+    {
+        printf("FAIL: %s %u resolve or connect requests the script did not expect\n", profile->name,
+               (unsigned)wincSimStats.unanswered);
+        return 1;
+    }
+    qsort(latencies, received, sizeof(latencies[0]), compareU32);
+
+    printf("%-8s %6u %5u %5u %5u %8u %10u %10u %7u %7u %7u %5u\n", profile->name, (unsigned)profile->taskMs,
+           (unsigned)profile->link.latencyMs, (unsigned)profile->link.segmentMax, (unsigned)profile->link.dropEvery,
+           (unsigned)connectMs, (unsigned)cloudConnectStats.lastWithDnsCacheMs, (unsigned)reconnectMs,
+           (unsigned)latencies[received / 2], (unsigned)latencies[(received * 99) / 100], (unsigned)latencies[received - 1],
+           (unsigned)lost);
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t count  = 200;
+    int      failed = 0;
+    size_t   p;
+    uint32_t i;
+    int      arg;
+
+    HOST_consoleEnable(false);
+    for (arg = 1; arg < argc; arg++)
+    {
+        if (strcmp(argv[arg], "--quick") == 0)
+        {
+            count = 20;
+        }
+        else if (strcmp(argv[arg], "--count") == 0 && arg + 1 < argc)
+        {
+            count = (uint32_t)strtoul(argv[++arg], NULL, 0);
+        }
+        else if (strcmp(argv[arg], "--verbose") == 0)
+        {
+            HOST_consoleEnable(true);
+            debug_init(BENCH_CLIENT_ID);
+            debug_setSeverity(SEVERITY_TRACE);
+        }
+        else
+        {
+            printf("usage: %s [--quick] [--count N] [--verbose]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (count == 0 || count > BENCH_COUNT_MAX)
+    {
+        printf("FAIL: count must be 1 to %d\n", BENCH_COUNT_MAX);
+        return 2;
+    }
+
+    for (i = 0; i < BENCH_PAYLOAD_SIZE; i++)
+    {
+        payload[i] = (uint8_t)('a' + i % 26);
+    }
+    // The broker's copy of each publish, QoS 0
+    echo[0] = 0x30;
+    echo[1] = sizeof(echo) - 2;
+    echo[2] = 0;
+    echo[3] = sizeof(BENCH_ECHO_TOPIC) - 1;
+    memcpy(&echo[4], BENCH_ECHO_TOPIC, sizeof(BENCH_ECHO_TOPIC) - 1);
+    memcpy(&echo[4 + sizeof(BENCH_ECHO_TOPIC) - 1], payload, BENCH_PAYLOAD_SIZE);
+
+    printf("virtual time in ms, %u echoes of %d bytes per profile\n", (unsigned)count, BENCH_PAYLOAD_SIZE);
+    printf("%-8s %6s %5s %5s %5s %8s %10s %10s %7s %7s %7s %5s\n", "link", "task", "lat", "seg", "drop",
+           "connect", "re-CONNACK", "reconnect", "p50", "p99", "max", "lost");
+    fflush(stdout);
+
+    for (p = 0; p < sizeof(profiles) / sizeof(profiles[0]); p++)
+    {
+        pid_t pid = fork();
+        int   status;
+
+        if (pid < 0)
+        {
+            perror("fork");
+            return 1;
+        }
+        if (pid == 0)
+        {
+            int result = bench_run(&profiles[p], count);
+
+            fflush(stdout);
+            _exit(result);
+        }
+        if (waitpid(pid, &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+        {
+            failed = 1;
+        }
+    }
+    return failed;
+}
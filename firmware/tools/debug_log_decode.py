@@ -0,0 +1,165 @@
+#!/usr/bin/env python3
+"""Expand binary debug log records from the SAM-IoT console.
+
+Build the firmware with CFG_DEBUG_BINARY_LOG 1, capture the console to a
+file (or pipe it in), and decode it with the ELF of the same build:
+
+    debug_log_decode.py AzureIotPnpDps.X/dist/SAMD21_WG_IOT/production/AzureIotPnpDps.X.production.elf capture.bin
+
+Each record holds the flash address of its format string and the raw
+arguments, see debug_print.c.  Bytes outside records, such as CLI output,
+are passed through unchanged.
+"""
+
+import argparse
+import re
+import struct
+import sys
+
+SYNC = b"\xa5\x5a"
+HEADER_SIZE = 12
+SEVERITIES = ["NONE", "ERROR", "WARN", "DEBUG", "INFO", "TRACE"]
+LEVELS = ["INFO", "GOOD", "WARN", "ERROR"]
+CONVERSION = re.compile(r"%([-+ #0]*)(\*|\d+)?(?:\.(\*|\d*))?([hlLqjzt]*)([diouxXcspfeEgGn%])")
+CSI = re.compile(r"\x1b\[[0-9;]*[A-Za-z]")
+
+
+class Elf:
+    """Reads NUL-terminated strings from the loadable sections of an ELF32 file."""
+
+    def __init__(self, path):
+        with open(path, "rb") as f:
+            self.data = f.read()
+        if self.data[:4] != b"\x7fELF" or self.data[4] != 1:
+            raise ValueError("%s is not an ELF32 file" % path)
+        shoff, = struct.unpack_from("<I", self.data, 0x20)
+        shentsize, shnum = struct.unpack_from("<HH", self.data, 0x2E)
+        self.sections = []
+        for i in range(shnum):
+            _, sh_type, _, addr, offset, size = struct.unpack_from("<IIIIII", self.data, shoff + i * shentsize)
+            if sh_type == 1 and addr:   # SHT_PROGBITS
+                self.sections.append((addr, offset, size))
+
+    def string(self, address):
+        for addr, offset, size in self.sections:
+            if addr <= address < addr + size:
+                start = offset + address - addr
+                end = self.data.index(b"\0", start)
+                return self.data[start:end].decode("latin-1")
+        return None
+
+
+def decode_args(fmt, data):
+    """Rebuilds the argument tuple and a Python format string from the record."""
+    values = []
+    pos = 0
+    out = []
+    last = 0
+
+    def take(size, code):
+        nonlocal pos
+        value, = struct.unpack_from(code, data, pos)
+        pos += size
+        return value
+
+    for m in CONVERSION.finditer(fmt):
+        flags, width, precision, length, conv = m.groups()
+        out.append(fmt[last:m.start()].replace("%", "%%"))
+        last = m.end()
+        if conv == "%":
+            out.append("%%")
+            continue
+        if width == "*":
+            values.append(take(4, "<i"))
+        if precision == "*":
+            values.append(take(4, "<i"))
+        spec = "%" + flags + (width or "") + ("." + precision if precision is not None else "")
+        if conv == "s":
+            size = data[pos]
+            values.append(data[pos + 1:pos + 1 + size].decode("latin-1"))
+            pos += 1 + size
+            out.append(spec + "s")
+        elif conv in "feEgG":
+            values.append(take(8, "<d"))
+            out.append(spec + conv)
+        elif conv == "n":
+            values.append(take(4, "<I"))
+            out.append("")
+            values.pop()
+        elif length.count("l") + length.count("q") + length.count("j") >= 2:
+            values.append(take(8, "<q" if conv in "di" else "<Q"))
+            out.append(spec + ("d" if conv == "i" else conv))
+        elif conv == "p":
+            values.append(take(4, "<I"))
+            out.append("0x%08x")
+        elif conv in "di":
+            values.append(take(4, "<i"))
+            out.append(spec + "d")
+        else:
+            values.append(take(4, "<I"))
+            out.append(spec + conv)
+    out.append(fmt[last:].replace("%", "%%"))
+    return "".join(out) % tuple(values)
+
+
+def decode(elf, stream, out, tick_hz, keep_color):
+    buf = stream.read()
+    i = 0
+    while i < len(buf):
+        j = buf.find(SYNC, i)
+        if j < 0:
+            out.write(buf[i:].decode("latin-1"))
+            break
+        out.write(buf[i:j].decode("latin-1"))
+        if j + HEADER_SIZE > len(buf):
+            break
+        size = buf[j + 2]
+        end = j + HEADER_SIZE + size
+        if end >= len(buf):
+            break
+        check = 0
+        for b in buf[j:end]:
+            check ^= b
+        if check != buf[end]:
+            # Not a record, pass the sync bytes through and resync
+            out.write(buf[j:j + 1].decode("latin-1"))
+            i = j + 1
+            continue
+        severity, level = buf[j + 3] >> 4, buf[j + 3] & 0x0F
+        address, count = struct.unpack_from("<II", buf, j + 4)
+        args = buf[j + HEADER_SIZE:end]
+        if address == 0:
+            text = "%u log records dropped" % struct.unpack_from("<I", args)[0]
+        else:
+            fmt = elf.string(address)
+            if fmt is None:
+                text = "unknown format at 0x%08x" % address
+            else:
+                try:
+                    text = decode_args(fmt, args)
+                except (struct.error, IndexError, TypeError, ValueError) as e:
+                    text = "bad record for %r: %s" % (fmt, e)
+        if not keep_color:
+            text = CSI.sub("", text)
+        out.write("%10.6f %5s %5s %s\n" % (count / tick_hz,
+                                           SEVERITIES[severity] if severity < len(SEVERITIES) else severity,
+                                           LEVELS[level] if level < len(LEVELS) else level,
+                                           text))
+        i = end + 1
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("elf", help="ELF file of the running firmware")
+    parser.add_argument("capture", nargs="?", default="-", help="console capture, - for stdin")
+    parser.add_argument("--tick-hz", type=float, default=1000000.0, help="SYS_TIME counter frequency")
+    parser.add_argument("--color", action="store_true", help="keep the ANSI colour sequences")
+    args = parser.parse_args()
+
+    elf = Elf(args.elf)
+    stream = sys.stdin.buffer if args.capture == "-" else open(args.capture, "rb")
+    decode(elf, stream, sys.stdout, args.tick_hz, args.color)
+
+
+if __name__ == "__main__":
+    main()
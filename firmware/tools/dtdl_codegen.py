@@ -0,0 +1,305 @@
+#!/usr/bin/env python3
+"""Generate the C property, telemetry and command tables from the DTDL model.
+
+    dtdl_codegen.py [--model ../device_model/sam_iot_wm-2.json] [--out-dir src] [--check]
+
+Writes src/dtdl_model.h and src/dtdl_model.c.  Each table is sorted by name
+so the firmware finds an entry with a binary search, and each entry points at
+handlers named after the model:
+
+    dtdl_desired_<property>    writable properties, parses the desired value
+    dtdl_reported_<property>   every property, supplies the reported value
+    dtdl_telemetry_<name>      primitive telemetry, reads the value to send
+    dtdl_command_<name>        commands, builds the response
+
+azutil.c implements the handlers.  Object telemetry has no handler, its
+builder writes the fields itself.  Re-run after editing the model and commit
+the output with it; --check exits non-zero when the committed files are stale.
+"""
+
+import argparse
+import json
+import os
+import re
+import sys
+
+TOOLS_DIR = os.path.dirname(os.path.abspath(__file__))
+DEFAULT_MODEL = os.path.join(TOOLS_DIR, "..", "..", "device_model", "sam_iot_wm-2.json")
+DEFAULT_OUT_DIR = os.path.join(TOOLS_DIR, "..", "src")
+
+# DTDL schema to dtdl_schema_t
+SCHEMAS = {
+    "boolean": "DTDL_SCHEMA_BOOLEAN",
+    "date": "DTDL_SCHEMA_DATE",
+    "dateTime": "DTDL_SCHEMA_DATETIME",
+    "double": "DTDL_SCHEMA_DOUBLE",
+    "duration": "DTDL_SCHEMA_DURATION",
+    "float": "DTDL_SCHEMA_FLOAT",
+    "integer": "DTDL_SCHEMA_INTEGER",
+    "long": "DTDL_SCHEMA_LONG",
+    "string": "DTDL_SCHEMA_STRING",
+    "time": "DTDL_SCHEMA_TIME",
+    "Enum": "DTDL_SCHEMA_ENUM",
+    "Object": "DTDL_SCHEMA_OBJECT",
+    "Array": "DTDL_SCHEMA_ARRAY",
+    "Map": "DTDL_SCHEMA_MAP",
+}
+
+# Values that fit the int32_t handlers
+INT32_SCHEMAS = ("DTDL_SCHEMA_INTEGER", "DTDL_SCHEMA_ENUM")
+
+
+def macro_name(name):
+    """telemetryInterval -> TELEMETRY_INTERVAL, led_b -> LED_B"""
+    return re.sub(r"(?<=[a-z0-9])([A-Z])", r"_\1", name).upper()
+
+
+def c_string(text):
+    return '"%s"' % text.replace("\\", "\\\\").replace('"', '\\"')
+
+
+class Model:
+    def __init__(self, path):
+        with open(path, "r") as f:
+            self.doc = json.load(f)
+        self.path = path
+        self.schemas = {s["@id"]: s for s in self.doc.get("schemas", [])}
+        self.properties = []
+        self.telemetry = []
+        self.commands = []
+        self.enums = []
+
+        for item in self.doc["contents"]:
+            types = item["@type"] if isinstance(item["@type"], list) else [item["@type"]]
+            if "Property" in types:
+                self.properties.append(item)
+            elif "Telemetry" in types:
+                self.telemetry.append(item)
+            elif "Command" in types:
+                self.commands.append(item)
+            else:
+                raise ValueError("%s: unsupported content type %s" % (item.get("name"), types))
+
+        for schema in self.schemas.values():
+            if schema["@type"] == "Enum":
+                self.enums.append(schema)
+
+        for table in (self.properties, self.telemetry, self.commands):
+            table.sort(key=lambda item: item["name"].encode())
+
+        for item in self.properties:
+            if self.schema(item) not in INT32_SCHEMAS:
+                raise ValueError("property %s: only integer and integer enum properties are supported" % item["name"])
+
+    def schema(self, item):
+        schema = item["schema"]
+        if isinstance(schema, str):
+            schema = self.schemas.get(schema, schema)
+        if isinstance(schema, dict):
+            if schema["@type"] == "Enum" and schema.get("valueSchema") != "integer":
+                raise ValueError("%s: only integer enums are supported" % item["name"])
+            return SCHEMAS[schema["@type"]]
+        return SCHEMAS[schema]
+
+
+def generate_header(model, source):
+    out = []
+    out.append("// Generated by tools/dtdl_codegen.py from %s, do not edit." % source)
+    out.append("")
+    out.append("#ifndef DTDL_MODEL_H_")
+    out.append("#define DTDL_MODEL_H_")
+    out.append("#include <stdbool.h>")
+    out.append("#include <stdint.h>")
+    out.append('#include "azutil.h"')
+    out.append("")
+    out.append("#define DTDL_MODEL_ID %s" % c_string(model.doc["@id"]))
+    out.append("")
+
+    for enum in model.enums:
+        prefix = "DTDL_" + macro_name(enum["@id"].split(":")[-1].split(";")[0])
+        out.append("// %s" % enum["@id"])
+        width = max(len(prefix + "_" + macro_name(v["name"])) for v in enum["enumValues"])
+        for value in enum["enumValues"]:
+            out.append("#define %-*s %d" % (width, prefix + "_" + macro_name(value["name"]), value["enumValue"]))
+        out.append("")
+
+    out.append("typedef enum")
+    out.append("{")
+    for i, name in enumerate(SCHEMAS.values()):
+        out.append("    %s%s," % (name, " = 0" if i == 0 else ""))
+    out.append("} dtdl_schema_t;")
+    out.append("")
+
+    out.append("typedef az_result (*dtdl_desired_handler_t)(az_json_token* token, twin_properties_t* twin_properties);")
+    out.append("typedef bool (*dtdl_reported_handler_t)(const twin_properties_t* twin_properties, int32_t* value);")
+    out.append("typedef int32_t (*dtdl_telemetry_handler_t)(void);")
+    out.append("typedef az_result (*dtdl_command_handler_t)(az_span payload_span, az_span response_span, az_span* out_response_span, uint16_t* out_response_status);")
+    out.append("")
+    out.append("typedef struct")
+    out.append("{")
+    out.append("    az_span                 name;")
+    out.append("    dtdl_schema_t           schema;")
+    out.append("    dtdl_desired_handler_t  desired;    // NULL for read-only properties")
+    out.append("    dtdl_reported_handler_t reported;   // returns true when the value changed")
+    out.append("} dtdl_property_t;")
+    out.append("")
+    out.append("typedef struct")
+    out.append("{")
+    out.append("    az_span                  name;")
+    out.append("    dtdl_schema_t            schema;")
+    out.append("    dtdl_telemetry_handler_t read;   // NULL for objects, their builder writes the fields")
+    out.append("} dtdl_telemetry_t;")
+    out.append("")
+    out.append("typedef struct")
+    out.append("{")
+    out.append("    az_span                name;")
+    out.append("    dtdl_command_handler_t handler;")
+    out.append("} dtdl_command_t;")
+    out.append("")
+
+    for kind, table in (("PROPERTY", model.properties), ("TELEMETRY", model.telemetry), ("COMMAND", model.commands)):
+        out.append("typedef enum")
+        out.append("{")
+        for i, item in enumerate(table):
+            out.append("    DTDL_%s_%s%s," % (kind, macro_name(item["name"]), " = 0" if i == 0 else ""))
+        out.append("    DTDL_%s_COUNT" % kind)
+        out.append("} dtdl_%s_index_t;" % kind.lower())
+        out.append("")
+
+    out.append("// Sorted by name")
+    out.append("extern const dtdl_property_t  dtdlProperties[DTDL_PROPERTY_COUNT];")
+    out.append("extern const dtdl_telemetry_t dtdlTelemetry[DTDL_TELEMETRY_COUNT];")
+    out.append("extern const dtdl_command_t   dtdlCommands[DTDL_COMMAND_COUNT];")
+    out.append("")
+    out.append("const dtdl_property_t*  DTDL_findProperty(az_span name);")
+    out.append("const dtdl_telemetry_t* DTDL_findTelemetry(az_span name);")
+    out.append("const dtdl_command_t*   DTDL_findCommand(az_span name);")
+    out.append("")
+
+    out.append("// Handlers, implemented by the application")
+    for item in model.properties:
+        if item.get("writable"):
+            out.append("az_result dtdl_desired_%s(az_json_token* token, twin_properties_t* twin_properties);" % item["name"])
+        out.append("bool      dtdl_reported_%s(const twin_properties_t* twin_properties, int32_t* value);" % item["name"])
+    for item in model.telemetry:
+        if model.schema(item) in INT32_SCHEMAS:
+            out.append("int32_t   dtdl_telemetry_%s(void);" % item["name"])
+    for item in model.commands:
+        out.append("az_result dtdl_command_%s(az_span payload_span, az_span response_span, az_span* out_response_span, uint16_t* out_response_status);" % item["name"])
+    out.append("")
+    out.append("#endif /* DTDL_MODEL_H_ */")
+    return "\n".join(out) + "\n"
+
+
+def generate_source(model, source):
+    out = []
+    out.append("// Generated by tools/dtdl_codegen.py from %s, do not edit." % source)
+    out.append("")
+    out.append("#include <stddef.h>")
+    out.append("#include <string.h>")
+    out.append('#include "dtdl_model.h"')
+    out.append("")
+
+    out.append("const dtdl_property_t dtdlProperties[DTDL_PROPERTY_COUNT] = {")
+    for item in model.properties:
+        desired = "dtdl_desired_%s" % item["name"] if item.get("writable") else "NULL"
+        out.append("    {AZ_SPAN_LITERAL_FROM_STR(%s), %s, %s, dtdl_reported_%s}," % (c_string(item["name"]), model.schema(item), desired, item["name"]))
+    out.append("};")
+    out.append("")
+
+    out.append("const dtdl_telemetry_t dtdlTelemetry[DTDL_TELEMETRY_COUNT] = {")
+    for item in model.telemetry:
+        schema = model.schema(item)
+        read = "dtdl_telemetry_%s" % item["name"] if schema in INT32_SCHEMAS else "NULL"
+        out.append("    {AZ_SPAN_LITERAL_FROM_STR(%s), %s, %s}," % (c_string(item["name"]), schema, read))
+    out.append("};")
+    out.append("")
+
+    out.append("const dtdl_command_t dtdlCommands[DTDL_COMMAND_COUNT] = {")
+    for item in model.commands:
+        out.append("    {AZ_SPAN_LITERAL_FROM_STR(%s), dtdl_command_%s}," % (c_string(item["name"]), item["name"]))
+    out.append("};")
+    out.append("")
+
+    out.append("// Every table entry starts with its az_span name, so one search serves all three")
+    out.append("static const void* dtdl_search(az_span name, const void* table, size_t count, size_t stride)")
+    out.append("{")
+    out.append("    size_t low  = 0;")
+    out.append("    size_t high = count;")
+    out.append("")
+    out.append("    while (low < high)")
+    out.append("    {")
+    out.append("        size_t         mid   = low + (high - low) / 2;")
+    out.append("        const az_span* key   = (const az_span*)((const uint8_t*)table + mid * stride);")
+    out.append("        int32_t        size  = az_span_size(name) < az_span_size(*key) ? az_span_size(name) : az_span_size(*key);")
+    out.append("        int            order = memcmp(az_span_ptr(name), az_span_ptr(*key), (size_t)size);")
+    out.append("")
+    out.append("        if (order == 0)")
+    out.append("        {")
+    out.append("            order = az_span_size(name) - az_span_size(*key);")
+    out.append("        }")
+    out.append("        if (order == 0)")
+    out.append("        {")
+    out.append("            return key;")
+    out.append("        }")
+    out.append("        if (order < 0)")
+    out.append("        {")
+    out.append("            high = mid;")
+    out.append("        }")
+    out.append("        else")
+    out.append("        {")
+    out.append("            low = mid + 1;")
+    out.append("        }")
+    out.append("    }")
+    out.append("    return NULL;")
+    out.append("}")
+    out.append("")
+    for kind, table, type_name in (("Property", "dtdlProperties", "dtdl_property_t"),
+                                   ("Telemetry", "dtdlTelemetry", "dtdl_telemetry_t"),
+                                   ("Command", "dtdlCommands", "dtdl_command_t")):
+        out.append("const %s* DTDL_find%s(az_span name)" % (type_name, kind))
+        out.append("{")
+        out.append("    return dtdl_search(name, %s, DTDL_%s_COUNT, sizeof(%s));" % (table, kind.upper(), type_name))
+        out.append("}")
+        out.append("")
+    return "\n".join(out).rstrip("\n") + "\n"
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--model", default=DEFAULT_MODEL, help="DTDL interface (default device_model/sam_iot_wm-2.json)")
+    parser.add_argument("--out-dir", default=DEFAULT_OUT_DIR, help="where to write dtdl_model.h/.c (default src)")
+    parser.add_argument("--check", action="store_true", help="fail if the files on disk differ instead of writing them")
+    args = parser.parse_args()
+
+    try:
+        model = Model(args.model)
+    except (OSError, ValueError, KeyError) as e:
+        sys.exit("dtdl_codegen: %s" % e)
+
+    source = "device_model/" + os.path.basename(args.model)
+    outputs = {
+        "dtdl_model.h": generate_header(model, source),
+        "dtdl_model.c": generate_source(model, source),
+    }
+
+    stale = []
+    for name, text in outputs.items():
+        path = os.path.join(args.out_dir, name)
+        if args.check:
+            try:
+                with open(path, "r", newline="") as f:
+                    if f.read() != text:
+                        stale.append(path)
+            except OSError:
+                stale.append(path)
+        else:
+            with open(path, "w", newline="\n") as f:
+                f.write(text)
+
+    if stale:
+        sys.exit("dtdl_codegen: out of date, re-run: %s" % ", ".join(stale))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,134 @@
+#!/usr/bin/env python3
+"""Per-module static RAM budget from the linker map file.
+
+The MPLAB project writes a map file next to the ELF.  Run this on it after a
+build:
+
+    ram_budget.py AzureIotPnpDps.X/dist/SAMD21_WG_IOT/production/AzureIotPnpDps.X.production.map
+
+Every input section placed in RAM is charged to the object file (or archive
+member) it came from, split into .data (initialized, also costs flash) and
+.bss (zeroed).  The heap and stack reservations are listed after the modules.
+With --max-static the script exits non-zero when .data and .bss together grow
+past the given size, so it can run as a post-build step.  The live heap and
+stack high-water marks come from the "mem" CLI command.
+"""
+
+import argparse
+import os
+import re
+import sys
+from collections import defaultdict
+
+MEMORY = re.compile(r"^(\w+)\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)")
+INPUT = re.compile(r"^\s+((?!0x)\S+)?\s*0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)\s+(\S.*)$")
+RESERVE = re.compile(r"^(\.heap|\.stack)\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)")
+
+
+def parse(path, region):
+    """Returns (ram origin, ram length, {module: [data, bss]}, {reserve: size})."""
+    origin = length = None
+    modules = defaultdict(lambda: [0, 0])
+    reserves = {}
+    in_memory = False
+    in_map = False
+    pending = None
+
+    with open(path, "r", errors="replace") as f:
+        for line in f:
+            line = line.rstrip("\r\n")
+            if line.startswith("Memory Configuration"):
+                in_memory = True
+                continue
+            if line.startswith("Linker script and memory map"):
+                in_memory = False
+                in_map = True
+                continue
+
+            if in_memory:
+                m = MEMORY.match(line)
+                if m and m.group(1) == region:
+                    origin, length = int(m.group(2), 16), int(m.group(3), 16)
+                continue
+            if not in_map or origin is None:
+                continue
+
+            m = RESERVE.match(line)
+            if m:
+                reserves[m.group(1)] = int(m.group(3), 16)
+                continue
+
+            # ld puts long section names on a line of their own
+            stripped = line.strip()
+            if line.startswith(" ") and stripped and " " not in stripped and stripped.startswith((".", "COMMON")):
+                pending = stripped
+                continue
+
+            m = INPUT.match(line)
+            name = (m.group(1) or pending) if m else None
+            pending = None
+            if not m or not name or name == "*fill*":
+                continue
+
+            address, size, source = int(m.group(2), 16), int(m.group(3), 16), m.group(4).strip()
+            if size == 0 or not origin <= address < origin + length:
+                continue
+            if name.startswith((".data", ".ramfunc")):
+                kind = 0
+            elif name.startswith((".bss", ".sbss", "COMMON", ".noinit")):
+                kind = 1
+            else:
+                continue
+            modules[module_name(source)][kind] += size
+
+    if origin is None:
+        raise ValueError("no '%s' region in the Memory Configuration of %s" % (region, path))
+    return origin, length, modules, reserves
+
+
+def module_name(source):
+    """Object file name, or library(member) for archive members."""
+    m = re.match(r"(.*?)\((.*)\)$", source)
+    if m:
+        return "%s(%s)" % (os.path.basename(m.group(1)), m.group(2))
+    return os.path.basename(source)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("map", help="linker map file")
+    parser.add_argument("--region", default="ram", help="memory region name in the map (default ram)")
+    parser.add_argument("--top", type=int, default=0, help="list only the N largest modules")
+    parser.add_argument("--max-static", type=lambda s: int(s, 0), help="fail when .data + .bss exceed this many bytes")
+    args = parser.parse_args()
+
+    try:
+        _, length, modules, reserves = parse(args.map, args.region)
+    except (OSError, ValueError) as e:
+        sys.exit("ram_budget: %s" % e)
+
+    rows = sorted(modules.items(), key=lambda item: sum(item[1]), reverse=True)
+    if args.top:
+        rows = rows[: args.top]
+
+    print("%-40s %7s %7s %7s %6s" % ("module", "data", "bss", "total", "ram"))
+    for name, (data, bss) in rows:
+        print("%-40s %7d %7d %7d %5.1f%%" % (name[-40:], data, bss, data + bss, 100.0 * (data + bss) / length))
+
+    data = sum(d for d, _ in modules.values())
+    bss = sum(b for _, b in modules.values())
+    static = data + bss
+    print("%-40s %7d %7d %7d %5.1f%%" % ("static total", data, bss, static, 100.0 * static / length))
+    used = static
+    for name in (".heap", ".stack"):
+        if name in reserves:
+            used += reserves[name]
+            print("%-40s %23d %5.1f%%" % (name + " reserve", reserves[name], 100.0 * reserves[name] / length))
+    print("%-40s %23d %5.1f%%" % ("unallocated", length - used, 100.0 * (length - used) / length))
+
+    if args.max_static is not None and static > args.max_static:
+        sys.exit("ram_budget: static RAM %d bytes is over the %d byte budget" % (static, args.max_static))
+
+
+if __name__ == "__main__":
+    main()